@@ -663,6 +663,7 @@ struct rtl8139_private {
 	unsigned long		fifo_copy_timeout;
 
 	ec_device_t *ecdev;
+	int ec_irq_requested; /* IRQ line held for ec_irq() */
 };
 
 MODULE_AUTHOR("Florian Pose <fp@igh-essen.com>");
@@ -682,6 +683,7 @@ MODULE_PARM_DESC (media, "8139too: Bits 4+9: force full duplex, bit 5: 100Mbps")
 MODULE_PARM_DESC (full_duplex, "8139too: Force full duplex for board(s) (1)");
 
 void ec_poll(struct net_device *);
+void ec_irq(struct net_device *, int);
 
 static int read_eeprom (void __iomem *ioaddr, int location, int addr_len);
 static int rtl8139_open (struct net_device *dev);
@@ -699,6 +701,7 @@ static void rtl8139_poll_controller(struct net_device *dev);
 static int rtl8139_set_mac_address(struct net_device *dev, void *p);
 static int rtl8139_poll(struct napi_struct *napi, int budget);
 static irqreturn_t rtl8139_interrupt (int irq, void *dev_instance);
+static irqreturn_t rtl8139_ec_interrupt (int irq, void *dev_instance);
 static int rtl8139_close (struct net_device *dev);
 static int netdev_ioctl (struct net_device *dev, struct ifreq *rq, int cmd);
 static struct rtnl_link_stats64 *rtl8139_get_stats64(struct net_device *dev,
@@ -1158,6 +1161,7 @@ static int rtl8139_init_one(struct pci_dev *pdev,
 		RTL_W8 (HltClk, 'H');	/* 'R' would leave the clock running. */
 
 	if (tp->ecdev) {
+		ecdev_set_irq_func(tp->ecdev, ec_irq);
 		i = ecdev_open(tp->ecdev);
 		if (i) {
 			ecdev_withdraw(tp->ecdev);
@@ -1397,15 +1401,15 @@ static int rtl8139_open (struct net_device *dev)
 		if (retval)
 			return retval;
 	}
+	/* in EtherCAT mode, the line is requested by ec_irq() on demand */
 
 	tp->tx_bufs = dma_alloc_coherent(&tp->pci_dev->dev, TX_BUF_TOT_LEN,
 					   &tp->tx_bufs_dma, GFP_KERNEL);
 	tp->rx_ring = dma_alloc_coherent(&tp->pci_dev->dev, RX_BUF_TOT_LEN,
 					   &tp->rx_ring_dma, GFP_KERNEL);
 	if (tp->tx_bufs == NULL || tp->rx_ring == NULL) {
-		if (!tp->ecdev) {
+		if (!tp->ecdev)
 			free_irq(irq, dev);
-		}
 
 		if (tp->tx_bufs)
 			dma_free_coherent(&tp->pci_dev->dev, TX_BUF_TOT_LEN,
@@ -2283,6 +2287,43 @@ void ec_poll(struct net_device *dev)
 	rtl8139_interrupt(0, dev);
 }
 
+/* Enables or disables the receive interrupts in EtherCAT mode. The frames
+   are still processed by ec_poll(), the interrupt only wakes up the master.
+   The line is only requested, when the master enables the interrupt for the
+   first time (idle_irq module parameter of the master), and held until the
+   device is closed. Called from the master thread. */
+void ec_irq(struct net_device *dev, int enable)
+{
+	struct rtl8139_private *tp = netdev_priv(dev);
+	void __iomem *ioaddr = tp->mmio_addr;
+
+	if (enable && !tp->ec_irq_requested) {
+		if (request_irq(tp->pci_dev->irq, rtl8139_ec_interrupt,
+					IRQF_SHARED, dev->name, dev)) {
+			return; /* the master keeps polling */
+		}
+		tp->ec_irq_requested = 1;
+	}
+
+	RTL_W16_F (IntrMask, enable ? RxOK | RxErr | RxOverflow | RxFIFOOver : 0);
+}
+
+/* Interrupt handler in EtherCAT mode. Masks the interrupt and notifies the
+   master, the status is acknowledged by the next ec_poll(). */
+static irqreturn_t rtl8139_ec_interrupt (int irq, void *dev_instance)
+{
+	struct net_device *dev = (struct net_device *) dev_instance;
+	struct rtl8139_private *tp = netdev_priv(dev);
+	void __iomem *ioaddr = tp->mmio_addr;
+
+	if (!(RTL_R16 (IntrMask) & RTL_R16 (IntrStatus)))
+		return IRQ_NONE;
+
+	RTL_W16 (IntrMask, 0);
+	ecdev_irq(tp->ecdev);
+	return IRQ_HANDLED;
+}
+
 /* The interrupt handler does all of the Rx thread work and cleans up
    after the Tx thread. */
 static irqreturn_t rtl8139_interrupt (int irq, void *dev_instance)
@@ -2432,8 +2473,11 @@ static int rtl8139_close (struct net_device *dev)
 
 	if (!tp->ecdev) {
 		spin_unlock_irqrestore (&tp->lock, flags);
+	}
 
+	if (!tp->ecdev || tp->ec_irq_requested) {
 		free_irq(tp->pci_dev->irq, dev);
+		tp->ec_irq_requested = 0;
 	}
 
 	rtl8139_tx_clear (tp);
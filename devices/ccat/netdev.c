@@ -50,6 +50,7 @@ static const u8 frameForwardEthernetFrames[] = {
 };
 
 #define FIFO_LENGTH 64
+#define TX_BATCH_LENGTH 8
 #define POLL_TIME ktime_set(0, 50 * NSEC_PER_USEC)
 #define CCAT_ALIGNMENT ((size_t)(128 * 1024))
 #define CCAT_ALIGN_CHANNEL(x, c) ((typeof(x))(ALIGN((size_t)((x) + ((c) * CCAT_ALIGNMENT)), CCAT_ALIGNMENT)))
@@ -149,6 +150,8 @@ struct ccat_mem {
  * @reg: PCI register address of this fifo
  * @rx_bytes: number of bytes processed -> reported with ndo_get_stats64()
  * @rx_dropped: number of dropped frames -> reported with ndo_get_stats64()
+ * @pending: tx descriptors prepared, but not yet written to @reg
+ * @num_pending: number of valid entries in @pending
  * @mem/dma/eim: information about the associated memory
  */
 struct ccat_eth_fifo {
@@ -157,6 +160,8 @@ struct ccat_eth_fifo {
 	void __iomem *reg;
 	atomic64_t bytes;
 	atomic64_t dropped;
+	u32 pending[TX_BATCH_LENGTH];
+	size_t num_pending;
 	union {
 		struct ccat_mem mem;
 		struct ccat_dma dma;
@@ -170,10 +175,12 @@ struct ccat_eth_fifo {
  * @add: callback used to add a frame to this fifo
  * @copy_to_skb: callback used to copy from rx fifos to skbs
  * @skb: callback used to queue skbs into tx fifos
+ * @flush: optional callback used to start all frames queued into tx fifos
  */
 struct ccat_eth_fifo_operations {
 	size_t(*ready) (struct ccat_eth_fifo *);
 	void (*add) (struct ccat_eth_fifo *);
+	void (*flush) (struct ccat_eth_fifo *);
 	union {
 		void (*copy_to_skb) (struct ccat_eth_fifo *, struct sk_buff *,
 				     size_t);
@@ -202,6 +209,7 @@ struct ccat_mac_infoblock {
  * @rx_fifo: fifo used for RX descriptors
  * @tx_fifo: fifo used for TX descriptors
  * @poll_timer: interval timer used to poll CCAT for events like link changed, rx done, tx done
+ * @tx_batch: defer tx descriptors until the EtherCAT master flushes them
  */
 struct ccat_eth_priv {
 	struct ccat_function *func;
@@ -212,6 +220,7 @@ struct ccat_eth_priv {
 	struct hrtimer poll_timer;
 	struct ccat_dma_mem dma_mem;
 	ec_device_t *ecdev;
+	bool tx_batch;
 	void (*carrier_off) (struct net_device * netdev);
 	 bool(*carrier_ok) (const struct net_device * netdev);
 	void (*carrier_on) (struct net_device * netdev);
@@ -412,6 +421,7 @@ static void ccat_eth_fifo_hw_reset(struct ccat_eth_fifo *const fifo)
 static void ccat_eth_fifo_reset(struct ccat_eth_fifo *const fifo)
 {
 	ccat_eth_fifo_hw_reset(fifo);
+	fifo->num_pending = 0;
 
 	if (fifo->ops->add) {
 		fifo->mem.next = fifo->mem.start;
@@ -479,7 +489,27 @@ static void fifo_dma_queue_skb(struct ccat_eth_fifo *const fifo,
 	addr_and_length += ((void *)frame - fifo->dma.start);
 	addr_and_length +=
 	    ((skb->len + sizeof(struct ccat_dma_frame_hdr)) / 8) << 24;
-	iowrite32(addr_and_length, fifo->reg);
+	fifo->pending[fifo->num_pending++] = addr_and_length;
+}
+
+/**
+ * fifo_dma_flush() - start all frames queued by fifo_dma_queue_skb()
+ *
+ * The descriptors are written back to back, after a single barrier ensured
+ * the frame data of the whole batch is visible to the CCAT DMA engine.
+ */
+static void fifo_dma_flush(struct ccat_eth_fifo *const fifo)
+{
+	const size_t num = fifo->num_pending;
+	size_t i;
+
+	if (!num)
+		return;
+
+	wmb();
+	for (i = 0; i < num; ++i)
+		iowrite32(fifo->pending[i], fifo->reg);
+	fifo->num_pending = 0;
 }
 
 static const struct ccat_eth_fifo_operations dma_rx_fifo_ops = {
@@ -491,6 +521,7 @@ static const struct ccat_eth_fifo_operations dma_rx_fifo_ops = {
 static const struct ccat_eth_fifo_operations dma_tx_fifo_ops = {
 	.add = ccat_eth_tx_fifo_dma_add_free,
 	.ready = fifo_dma_tx_ready,
+	.flush = fifo_dma_flush,
 	.queue.skb = fifo_dma_queue_skb,
 };
 
@@ -608,6 +639,14 @@ static void ccat_eth_priv_init_reg(struct ccat_eth_priv *const priv)
 	reg->misc = func_base + offsets.misc;
 }
 
+static void ccat_eth_tx_flush(struct ccat_eth_priv *const priv)
+{
+	struct ccat_eth_fifo *const fifo = &priv->tx_fifo;
+
+	if (fifo->ops->flush)
+		fifo->ops->flush(fifo);
+}
+
 static netdev_tx_t ccat_eth_start_xmit(struct sk_buff *skb,
 				       struct net_device *dev)
 {
@@ -646,7 +685,11 @@ static netdev_tx_t ccat_eth_start_xmit(struct sk_buff *skb,
 	ccat_eth_fifo_inc(fifo);
 	/* stop queue if tx ring is full */
 	if (!fifo->ops->ready(fifo)) {
+		ccat_eth_tx_flush(priv);
 		priv->stop_queue(priv->netdev);
+	} else if (!priv->tx_batch ||
+		   fifo->num_pending == ARRAY_SIZE(fifo->pending)) {
+		ccat_eth_tx_flush(priv);
 	}
 	return NETDEV_TX_OK;
 }
@@ -666,6 +709,7 @@ static void ccat_eth_xmit_raw(struct net_device *dev, const char *const data,
 	skb_copy_to_linear_data(skb, data, len);
 	skb_put(skb, len);
 	ccat_eth_start_xmit(skb, dev);
+	ccat_eth_tx_flush(netdev_priv(dev));
 }
 
 static void ccat_eth_receive(struct ccat_eth_priv *const priv, const size_t len)
@@ -744,17 +788,19 @@ static void poll_link(struct ccat_eth_priv *const priv)
 }
 
 /**
- * Poll for available rx dma descriptors in ethernet operating mode
+ * Poll for available rx dma descriptors and drain all completed ones
  */
 static void poll_rx(struct ccat_eth_priv *const priv)
 {
 	struct ccat_eth_fifo *const fifo = &priv->rx_fifo;
-	const size_t len = fifo->ops->ready(fifo);
+	size_t frames = 0;
+	size_t len;
 
-	if (len) {
+	while (frames < FIFO_LENGTH && (len = fifo->ops->ready(fifo))) {
 		priv->receive(priv, len);
 		fifo->ops->add(fifo);
 		ccat_eth_fifo_inc(fifo);
+		++frames;
 	}
 }
 
@@ -765,6 +811,11 @@ static void ec_poll(struct net_device *dev)
 	poll_rx(priv);
 }
 
+static void ec_flush(struct net_device *dev)
+{
+	ccat_eth_tx_flush(netdev_priv(dev));
+}
+
 /**
  * Poll for available tx dma descriptors in ethernet operating mode
  */
@@ -904,6 +955,8 @@ static int ccat_eth_init_netdev(struct ccat_eth_priv *priv)
 	priv->unregister = unregister_ecdev;
 	priv->ecdev = ecdev_offer(priv->netdev, ec_poll, THIS_MODULE);
 	if (priv->ecdev) {
+		ecdev_set_flush_func(priv->ecdev, ec_flush);
+		priv->tx_batch = true;
 		priv->carrier_off(priv->netdev);
 		if (ecdev_open(priv->ecdev)) {
 			pr_info("unable to register network device.\n");
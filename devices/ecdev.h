@@ -56,6 +56,21 @@ typedef struct ec_device ec_device_t; /**< \see ec_device */
  */
 typedef void (*ec_pollfunc_t)(struct net_device *);
 
+/** Device interrupt control function type.
+ *
+ * Enables (non-zero) or disables (zero) the receive interrupt of the device.
+ * When enabling, the device shall raise an interrupt immediately, if frames
+ * are already pending.
+ */
+typedef void (*ec_irqfunc_t)(struct net_device *, int);
+
+/** Device transmit flush function type.
+ *
+ * Hands all frames to the hardware, that the driver has queued, but not yet
+ * started, since the last call.
+ */
+typedef void (*ec_flushfunc_t)(struct net_device *);
+
 /******************************************************************************
  * Offering/withdrawal functions
  *****************************************************************************/
@@ -63,6 +78,8 @@ typedef void (*ec_pollfunc_t)(struct net_device *);
 ec_device_t *ecdev_offer(struct net_device *net_dev, ec_pollfunc_t poll,
         struct module *module);
 void ecdev_withdraw(ec_device_t *device);
+void ecdev_set_irq_func(ec_device_t *device, ec_irqfunc_t irq);
+void ecdev_set_flush_func(ec_device_t *device, ec_flushfunc_t flush);
 
 /******************************************************************************
  * Device methods
@@ -73,6 +90,7 @@ void ecdev_close(ec_device_t *device);
 void ecdev_receive(ec_device_t *device, const void *data, size_t size);
 void ecdev_set_link(ec_device_t *device, uint8_t state);
 uint8_t ecdev_get_link(const ec_device_t *device);
+void ecdev_irq(ec_device_t *device);
 
 /*****************************************************************************/
 
@@ -39,6 +39,9 @@
 #include <linux/version.h>
 #include <linux/if_arp.h> /* ARPHRD_ETHER */
 #include <linux/etherdevice.h>
+#include <linux/netdevice.h>
+#include <linux/rtnetlink.h>
+#include <linux/skbuff.h>
 
 #include "../globals.h"
 #include "ecdev.h"
@@ -49,6 +52,17 @@
 
 #define EC_GEN_RX_BUF_SIZE 1600
 
+/** Maximum number of received frames queued by the receive handler.
+ */
+#define EC_GEN_RX_QUEUE_SIZE 64
+
+/** The receive handler interface with the skb pointer argument is available
+ * since 2.6.39.
+ */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 39)
+#define EC_GEN_RX_HANDLER
+#endif
+
 /*****************************************************************************/
 
 int __init ec_gen_init_module(void);
@@ -63,6 +77,13 @@ MODULE_DESCRIPTION("EtherCAT master generic Ethernet device module");
 MODULE_LICENSE("GPL");
 MODULE_VERSION(EC_MASTER_VERSION);
 
+#ifdef EC_GEN_RX_HANDLER
+static unsigned int stack_bypass; /**< Stack bypass parameter. */
+module_param_named(stack_bypass, stack_bypass, uint, S_IRUGO);
+MODULE_PARM_DESC(stack_bypass, "Exchange frames directly with the network"
+        " devices instead of using packet sockets");
+#endif
+
 /** \endcond */
 
 struct list_head generic_devices;
@@ -74,6 +95,11 @@ typedef struct {
     struct socket *socket;
     ec_device_t *ecdev;
     uint8_t *rx_buf;
+#ifdef EC_GEN_RX_HANDLER
+    int rx_handler; /**< The receive handler is registered. */
+    struct sk_buff_head rx_queue; /**< Frames queued by the receive
+                                    handler. */
+#endif
 } ec_gen_device_t;
 
 typedef struct {
@@ -148,6 +174,10 @@ int ec_gen_device_init(
     dev->ecdev = NULL;
     dev->socket = NULL;
     dev->rx_buf = NULL;
+#ifdef EC_GEN_RX_HANDLER
+    dev->rx_handler = 0;
+    skb_queue_head_init(&dev->rx_queue);
+#endif
 
 #if (LINUX_VERSION_CODE < KERNEL_VERSION(3, 17, 0)) 
     dev->netdev = alloc_netdev(sizeof(ec_gen_device_t *), &null, ether_setup); 
@@ -187,6 +217,15 @@ void ec_gen_device_clear(
     if (dev->socket) {
         sock_release(dev->socket);
     }
+#ifdef EC_GEN_RX_HANDLER
+    if (dev->rx_handler) {
+        rtnl_lock();
+        netdev_rx_handler_unregister(dev->used_netdev);
+        rtnl_unlock();
+        dev->rx_handler = 0;
+    }
+    skb_queue_purge(&dev->rx_queue);
+#endif
     free_netdev(dev->netdev);
 
     if (dev->rx_buf) {
@@ -253,6 +292,90 @@ int ec_gen_device_create_socket(
 
 /*****************************************************************************/
 
+#ifdef EC_GEN_RX_HANDLER
+
+/** Receive handler of the used network device.
+ *
+ * Takes EtherCAT frames before they are passed to the network stack and
+ * queues them for ec_gen_device_poll().
+ */
+static rx_handler_result_t ec_gen_rx_handler(
+        struct sk_buff **pskb
+        )
+{
+    struct sk_buff *skb = *pskb;
+    ec_gen_device_t *dev = rcu_dereference(skb->dev->rx_handler_data);
+
+    if (skb->protocol != htons(ETH_P_ETHERCAT)) {
+        return RX_HANDLER_PASS;
+    }
+
+    skb = skb_share_check(skb, GFP_ATOMIC);
+    if (!skb) {
+        return RX_HANDLER_CONSUMED;
+    }
+
+    if (skb_queue_len(&dev->rx_queue) >= EC_GEN_RX_QUEUE_SIZE) {
+        kfree_skb(skb);
+    } else {
+        skb_queue_tail(&dev->rx_queue, skb);
+    }
+
+    return RX_HANDLER_CONSUMED;
+}
+
+/*****************************************************************************/
+
+/** Registers the receive handler at the used network device.
+ */
+int ec_gen_device_register_rx_handler(
+        ec_gen_device_t *dev
+        )
+{
+    int ret;
+
+    rtnl_lock();
+    ret = netdev_rx_handler_register(dev->used_netdev, ec_gen_rx_handler,
+            dev);
+    rtnl_unlock();
+
+    if (ret) {
+        printk(KERN_ERR PFX "Failed to register receive handler at %s"
+                " (ret = %i).\n", dev->used_netdev->name, ret);
+        return ret;
+    }
+
+    printk(KERN_INFO PFX "Bypassing network stack on %s.\n",
+            dev->used_netdev->name);
+    dev->rx_handler = 1;
+    return 0;
+}
+
+#endif
+
+/*****************************************************************************/
+
+/** Connects to the used network device.
+ *
+ * Registers a receive handler, if the network stack shall be bypassed.
+ * Otherwise (or if that fails), a packet socket is used.
+ */
+int ec_gen_device_connect(
+        ec_gen_device_t *dev,
+        ec_gen_interface_desc_t *desc
+        )
+{
+#ifdef EC_GEN_RX_HANDLER
+    if (stack_bypass && !ec_gen_device_register_rx_handler(dev)) {
+        return 0;
+    }
+#endif
+
+    return ec_gen_device_create_socket(dev, desc);
+}
+
+/*****************************************************************************/
+
 /** Offer generic device to master.
  */
 int ec_gen_device_offer(
@@ -267,7 +390,7 @@ int ec_gen_device_offer(
 
     dev->ecdev = ecdev_offer(dev->netdev, ec_gen_poll, THIS_MODULE);
     if (dev->ecdev) {
-        if (ec_gen_device_create_socket(dev, desc)) {
+        if (ec_gen_device_connect(dev, desc)) {
             ecdev_withdraw(dev->ecdev);
             dev->ecdev = NULL;
         } else if (ecdev_open(dev->ecdev)) {
@@ -318,6 +441,25 @@ int ec_gen_device_start_xmit(
 
     ecdev_set_link(dev->ecdev, netif_carrier_ok(dev->used_netdev));
 
+#ifdef EC_GEN_RX_HANDLER
+    if (dev->rx_handler) {
+        // the master re-uses its socket buffers, so send a copy
+        struct sk_buff *tx_skb = netdev_alloc_skb(dev->used_netdev, len);
+
+        if (!tx_skb) {
+            return NETDEV_TX_BUSY;
+        }
+
+        memcpy(skb_put(tx_skb, len), skb->data, len);
+        skb_reset_mac_header(tx_skb);
+        tx_skb->dev = dev->used_netdev;
+        tx_skb->protocol = htons(ETH_P_ETHERCAT);
+
+        return dev_queue_xmit(tx_skb) == NET_XMIT_SUCCESS ?
+            NETDEV_TX_OK : NETDEV_TX_BUSY;
+    }
+#endif
+
     iov.iov_base = skb->data;
     iov.iov_len = len;
     memset(&msg, 0, sizeof(msg));
@@ -341,6 +483,22 @@ void ec_gen_device_poll(
 
     ecdev_set_link(dev->ecdev, netif_carrier_ok(dev->used_netdev));
 
+#ifdef EC_GEN_RX_HANDLER
+    if (dev->rx_handler) {
+        struct sk_buff *skb;
+
+        while (budget-- && (skb = skb_dequeue(&dev->rx_queue))) {
+            // the receive path has already pulled the Ethernet header
+            if (!skb_linearize(skb)) {
+                ecdev_receive(dev->ecdev, skb_mac_header(skb),
+                        skb->len + ETH_HLEN);
+            }
+            consume_skb(skb);
+        }
+        return;
+    }
+#endif
+
     do {
         iov.iov_base = dev->rx_buf;
         iov.iov_len = EC_GEN_RX_BUF_SIZE;
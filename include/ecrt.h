@@ -69,6 +69,24 @@
  * - Added ecrt_slave_config_reg_pdo_entry_pos() and the feature flag
  *   EC_HAVE_REG_BY_POS for registering PDO entries with non-unique indices
  *   via their positions in the mapping.
+ * - Added ecrt_master_read_idns() and ecrt_master_write_idns() to transfer
+ *   lists of IDNs at once, the data type ec_soe_transfer_t and the feature
+ *   flag EC_HAVE_SOE_LIST.
+ * - Added ecrt_sdo_request_notify(), ecrt_reg_request_notify(),
+ *   ecrt_voe_handler_notify(), ecrt_master_completions(),
+ *   ecrt_master_event_fd(), the data type ec_request_completion_t and the
+ *   feature flag EC_HAVE_COMPLETIONS for collecting the results of
+ *   asynchronous requests from a completion queue.
+ * - Added a master-wide CoE emergency event stream, that can be read from
+ *   the master's character device and via ecrt_master_emerg_events(), the
+ *   data type ec_coe_emerg_event_t and the feature flag
+ *   EC_HAVE_EMERG_STREAM.
+ * - Added ecrt_master_wait_link_up(), ecrt_master_wait_scan() and
+ *   ecrt_master_wait_al_state() to block until the bus is ready instead of
+ *   polling ecrt_master_state(), and the feature flag EC_HAVE_MASTER_WAIT.
+ * - Added ecrt_sdo_request_write_with_size() to download less data than the
+ *   request memory holds, so that one SDO request can be used for objects of
+ *   different sizes, and the feature flag EC_HAVE_SDO_WRITE_WITH_SIZE.
  *
  * Changes in version 1.5:
  *
@@ -187,6 +205,31 @@
  */
 #define EC_HAVE_REG_BY_POS
 
+/** Defined if the methods ecrt_master_read_idns() and
+ * ecrt_master_write_idns() are available.
+ */
+#define EC_HAVE_SOE_LIST
+
+/** Defined if the methods ecrt_sdo_request_notify(),
+ * ecrt_reg_request_notify(), ecrt_voe_handler_notify() and
+ * ecrt_master_completions() are available.
+ */
+#define EC_HAVE_COMPLETIONS
+
+/** Defined if the master-wide CoE emergency stream and
+ * ecrt_master_emerg_events() are available.
+ */
+#define EC_HAVE_EMERG_STREAM
+
+/** Defined if the methods ecrt_master_wait_link_up(),
+ * ecrt_master_wait_scan() and ecrt_master_wait_al_state() are available.
+ */
+#define EC_HAVE_MASTER_WAIT
+
+/** Defined if the method ecrt_sdo_request_write_with_size() is available.
+ */
+#define EC_HAVE_SDO_WRITE_WITH_SIZE
+
 /*****************************************************************************/
 
 /** End of list marker.
@@ -527,6 +570,39 @@ typedef enum {
 
 /*****************************************************************************/
 
+/** CoE emergency event.
+ *
+ * Record of the master-wide emergency stream, see
+ * ecrt_master_emerg_events(). Userspace applications can also read() these
+ * records from the master's character device.
+ */
+typedef struct {
+    uint64_t timestamp; /**< Reception time in ns since 1970-01-01. */
+    uint16_t slave_position; /**< Ring position of the slave. */
+    uint16_t alias; /**< Effective alias address of the slave. */
+    uint8_t data[EC_COE_EMERGENCY_MSG_SIZE]; /**< Emergency message (error
+                                               code, error register and
+                                               vendor data). */
+    uint8_t reserved[4]; /**< Reserved, always zero. */
+} ec_coe_emerg_event_t;
+
+/*****************************************************************************/
+
+/** Request completion.
+ *
+ * This is used as element type for ecrt_master_completions(). It reports
+ * the final state of a request, for which a notification was enabled via
+ * ecrt_sdo_request_notify(), ecrt_reg_request_notify() or
+ * ecrt_voe_handler_notify().
+ */
+typedef struct {
+    uint64_t tag; /**< Tag given when enabling the notification. */
+    ec_request_state_t state; /**< Final request state (EC_REQUEST_SUCCESS
+                                or EC_REQUEST_ERROR). */
+} ec_request_completion_t;
+
+/*****************************************************************************/
+
 /** Application-layer state.
  */
 typedef enum {
@@ -561,6 +637,24 @@ typedef struct {
 
 /*****************************************************************************/
 
+/** SoE IDN transfer.
+ *
+ * This is used as an element of the IDN lists of ecrt_master_read_idns() and
+ * ecrt_master_write_idns().
+ */
+typedef struct {
+    uint16_t idn; /**< SoE IDN (see ecrt_slave_config_idn()). */
+    uint8_t *data; /**< Data to write, or memory for the read data. */
+    size_t size; /**< Size of the data to write, or of the memory \a data
+                   points to for reading. */
+    size_t result_size; /**< Actual size of the read data. If the memory was
+                          too small, this is the size needed. */
+    uint16_t error_code; /**< SoE error code. */
+    int result; /**< Zero on success, otherwise a negative error code. */
+} ec_soe_transfer_t;
+
+/*****************************************************************************/
+
 /******************************************************************************
  * Global functions
  *****************************************************************************/
@@ -957,6 +1051,40 @@ int ecrt_master_read_idn(
                                can be stored. */
         );
 
+/** Executes a list of SoE read requests.
+ *
+ * All requests are queued at once and processed back-to-back by the slave's
+ * state machine. The function blocks until all requests were processed. The
+ * outcome of each request is stored in its list element.
+ *
+ * \retval  0 Success.
+ * \retval -EIO At least one of the requests failed.
+ * \retval <0 Error code.
+ */
+int ecrt_master_read_idns(
+        ec_master_t *master, /**< EtherCAT master. */
+        uint16_t slave_position, /**< Slave position. */
+        uint8_t drive_no, /**< Drive number. */
+        ec_soe_transfer_t *transfers, /**< IDN list. */
+        size_t count /**< Number of elements in \a transfers. */
+        );
+
+/** Executes a list of SoE write requests.
+ *
+ * \see ecrt_master_read_idns()
+ *
+ * \retval  0 Success.
+ * \retval -EIO At least one of the requests failed.
+ * \retval <0 Error code.
+ */
+int ecrt_master_write_idns(
+        ec_master_t *master, /**< EtherCAT master. */
+        uint16_t slave_position, /**< Slave position. */
+        uint8_t drive_no, /**< Drive number. */
+        ec_soe_transfer_t *transfers, /**< IDN list. */
+        size_t count /**< Number of elements in \a transfers. */
+        );
+
 /** Finishes the configuration phase and prepares for cyclic operation.
  *
  * This function tells the master that the configuration phase is finished and
@@ -1186,6 +1314,126 @@ void ecrt_master_reset(
         ec_master_t *master /**< EtherCAT master. */
         );
 
+/** Fetches request completions.
+ *
+ * Removes up to \a max_count entries from the master's completion queue.
+ * An entry is posted each time a request with enabled notification (see
+ * ecrt_sdo_request_notify(), ecrt_reg_request_notify() and
+ * ecrt_voe_handler_notify()) finishes. This way, an application can keep
+ * many acyclic requests outstanding without querying each of them in every
+ * cycle.
+ *
+ * The queue holds a limited number of entries. If completions had to be
+ * dropped, because the queue was not emptied in time, -EOVERFLOW is returned
+ * once and the states of the affected requests have to be queried
+ * individually.
+ *
+ * This method does not block and may be called in realtime context.
+ *
+ * \return Number of completions stored in \a completions, or a negative
+ *         error code.
+ */
+int ecrt_master_completions(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_request_completion_t *completions, /**< Completion array. */
+        size_t max_count /**< Size of \a completions. */
+        );
+
+#ifndef __KERNEL__
+
+/** Returns a file descriptor to wait for request completions.
+ *
+ * The descriptor becomes readable for poll(), select() or epoll, as soon as
+ * the completion queue is not empty or new CoE emergency events arrived. The
+ * completions have to be fetched via ecrt_master_completions(), the events
+ * via ecrt_master_emerg_events(). The descriptor is owned by the master and
+ * must not be closed or read from.
+ *
+ * \return File descriptor, or a negative error code.
+ */
+int ecrt_master_event_fd(
+        ec_master_t *master /**< EtherCAT master. */
+        );
+
+/** Fetches CoE emergency events.
+ *
+ * All emergency messages received from any slave of the bus are collected
+ * in a master-wide stream. Each application only sees the events that were
+ * received after it opened the master. The descriptor returned by
+ * ecrt_master_event_fd() becomes readable, when new events arrive, so no
+ * periodic polling of the individual slave configurations is necessary.
+ *
+ * The stream keeps a limited number of events. If the application does not
+ * fetch them in time, the oldest events are dropped and counted in \a
+ * overruns.
+ *
+ * This method does not block.
+ *
+ * \return Number of events stored in \a events, or a negative error code.
+ */
+int ecrt_master_emerg_events(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_coe_emerg_event_t *events, /**< Event array. */
+        size_t max_count, /**< Size of \a events. */
+        unsigned int *overruns /**< Number of events dropped since the last
+                                 call, or NULL. */
+        );
+
+/** Waits until at least one device has link.
+ *
+ * Sleeps in the kernel until the master state machine reports a change, so
+ * the call returns as soon as the link is up.
+ *
+ * \attention RTDM devices do not support the blocking wait, with the RTDM
+ * library the master state is polled every 10 ms instead.
+ *
+ * \return Zero on success, -ETIMEDOUT if \a timeout_ms elapsed, otherwise a
+ *         negative error code.
+ */
+int ecrt_master_wait_link_up(
+        ec_master_t *master, /**< EtherCAT master. */
+        unsigned int timeout_ms /**< Timeout in milliseconds. */
+        );
+
+/** Waits until the bus scan is complete.
+ *
+ * The scan is complete, when the master state machine has seen the link, no
+ * scan is running or pending and the number of scanned slaves equals the
+ * number of responding slaves. A pending rescan is ignored for a requested
+ * master, as it is not done before activation. Only useful before the master is activated,
+ * as no scans are done afterwards.
+ *
+ * \attention With the RTDM library the master state is polled every 10 ms.
+ * Whether the master state machine has already seen the link is not visible
+ * there, so the call may return shortly before the kernel would.
+ *
+ * \return Zero on success, -ETIMEDOUT if \a timeout_ms elapsed, otherwise a
+ *         negative error code.
+ */
+int ecrt_master_wait_scan(
+        ec_master_t *master, /**< EtherCAT master. */
+        unsigned int timeout_ms /**< Timeout in milliseconds. */
+        );
+
+/** Waits until all slaves are in an application-layer state.
+ *
+ * Implies ecrt_master_wait_scan() and requires at least one slave.
+ *
+ * \attention With the RTDM library the master state is polled every 10 ms,
+ * see ecrt_master_wait_scan().
+ *
+ * \return Zero on success, -ETIMEDOUT if \a timeout_ms elapsed, otherwise a
+ *         negative error code.
+ */
+int ecrt_master_wait_al_state(
+        ec_master_t *master, /**< EtherCAT master. */
+        uint8_t al_state, /**< Application-layer state (1 = INIT, 2 =
+                            PREOP, 4 = SAFEOP, 8 = OP). */
+        unsigned int timeout_ms /**< Timeout in milliseconds. */
+        );
+
+#endif /* #ifndef __KERNEL__ */
+
 /******************************************************************************
  * Slave configuration methods
  *****************************************************************************/
@@ -1903,6 +2151,24 @@ void ecrt_sdo_request_write(
         ec_sdo_request_t *req /**< SDO request. */
         );
 
+/** Schedule an SDO write operation with an explicit data size.
+ *
+ * Downloads the first \a size bytes of the request data. Together with
+ * ecrt_sdo_request_index() this allows to reuse one request for objects of
+ * different sizes.
+ *
+ * \attention This method may not be called while ecrt_sdo_request_state()
+ * returns EC_REQUEST_BUSY.
+ *
+ * \retval 0 Success.
+ * \retval -EINVAL \a size is zero.
+ * \retval -EOVERFLOW \a size exceeds the size of the request memory.
+ */
+int ecrt_sdo_request_write_with_size(
+        ec_sdo_request_t *req, /**< SDO request. */
+        size_t size /**< Number of bytes to download. */
+        );
+
 /** Schedule an SDO read operation.
  *
  * \attention This method may not be called while ecrt_sdo_request_state()
@@ -1916,6 +2182,22 @@ void ecrt_sdo_request_read(
         ec_sdo_request_t *req /**< SDO request. */
         );
 
+/** Enables completion notification for an SDO request.
+ *
+ * Every time the request finishes after a call to ecrt_sdo_request_read() or
+ * ecrt_sdo_request_write(), an entry with the given \a tag is posted to the
+ * completion queue, see ecrt_master_completions(). The request state does
+ * not have to be polled any more.
+ *
+ * This method has to be called in non-realtime context.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ecrt_sdo_request_notify(
+        ec_sdo_request_t *req, /**< SDO request. */
+        uint64_t tag /**< Tag for the completion entries. */
+        );
+
 /*****************************************************************************
  * VoE handler methods.
  ****************************************************************************/
@@ -2046,6 +2328,30 @@ ec_request_state_t ecrt_voe_handler_execute(
     ec_voe_handler_t *voe /**< VoE handler. */
     );
 
+/** Enables completion notification for a VoE handler.
+ *
+ * After this call, the master executes the handler itself from within
+ * ecrt_master_send() once it was started via ecrt_voe_handler_read(),
+ * ecrt_voe_handler_read_nosync() or ecrt_voe_handler_write(), so
+ * ecrt_voe_handler_execute() must not be called while the operation is in
+ * progress. When the operation finishes, an entry with the given \a tag is
+ * posted to the completion queue, see ecrt_master_completions(). A single
+ * call to ecrt_voe_handler_execute() then returns the final state and makes
+ * the received data available via ecrt_voe_handler_data().
+ *
+ * Handlers are only executed by the master after ecrt_master_activate().
+ * The completion is pushed from within ecrt_master_send(), processes waiting
+ * for it are woken up by the master's operation thread.
+ *
+ * This method has to be called in non-realtime context.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ecrt_voe_handler_notify(
+        ec_voe_handler_t *voe, /**< VoE handler. */
+        uint64_t tag /**< Tag for the completion entries. */
+        );
+
 /*****************************************************************************
  * Register request methods.
  ****************************************************************************/
@@ -2115,6 +2421,21 @@ void ecrt_reg_request_read(
         size_t size /**< Size to write. */
         );
 
+/** Enables completion notification for a register request.
+ *
+ * Every time the request finishes after a call to ecrt_reg_request_read() or
+ * ecrt_reg_request_write(), an entry with the given \a tag is posted to the
+ * completion queue, see ecrt_master_completions().
+ *
+ * This method has to be called in non-realtime context.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ecrt_reg_request_notify(
+        ec_reg_request_t *req, /**< Register request. */
+        uint64_t tag /**< Tag for the completion entries. */
+        );
+
 /*****************************************************************************/
 
 #ifdef __cplusplus
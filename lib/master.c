@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
+#include <time.h>
 #include <sys/mman.h>
 
 #include "ioctl.h"
@@ -533,6 +534,52 @@ int ecrt_master_read_idn(ec_master_t *master, uint16_t slave_position,
 
 /****************************************************************************/
 
+static int ec_master_transfer_idns(ec_master_t *master,
+        uint16_t slave_position, uint8_t drive_no,
+        ec_soe_transfer_t *transfers, size_t count, int write)
+{
+    ec_ioctl_slave_soe_list_t io;
+    int ret;
+
+    io.slave_position = slave_position;
+    io.drive_no = drive_no;
+    io.idn_count = count;
+    io.transfers = transfers;
+
+    ret = ioctl(master->fd, write ? EC_IOCTL_SLAVE_SOE_WRITE_LIST :
+            EC_IOCTL_SLAVE_SOE_READ_LIST, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        if (EC_IOCTL_ERRNO(ret) != EIO) { // EIO: see transfer results
+            fprintf(stderr, "Failed to %s IDNs: %s\n",
+                    write ? "write" : "read",
+                    strerror(EC_IOCTL_ERRNO(ret)));
+        }
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+/****************************************************************************/
+
+int ecrt_master_read_idns(ec_master_t *master, uint16_t slave_position,
+        uint8_t drive_no, ec_soe_transfer_t *transfers, size_t count)
+{
+    return ec_master_transfer_idns(master, slave_position, drive_no,
+            transfers, count, 0);
+}
+
+/****************************************************************************/
+
+int ecrt_master_write_idns(ec_master_t *master, uint16_t slave_position,
+        uint8_t drive_no, ec_soe_transfer_t *transfers, size_t count)
+{
+    return ec_master_transfer_idns(master, slave_position, drive_no,
+            transfers, count, 1);
+}
+
+/****************************************************************************/
+
 int ecrt_master_activate(ec_master_t *master)
 {
     ec_ioctl_master_activate_t io;
@@ -802,3 +849,185 @@ void ecrt_master_reset(ec_master_t *master)
 }
 
 /****************************************************************************/
+
+int ecrt_master_completions(ec_master_t *master,
+        ec_request_completion_t *completions, size_t max_count)
+{
+    ec_ioctl_completions_t io;
+    int ret;
+
+    io.max_count = max_count;
+    io.completions = completions;
+
+    ret = ioctl(master->fd, EC_IOCTL_COMPLETIONS, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        if (EC_IOCTL_ERRNO(ret) != EOVERFLOW) {
+            fprintf(stderr, "Failed to get completions: %s\n",
+                    strerror(EC_IOCTL_ERRNO(ret)));
+        }
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return io.count;
+}
+
+/****************************************************************************/
+
+int ecrt_master_emerg_events(ec_master_t *master,
+        ec_coe_emerg_event_t *events, size_t max_count,
+        unsigned int *overruns)
+{
+    ec_ioctl_emerg_events_t io;
+    int ret;
+
+    io.max_count = max_count;
+    io.events = events;
+
+    ret = ioctl(master->fd, EC_IOCTL_EMERG_EVENTS, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        fprintf(stderr, "Failed to get emergency events: %s\n",
+                strerror(EC_IOCTL_ERRNO(ret)));
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    if (overruns) {
+        *overruns = io.overruns;
+    }
+
+    return io.count;
+}
+
+/****************************************************************************/
+
+#ifdef USE_RTDM
+
+/** Poll interval of ec_master_wait() in microseconds.
+ */
+#define EC_MASTER_WAIT_POLL_US 10000
+
+/** Checks the wait condition with the master and state requests.
+ *
+ * RTDM devices do not support the blocking EC_IOCTL_MASTER_WAIT. Whether the
+ * master state machine has already seen the link is not visible here, so
+ * the scan condition relies on the scan flag and the slave counts only.
+ */
+static int ec_master_wait_done(ec_master_t *master, uint32_t condition,
+        uint8_t al_state)
+{
+    ec_master_state_t state;
+    ec_master_info_t info;
+    int ret;
+
+    ecrt_master_state(master, &state);
+
+    if (!state.link_up) {
+        return 0;
+    }
+
+    if (condition == EC_MASTER_WAIT_LINK_UP) {
+        return 1;
+    }
+
+    ret = ecrt_master(master, &info);
+    if (ret) {
+        return ret;
+    }
+
+    if (info.scan_busy || info.slave_count != state.slaves_responding) {
+        return 0;
+    }
+
+    if (condition == EC_MASTER_WAIT_SCAN) {
+        return 1;
+    }
+
+    return info.slave_count && state.al_states == al_state;
+}
+
+/****************************************************************************/
+
+static int ec_master_wait(ec_master_t *master, uint32_t condition,
+        uint8_t al_state, unsigned int timeout_ms)
+{
+    struct timespec start, now;
+    int ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (1) {
+        ret = ec_master_wait_done(master, condition, al_state);
+        if (ret) {
+            return ret < 0 ? ret : 0;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if ((now.tv_sec - start.tv_sec) * 1000
+                + (now.tv_nsec - start.tv_nsec) / 1000000 >= timeout_ms) {
+            return -ETIMEDOUT;
+        }
+
+        usleep(EC_MASTER_WAIT_POLL_US);
+    }
+}
+
+#else
+
+static int ec_master_wait(ec_master_t *master, uint32_t condition,
+        uint8_t al_state, unsigned int timeout_ms)
+{
+    ec_ioctl_master_wait_t io;
+    int ret;
+
+    io.condition = condition;
+    io.al_state = al_state;
+    io.timeout_ms = timeout_ms;
+
+    ret = ioctl(master->fd, EC_IOCTL_MASTER_WAIT, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        if (EC_IOCTL_ERRNO(ret) != ETIMEDOUT) {
+            fprintf(stderr, "Failed to wait for master: %s\n",
+                    strerror(EC_IOCTL_ERRNO(ret)));
+        }
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+#endif
+
+/****************************************************************************/
+
+int ecrt_master_wait_link_up(ec_master_t *master, unsigned int timeout_ms)
+{
+    return ec_master_wait(master, EC_MASTER_WAIT_LINK_UP, 0, timeout_ms);
+}
+
+/****************************************************************************/
+
+int ecrt_master_wait_scan(ec_master_t *master, unsigned int timeout_ms)
+{
+    return ec_master_wait(master, EC_MASTER_WAIT_SCAN, 0, timeout_ms);
+}
+
+/****************************************************************************/
+
+int ecrt_master_wait_al_state(ec_master_t *master, uint8_t al_state,
+        unsigned int timeout_ms)
+{
+    return ec_master_wait(master, EC_MASTER_WAIT_AL_STATE, al_state,
+            timeout_ms);
+}
+
+/****************************************************************************/
+
+int ecrt_master_event_fd(ec_master_t *master)
+{
+#ifdef USE_RTDM
+    return -EOPNOTSUPP; // RTDM devices can not be polled
+#else
+    return master->fd;
+#endif
+}
+
+/****************************************************************************/
@@ -136,3 +136,24 @@ void ecrt_reg_request_read(ec_reg_request_t *reg, uint16_t address,
 }
 
 /*****************************************************************************/
+
+int ecrt_reg_request_notify(ec_reg_request_t *reg, uint64_t tag)
+{
+    ec_ioctl_request_notify_t io;
+    int ret;
+
+    io.config_index = reg->config->index;
+    io.request_index = reg->index;
+    io.tag = tag;
+
+    ret = ioctl(reg->config->master->fd, EC_IOCTL_REG_REQUEST_NOTIFY, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        fprintf(stderr, "Failed to enable register request notification:"
+                " %s\n", strerror(EC_IOCTL_ERRNO(ret)));
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
@@ -163,6 +163,27 @@ void ecrt_sdo_request_read(ec_sdo_request_t *req)
 
 /*****************************************************************************/
 
+int ecrt_sdo_request_notify(ec_sdo_request_t *req, uint64_t tag)
+{
+    ec_ioctl_request_notify_t io;
+    int ret;
+
+    io.config_index = req->config->index;
+    io.request_index = req->index;
+    io.tag = tag;
+
+    ret = ioctl(req->config->master->fd, EC_IOCTL_SDO_REQUEST_NOTIFY, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        fprintf(stderr, "Failed to enable SDO request notification: %s\n",
+                strerror(EC_IOCTL_ERRNO(ret)));
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
 void ecrt_sdo_request_write(ec_sdo_request_t *req)
 {
     ec_ioctl_sdo_request_t data;
@@ -182,6 +203,40 @@ void ecrt_sdo_request_write(ec_sdo_request_t *req)
 
 /*****************************************************************************/
 
+int ecrt_sdo_request_write_with_size(ec_sdo_request_t *req, size_t size)
+{
+    ec_ioctl_sdo_request_t data;
+    int ret;
+
+    if (!size) {
+        return -EINVAL;
+    }
+
+    if (size > req->mem_size) {
+        fprintf(stderr, "Request to write %zu bytes to SDO of size %zu.\n",
+                size, req->mem_size);
+        return -EOVERFLOW;
+    }
+
+    req->data_size = size;
+
+    data.config_index = req->config->index;
+    data.request_index = req->index;
+    data.data = req->data;
+    data.size = size;
+
+    ret = ioctl(req->config->master->fd, EC_IOCTL_SDO_REQUEST_WRITE, &data);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        fprintf(stderr, "Failed to command an SDO write operation : %s\n",
+                strerror(EC_IOCTL_ERRNO(ret)));
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
 int ecrt_sdo_info_get(ec_master_t *master, uint16_t slave_pos, uint16_t sdo_position, ec_sdo_info_t *sdo)
 {
     ec_ioctl_slave_sdo_t s;
@@ -198,3 +198,24 @@ ec_request_state_t ecrt_voe_handler_execute(ec_voe_handler_t *voe)
 }
 
 /*****************************************************************************/
+
+int ecrt_voe_handler_notify(ec_voe_handler_t *voe, uint64_t tag)
+{
+    ec_ioctl_request_notify_t io;
+    int ret;
+
+    io.config_index = voe->config->index;
+    io.request_index = voe->index;
+    io.tag = tag;
+
+    ret = ioctl(voe->config->master->fd, EC_IOCTL_VOE_NOTIFY, &io);
+    if (EC_IOCTL_IS_ERROR(ret)) {
+        fprintf(stderr, "Failed to enable VoE notification: %s\n",
+                strerror(EC_IOCTL_ERRNO(ret)));
+        return -EC_IOCTL_ERRNO(ret);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
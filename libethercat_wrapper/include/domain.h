@@ -0,0 +1,33 @@
+/*
+ * domain.h
+ *
+ * Process data domains of the wrapper. This is a internal header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _DOMAIN_H
+#define _DOMAIN_H
+
+#include "pdo_plan.h"
+
+#include <ecrt.h>
+
+/* -> struct _ecw_domain */
+struct _ecw_domain {
+  unsigned int rate_divider; /* exchanged every rate_divider-th cycle */
+  int queued; /* datagrams were queued in the last send and wait for processing */
+
+  /* only valid in cyclic mode */
+  ec_domain_t *domain;
+  ec_pdo_entry_reg_t *domain_reg;
+  uint8_t *processdata;
+  Pdo_Plan_t *input_plan;
+  Pdo_Plan_t *output_plan;
+
+  ec_domain_state_t domain_state;
+};
+
+typedef struct _ecw_domain Ethercat_Domain_t;
+
+#endif /* _DOMAIN_H */
@@ -22,6 +22,76 @@
 #define ECW_ERROR_SDO_NOT_FOUND             -3
 #define ECW_ERROR_SDO_UNSUPORTED_BITLENGTH  -4
 #define ECW_ERROR_SDO_UNSUPORTED_ENTRY_TYPE -4
+#define ECW_ERROR_SDO_QUEUE_FULL            -5
+
+/* Timeout in ms of the link and bus scan waits in ecw_master_init() */
+#define ECW_WAIT_TIMEOUT                     1000
+
+/* Maximum number of process data domains, including the default domain */
+#define ECW_MAX_DOMAINS                      8
+
+/* Maximum number of pending operations in the SDO queue */
+#define ECW_SDO_QUEUE_SIZE                   64
+
+struct _ecw_domain;
+struct _status_buffer;
+struct _sdo_queue;
+struct _link_state;
+
+/**
+ * \brief Asynchronous SDO operation
+ *
+ * \see ecw_master_sdo_submit
+ */
+typedef struct {
+  int slave; /**< id of the slave */
+  uint16_t index; /**< index of the object */
+  uint8_t subindex; /**< subindex of the object */
+  int write; /**< 0 to read the object, 1 to write it */
+  uint64_t value; /**< value to write, or the read value on completion */
+  int result; /**< ECW_SUCCESS or error code on completion */
+  void *user; /**< user data, passed through unchanged */
+} Ethercat_Sdo_Op_t;
+
+/**
+ * \brief Completion callback of the SDO queue
+ */
+typedef void (*ecw_sdo_callback_t)(const Ethercat_Sdo_Op_t *op, void *arg);
+
+/**
+ * \brief Snapshot of the bus state
+ *
+ * Published by ecw_master_monitor(), \see ecw_master_get_status
+ */
+typedef struct {
+  unsigned long cycle; /**< number of ecw_master_send_pdo() calls at the snapshot */
+  ec_master_state_t master_state; /**< state of the master */
+  size_t domain_count; /**< number of valid entries in domain_state */
+  ec_domain_state_t domain_state[ECW_MAX_DOMAINS]; /**< state of every domain */
+  size_t slave_count; /**< number of entries in slave_state */
+  ec_slave_config_state_t *slave_state; /**< state of every slave */
+} Ethercat_Status_t;
+
+/**
+ * \brief Options of the master initialization
+ *
+ * \see ecw_master_init_ex
+ */
+typedef struct {
+  /** Do not read the object dictionaries in ecw_master_init_ex(), the
+   * dictionary of a slave is read on its first SDO access or with
+   * ecw_slave_load_dictionary() */
+  int lazy_dictionary;
+  /** Directory of the object dictionary cache or NULL for no cache. The
+   * directory has to exist, the dictionaries are stored per vendor id,
+   * product code and revision number. */
+  const char *dictionary_cache;
+  /** Path of the topology snapshot or NULL for no snapshot. If the vendor id,
+   * product code, revision and serial number of every slave match the
+   * snapshot, the sync manager and PDO layout is taken from it, otherwise the
+   * layout is read from the master and the snapshot is rewritten. */
+  const char *topology_cache;
+} Ethercat_Init_Options_t;
 
 /* -> Ethercat_Master_t */
 struct _ecw_master_t {
@@ -29,11 +99,23 @@ struct _ecw_master_t {
   /* master information */
   ec_master_t *master;
 
-  /* variables for data structures */
+  /* variables for data structures, domain and processdata refer to the
+   * default domain */
   ec_domain_t *domain;
-  ec_pdo_entry_reg_t *domain_reg;
+  ec_pdo_entry_reg_t *domain_reg; /* registration of all PDO entries */
   uint8_t *processdata; /* FIXME are they needed here? */
 
+  /* process data domains, the first one is the default domain */
+  struct _ecw_domain *domains;
+  size_t domain_count;
+  unsigned long cycle; /* cycle counter for the domain rate dividers */
+
+  char *dictionary_cache; /* directory of the object dictionary cache or NULL */
+
+  struct _status_buffer *status; /* snapshots of ecw_master_monitor() */
+  struct _sdo_queue *sdo_queue; /* asynchronous SDO operations */
+  struct _link_state *link_state; /* master state cached for the SDO access */
+
   /* slaves */
   Ethercat_Slave_t *slaves;  ///<< list of slaves
   size_t slave_count;
@@ -129,6 +211,31 @@ unsigned int ecw_preemptive_slave_product_code(int master_id, int slave_index);
  */
 Ethercat_Master_t *ecw_master_init(int master_id, FILE *log);
 
+/**
+ * \brief Create ethercat master object and initialize with options
+ *
+ * Like ecw_master_init(). Reading the object dictionaries takes two requests
+ * to the master per object entry, with `options->lazy_dictionary` set only
+ * the PDO and sync manager layout is read and the start-up time no longer
+ * depends on the size of the dictionaries. With a dictionary cache the
+ * dictionary of known devices is read from the cache instead of the master,
+ * with a topology snapshot the same holds for the PDO layout of an unchanged
+ * bus.
+ *
+ * IMPORTANT: In lazy mode the first SDO access of a slave reads its
+ * dictionary, which is not real time safe. Call ecw_slave_load_dictionary()
+ * before the cyclic operation for slaves accessed in real time context. Until
+ * the dictionary of a slave is loaded its PDO entries are typed by their bit
+ * length only.
+ *
+ * \param master_id   id of the master to use, for single master use 0
+ * \param log         pointer to file descriptor for logging
+ * \param options     init options, NULL for the defaults of ecw_master_init()
+ * \return initialized master object or NULL on error
+ */
+Ethercat_Master_t *ecw_master_init_ex(int master_id, FILE *log,
+                                      const Ethercat_Init_Options_t *options);
+
 /**
  * \brief clean up master object
  *
@@ -169,6 +276,11 @@ int ecw_master_stop_cyclic(Ethercat_Master_t *master);
 /**
  * \brief This function has to be called in a real time context in a regular manner!
  *
+ * Besides the PDO exchange the states of the master, the domains and all
+ * slaves are read every cycle. For a shorter cycle use
+ * ecw_master_pdo_exchange() in the real time context and ecw_master_monitor()
+ * at a lower rate outside of it instead.
+ *
  * \param master  the master to use
  * \return  0 no error != 0 something went wrong
  */
@@ -184,7 +296,9 @@ int ecw_master_cyclic_function(Ethercat_Master_t *);
  * \brief Exchange PDO values during cyclic operation
  *
  * This function basically calls \c ecw_master_receive_pdo() and
- * then \c ecw_master_send_pdo()
+ * then \c ecw_master_send_pdo(). It is the real time part of the cyclic
+ * operation: it only receives, processes and queues the due domains, copies
+ * the PDO values and sends, no states are read and nothing is logged.
  *
  * \param master  master to request
  * \return 0 on success
@@ -209,6 +323,162 @@ int ecw_master_receive_pdo(Ethercat_Master_t *master);
  */
 int ecw_master_send_pdo(Ethercat_Master_t *master);
 
+/**
+ * \brief Read the bus state and publish it as a new snapshot
+ *
+ * The non real time part of the cyclic operation, meant to be called at a low
+ * rate from an other thread than ecw_master_pdo_exchange(). Reads the states
+ * of the master, the domains and the slaves and logs changes of the number of
+ * responding slaves and of the domain working counters.
+ *
+ * Only one thread may call this function.
+ *
+ * \param master  master to request
+ * \return 0 on success
+ */
+int ecw_master_monitor(Ethercat_Master_t *master);
+
+/**
+ * \brief Get the newest snapshot of the bus state
+ *
+ * Lock and wait free, so it may be called from the real time context. The
+ * snapshot stays valid until the next call of this function, only one thread
+ * may call this function.
+ *
+ * \param master  master to request
+ * \return newest snapshot or NULL if ecw_master_monitor() was not called yet
+ */
+const Ethercat_Status_t *ecw_master_get_status(Ethercat_Master_t *master);
+
+/*
+ * Asynchronous SDO access
+ *
+ * SDO reads and writes are posted to a queue of the master and dispatched on
+ * the SDO requests of the slaves whenever one is available, so many objects
+ * can be transferred at the same time without polling every single one.
+ * ecw_master_sdo_process() drives the queue and is meant to be called once
+ * per cycle. Operations on the same object are executed in the order they
+ * were submitted. Only numeric objects are supported.
+ *
+ * The queue is only processed in cyclic mode, pending operations are
+ * discarded by ecw_master_stop(). Submitting and processing have to happen in
+ * the same thread.
+ */
+
+/**
+ * \brief Post an SDO operation
+ *
+ * The operation is copied into the queue.
+ *
+ * \param master  the master to use
+ * \param op      operation, result is ignored
+ * \return ECW_SUCCESS, ECW_ERROR_SDO_QUEUE_FULL, ECW_ERROR_SDO_NOT_FOUND if
+ *         the slave or the object does not exist
+ */
+int ecw_master_sdo_submit(Ethercat_Master_t *master,
+                          const Ethercat_Sdo_Op_t *op);
+
+/**
+ * \brief Set the completion callback of the SDO queue
+ *
+ * Without a callback the completed operations are returned by
+ * ecw_master_sdo_process().
+ *
+ * \param master    the master to use
+ * \param callback  called from ecw_master_sdo_process() for every completed
+ *                  operation, NULL to disable
+ * \param arg       passed to the callback
+ */
+void ecw_master_sdo_set_callback(Ethercat_Master_t *master,
+                                 ecw_sdo_callback_t callback, void *arg);
+
+/**
+ * \brief Dispatch pending SDO operations and collect the completed ones
+ *
+ * Completed operations are passed to the callback if one is set, otherwise
+ * up to max_completed of them are copied to the completed array. Operations
+ * which do not fit are returned by the next call.
+ *
+ * \param master         the master to use
+ * \param completed      array for the completed operations, may be NULL if
+ *                       a callback is set
+ * \param max_completed  size of the completed array
+ * \return number of operations copied to the completed array
+ */
+size_t ecw_master_sdo_process(Ethercat_Master_t *master,
+                              Ethercat_Sdo_Op_t *completed,
+                              size_t max_completed);
+
+/**
+ * \brief Number of submitted but not yet returned SDO operations
+ */
+size_t ecw_master_sdo_pending(Ethercat_Master_t *master);
+
+/*
+ * Process data domains
+ *
+ * Initially all slaves are member of the default domain (id 0), which is
+ * exchanged every cycle. Additional domains take over slaves from the domain
+ * they were assigned to so far. A domain with a rate divider of n is only
+ * processed and queued every n-th call of ecw_master_send_pdo(), so slow
+ * devices do not enlarge the frames of every cycle.
+ *
+ * The domains have to be configured between ecw_master_init() and
+ * ecw_master_start().
+ */
+
+/**
+ * \brief Create a domain for all slaves of a type
+ *
+ * \param master        master to use
+ * \param type          slave type \see type_map_get_type
+ * \param rate_divider  the domain is exchanged every rate_divider-th cycle
+ * \return id of the new domain, <0 on error
+ */
+int ecw_master_create_domain_by_type(Ethercat_Master_t *master,
+                                     enum eSlaveType type,
+                                     unsigned int rate_divider);
+
+/**
+ * \brief Create a domain for a list of slaves
+ *
+ * \param master        master to use
+ * \param slave_ids     list of slave ids (bus positions)
+ * \param count         number of elements in slave_ids
+ * \param rate_divider  the domain is exchanged every rate_divider-th cycle
+ * \return id of the new domain, <0 on error
+ */
+int ecw_master_create_domain(Ethercat_Master_t *master, const int *slave_ids,
+                             size_t count, unsigned int rate_divider);
+
+/**
+ * \brief Change the rate divider of a domain
+ *
+ * \param master        master to use
+ * \param domain_id     id of the domain, 0 for the default domain
+ * \param rate_divider  the domain is exchanged every rate_divider-th cycle
+ * \return 0 on success
+ */
+int ecw_master_set_domain_rate(Ethercat_Master_t *master, int domain_id,
+                               unsigned int rate_divider);
+
+/**
+ * \brief Get the number of domains, including the default domain
+ */
+size_t ecw_master_domain_count(Ethercat_Master_t *master);
+
+/**
+ * \brief Get the state of a domain
+ *
+ * \param master     master to use
+ * \param domain_id  id of the domain, 0 for the default domain
+ * \param state      domain state as of the last ecw_master_monitor(), or of
+ *                   the last ecw_master_cyclic_function() without monitor
+ * \return 0 on success, <0 if the domain does not exist or is not active
+ */
+int ecw_master_get_domain_state(Ethercat_Master_t *master, int domain_id,
+                                ec_domain_state_t *state);
+
 /**
  * \brief Return pointer to slave by index
  *
@@ -218,6 +488,21 @@ int ecw_master_send_pdo(Ethercat_Master_t *master);
  */
 Ethercat_Slave_t *ecw_slave_get(Ethercat_Master_t *master, int slaveid);
 
+/**
+ * \brief Wait until all slaves are in the AL state
+ *
+ * Blocks until the master reports all slaves in `state`, without polling.
+ * Not to be called in real time context.
+ *
+ * \param master      master to request
+ * \param state       state to wait for
+ * \param timeout_ms  maximum time to wait in ms
+ * \return 0 on success, -ETIMEDOUT on timeout, other negative values on
+ *         error
+ */
+int ecw_master_wait_state(Ethercat_Master_t *master, enum eALState state,
+                          unsigned int timeout_ms);
+
 /**
  * \brief Request AL state from slave
  *
@@ -52,7 +52,12 @@ enum eValueType {
   VALUE_TYPE_SIGNED8,
   VALUE_TYPE_SIGNED16,
   VALUE_TYPE_SIGNED32,
-  VALUE_TYPE_PADDING /* special type for gaps in PDO mapping for byte alignment */
+  VALUE_TYPE_PADDING, /* special type for gaps in PDO mapping for byte alignment */
+  VALUE_TYPE_UNSIGNED64,
+  VALUE_TYPE_SIGNED64,
+  VALUE_TYPE_REAL32, /* exchanged as raw 32 bit pattern through the int value */
+  VALUE_TYPE_REAL64,
+  VALUE_TYPE_OCTETS /* byte array of bit_length / 8 bytes */
 };
 
 /**
@@ -81,7 +86,10 @@ enum eEntryType {
   ENTRY_TYPE_VISIBLE_STRING,    // 9: STRING(n) - Visible string - 8^n bits
   ENTRY_TYPE_OCTET_STRING,      // 10: ARRAY[0..n] OF BYTE - Sequence of octets - 8^(n+1) bits
   ENTRY_TYPE_UNICODE_STRING,    // 11: ARRAY[0..n] OF UINT - Sequence of UINT - 16^(n+1) bits
-  ENTRY_TYPE_TIME_OF_DAY        // 12: Time of day - 48 bits
+  ENTRY_TYPE_TIME_OF_DAY,       // 12: Time of day - 48 bits
+  ENTRY_TYPE_REAL64 = 0x11,     // 17: LREAL - Floating point - 64 bits
+  ENTRY_TYPE_INTEGER64 = 0x15,  // 21: LINT - Long integer - 64 bits
+  ENTRY_TYPE_UNSIGNED64 = 0x1b  // 27: ULINT - Unsigned long integer - 64 bits
 };
 
 /**
@@ -112,6 +120,8 @@ typedef struct {
   unsigned int offset;
   unsigned int bit_offset;
   enum eValueType type;
+  enum eEntryType entry_type; /**< CoE data type from the object dictionary */
+  unsigned int bit_length; /**< bit length of the mapped entry */
 } pdo_t;
 
 /**
@@ -221,6 +231,108 @@ int ecw_slave_set_out_value(Ethercat_Slave_t *s, size_t pdoindex, int value);
  */
 int ecw_slave_get_in_value(Ethercat_Slave_t *s, size_t pdoindex);
 
+/*
+ * Typed PDO access functions
+ *
+ * These functions access the process data directly at the registered domain
+ * offset of the PDO entry, without the int value of pdo_t. They are only
+ * valid in cyclic mode (between ecw_master_start() and ecw_master_stop()).
+ * For speed the type of the entry is not checked, the caller has to know the
+ * mapping, \see ecw_slave_get_in_pdo_type and ecw_slave_get_out_pdo_type.
+ *
+ * The typed accessors check for the cyclic mode on every call. For a fast path
+ * without any check, fetch the entry pointers with ecw_slave_get_in_data() and
+ * ecw_slave_get_out_data() once after ecw_master_start() and use the EC_READ_*
+ * and EC_WRITE_* macros on them, they stay valid until ecw_master_stop().
+ */
+
+/**
+ * \brief Get the value type of an input PDO entry
+ *
+ * \param slave     slave the PDO is associated
+ * \param pdoindex  index of the PDO in the buffer
+ * \param entry_type if not NULL, CoE data type of the entry
+ * \return the value type of the entry \see eValueType
+ */
+enum eValueType ecw_slave_get_in_pdo_type(Ethercat_Slave_t *s, size_t pdoindex,
+                                          enum eEntryType *entry_type);
+
+/**
+ * \brief Get the value type of an output PDO entry
+ *
+ * \param slave     slave the PDO is associated
+ * \param pdoindex  index of the PDO in the buffer
+ * \param entry_type if not NULL, CoE data type of the entry
+ * \return the value type of the entry \see eValueType
+ */
+enum eValueType ecw_slave_get_out_pdo_type(Ethercat_Slave_t *s,
+                                           size_t pdoindex,
+                                           enum eEntryType *entry_type);
+
+/**
+ * \brief Get a pointer to the process data of an input PDO entry
+ *
+ * Allows to use the EC_READ_* macros directly on the domain memory.
+ *
+ * \return pointer to the first byte of the entry, NULL if not in cyclic mode
+ */
+const uint8_t *ecw_slave_get_in_data(Ethercat_Slave_t *s, size_t pdoindex);
+
+/**
+ * \brief Get a pointer to the process data of an output PDO entry
+ *
+ * Allows to use the EC_WRITE_* macros directly on the domain memory. Entries
+ * of up to 32 bit are also written from the int value of the pdo_t by
+ * ecw_master_send_pdo(), so use this only for 64 bit, REAL64 and array
+ * entries.
+ *
+ * \return pointer to the first byte of the entry, NULL if not in cyclic mode
+ */
+uint8_t *ecw_slave_get_out_data(Ethercat_Slave_t *s, size_t pdoindex);
+
+/*
+ * Typed access to 64 bit and floating point PDO entries. Outside of cyclic
+ * mode the getters return 0 and the setters have no effect on the process
+ * data.
+ */
+uint64_t ecw_slave_get_in_u64(Ethercat_Slave_t *s, size_t pdoindex);
+int64_t ecw_slave_get_in_s64(Ethercat_Slave_t *s, size_t pdoindex);
+float ecw_slave_get_in_real32(Ethercat_Slave_t *s, size_t pdoindex);
+double ecw_slave_get_in_real64(Ethercat_Slave_t *s, size_t pdoindex);
+
+void ecw_slave_set_out_u64(Ethercat_Slave_t *s, size_t pdoindex,
+                           uint64_t value);
+void ecw_slave_set_out_s64(Ethercat_Slave_t *s, size_t pdoindex,
+                           int64_t value);
+void ecw_slave_set_out_real32(Ethercat_Slave_t *s, size_t pdoindex,
+                              float value);
+void ecw_slave_set_out_real64(Ethercat_Slave_t *s, size_t pdoindex,
+                              double value);
+
+/**
+ * \brief Copy an input PDO entry of arbitrary byte length
+ *
+ * \param slave     slave the PDO is associated
+ * \param pdoindex  index of the PDO in the buffer
+ * \param data      buffer to store the entry
+ * \param size      size of the buffer, at most this many bytes are copied
+ * \return number of bytes of the entry, <0 if not in cyclic mode
+ */
+int ecw_slave_get_in_array(Ethercat_Slave_t *s, size_t pdoindex, uint8_t *data,
+                           size_t size);
+
+/**
+ * \brief Write an output PDO entry of arbitrary byte length
+ *
+ * \param slave     slave the PDO is associated
+ * \param pdoindex  index of the PDO in the buffer
+ * \param data      data to write
+ * \param size      size of data, at most the entry size is copied
+ * \return number of bytes of the entry, <0 if not in cyclic mode
+ */
+int ecw_slave_set_out_array(Ethercat_Slave_t *s, size_t pdoindex,
+                            const uint8_t *data, size_t size);
+
 /*
  * SDO Access Functions
  */
@@ -302,6 +414,34 @@ Sdo_t *ecw_slave_get_sdo(Ethercat_Slave_t *s, int index, int subindex);
  */
 Sdo_t *ecw_slave_get_sdo_index(Ethercat_Slave_t *s, size_t sdoindex);
 
+/**
+ * \brief Look up an object of the object dictionary
+ *
+ * In contrast to ecw_slave_get_sdo() no copy is created, the returned object
+ * is owned by the slave and valid until the master is released. The lookup
+ * uses a hash table and does not allocate memory.
+ *
+ * \param slave    Slave to request
+ * \param index    Index of the requested object
+ * \param subindex Subindex of the requested object
+ * \return NULL if not available or pointer to the object \see Sdo_t
+ */
+const Sdo_t *ecw_slave_find_sdo(Ethercat_Slave_t *s, int index, int subindex);
+
+/**
+ * \brief Copy an object of the object dictionary into a caller buffer
+ *
+ * Allocation free variant of ecw_slave_get_sdo().
+ *
+ * \param slave    Slave to request
+ * \param index    Index of the requested object
+ * \param subindex Subindex of the requested object
+ * \param sdo      Buffer to store the object
+ * \return 0 on success, ECW_ERROR_SDO_NOT_FOUND if not available
+ */
+int ecw_slave_copy_sdo(Ethercat_Slave_t *s, int index, int subindex,
+                       Sdo_t *sdo);
+
 /**
  * \brief low level access to write SDO value to slave
  *
@@ -329,6 +469,18 @@ int slave_sdo_upload(Ethercat_Slave_t *s, Sdo_t *sdo);
 /* deprecated or not used */
 int ecw_slave_get_sdo_list(Ethercat_Slave_t *s, int *index_list);
 
+/**
+ * \brief Read the object dictionary of the slave
+ *
+ * Only necessary if the master was initialized with a lazy dictionary, then
+ * the dictionary is otherwise read on the first SDO access. Does nothing if
+ * the dictionary is already available.
+ *
+ * \param slave   Slave to request
+ * \return 0 on success, <0 on error
+ */
+int ecw_slave_load_dictionary(Ethercat_Slave_t *s);
+
 /**
  * \brief Request the number of all SDOs in the slaves object dictionary
  *
@@ -0,0 +1,38 @@
+/*
+ * od_cache.h
+ *
+ * File cache of the object dictionary descriptions, one file per device
+ * identified by vendor id, product code and revision number. This is a
+ * internal header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _OD_CACHE_H
+#define _OD_CACHE_H
+
+#include "ethercat_wrapper_slave.h"
+
+#include <ecrt.h>
+#include <stddef.h>
+
+/*
+ * Load the dictionary of the device described by `info` from the cache in
+ * directory `dir`. On success `*dictionary` is a newly allocated array of
+ * `*count` objects, the values and requests of the objects are cleared.
+ *
+ * Returns 0 on success and -1 if there is no valid cache file for the device.
+ */
+int od_cache_load(const char *dir, const ec_slave_info_t *info,
+                  Sdo_t **dictionary, size_t *count);
+
+/*
+ * Store the dictionary of the device described by `info` in the cache in
+ * directory `dir`. An existing cache file of the device is replaced.
+ *
+ * Returns 0 on success and -1 on error.
+ */
+int od_cache_store(const char *dir, const ec_slave_info_t *info,
+                   const Sdo_t *dictionary, size_t count);
+
+#endif /* _OD_CACHE_H */
@@ -0,0 +1,80 @@
+/*
+ * pdo_plan.h
+ *
+ * Compiled copy plan between the domain process data and the pdo_t values of
+ * the slaves. This is a internal header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _PDO_PLAN_H
+#define _PDO_PLAN_H
+
+#include "ethercat_wrapper.h"
+#include "slave.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Kind of copy operation, determined once from the pdo_t type when the plan
+ * is build.
+ */
+enum ePdoCopyKind {
+  PDO_COPY_BITS = 0,
+  PDO_COPY_U8,
+  PDO_COPY_U16,
+  PDO_COPY_U32,
+  PDO_COPY_S8,
+  PDO_COPY_S16,
+  PDO_COPY_S32
+};
+
+/*
+ * One copy operation covers `count` consecutive pdo_t values of a slave.
+ *
+ * For byte wide kinds the entries are packed back to back in the process data
+ * starting at `offset`. For PDO_COPY_BITS all entries live in the byte at
+ * `offset`, starting at bit `bit_offset`.
+ */
+typedef struct _pdo_copy_op {
+  uint32_t offset;
+  uint16_t count;
+  uint8_t kind;
+  uint8_t bit_offset;
+  pdo_t *values;
+} Pdo_Copy_Op_t;
+
+/* -> struct _pdo_plan */
+struct _pdo_plan {
+  Pdo_Copy_Op_t *ops;
+  size_t op_count;
+  size_t entry_count; /* number of pdo_t values covered by the plan */
+};
+
+typedef struct _pdo_plan Pdo_Plan_t;
+
+/*
+ * Compile the plan for the input (direction == EC_DIR_INPUT) or output values
+ * of the slaves in domain `domain_id` (all slaves if domain_id < 0). The
+ * offsets of the pdo_t values have to be valid, i.e. the PDO entries have to
+ * be registered in the domain already.
+ *
+ * Returns NULL if no memory is available.
+ */
+Pdo_Plan_t *pdo_plan_create(Ethercat_Slave_t *slaves, size_t slave_count,
+                            int domain_id, ec_direction_t direction);
+
+void pdo_plan_free(Pdo_Plan_t *plan);
+
+/*
+ * Copy the process data into the pdo_t values.
+ */
+void pdo_plan_read(const Pdo_Plan_t *plan, const uint8_t *processdata);
+
+/*
+ * Copy the pdo_t values into the process data.
+ */
+void pdo_plan_write(const Pdo_Plan_t *plan, uint8_t *processdata);
+
+#endif /* _PDO_PLAN_H */
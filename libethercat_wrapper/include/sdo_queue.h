@@ -0,0 +1,57 @@
+/*
+ * sdo_queue.h
+ *
+ * Queue of the asynchronous SDO operations of a master. This is a internal
+ * header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _SDO_QUEUE_H
+#define _SDO_QUEUE_H
+
+#include "ethercat_wrapper.h"
+#include "slave.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum eSdoOpState {
+  SDO_OP_FREE = 0,
+  SDO_OP_QUEUED, /* waiting for a request of the slave */
+  SDO_OP_ACTIVE, /* transfer is running */
+  SDO_OP_DONE /* completed, not yet returned to the application */
+};
+
+/*
+ * The operations are kept in a ring in the order of submission, `head` is the
+ * oldest one not yet returned. Returned operations in the middle of the ring
+ * are freed when the head passes them.
+ */
+struct _sdo_queue {
+  Ethercat_Sdo_Op_t op[ECW_SDO_QUEUE_SIZE];
+  Sdo_t *sdo[ECW_SDO_QUEUE_SIZE];
+  uint8_t state[ECW_SDO_QUEUE_SIZE];
+  size_t head;
+  size_t count;
+  size_t pending; /* operations not yet returned */
+
+  ecw_sdo_callback_t callback;
+  void *callback_arg;
+};
+
+typedef struct _sdo_queue Sdo_Queue_t;
+
+/*
+ * Returns NULL if no memory is available.
+ */
+Sdo_Queue_t *sdo_queue_create(void);
+
+void sdo_queue_free(Sdo_Queue_t *queue);
+
+/*
+ * Discard all operations, the SDO requests are not touched.
+ */
+void sdo_queue_clear(Sdo_Queue_t *queue);
+
+#endif /* _SDO_QUEUE_H */
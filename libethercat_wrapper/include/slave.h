@@ -10,11 +10,39 @@
 #include "ethercat_wrapper_slave.h"
 #include <ecrt.h>
 
+/*
+ * Number of SDO requests per slave for the SDO access in cyclic operation.
+ * The requests are retargeted to the object which is accessed, so the number
+ * of requests does not depend on the size of the object dictionary.
+ */
+#define ECW_SDO_REQUEST_POOL_SIZE  4
+
+#define SDO_REQUEST_TIMEOUT        500  /* ms taken from etherlab example */
+
+/*
+ * Time in ms a finished read keeps its request for the object, if the result
+ * is not collected within this time the request may be retargeted.
+ */
+#define SDO_REQUEST_COLLECT_TIMEOUT  1000
+
+/*
+ * Master state as seen by the SDO access, shared by all slaves of a master.
+ * In cyclic mode it is read at most once per cycle, ecw_master_send_pdo()
+ * invalidates it.
+ */
+struct _link_state {
+  ec_master_state_t state;
+  int valid;
+};
+
+typedef struct _link_state Link_State_t;
+
 struct _ecw_slave_t {
   uint16_t reference_alias; /* keeps the last active alias, since it is different than in ec_slave_info_t */
   uint16_t relative_position; /* position relative to the last defined alias in the ring */
 
   enum eSlaveType type; /* type is determined by the vendor/product numbers */
+  int domain_id; /* process data domain the PDOs are registered in */
   int cyclic_mode; /* to mark when in cyclic mode */
 
   /* Information structures from libethercat */
@@ -22,6 +50,7 @@ struct _ecw_slave_t {
   ec_sync_info_t *sminfo;
   ec_slave_config_t *config;
   ec_master_t *master; /* reference to the master interface this slave is connected */
+  Link_State_t *link_state; /* cached master state, owned by the master */
   ec_slave_config_state_t state; /* read with ecrt_slave_config_state() */
 
   /*
@@ -34,6 +63,7 @@ struct _ecw_slave_t {
 
   pdo_t *output_values;
   pdo_t *input_values;
+  uint8_t *processdata; /* domain memory for the typed PDO access, only valid in cyclic mode */
 
   /*
    * Object Dictionary for SDO exchange
@@ -41,6 +71,20 @@ struct _ecw_slave_t {
 
   Sdo_t *dictionary; /* SDOs for configuration */
   size_t sdo_count; /* number of all objects and sub-objects in the dictionary */
+  int dictionary_loaded; /* dictionary is read, it is loaded on demand in the lazy init mode */
+  const char *dictionary_cache; /* directory of the dictionary cache or NULL, owned by the master */
+
+  /* open addressing hash table (index, subindex) -> dictionary position + 1,
+   * 0 marks an empty slot */
+  uint32_t *sdo_table;
+  unsigned int sdo_table_bits; /* the table has 2^sdo_table_bits slots */
+
+  /* SDO request pool, only valid in cyclic mode */
+  ec_sdo_request_t *sdo_request_pool[ECW_SDO_REQUEST_POOL_SIZE];
+  Sdo_t *sdo_request_owner[ECW_SDO_REQUEST_POOL_SIZE]; /* object the request is currently targeted to */
+  size_t sdo_request_next; /* next candidate for retargeting */
+  int sdo_request_locked[ECW_SDO_REQUEST_POOL_SIZE]; /* held by a queued SDO operation */
+  uint64_t sdo_request_used[ECW_SDO_REQUEST_POOL_SIZE]; /* last access of the owner, monotonic time in ms */
 };
 
 int ecw_slave_scan(Ethercat_Slave_t *);
@@ -63,4 +107,58 @@ pdo_t *ecw_slave_get_inpdo(Ethercat_Slave_t *s, size_t pdoindex);
  */
 int sdo_read_value(Sdo_t *sdo);
 
+/*
+ * Read the object dictionary of the slave, from the dictionary cache if
+ * available or from the master otherwise. Does nothing if the dictionary is
+ * already loaded.
+ */
+int slave_dictionary_load(Ethercat_Slave_t *s);
+
+/*
+ * Object of the dictionary or NULL, the dictionary is loaded if necessary.
+ */
+Sdo_t *sdo_find(Ethercat_Slave_t *s, int index, int subindex);
+
+/*
+ * Like sdo_find() but never reads the dictionary, NULL if it is not loaded.
+ */
+Sdo_t *sdo_find_loaded(Ethercat_Slave_t *s, int index, int subindex);
+
+/*
+ * Set the value types of the PDO entries of the slave from the CoE data types
+ * of the dictionary, or from the bit length if it is not loaded yet.
+ */
+void slave_pdo_types_resolve(Ethercat_Slave_t *s);
+
+/*
+ * Build and free the hash table over the object dictionary.
+ */
+int sdo_table_build(Ethercat_Slave_t *s);
+void sdo_table_free(Ethercat_Slave_t *s);
+
+/*
+ * Create and release the SDO request pool of a slave for cyclic operation.
+ */
+int sdo_request_pool_create(Ethercat_Slave_t *s);
+void sdo_request_pool_release(Ethercat_Slave_t *s);
+
+/*
+ * Start the upload (write == 0) or download of the object on a request of
+ * the pool, the request is held until sdo_request_complete() reports the end
+ * of the transfer. A download sends the current sdo->value.
+ *
+ * Returns ECW_SUCCESS if the transfer is started, ECW_ERROR_SDO_REQUEST_BUSY
+ * if no request is available for the object right now and <0 on error.
+ */
+int sdo_request_submit(Ethercat_Slave_t *s, Sdo_t *sdo, int write);
+
+/*
+ * Check the transfer started with sdo_request_submit(). On success the value
+ * of an upload is stored in sdo->value.
+ *
+ * Returns ECW_ERROR_SDO_REQUEST_BUSY while the transfer is running,
+ * ECW_SUCCESS or <0 if it is finished.
+ */
+int sdo_request_complete(Ethercat_Slave_t *s, Sdo_t *sdo);
+
 #endif /* _SLAVE_H */
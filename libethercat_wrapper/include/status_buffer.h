@@ -0,0 +1,60 @@
+/*
+ * status_buffer.h
+ *
+ * Triple buffer for the status snapshots published by ecw_master_monitor().
+ * This is a internal header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _STATUS_BUFFER_H
+#define _STATUS_BUFFER_H
+
+#include "ethercat_wrapper.h"
+
+#include <stddef.h>
+
+/*
+ * One writer fills the back buffer and swaps it with the middle buffer, one
+ * reader swaps its front buffer with the middle buffer if a newer snapshot is
+ * available. The swaps are single atomic operations on `state`, so neither
+ * side ever waits for the other and the front buffer stays stable while the
+ * reader uses it.
+ */
+struct _status_buffer {
+  Ethercat_Status_t buffer[3];
+  unsigned int state; /* index of the middle buffer | STATUS_BUFFER_FRESH */
+  unsigned int back; /* only accessed by the writer */
+  unsigned int front; /* only accessed by the reader */
+  int published; /* the reader got at least one snapshot */
+
+  /* states of the last snapshot for the change detection of the writer */
+  ec_master_state_t last_master_state;
+  ec_wc_state_t last_wc_state[ECW_MAX_DOMAINS];
+};
+
+typedef struct _status_buffer Status_Buffer_t;
+
+/*
+ * Returns NULL if no memory is available.
+ */
+Status_Buffer_t *status_buffer_create(size_t slave_count);
+
+void status_buffer_free(Status_Buffer_t *status);
+
+/*
+ * Buffer to fill by the writer.
+ */
+Ethercat_Status_t *status_buffer_back(Status_Buffer_t *status);
+
+/*
+ * Make the back buffer the newest snapshot.
+ */
+void status_buffer_publish(Status_Buffer_t *status);
+
+/*
+ * Newest snapshot for the reader or NULL if none was published yet.
+ */
+const Ethercat_Status_t *status_buffer_latest(Status_Buffer_t *status);
+
+#endif /* _STATUS_BUFFER_H */
@@ -0,0 +1,45 @@
+/*
+ * topology.h
+ *
+ * File snapshot of the sync manager and PDO layout of all slaves on the bus.
+ * This is a internal header.
+ *
+ * Synapticon GmbH
+ */
+
+#ifndef _TOPOLOGY_H
+#define _TOPOLOGY_H
+
+#include "ethercat_wrapper.h"
+#include "slave.h"
+
+#include <stddef.h>
+
+/*
+ * Load the layout of the slaves from the snapshot at `path`. The slave
+ * information (slave->info) has to be read already, the snapshot is only used
+ * if vendor id, product code, revision and serial number of every position
+ * match. On success slave->sminfo of every slave is allocated like the master
+ * query would do, with space for the terminating element.
+ *
+ * Returns 0 on success and -1 if there is no matching snapshot.
+ */
+int topology_load(const char *path, Ethercat_Slave_t *slaves,
+                  size_t slave_count);
+
+/*
+ * Store the layout of the slaves in the snapshot at `path`. An existing
+ * snapshot is replaced.
+ *
+ * Returns 0 on success and -1 on error.
+ */
+int topology_store(const char *path, const Ethercat_Slave_t *slaves,
+                   size_t slave_count);
+
+/*
+ * Free the layout of a slave as allocated by topology_load() or the master
+ * query.
+ */
+void topology_free_layout(Ethercat_Slave_t *slave);
+
+#endif /* _TOPOLOGY_H */
@@ -5,16 +5,19 @@
 #include "ethercat_wrapper.h"
 #include "slave.h"
 #include "ethercat_wrapper_slave.h"
+#include "domain.h"
+#include "status_buffer.h"
+#include "sdo_queue.h"
+#include "topology.h"
 
 #include <ecrt.h>
+#include <assert.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 #include <syslog.h>
 
-#define SDO_REQUEST_TIMEOUT     500  /* ms taken from etherlab example */
-
 #ifndef VERSIONING
 #error no version information
 #endif
@@ -38,6 +41,8 @@ static void update_master_state(Ethercat_Master_t *master);
 static void update_all_slave_state(Ethercat_Master_t *master);
 
 static void free_all_slaves(Ethercat_Master_t *master);
+static void clear_domains(Ethercat_Master_t *master);
+static void discard_domains(Ethercat_Master_t *master);
 
 const char *ecw_master_get_version(void)
 {
@@ -71,7 +76,14 @@ enum eValueType get_type_from_bitlength(int bit_length)
     case 32:
       type = VALUE_TYPE_UNSIGNED32;
       break;
+    case 64:
+      type = VALUE_TYPE_UNSIGNED64;
+      break;
     default:
+      if (bit_length > 0 && bit_length % 8 == 0) {
+        type = VALUE_TYPE_OCTETS;
+        break;
+      }
       type = VALUE_TYPE_NONE;
       syslog(LOG_ERR, "Warning, bit size: %d not supported", bit_length);
       break;
@@ -80,56 +92,198 @@ enum eValueType get_type_from_bitlength(int bit_length)
   return type;
 }
 
-static int setup_sdo_request(Ethercat_Slave_t *slave)
+/*
+ * get the pdo type according to the CoE data type of the mapped object, the
+ * types up to 32 bit keep the unsigned type of get_type_from_bitlength() for
+ * compatibility of the int value
+ */
+static enum eValueType get_type_from_entry(enum eEntryType entry_type,
+                                           int bit_length)
 {
-  for (size_t sdoindex = 0; sdoindex < slave->sdo_count; sdoindex++) {
-    Sdo_t *sdo = slave->dictionary + sdoindex;
-
-    if (sdo->bit_length >= 8) {
-      sdo->request = ecrt_slave_config_create_sdo_request(
-          slave->config, sdo->index, sdo->subindex, (sdo->bit_length / 8));
-    } else {
-      sdo->request = ecrt_slave_config_create_sdo_request(slave->config,
-                                                          sdo->index,
-                                                          sdo->subindex, 1);
+  switch (entry_type) {
+    case ENTRY_TYPE_REAL32:
+      if (bit_length == 32) {
+        return VALUE_TYPE_REAL32;
+      }
+      break;
+    case ENTRY_TYPE_REAL64:
+      if (bit_length == 64) {
+        return VALUE_TYPE_REAL64;
+      }
+      break;
+    case ENTRY_TYPE_INTEGER64:
+      if (bit_length == 64) {
+        return VALUE_TYPE_SIGNED64;
+      }
+      break;
+    default:
+      break;
+  }
+
+  return get_type_from_bitlength(bit_length);
+}
+
+/*
+ * The dictionary is not read here, in the lazy mode the entries are typed by
+ * their bit length until it is loaded.
+ */
+static void setup_pdo_value(Ethercat_Slave_t *slave, pdo_t *pdoe,
+                            const ec_pdo_entry_info_t *entry)
+{
+  const Sdo_t *sdo = NULL;
+
+  if (entry->index != 0) { /* index 0 marks a gap in the mapping */
+    sdo = sdo_find_loaded(slave, entry->index, entry->subindex);
+  }
+
+  pdoe->entry_type = (sdo != NULL) ? sdo->entry_type : ENTRY_TYPE_NONE;
+  pdoe->bit_length = entry->bit_length;
+  pdoe->type = get_type_from_entry(pdoe->entry_type, entry->bit_length);
+}
+
+/*
+ * Type the PDO entries of the slave in the given direction, the entries are
+ * walked in the same order as in append_domain_regs().
+ */
+static void resolve_pdo_values(Ethercat_Slave_t *slave,
+                               ec_direction_t direction)
+{
+  pdo_t *values = (direction == EC_DIR_INPUT) ?
+      slave->input_values : slave->output_values;
+  size_t valcount = 0;
+
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    ec_sync_info_t *sm = slave->sminfo + j;
+    if (0 == sm->n_pdos || sm->dir != direction) {
+      continue;
     }
 
-    if (sdo->request == NULL) {
-      syslog(LOG_ERR,
-             "Warning, could not create sdo request for cyclic operation!");
-      return -1;
-    } else {
-      ecrt_sdo_request_timeout(sdo->request, SDO_REQUEST_TIMEOUT);
-      sdo->request_state = ecrt_sdo_request_state(sdo->request);
-      sdo->read_request = 0;
+    for (int m = 0; m < sm->n_pdos; m++) {
+      ec_pdo_info_t *pdos = sm->pdos + m;
+
+      for (int n = 0; n < pdos->n_entries; n++) {
+        setup_pdo_value(slave, values + valcount, pdos->entries + n);
+        valcount++;
+      }
     }
   }
+}
 
-  return 0;
+void slave_pdo_types_resolve(Ethercat_Slave_t *slave)
+{
+  if (slave->sminfo == NULL) {
+    return;
+  }
+
+  resolve_pdo_values(slave, EC_DIR_INPUT);
+  resolve_pdo_values(slave, EC_DIR_OUTPUT);
 }
 
 /*
- * populate the fields:
- * master->slave[*]->[RT]xPDO
- *
- * FIXME Move to slave.c:ecw_slave_scan()
+ * Add the registrations of all PDO entries of the slave in the given
+ * direction to the registration list and return the next free element.
  */
-static int slave_config(Ethercat_Master_t *master, Ethercat_Slave_t *slave)
+static ec_pdo_entry_reg_t *append_domain_regs(Ethercat_Slave_t *slave,
+                                              ec_direction_t direction,
+                                              ec_pdo_entry_reg_t *domain_reg_cur)
 {
-  slave->sdo_count = slave->info->sdo_count;
-  if (slave->sdo_count == 0) {
-    syslog(LOG_WARNING, "Slave %d has no SDOs", slave->info->position);
+  pdo_t *values = (direction == EC_DIR_INPUT) ?
+      slave->input_values : slave->output_values;
+  size_t valcount = 0;
+
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    ec_sync_info_t *sm = slave->sminfo + j;
+    if (0 == sm->n_pdos || sm->dir != direction) {
+      /* mailbox sync manager or other direction */
+      continue;
+    }
+
+    for (int m = 0; m < sm->n_pdos; m++) {
+      ec_pdo_info_t *pdos = sm->pdos + m;
+
+      for (int n = 0; n < pdos->n_entries; n++) {
+        ec_pdo_entry_info_t *entry = pdos->entries + n;
+
+        pdo_t *pdoe = (values + valcount);
+        valcount++;
+
+        /* FIXME Add proper error handling if VALUE_TYPE_NONE is returned */
+        setup_pdo_value(slave, pdoe, entry);
+
+        // IMPORTANT: The reference alias must be used, as well as the
+        // position relative to that alias
+        domain_reg_cur->alias = slave->reference_alias;
+        domain_reg_cur->position = slave->relative_position;
+
+        domain_reg_cur->vendor_id = slave->info->vendor_id;
+        domain_reg_cur->product_code = slave->info->product_code;
+        domain_reg_cur->index = entry->index;
+        domain_reg_cur->subindex = entry->subindex;
+        domain_reg_cur->offset = &(pdoe->offset);
+        domain_reg_cur->bit_position = &(pdoe->bit_offset);
+        domain_reg_cur++;
+      }
+    }
   }
 
-  slave->type = type_map_get_type(slave->info->vendor_id,
-                                  slave->info->product_code);
+  return domain_reg_cur;
+}
 
-  slave->outpdocount = 0;
-  slave->inpdocount = 0;
+/*
+ * Build the registration list of the domain, inputs first then outputs like
+ * the list of all entries.
+ */
+static ec_pdo_entry_reg_t *create_domain_regs(Ethercat_Master_t *master,
+                                              int domain_id, size_t *count)
+{
+  size_t pdo_count = 0;
+
+  for (size_t i = 0; i < master->slave_count; i++) {
+    Ethercat_Slave_t *slave = master->slaves + i;
+    if (slave->domain_id == domain_id) {
+      pdo_count += slave->inpdocount + slave->outpdocount;
+    }
+  }
+
+  ec_pdo_entry_reg_t *domain_reg = malloc(
+      (pdo_count + 1) * sizeof(ec_pdo_entry_reg_t));
+  if (domain_reg == NULL) {
+    return NULL;
+  }
+
+  ec_pdo_entry_reg_t *domain_reg_cur = domain_reg;
+
+  for (size_t i = 0; i < master->slave_count; i++) {
+    Ethercat_Slave_t *slave = master->slaves + i;
+    if (slave->domain_id == domain_id) {
+      domain_reg_cur = append_domain_regs(slave, EC_DIR_INPUT, domain_reg_cur);
+    }
+  }
+
+  for (size_t i = 0; i < master->slave_count; i++) {
+    Ethercat_Slave_t *slave = master->slaves + i;
+    if (slave->domain_id == domain_id) {
+      domain_reg_cur = append_domain_regs(slave, EC_DIR_OUTPUT, domain_reg_cur);
+    }
+  }
+
+  memset(domain_reg_cur, 0, sizeof(ec_pdo_entry_reg_t));
+  *count = pdo_count;
+
+  return domain_reg;
+}
 
+/*
+ * Read the sync managers, PDOs and PDO entries of the slave from the master.
+ */
+static int slave_layout_query(Ethercat_Master_t *master,
+                              Ethercat_Slave_t *slave)
+{
   /* add one more field for the sync manager count because of the last element */
-  slave->sminfo = malloc(
-      (slave->info->sync_count + 1) * sizeof(ec_sync_info_t));
+  slave->sminfo = calloc(slave->info->sync_count + 1, sizeof(ec_sync_info_t));
+  if (slave->sminfo == NULL) {
+    return -1;
+  }
 
   for (int j = 0; j < slave->info->sync_count; j++) {
     ec_sync_info_t *sminfo = slave->sminfo + j;
@@ -155,6 +309,74 @@ static int slave_config(Ethercat_Master_t *master, Ethercat_Slave_t *slave)
             pdoinfo->n_entries * sizeof(ec_pdo_entry_info_t));
       }
 
+      for (int l = 0; l < pdoinfo->n_entries; l++) {
+        ec_pdo_entry_info_t *pdoentry = pdoinfo->entries + l;
+        ecrt_master_get_pdo_entry(master->master, slave->info->position, j, k,
+                                  l, pdoentry);
+      }
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Read the layout of all slaves, from the topology snapshot if it matches the
+ * bus or from the master otherwise. A new snapshot is written in the latter
+ * case.
+ */
+static int slave_layout_init(Ethercat_Master_t *master, const char *snapshot)
+{
+  if (snapshot != NULL
+      && topology_load(snapshot, master->slaves, master->slave_count) == 0) {
+    return 0;
+  }
+
+  for (int i = 0; i < master->slave_count; i++) {
+    if (slave_layout_query(master, master->slaves + i) != 0) {
+      syslog(LOG_ERR, "Error, cannot read the PDO layout of slave %d", i);
+      return -1;
+    }
+  }
+
+  if (snapshot != NULL
+      && topology_store(snapshot, master->slaves, master->slave_count) != 0) {
+    syslog(LOG_WARNING, "Warning, unable to write the topology snapshot %s",
+           snapshot);
+  }
+
+  return 0;
+}
+
+/*
+ * populate the fields:
+ * master->slave[*]->[RT]xPDO
+ *
+ * The sync manager layout in slave->sminfo has to be read already.
+ *
+ * FIXME Move to slave.c:ecw_slave_scan()
+ */
+static int slave_config(Ethercat_Master_t *master, Ethercat_Slave_t *slave)
+{
+  if (slave->info->sdo_count == 0) {
+    syslog(LOG_WARNING, "Slave %d has no SDOs", slave->info->position);
+  }
+
+  slave->type = type_map_get_type(slave->info->vendor_id,
+                                  slave->info->product_code);
+
+  slave->outpdocount = 0;
+  slave->inpdocount = 0;
+
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    ec_sync_info_t *sminfo = slave->sminfo + j;
+
+    if (sminfo->n_pdos == 0)
+      continue;
+
+    for (int k = 0; k < sminfo->n_pdos; k++) {
+      ec_pdo_info_t *pdoinfo = sminfo->pdos + k;
+
       if (sminfo->dir == EC_DIR_OUTPUT) {
         slave->outpdocount += pdoinfo->n_entries;
       } else if (sminfo->dir == EC_DIR_INPUT) {
@@ -163,12 +385,6 @@ static int slave_config(Ethercat_Master_t *master, Ethercat_Slave_t *slave)
         /* FIXME error handling? */
         syslog(LOG_ERR, "WARNING undefined direction");
       }
-
-      for (int l = 0; l < pdoinfo->n_entries; l++) {
-        ec_pdo_entry_info_t *pdoentry = pdoinfo->entries + l;
-        ecrt_master_get_pdo_entry(master->master, slave->info->position, j, k,
-                                  l, pdoentry);
-      }
     }
   }
 
@@ -196,87 +412,6 @@ static int slave_config(Ethercat_Master_t *master, Ethercat_Slave_t *slave)
     return -1;
   }
 
-  /*
-   * read slave object dictionary and get the values
-   */
-
-  /* count the real number of object entries (including subindexes) */
-  size_t object_count = slave->sdo_count;
-  for (int i = 0; i < slave->sdo_count; i++) {
-    ec_sdo_info_t sdoi;
-    if (ecrt_sdo_info_get(master->master, slave->info->position, i, &sdoi)) {
-      syslog(
-          LOG_ERR,
-          "Error, unable to retrieve information of object dictionary info %d",
-          i);
-      return -1;
-    }
-
-    object_count += sdoi.maxindex;
-  }
-
-  if (slave->sdo_count && slave->sdo_count == object_count) {
-    syslog(LOG_WARNING, "All Slave %d SDOs have no index", slave->info->position);
-  }
-
-  slave->dictionary = malloc(/*slave->sdo_count */object_count * sizeof(Sdo_t));
-
-  for (int i = 0, current_sdo = 0; i < slave->sdo_count; i++) {
-    ec_sdo_info_t sdoi;
-    //size_t current_sdo = 0;
-
-    if (ecrt_sdo_info_get(master->master, slave->info->position, i, &sdoi)) {
-      syslog(
-          LOG_WARNING,
-          "Warning, unable to retrieve information of object dictionary entry %d",
-          i);
-      continue;
-    }
-
-    for (int j = 0; j < (sdoi.maxindex + 1); j++) {
-      Sdo_t *sdo = slave->dictionary + current_sdo++;
-      ec_sdo_info_entry_t entry;
-
-      if (ecrt_sdo_get_info_entry(master->master, slave->info->position,
-                                  sdoi.index, j, &entry)) {
-        syslog(LOG_WARNING,
-               "Warning, cannot read SDO entry index: 0x%04x subindex: %d",
-               sdoi.index, j);
-        continue;
-      }
-
-      sdo->index = sdoi.index;
-      sdo->subindex = j;
-      sdo->entry_type = entry.data_type;
-      sdo->object_type = sdoi.object_code;
-
-      // FIXME: For some reason the bit length of the VISIBLE_STRING gets set to
-      // 144 which is not correct. This causes the SDO requests to have the
-      // wrong size and fail for strings. The root cause why this is happening
-      // must be found and then this workaround should be removed.
-      if (entry.data_type == ENTRY_TYPE_VISIBLE_STRING) {
-        sdo->bit_length = ECW_MAX_VISIBLE_STRING_LENGTH;
-      } else {
-        sdo->bit_length = entry.bit_length;
-      }
-
-      sdo->value = 0;
-      sdo->value_string[0] = '\0';
-
-      memmove(sdo->name, entry.description, EC_MAX_STRING_LENGTH);
-      memmove(sdo->object_name, sdoi.name, EC_MAX_STRING_LENGTH);
-      memmove(sdo->read_access, entry.read_access, EC_SDO_ENTRY_ACCESS_COUNTER);
-      memmove(sdo->write_access, entry.write_access,
-      EC_SDO_ENTRY_ACCESS_COUNTER);
-
-      /* SDO requests are uploaded at master_start(), they are only
-       * needed when master and slave are in real time context. */
-      sdo->request = NULL;
-    }
-  }
-
-  slave->sdo_count = object_count;
-
   return 0;
 }
 
@@ -410,22 +545,22 @@ ec_master_info_t* ecw_preemptive_master_info(int master_id)
     return NULL;
   }
 
-  int timeout = 1000;
+  /* the calls return as soon as the bus is ready */
+  if (ecrt_master_wait_link_up(master, ECW_WAIT_TIMEOUT) != 0
+      || ecrt_master_wait_scan(master, ECW_WAIT_TIMEOUT) != 0) {
+    syslog(LOG_ERR, "ERROR, link_up or scan_busy timed out");
+    ecrt_release_master(master);
+    return NULL;
+  }
+
   ec_master_info_t *info = calloc(1, sizeof(ec_master_info_t));
-  info->scan_busy = 1;
-  info->link_up = 0;
-  while (info->link_up == 0 && info->scan_busy && (timeout-- > 0)) {
-    ecrt_master(master, info);
-    usleep(1000);
+  if (info != NULL && ecrt_master(master, info) != 0) {
+    free(info);
+    info = NULL;
   }
 
   ecrt_release_master(master);
 
-  if (timeout <= 0) {
-    syslog(LOG_ERR, "ERROR, link_up or scan_busy timed out");
-    return NULL;
-  }
-
   return info;
 }
 
@@ -580,11 +715,17 @@ unsigned int ecw_preemptive_slave_product_code(int master_id, int slave_index)
 }
 
 Ethercat_Master_t *ecw_master_init(int master_id, FILE *logfile)
+{
+  return ecw_master_init_ex(master_id, logfile, NULL);
+}
+
+Ethercat_Master_t *ecw_master_init_ex(int master_id, FILE *logfile,
+                                      const Ethercat_Init_Options_t *options)
 {
   openlog(LIBETHERCAT_WRAPPER_SYSLOG, LOG_CONS | LOG_PID | LOG_NDELAY,
   LOG_USER);
 
-  Ethercat_Master_t *master = malloc(sizeof(Ethercat_Master_t));
+  Ethercat_Master_t *master = calloc(1, sizeof(Ethercat_Master_t));
   if (master == NULL) {
     /* Cannot allocate master */
     free(master);
@@ -596,41 +737,39 @@ Ethercat_Master_t *ecw_master_init(int master_id, FILE *logfile)
     return NULL;
   }
 
-  /* wait for the master and get its state */
-  int timeout = 1000;
-  ec_master_state_t state;
-  state.link_up = 0;
-  while (state.link_up == 0 && (timeout-- > 0)) {
-    ecrt_master_state(master->master, &state);
-    usleep(1000);
+  int lazy_dictionary = (options != NULL) ? options->lazy_dictionary : 0;
+  if (options != NULL && options->dictionary_cache != NULL) {
+    master->dictionary_cache = strdup(options->dictionary_cache);
   }
-  if (timeout <= 0) {
+  const char *topology_cache = (options != NULL) ?
+      options->topology_cache : NULL;
+
+  /* wait for the master, the calls return as soon as the bus is ready */
+  if (ecrt_master_wait_link_up(master->master, ECW_WAIT_TIMEOUT) != 0) {
     syslog(LOG_ERR, "ERROR, link_state timed out");
     return NULL;
   }
 
-  /* configure slaves */
-  ec_master_info_t *info = calloc(1, sizeof(ec_master_info_t));
-
-  timeout = 1000;
-  info->scan_busy = 1;
-  while ((info->scan_busy) && (timeout-- > 0)) {
-    ecrt_master(master->master, info);
-    usleep(1000);
-  }
-
-  if (timeout <= 0) {
+  if (ecrt_master_wait_scan(master->master, ECW_WAIT_TIMEOUT) != 0) {
     syslog(LOG_ERR, "ERROR, scan_busy timed out");
     return NULL;
   }
 
+  /* configure slaves */
+  ec_master_state_t state;
+  ecrt_master_state(master->master, &state);
+
+  ec_master_info_t *info = calloc(1, sizeof(ec_master_info_t));
+  ecrt_master(master->master, info);
+
   if (info->slave_count != state.slaves_responding) {
     syslog(LOG_ERR, "ERROR, slave_count - slaves_responding mismatch");
     return NULL;
   }
 
   master->slave_count = info->slave_count;
-  master->slaves = malloc(master->slave_count * sizeof(Ethercat_Slave_t));
+  master->slaves = calloc(master->slave_count, sizeof(Ethercat_Slave_t));
+  master->link_state = calloc(1, sizeof(Link_State_t));
 
   size_t all_pdo_count = 0;
 
@@ -651,6 +790,7 @@ Ethercat_Master_t *ecw_master_init(int master_id, FILE *logfile)
   for (int i = 0; i < info->slave_count; i++) {
     Ethercat_Slave_t *slave = master->slaves + i;
     slave->master = master->master;
+    slave->link_state = master->link_state;
     slave->info = malloc(sizeof(ec_slave_info_t));
     if (ecrt_master_get_slave(master->master, i, slave->info) != 0) {
       syslog(LOG_ERR, "Error, could not read slave configuration for slave %d",
@@ -666,20 +806,35 @@ Ethercat_Master_t *ecw_master_init(int master_id, FILE *logfile)
     slave->reference_alias = reference_alias;
     slave->relative_position = relative_position;
 
-    /* get the PDOs from the buffered sync managers */
+    relative_position++;
+  }
+
+  free(info);
+
+  /* get the PDOs from the buffered sync managers */
+  if (slave_layout_init(master, topology_cache) != 0) {
+    return NULL;
+  }
+
+  for (int i = 0; i < master->slave_count; i++) {
+    Ethercat_Slave_t *slave = master->slaves + i;
+
     if (slave_config(master, slave) != 0) {
       syslog(LOG_ERR, "ERROR, configuration slave %d", i);
       return NULL;
     }
 
+    slave->dictionary_cache = master->dictionary_cache;
+    if (!lazy_dictionary && slave_dictionary_load(slave) != 0) {
+      syslog(LOG_ERR, "Error, unable to read the object dictionary of slave %d",
+             i);
+      return NULL;
+    }
+
     all_pdo_count += ((master->slaves + i)->outpdocount
         + (master->slaves + i)->inpdocount);
-
-    relative_position++;
   }
 
-  free(info);
-
   /*
    * Register domain for PDO exchange
    */
@@ -689,102 +844,42 @@ Ethercat_Master_t *ecw_master_init(int master_id, FILE *logfile)
   for (int i = 0; i < master->slave_count; i++) {
     Ethercat_Slave_t *slave = master->slaves + i;
     slave->cyclic_mode = 0;  // mark slaves as not in cyclic mode
-    for (int j = 0; j < slave->info->sync_count; j++) {
-      ec_sync_info_t *sm = slave->sminfo + j;
-      if (0 == sm->n_pdos) { /* if no PDOs for this sync manager proceed to the next one */
-        continue;
-      }
-
-      pdo_t *values = NULL;
-
-      if (sm->dir == EC_DIR_INPUT) {
-        values = slave->input_values;
-      } else {
-        syslog(LOG_WARNING, "... skip wrong direction");
-        continue; /* skip this configuration - FIXME better error handling? */
-      }
-
-      size_t valcount = 0;
-
-      for (int m = 0; m < sm->n_pdos; m++) {
-        ec_pdo_info_t *pdos = sm->pdos + m;
-
-        for (int n = 0; n < pdos->n_entries; n++) {
-          ec_pdo_entry_info_t *entry = pdos->entries + n;
-
-          pdo_t *pdoe = (values + valcount);
-          valcount++;
-
-          /* FIXME Add proper error handling if VALUE_TYPE_NONE is returned */
-          pdoe->type = get_type_from_bitlength(entry->bit_length);
-
-          // IMPORTANT: The reference alias must be used, as well as the
-          // position relative to that alias
-          domain_reg_cur->alias = slave->reference_alias;
-          domain_reg_cur->position = slave->relative_position;
-
-          domain_reg_cur->vendor_id = slave->info->vendor_id;
-          domain_reg_cur->product_code = slave->info->product_code;
-          domain_reg_cur->index = entry->index;
-          domain_reg_cur->subindex = entry->subindex;
-          domain_reg_cur->offset = &(pdoe->offset);
-          domain_reg_cur->bit_position = &(pdoe->bit_offset);
-          domain_reg_cur++;
-        }
-      }
-    }
+    slave->domain_id = 0; // member of the default domain
+    domain_reg_cur = append_domain_regs(slave, EC_DIR_INPUT, domain_reg_cur);
   }
 
   for (int i = 0; i < master->slave_count; i++) {
     Ethercat_Slave_t *slave = master->slaves + i;
-    for (int j = 0; j < slave->info->sync_count; j++) {
-      ec_sync_info_t *sm = slave->sminfo + j;
-      if (0 == sm->n_pdos) { /* if no PDOs for this sync manager proceed to the next one */
-        continue;
-      }
-
-      pdo_t *values = NULL;
-
-      if (sm->dir == EC_DIR_OUTPUT) {
-        values = slave->output_values;
-      } else {
-        syslog(LOG_WARNING, "... skip wrong direction");
-        continue; /* skip this configuration - FIXME better error handling? */
-      }
+    domain_reg_cur = append_domain_regs(slave, EC_DIR_OUTPUT, domain_reg_cur);
 
-      size_t valcount = 0;
-
-      for (int m = 0; m < sm->n_pdos; m++) {
-        ec_pdo_info_t *pdos = sm->pdos + m;
-
-        for (int n = 0; n < pdos->n_entries; n++) {
-          ec_pdo_entry_info_t *entry = pdos->entries + n;
+    /* in the lazy mode no dictionary must be read during the init */
+    assert(!lazy_dictionary || !slave->dictionary_loaded);
+  }
 
-          pdo_t *pdoe = (values + valcount);
-          valcount++;
+  // IMPORTANT: The last element in the domain registration must be a null
+  // struct, or at least an ec_pdo_entry_reg_t with its index set to zero
+  memset(domain_reg_cur, 0, sizeof(ec_pdo_entry_reg_t));
 
-          /* FIXME Add proper error handling if VALUE_TYPE_NONE is returned */
-          pdoe->type = get_type_from_bitlength(entry->bit_length);
+  /* the default domain, exchanged every cycle */
+  master->domains = calloc(ECW_MAX_DOMAINS, sizeof(Ethercat_Domain_t));
+  if (master->domains == NULL) {
+    syslog(LOG_ERR, "Error, cannot allocate the domains");
+    return NULL;
+  }
+  master->domains->rate_divider = 1;
+  master->domain_count = 1;
 
-          // IMPORTANT: The reference alias must be used, as well as the
-          // position relative to that alias
-          domain_reg_cur->alias = slave->reference_alias;
-          domain_reg_cur->position = slave->relative_position;
+  master->status = status_buffer_create(master->slave_count);
+  if (master->status == NULL) {
+    syslog(LOG_ERR, "Error, cannot allocate the status snapshots");
+    return NULL;
+  }
 
-          domain_reg_cur->vendor_id = slave->info->vendor_id;
-          domain_reg_cur->product_code = slave->info->product_code;
-          domain_reg_cur->index = entry->index;
-          domain_reg_cur->subindex = entry->subindex;
-          domain_reg_cur->offset = &(pdoe->offset);
-          domain_reg_cur->bit_position = &(pdoe->bit_offset);
-          domain_reg_cur++;
-        }
-      }
-    }
+  master->sdo_queue = sdo_queue_create();
+  if (master->sdo_queue == NULL) {
+    syslog(LOG_ERR, "Error, cannot allocate the SDO queue");
+    return NULL;
   }
-  // IMPORTANT: The last element in the domain registration must be a null
-  // struct, or at least an ec_pdo_entry_reg_t with its index set to zero
-  memset(domain_reg_cur, 0, sizeof(ec_pdo_entry_reg_t));
 
   update_master_state(master);
   update_all_slave_state(master);
@@ -798,7 +893,14 @@ void ecw_master_release(Ethercat_Master_t *master)
 {
   free_all_slaves(master); /* FIXME have to recursively clean up the slaves! */
   ecrt_release_master(master->master);
+  /* the domains are unlinked from the master now and can be freed */
+  clear_domains(master);
   free(master->domain_reg);
+  free(master->domains);
+  free(master->dictionary_cache);
+  status_buffer_free(master->status);
+  sdo_queue_free(master->sdo_queue);
+  free(master->link_state);
   free(master);
 }
 
@@ -827,40 +929,95 @@ int ecw_master_start(Ethercat_Master_t *master)
       return -1;
     }
 
-    if (setup_sdo_request(slave)) {
+    if (sdo_request_pool_create(slave)) {
       syslog(LOG_ERR, "Error could not setup SDO requests for slave id %lu",
              slaveid);
       return -1;
     }
   }
 
-  /* create the domain registry */
-  master->domain = ecrt_master_create_domain(master->master);
-  if (master->domain == NULL) {
-    return -1;
-  }
+  /* create the domains and their registries, empty domains are skipped */
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
+    size_t pdo_count = 0;
 
-  if (ecrt_domain_reg_pdo_entry_list(master->domain, master->domain_reg) != 0) {
-    syslog(LOG_ERR, "Error cannot register PDO domain");
-    return -1;
+    domain->domain_reg = create_domain_regs(master, d, &pdo_count);
+    if (domain->domain_reg == NULL) {
+      syslog(LOG_ERR, "Error cannot allocate the registry of domain %zu", d);
+      discard_domains(master);
+      return -1;
+    }
+
+    if (pdo_count == 0) {
+      continue;
+    }
+
+    domain->domain = ecrt_master_create_domain(master->master);
+    if (domain->domain == NULL) {
+      discard_domains(master);
+      return -1;
+    }
+
+    if (ecrt_domain_reg_pdo_entry_list(domain->domain, domain->domain_reg) != 0) {
+      syslog(LOG_ERR, "Error cannot register PDO domain %zu", d);
+      discard_domains(master);
+      return -1;
+    }
   }
 
   /* FIXME how can I get information about the error leading to no activation
    * of the master */
   if (ecrt_master_activate(master->master) < 0) {
     syslog(LOG_ERR, "Error could not activate master.");
+    discard_domains(master);
     return -1;
   }
 
-  master->processdata = ecrt_domain_data(master->domain);
-  if (master->processdata == NULL) {
-    syslog(
-        LOG_ERR,
-        "Error unable to get the process data pointer. Disable master again.");
-    ecrt_master_deactivate(master->master);
-    return -1;
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
+
+    if (domain->domain == NULL) {
+      continue;
+    }
+
+    domain->processdata = ecrt_domain_data(domain->domain);
+    if (domain->processdata == NULL) {
+      syslog(
+          LOG_ERR,
+          "Error unable to get the process data pointer. Disable master again.");
+      discard_domains(master);
+      return -1;
+    }
+
+    /* the PDO offsets are known now, compile the cyclic copy plans */
+    domain->input_plan = pdo_plan_create(master->slaves, master->slave_count,
+                                         d, EC_DIR_INPUT);
+    domain->output_plan = pdo_plan_create(master->slaves, master->slave_count,
+                                          d, EC_DIR_OUTPUT);
+    if (domain->input_plan == NULL || domain->output_plan == NULL) {
+      syslog(LOG_ERR, "Error unable to create the PDO copy plan. Disable master again.");
+      discard_domains(master);
+      return -1;
+    }
+
+    domain->queued = 0;
+
+    syslog(LOG_INFO, "Domain %zu (rate 1/%u): %zu input entries in %zu "
+           "operations, %zu output entries in %zu operations", d,
+           domain->rate_divider,
+           domain->input_plan->entry_count, domain->input_plan->op_count,
+           domain->output_plan->entry_count, domain->output_plan->op_count);
+  }
+
+  for (size_t slaveid = 0; slaveid < master->slave_count; slaveid++) {
+    Ethercat_Slave_t *slave = master->slaves + slaveid;
+    slave->processdata = master->domains[slave->domain_id].processdata;
   }
 
+  master->domain = master->domains->domain;
+  master->processdata = master->domains->processdata;
+  master->cycle = 0;
+
   update_domain_state(master);
 
   closelog();
@@ -878,11 +1035,8 @@ int ecw_master_stop(Ethercat_Master_t *master)
    * counterpart to ecrt_master_activate(). */
   ecrt_master_deactivate(master->master);
 
-  free(master->domain);
-
   /* These pointer will become invalid after call to ecrt_master_deactivate() */
-  master->domain = NULL;
-  master->processdata = NULL;
+  clear_domains(master);
 
   /* This function frees the following data structures (internally):
    *
@@ -897,8 +1051,14 @@ int ecw_master_stop(Ethercat_Master_t *master)
   for (size_t slaveid = 0; slaveid < master->slave_count; slaveid++) {
     Ethercat_Slave_t *slave = master->slaves + slaveid;
     slave->cyclic_mode = 0;
+    slave->processdata = NULL;
+    sdo_request_pool_release(slave);
   }
 
+  /* the requests of the pending SDO operations are gone */
+  sdo_queue_clear(master->sdo_queue);
+  master->link_state->valid = 0;
+
   return 0;
 }
 
@@ -980,112 +1140,227 @@ int ecw_master_pdo_exchange(Ethercat_Master_t *master)
   return ret;
 }
 
-int ecw_master_receive_pdo(Ethercat_Master_t *master)
+int ecw_master_monitor(Ethercat_Master_t *master)
 {
-  openlog(LIBETHERCAT_WRAPPER_SYSLOG, LOG_CONS | LOG_PID | LOG_NDELAY,
-  LOG_USER);
+  Status_Buffer_t *status = master->status;
+  Ethercat_Status_t *snapshot = status_buffer_back(status);
+
+  snapshot->cycle = master->cycle;
+  ecrt_master_state(master->master, &(snapshot->master_state));
+
+  if (snapshot->master_state.slaves_responding
+      != status->last_master_state.slaves_responding
+      && snapshot->master_state.slaves_responding != master->slave_count) {
+    syslog(LOG_ERR, "Warning slaves responding: %u expected: %zu",
+           snapshot->master_state.slaves_responding, master->slave_count);
+  }
+  status->last_master_state = snapshot->master_state;
+
+  snapshot->domain_count = master->domain_count;
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
+    ec_domain_state_t *ds = snapshot->domain_state + d;
+
+    if (domain->domain == NULL) {
+      memset(ds, 0, sizeof(ec_domain_state_t));
+      continue;
+    }
+
+    ecrt_domain_state(domain->domain, ds);
+    if (ds->wc_state != status->last_wc_state[d]) {
+      syslog(LOG_WARNING, "Domain %zu working counter state: %d", d,
+             ds->wc_state);
+      status->last_wc_state[d] = ds->wc_state;
+    }
+  }
+
+  for (size_t i = 0; i < master->slave_count; i++) {
+    Ethercat_Slave_t *slave = master->slaves + i;
+
+    if (slave->config == NULL) {
+      memset(snapshot->slave_state + i, 0, sizeof(ec_slave_config_state_t));
+      continue;
+    }
+
+    ecrt_slave_config_state(slave->config, snapshot->slave_state + i);
+  }
+
+  status_buffer_publish(status);
 
+  return 0;
+}
+
+const Ethercat_Status_t *ecw_master_get_status(Ethercat_Master_t *master)
+{
+  return status_buffer_latest(master->status);
+}
+
+int ecw_master_receive_pdo(Ethercat_Master_t *master)
+{
   /* FIXME: Check error state and may add handler for broken topology. */
   ecrt_master_receive(master->master);
-  ecrt_domain_process(master->domain);
 
-  for (int i = 0; i < master->slave_count; i++) {
-    Ethercat_Slave_t *slave = master->slaves + i;
+  /* only the domains queued in the last cycle have new data */
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
 
-    for (int k = 0; k < slave->inpdocount; k++) {
-      pdo_t *pdo = ecw_slave_get_inpdo(slave, k);
-
-      switch (pdo->type) {
-        case VALUE_TYPE_UNSIGNED1:
-          pdo->value = EC_READ_BIT(master->processdata + pdo->offset,
-                                   pdo->bit_offset);
-          break;
-        case VALUE_TYPE_UNSIGNED8:
-          pdo->value = EC_READ_U8(master->processdata + pdo->offset);
-          break;
-        case VALUE_TYPE_UNSIGNED16:
-          pdo->value = EC_READ_U16(master->processdata + pdo->offset);
-          break;
-        case VALUE_TYPE_UNSIGNED32:
-          pdo->value = EC_READ_U32(master->processdata + pdo->offset);
-          break;
-        case VALUE_TYPE_SIGNED8:
-          pdo->value = EC_READ_S8(master->processdata + pdo->offset);
-          break;
-        case VALUE_TYPE_SIGNED16:
-          pdo->value = EC_READ_S16(master->processdata + pdo->offset);
-          break;
-        case VALUE_TYPE_SIGNED32:
-          pdo->value = EC_READ_S32(master->processdata + pdo->offset);
-          break;
-
-        case VALUE_TYPE_PADDING:
-        case VALUE_TYPE_NONE:
-        default:
-          //syslog(LOG_ERR, "Warning, unknown value type(%d). No RxPDO update", pdo->type);
-          pdo->value = 0;
-          break;
-      }
+    if (!domain->queued) {
+      continue;
+    }
+
+    ecrt_domain_process(domain->domain);
+    pdo_plan_read(domain->input_plan, domain->processdata);
+    domain->queued = 0;
+  }
+
+  return 0;
+}
+
+int ecw_master_send_pdo(Ethercat_Master_t *master)
+{
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
 
-      ecw_slave_set_inpdo(slave, k, pdo);
+    if (domain->domain == NULL || master->cycle % domain->rate_divider != 0) {
+      continue;
     }
+
+    pdo_plan_write(domain->output_plan, domain->processdata);
+    ecrt_domain_queue(domain->domain);
+    domain->queued = 1;
   }
 
-  closelog();
+  ecrt_master_send(master->master);
+  master->cycle++;
+  master->link_state->valid = 0;
 
   return 0;
 }
 
-int ecw_master_send_pdo(Ethercat_Master_t *master)
+/*
+ * Domain handling
+ */
+
+/*
+ * The slaves enter and leave the cyclic mode together, master->domain is no
+ * indication as it stays NULL if the default domain has no entries.
+ */
+static int master_is_cyclic(const Ethercat_Master_t *master)
+{
+  return master->slave_count > 0 && master->slaves->cyclic_mode;
+}
+
+static int create_domain(Ethercat_Master_t *master, unsigned int rate_divider)
+{
+  if (master_is_cyclic(master)) {
+    syslog(LOG_ERR, "Error, domains cannot be created in cyclic mode");
+    return -1;
+  }
+
+  if (master->domain_count >= ECW_MAX_DOMAINS) {
+    syslog(LOG_ERR, "Error, no more than %d domains supported",
+           ECW_MAX_DOMAINS);
+    return -1;
+  }
+
+  if (rate_divider == 0) {
+    syslog(LOG_ERR, "Error, invalid rate divider 0");
+    return -1;
+  }
+
+  Ethercat_Domain_t *domain = master->domains + master->domain_count;
+  memset(domain, 0, sizeof(Ethercat_Domain_t));
+  domain->rate_divider = rate_divider;
+
+  return master->domain_count++;
+}
+
+int ecw_master_create_domain_by_type(Ethercat_Master_t *master,
+                                     enum eSlaveType type,
+                                     unsigned int rate_divider)
 {
   openlog(LIBETHERCAT_WRAPPER_SYSLOG, LOG_CONS | LOG_PID | LOG_NDELAY,
   LOG_USER);
 
-  for (int i = 0; i < master->slave_count; i++) {
-    Ethercat_Slave_t *slave = master->slaves + i;
+  int domain_id = create_domain(master, rate_divider);
 
-    for (int k = 0; k < slave->outpdocount; k++) {
-      pdo_t *value = ecw_slave_get_outpdo(slave, k);
-
-      // EC_WRITE_XX(master->processdata + (slave->txpdo_offset + k), value);
-      switch (value->type) {
-        case VALUE_TYPE_UNSIGNED1:
-          EC_WRITE_BIT(master->processdata + value->offset, value->bit_offset,
-                       value->value);
-          break;
-        case VALUE_TYPE_UNSIGNED8:
-          EC_WRITE_U8(master->processdata + value->offset, value->value);
-          break;
-        case VALUE_TYPE_UNSIGNED16:
-          EC_WRITE_U16(master->processdata + value->offset, value->value);
-          break;
-        case VALUE_TYPE_UNSIGNED32:
-          EC_WRITE_U32(master->processdata + value->offset, value->value);
-          break;
-        case VALUE_TYPE_SIGNED8:
-          EC_WRITE_S8(master->processdata + value->offset, value->value);
-          break;
-        case VALUE_TYPE_SIGNED16:
-          EC_WRITE_S16(master->processdata + value->offset, value->value);
-          break;
-        case VALUE_TYPE_SIGNED32:
-          EC_WRITE_S32(master->processdata + value->offset, value->value);
-          break;
-
-        case VALUE_TYPE_PADDING:
-        case VALUE_TYPE_NONE:
-        default:
-          //syslog(LOG_ERR, "Warning, unknown value type(%d). No TxPDO update", value->type);
-          break;
+  if (domain_id > 0) {
+    for (size_t i = 0; i < master->slave_count; i++) {
+      Ethercat_Slave_t *slave = master->slaves + i;
+      if (slave->type == type) {
+        slave->domain_id = domain_id;
       }
     }
   }
 
-  ecrt_domain_queue(master->domain);
-  ecrt_master_send(master->master);
+  closelog();
+
+  return domain_id;
+}
+
+int ecw_master_create_domain(Ethercat_Master_t *master, const int *slave_ids,
+                             size_t count, unsigned int rate_divider)
+{
+  openlog(LIBETHERCAT_WRAPPER_SYSLOG, LOG_CONS | LOG_PID | LOG_NDELAY,
+  LOG_USER);
+
+  for (size_t i = 0; i < count; i++) {
+    if (slave_ids[i] < 0 || slave_ids[i] >= master->slave_count) {
+      syslog(LOG_ERR, "Error, invalid slave id %d for domain", slave_ids[i]);
+      closelog();
+      return -1;
+    }
+  }
+
+  int domain_id = create_domain(master, rate_divider);
+
+  if (domain_id > 0) {
+    for (size_t i = 0; i < count; i++) {
+      (master->slaves + slave_ids[i])->domain_id = domain_id;
+    }
+  }
 
   closelog();
 
+  return domain_id;
+}
+
+int ecw_master_set_domain_rate(Ethercat_Master_t *master, int domain_id,
+                               unsigned int rate_divider)
+{
+  if (domain_id < 0 || domain_id >= master->domain_count
+      || rate_divider == 0) {
+    return -1;
+  }
+
+  master->domains[domain_id].rate_divider = rate_divider;
+
+  return 0;
+}
+
+size_t ecw_master_domain_count(Ethercat_Master_t *master)
+{
+  return master->domain_count;
+}
+
+int ecw_master_get_domain_state(Ethercat_Master_t *master, int domain_id,
+                                ec_domain_state_t *state)
+{
+  if (domain_id < 0 || domain_id >= master->domain_count
+      || master->domains[domain_id].domain == NULL) {
+    return -1;
+  }
+
+  /* with ecw_master_pdo_exchange() the states are only read by
+   * ecw_master_monitor(), domain_state is kept by ecw_master_cyclic_function()
+   * only */
+  const Ethercat_Status_t *status = status_buffer_latest(master->status);
+  if (status != NULL && (size_t) domain_id < status->domain_count) {
+    *state = status->domain_state[domain_id];
+  } else {
+    *state = master->domains[domain_id].domain_state;
+  }
+
   return 0;
 }
 
@@ -1113,8 +1388,10 @@ Ethercat_Slave_t *ecw_slave_get(Ethercat_Master_t *master, int slaveid)
   return (master->slaves + slaveid);
 }
 
-int ecw_slave_set_state(Ethercat_Master_t *master, int slaveid,
-                        enum eALState state)
+/*
+ * AL state code as used by the master
+ */
+static uint8_t al_state_code(enum eALState state)
 {
   uint8_t int_state = ALSTATE_INIT;
   switch (state) {
@@ -1135,8 +1412,25 @@ int ecw_slave_set_state(Ethercat_Master_t *master, int slaveid,
       break;
   }
 
+  return int_state;
+}
+
+int ecw_master_wait_state(Ethercat_Master_t *master, enum eALState state,
+                          unsigned int timeout_ms)
+{
+  int ret = ecrt_master_wait_al_state(master->master, al_state_code(state),
+                                      timeout_ms);
+
+  update_master_state(master);
+
+  return ret;
+}
+
+int ecw_slave_set_state(Ethercat_Master_t *master, int slaveid,
+                        enum eALState state)
+{
   return ecrt_master_slave_link_state_request(master->master, slaveid,
-                                              int_state);
+                                              al_state_code(state));
 }
 
 /*
@@ -1145,27 +1439,42 @@ int ecw_slave_set_state(Ethercat_Master_t *master, int slaveid,
 
 static void update_domain_state(Ethercat_Master_t *master)
 {
-  ec_domain_state_t ds;
-  ecrt_domain_state(master->domain, &ds/*&(master->domain_state)*/);
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
+
+    if (domain->domain == NULL) {
+      continue;
+    }
+
+    ec_domain_state_t ds;
+    ecrt_domain_state(domain->domain, &ds/*&(domain->domain_state)*/);
 
 #if 0 /* for now disable this vast amount of prints FIXME have to figure out why this happend */
-  if (ds.working_counter != master->domain_state.working_counter)
-  syslog(LOG_ERR, "Working counter differ: %d / %d",
-      ds.working_counter, master->domain_state.working_counter);
+    if (ds.working_counter != domain->domain_state.working_counter)
+    syslog(LOG_ERR, "Working counter differ: %d / %d",
+        ds.working_counter, domain->domain_state.working_counter);
 
-  if (ds.wc_state != master->domain_state.wc_state)
-  syslog(LOG_ERR, "New WC State: %d / %d",
-      ds.wc_state, master->domain_state.wc_state);
+    if (ds.wc_state != domain->domain_state.wc_state)
+    syslog(LOG_ERR, "New WC State: %d / %d",
+        ds.wc_state, domain->domain_state.wc_state);
 #endif
 
-  master->domain_state = ds;
+    domain->domain_state = ds;
+  }
+
+  master->domain_state = master->domains->domain_state;
 }
 
 static void update_master_state(Ethercat_Master_t *master)
 {
+  unsigned int slaves_responding = master->master_state.slaves_responding;
+
   ecrt_master_state(master->master, &(master->master_state));
 
-  if (master->slave_count != master->master_state.slaves_responding) {
+  /* only log changes, this is called every cycle by
+   * ecw_master_cyclic_function() */
+  if (master->slave_count != master->master_state.slaves_responding
+      && slaves_responding != master->master_state.slaves_responding) {
     syslog(LOG_ERR, "Warning slaves responding: %u expected: %zu",
            master->master_state.slaves_responding, master->slave_count);
   }
@@ -1183,8 +1492,8 @@ static void free_all_slaves(Ethercat_Master_t *master)
 {
   for (int i = 0; i < master->slave_count; i++) {
     Ethercat_Slave_t *slave = master->slaves + i;
-    free(slave->sminfo->pdos);
-    free(slave->sminfo);
+    topology_free_layout(slave);
+    sdo_table_free(slave);
     free(slave->dictionary);
     free(slave->output_values);
     free(slave->input_values);
@@ -1195,6 +1504,47 @@ static void free_all_slaves(Ethercat_Master_t *master)
   free(master->slaves);
 }
 
+static void clear_domains(Ethercat_Master_t *master)
+{
+  for (size_t d = 0; d < master->domain_count; d++) {
+    Ethercat_Domain_t *domain = master->domains + d;
+
+    free(domain->domain);
+    free(domain->domain_reg);
+    pdo_plan_free(domain->input_plan);
+    pdo_plan_free(domain->output_plan);
+
+    domain->domain = NULL;
+    domain->domain_reg = NULL;
+    domain->processdata = NULL;
+    domain->input_plan = NULL;
+    domain->output_plan = NULL;
+    domain->queued = 0;
+  }
+
+  master->domain = NULL;
+  master->processdata = NULL;
+}
+
+/*
+ * Error path of ecw_master_start(): the domains created so far are still
+ * linked into the configuration of libethercat, so they must not be freed
+ * before the configuration is dropped with ecrt_master_deactivate(). This also
+ * drops the slave configurations and the SDO requests created on them.
+ */
+static void discard_domains(Ethercat_Master_t *master)
+{
+  ecrt_master_deactivate(master->master);
+  clear_domains(master);
+
+  for (size_t slaveid = 0; slaveid < master->slave_count; slaveid++) {
+    Ethercat_Slave_t *slave = master->slaves + slaveid;
+    slave->cyclic_mode = 0;
+    slave->processdata = NULL;
+    sdo_request_pool_release(slave);
+  }
+}
+
 void ecw_print_master_state(Ethercat_Master_t *master)
 {
   ec_master_state_t state;
@@ -0,0 +1,196 @@
+/*
+ * od_cache.c
+ *
+ * The object dictionary of a device only depends on its firmware, so the
+ * descriptions uploaded from one slave can be reused for every slave with the
+ * same vendor id, product code and revision number. The cache file holds a
+ * header followed by one fixed size record per object, in the byte order of
+ * the host. It is meant as a local cache and is not portable between
+ * machines.
+ *
+ * Synapticon GmbH
+ */
+
+#include "od_cache.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define OD_CACHE_MAGIC    0x444f4345 /* "ECOD" */
+#define OD_CACHE_VERSION  1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t vendor_id;
+  uint32_t product_code;
+  uint32_t revision_number;
+  uint32_t object_count; /* number of objects as reported by the slave */
+  uint32_t entry_count; /* number of records, including the subindexes */
+} Od_Cache_Header_t;
+
+typedef struct {
+  uint16_t index;
+  uint8_t subindex;
+  uint8_t object_type;
+  uint16_t entry_type;
+  uint16_t reserved;
+  int32_t bit_length;
+  uint8_t read_access[EC_SDO_ENTRY_ACCESS_COUNTER];
+  uint8_t write_access[EC_SDO_ENTRY_ACCESS_COUNTER];
+  char name[EC_MAX_STRING_LENGTH];
+  char object_name[EC_MAX_STRING_LENGTH];
+} Od_Cache_Record_t;
+
+static int od_cache_path(char *path, size_t size, const char *dir,
+                         const ec_slave_info_t *info)
+{
+  int len = snprintf(path, size, "%s/%08x-%08x-%08x.od", dir, info->vendor_id,
+                     info->product_code, info->revision_number);
+
+  return (len < 0 || (size_t) len >= size) ? -1 : 0;
+}
+
+static int header_matches(const Od_Cache_Header_t *header,
+                          const ec_slave_info_t *info)
+{
+  return header->magic == OD_CACHE_MAGIC
+      && header->version == OD_CACHE_VERSION
+      && header->vendor_id == info->vendor_id
+      && header->product_code == info->product_code
+      && header->revision_number == info->revision_number
+      && header->object_count == info->sdo_count;
+}
+
+int od_cache_load(const char *dir, const ec_slave_info_t *info,
+                  Sdo_t **dictionary, size_t *count)
+{
+  char path[FILENAME_MAX];
+  Od_Cache_Header_t header;
+
+  if (od_cache_path(path, sizeof(path), dir, info)) {
+    return -1;
+  }
+
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return -1;
+  }
+
+  if (fread(&header, sizeof(header), 1, f) != 1
+      || !header_matches(&header, info)) {
+    fclose(f);
+    return -1;
+  }
+
+  Sdo_t *od = calloc(header.entry_count ? header.entry_count : 1,
+                     sizeof(Sdo_t));
+  if (od == NULL) {
+    fclose(f);
+    return -1;
+  }
+
+  for (size_t i = 0; i < header.entry_count; i++) {
+    Od_Cache_Record_t record;
+    Sdo_t *sdo = od + i;
+
+    if (fread(&record, sizeof(record), 1, f) != 1) {
+      free(od);
+      fclose(f);
+      return -1;
+    }
+
+    sdo->index = record.index;
+    sdo->subindex = record.subindex;
+    sdo->object_type = record.object_type;
+    sdo->entry_type = record.entry_type;
+    sdo->bit_length = record.bit_length;
+    memmove(sdo->read_access, record.read_access, EC_SDO_ENTRY_ACCESS_COUNTER);
+    memmove(sdo->write_access, record.write_access,
+    EC_SDO_ENTRY_ACCESS_COUNTER);
+    memmove(sdo->name, record.name, EC_MAX_STRING_LENGTH);
+    memmove(sdo->object_name, record.object_name, EC_MAX_STRING_LENGTH);
+    sdo->name[EC_MAX_STRING_LENGTH - 1] = '\0';
+    sdo->object_name[EC_MAX_STRING_LENGTH - 1] = '\0';
+  }
+
+  fclose(f);
+
+  *dictionary = od;
+  *count = header.entry_count;
+
+  return 0;
+}
+
+int od_cache_store(const char *dir, const ec_slave_info_t *info,
+                   const Sdo_t *dictionary, size_t count)
+{
+  char path[FILENAME_MAX];
+  char tmppath[FILENAME_MAX];
+
+  if (od_cache_path(path, sizeof(path), dir, info)) {
+    return -1;
+  }
+
+  /* write to a temporary file first, so concurrent readers never see a
+   * partial cache file */
+  int len = snprintf(tmppath, sizeof(tmppath), "%s.%d", path, (int) getpid());
+  if (len < 0 || (size_t) len >= sizeof(tmppath)) {
+    return -1;
+  }
+
+  FILE *f = fopen(tmppath, "wb");
+  if (f == NULL) {
+    return -1;
+  }
+
+  Od_Cache_Header_t header = {
+    .magic = OD_CACHE_MAGIC,
+    .version = OD_CACHE_VERSION,
+    .vendor_id = info->vendor_id,
+    .product_code = info->product_code,
+    .revision_number = info->revision_number,
+    .object_count = info->sdo_count,
+    .entry_count = (uint32_t) count
+  };
+
+  int ret = (fwrite(&header, sizeof(header), 1, f) == 1) ? 0 : -1;
+
+  for (size_t i = 0; ret == 0 && i < count; i++) {
+    const Sdo_t *sdo = dictionary + i;
+    Od_Cache_Record_t record;
+
+    memset(&record, 0, sizeof(record));
+    record.index = sdo->index;
+    record.subindex = sdo->subindex;
+    record.object_type = (uint8_t) sdo->object_type;
+    record.entry_type = (uint16_t) sdo->entry_type;
+    record.bit_length = sdo->bit_length;
+    memmove(record.read_access, sdo->read_access, EC_SDO_ENTRY_ACCESS_COUNTER);
+    memmove(record.write_access, sdo->write_access,
+    EC_SDO_ENTRY_ACCESS_COUNTER);
+    memmove(record.name, sdo->name, EC_MAX_STRING_LENGTH);
+    memmove(record.object_name, sdo->object_name, EC_MAX_STRING_LENGTH);
+
+    if (fwrite(&record, sizeof(record), 1, f) != 1) {
+      ret = -1;
+    }
+  }
+
+  if (fclose(f) != 0) {
+    ret = -1;
+  }
+
+  if (ret == 0 && rename(tmppath, path) != 0) {
+    ret = -1;
+  }
+
+  if (ret != 0) {
+    unlink(tmppath);
+  }
+
+  return ret;
+}
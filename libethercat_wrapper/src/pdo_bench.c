@@ -0,0 +1,330 @@
+/*
+ * pdo_bench.c
+ *
+ * Benchmark of the cyclic PDO exchange of the wrapper. Runs offline on a
+ * synthetic process image, no master or bus is needed.
+ *
+ * The legacy per entry exchange is compared against the compiled copy plan
+ * for 1, 32 and 128 slaves with a CiA402 like PDO mapping. "legacy" is the
+ * former exchange including the syslog handling, "switch" the same without
+ * syslog and "plan" the compiled copy plan. The speedup is legacy / plan.
+ *
+ * Usage: pdo_bench [cycles]
+ *
+ * Synapticon GmbH
+ */
+
+#include "pdo_plan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#define DEFAULT_CYCLES  100000
+
+/* PDO mapping of one synthetic slave, in order of the domain registration */
+static const int g_in_bitlengths[] = {
+  16, 8, 32, 32, 16, 32, 32, 32, 32, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+static const int g_out_bitlengths[] = {
+  16, 8, 16, 32, 32, 32, 32, 32, 32, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+#define ARRAY_SIZE(a)  (sizeof(a) / sizeof((a)[0]))
+
+static enum eValueType value_type(int bit_length)
+{
+  switch (bit_length) {
+    case 1:
+      return VALUE_TYPE_UNSIGNED1;
+    case 8:
+      return VALUE_TYPE_UNSIGNED8;
+    case 16:
+      return VALUE_TYPE_UNSIGNED16;
+    case 32:
+      return VALUE_TYPE_UNSIGNED32;
+  }
+
+  return VALUE_TYPE_NONE;
+}
+
+/*
+ * Assign domain offsets like the master does, consecutive and bit entries
+ * packed into bytes.
+ */
+static size_t map_values(pdo_t *values, const int *bitlengths, size_t count,
+                         size_t bit_position)
+{
+  for (size_t k = 0; k < count; k++) {
+    values[k].type = value_type(bitlengths[k]);
+    values[k].offset = bit_position / 8;
+    values[k].bit_offset = bit_position % 8;
+    bit_position += bitlengths[k];
+  }
+
+  return bit_position;
+}
+
+static Ethercat_Slave_t *create_slaves(size_t slave_count, size_t *size)
+{
+  Ethercat_Slave_t *slaves = calloc(slave_count, sizeof(Ethercat_Slave_t));
+  size_t bit_position = 0;
+
+  for (size_t i = 0; i < slave_count; i++) {
+    Ethercat_Slave_t *slave = slaves + i;
+
+    slave->outpdocount = ARRAY_SIZE(g_out_bitlengths);
+    slave->inpdocount = ARRAY_SIZE(g_in_bitlengths);
+    slave->output_values = calloc(slave->outpdocount, sizeof(pdo_t));
+    slave->input_values = calloc(slave->inpdocount, sizeof(pdo_t));
+
+    bit_position = map_values(slave->output_values, g_out_bitlengths,
+                              slave->outpdocount, bit_position);
+    bit_position = map_values(slave->input_values, g_in_bitlengths,
+                              slave->inpdocount, bit_position);
+  }
+
+  *size = (bit_position + 7) / 8;
+
+  return slaves;
+}
+
+static void free_slaves(Ethercat_Slave_t *slaves, size_t slave_count)
+{
+  for (size_t i = 0; i < slave_count; i++) {
+    free(slaves[i].output_values);
+    free(slaves[i].input_values);
+  }
+  free(slaves);
+}
+
+/*
+ * Per entry exchange as done by ecw_master_receive_pdo() and
+ * ecw_master_send_pdo() before the copy plan, optionally including the
+ * openlog()/closelog() pair both functions called every cycle.
+ */
+static void legacy_exchange(Ethercat_Slave_t *slaves, size_t slave_count,
+                            uint8_t *processdata, int with_syslog)
+{
+  if (with_syslog) {
+    openlog("pdo_bench", LOG_CONS | LOG_PID | LOG_NDELAY, LOG_USER);
+  }
+
+  for (size_t i = 0; i < slave_count; i++) {
+    Ethercat_Slave_t *slave = slaves + i;
+
+    for (size_t k = 0; k < slave->inpdocount; k++) {
+      pdo_t *pdo = slave->input_values + k;
+
+      switch (pdo->type) {
+        case VALUE_TYPE_UNSIGNED1:
+          pdo->value = EC_READ_BIT(processdata + pdo->offset, pdo->bit_offset);
+          break;
+        case VALUE_TYPE_UNSIGNED8:
+          pdo->value = EC_READ_U8(processdata + pdo->offset);
+          break;
+        case VALUE_TYPE_UNSIGNED16:
+          pdo->value = EC_READ_U16(processdata + pdo->offset);
+          break;
+        case VALUE_TYPE_UNSIGNED32:
+          pdo->value = EC_READ_U32(processdata + pdo->offset);
+          break;
+        default:
+          pdo->value = 0;
+          break;
+      }
+    }
+  }
+
+  if (with_syslog) {
+    closelog();
+    openlog("pdo_bench", LOG_CONS | LOG_PID | LOG_NDELAY, LOG_USER);
+  }
+
+  for (size_t i = 0; i < slave_count; i++) {
+    Ethercat_Slave_t *slave = slaves + i;
+
+    for (size_t k = 0; k < slave->outpdocount; k++) {
+      pdo_t *pdo = slave->output_values + k;
+
+      switch (pdo->type) {
+        case VALUE_TYPE_UNSIGNED1:
+          EC_WRITE_BIT(processdata + pdo->offset, pdo->bit_offset, pdo->value);
+          break;
+        case VALUE_TYPE_UNSIGNED8:
+          EC_WRITE_U8(processdata + pdo->offset, pdo->value);
+          break;
+        case VALUE_TYPE_UNSIGNED16:
+          EC_WRITE_U16(processdata + pdo->offset, pdo->value);
+          break;
+        case VALUE_TYPE_UNSIGNED32:
+          EC_WRITE_U32(processdata + pdo->offset, pdo->value);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  if (with_syslog) {
+    closelog();
+  }
+}
+
+static void plan_exchange(const Pdo_Plan_t *input, const Pdo_Plan_t *output,
+                          uint8_t *processdata)
+{
+  pdo_plan_read(input, processdata);
+  pdo_plan_write(output, processdata);
+}
+
+static void fill_outputs(Ethercat_Slave_t *slaves, size_t slave_count,
+                         unsigned int seed)
+{
+  for (size_t i = 0; i < slave_count; i++) {
+    for (size_t k = 0; k < slaves[i].outpdocount; k++) {
+      pdo_t *pdo = slaves[i].output_values + k;
+      seed = seed * 1103515245 + 12345;
+      pdo->value = (pdo->type == VALUE_TYPE_UNSIGNED1) ?
+          (int) ((seed >> 16) & 1) : (int) (seed >> 8);
+    }
+  }
+}
+
+/*
+ * Run both variants once on the same image and compare the results.
+ */
+static int verify(Ethercat_Slave_t *slaves, size_t slave_count, size_t size,
+                  const Pdo_Plan_t *input, const Pdo_Plan_t *output)
+{
+  uint8_t *legacy = malloc(size);
+  uint8_t *plan = malloc(size);
+  int *values = malloc(ARRAY_SIZE(g_in_bitlengths) * slave_count * sizeof(int));
+  int ret = 0;
+
+  for (size_t n = 0; n < size; n++) {
+    legacy[n] = plan[n] = (uint8_t) (rand() & 0xff);
+  }
+
+  fill_outputs(slaves, slave_count, 1);
+  legacy_exchange(slaves, slave_count, legacy, 0);
+  for (size_t i = 0; i < slave_count; i++) {
+    for (size_t k = 0; k < slaves[i].inpdocount; k++) {
+      values[i * slaves[i].inpdocount + k] = slaves[i].input_values[k].value;
+      slaves[i].input_values[k].value = -1;
+    }
+  }
+
+  fill_outputs(slaves, slave_count, 1);
+  plan_exchange(input, output, plan);
+
+  if (memcmp(legacy, plan, size) != 0) {
+    ret = -1;
+  }
+
+  for (size_t i = 0; i < slave_count; i++) {
+    for (size_t k = 0; k < slaves[i].inpdocount; k++) {
+      if (values[i * slaves[i].inpdocount + k]
+          != slaves[i].input_values[k].value) {
+        ret = -1;
+      }
+    }
+  }
+
+  free(values);
+  free(plan);
+  free(legacy);
+
+  return ret;
+}
+
+static double elapsed_ns(struct timespec *start, struct timespec *stop)
+{
+  return (stop->tv_sec - start->tv_sec) * 1e9
+      + (stop->tv_nsec - start->tv_nsec);
+}
+
+static int run(size_t slave_count, unsigned long cycles)
+{
+  size_t size = 0;
+  Ethercat_Slave_t *slaves = create_slaves(slave_count, &size);
+  uint8_t *processdata = calloc(1, size);
+  struct timespec start, stop;
+
+  Pdo_Plan_t *input = pdo_plan_create(slaves, slave_count, -1, EC_DIR_INPUT);
+  Pdo_Plan_t *output = pdo_plan_create(slaves, slave_count, -1,
+                                       EC_DIR_OUTPUT);
+  if (input == NULL || output == NULL) {
+    fprintf(stderr, "Error, cannot create copy plan\n");
+    return -1;
+  }
+
+  if (verify(slaves, slave_count, size, input, output)) {
+    fprintf(stderr, "Error, copy plan differs from legacy exchange for %zu slaves\n",
+            slave_count);
+    return -1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (unsigned long c = 0; c < cycles; c++) {
+    legacy_exchange(slaves, slave_count, processdata, 1);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  double legacy_ns = elapsed_ns(&start, &stop) / cycles;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (unsigned long c = 0; c < cycles; c++) {
+    legacy_exchange(slaves, slave_count, processdata, 0);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  double switch_ns = elapsed_ns(&start, &stop) / cycles;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (unsigned long c = 0; c < cycles; c++) {
+    plan_exchange(input, output, processdata);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  double plan_ns = elapsed_ns(&start, &stop) / cycles;
+
+  printf("%6zu %8zu %8zu %8zu %12.1f %12.1f %12.1f %8.1fx\n", slave_count,
+         size, input->entry_count + output->entry_count,
+         input->op_count + output->op_count, legacy_ns, switch_ns, plan_ns,
+         legacy_ns / plan_ns);
+
+  pdo_plan_free(input);
+  pdo_plan_free(output);
+  free(processdata);
+  free_slaves(slaves, slave_count);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  static const size_t slave_counts[] = { 1, 32, 128 };
+  unsigned long cycles = DEFAULT_CYCLES;
+
+  if (argc > 1) {
+    cycles = strtoul(argv[1], NULL, 0);
+    if (cycles == 0) {
+      fprintf(stderr, "Usage: %s [cycles]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  printf("PDO exchange cost per cycle, %lu cycles\n\n", cycles);
+  printf("%6s %8s %8s %8s %12s %12s %12s %9s\n", "slaves", "bytes",
+         "entries", "ops", "legacy [ns]", "switch [ns]", "plan [ns]",
+         "speedup");
+
+  for (size_t i = 0; i < ARRAY_SIZE(slave_counts); i++) {
+    if (run(slave_counts[i], cycles)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,281 @@
+/*
+ * pdo_plan.c
+ *
+ * The per cycle PDO exchange is reduced to a flat list of copy operations.
+ * The list is compiled once after the domain registration, adjacent entries of
+ * the same width are merged into one block operation and single bit entries
+ * sharing a byte are grouped, so the cyclic part neither has to look at the
+ * type of every entry nor walk the slave list.
+ *
+ * Synapticon GmbH
+ */
+
+#include "pdo_plan.h"
+
+#include <stdlib.h>
+
+static int copy_kind(enum eValueType type, uint8_t *kind, unsigned int *width)
+{
+  switch (type) {
+    case VALUE_TYPE_UNSIGNED1:
+      *kind = PDO_COPY_BITS;
+      *width = 0;
+      break;
+    case VALUE_TYPE_UNSIGNED8:
+      *kind = PDO_COPY_U8;
+      *width = 1;
+      break;
+    case VALUE_TYPE_UNSIGNED16:
+      *kind = PDO_COPY_U16;
+      *width = 2;
+      break;
+    case VALUE_TYPE_UNSIGNED32:
+    case VALUE_TYPE_REAL32:
+      *kind = PDO_COPY_U32;
+      *width = 4;
+      break;
+    case VALUE_TYPE_SIGNED8:
+      *kind = PDO_COPY_S8;
+      *width = 1;
+      break;
+    case VALUE_TYPE_SIGNED16:
+      *kind = PDO_COPY_S16;
+      *width = 2;
+      break;
+    case VALUE_TYPE_SIGNED32:
+      *kind = PDO_COPY_S32;
+      *width = 4;
+      break;
+
+    /* no int representation, only available through the typed access */
+    case VALUE_TYPE_UNSIGNED64:
+    case VALUE_TYPE_SIGNED64:
+    case VALUE_TYPE_REAL64:
+    case VALUE_TYPE_OCTETS:
+    case VALUE_TYPE_PADDING:
+    case VALUE_TYPE_NONE:
+    default:
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Check if the value can be appended to the operation.
+ */
+static int can_merge(const Pdo_Copy_Op_t *op, const pdo_t *value,
+                     uint8_t kind, unsigned int width)
+{
+  if (op->kind != kind || value != op->values + op->count
+      || op->count == UINT16_MAX) {
+    return 0;
+  }
+
+  if (kind == PDO_COPY_BITS) {
+    return value->offset == op->offset
+        && value->bit_offset == (unsigned int) op->bit_offset + op->count
+        && value->bit_offset < 8;
+  }
+
+  return value->offset == op->offset + op->count * width;
+}
+
+static size_t compile_values(Pdo_Copy_Op_t *ops, pdo_t *values, size_t count)
+{
+  size_t op_count = 0;
+  Pdo_Copy_Op_t *op = NULL;
+
+  for (size_t k = 0; k < count; k++) {
+    pdo_t *value = values + k;
+    uint8_t kind;
+    unsigned int width;
+
+    if (copy_kind(value->type, &kind, &width)) {
+      /* padding and unsupported entries are not exchanged */
+      value->value = 0;
+      op = NULL;
+      continue;
+    }
+
+    if (op != NULL && can_merge(op, value, kind, width)) {
+      op->count++;
+      continue;
+    }
+
+    op = ops + op_count++;
+    op->offset = value->offset;
+    op->count = 1;
+    op->kind = kind;
+    op->bit_offset = (kind == PDO_COPY_BITS) ? value->bit_offset : 0;
+    op->values = value;
+  }
+
+  return op_count;
+}
+
+Pdo_Plan_t *pdo_plan_create(Ethercat_Slave_t *slaves, size_t slave_count,
+                            int domain_id, ec_direction_t direction)
+{
+  size_t entries = 0;
+
+  for (size_t i = 0; i < slave_count; i++) {
+    Ethercat_Slave_t *slave = slaves + i;
+    if (domain_id >= 0 && slave->domain_id != domain_id) {
+      continue;
+    }
+    entries += (direction == EC_DIR_INPUT) ?
+        slave->inpdocount : slave->outpdocount;
+  }
+
+  Pdo_Plan_t *plan = calloc(1, sizeof(Pdo_Plan_t));
+  if (plan == NULL) {
+    return NULL;
+  }
+
+  /* worst case: one operation per entry */
+  plan->ops = calloc(entries ? entries : 1, sizeof(Pdo_Copy_Op_t));
+  if (plan->ops == NULL) {
+    free(plan);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < slave_count; i++) {
+    Ethercat_Slave_t *slave = slaves + i;
+
+    if (domain_id >= 0 && slave->domain_id != domain_id) {
+      continue;
+    }
+
+    if (direction == EC_DIR_INPUT) {
+      plan->op_count += compile_values(plan->ops + plan->op_count,
+                                       slave->input_values, slave->inpdocount);
+    } else {
+      plan->op_count += compile_values(plan->ops + plan->op_count,
+                                       slave->output_values,
+                                       slave->outpdocount);
+    }
+  }
+
+  plan->entry_count = entries;
+
+  return plan;
+}
+
+void pdo_plan_free(Pdo_Plan_t *plan)
+{
+  if (plan == NULL) {
+    return;
+  }
+
+  free(plan->ops);
+  free(plan);
+}
+
+void pdo_plan_read(const Pdo_Plan_t *plan, const uint8_t *processdata)
+{
+  const Pdo_Copy_Op_t *op = plan->ops;
+  const Pdo_Copy_Op_t *end = plan->ops + plan->op_count;
+
+  for (; op < end; op++) {
+    const uint8_t *data = processdata + op->offset;
+    pdo_t *value = op->values;
+    unsigned int n;
+
+    switch (op->kind) {
+      case PDO_COPY_BITS: {
+        unsigned int byte = EC_READ_U8(data) >> op->bit_offset;
+        for (n = 0; n < op->count; n++, byte >>= 1) {
+          value[n].value = byte & 0x01;
+        }
+        break;
+      }
+      case PDO_COPY_U8:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_U8(data + n);
+        }
+        break;
+      case PDO_COPY_U16:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_U16(data + 2 * n);
+        }
+        break;
+      case PDO_COPY_U32:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_U32(data + 4 * n);
+        }
+        break;
+      case PDO_COPY_S8:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_S8(data + n);
+        }
+        break;
+      case PDO_COPY_S16:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_S16(data + 2 * n);
+        }
+        break;
+      case PDO_COPY_S32:
+        for (n = 0; n < op->count; n++) {
+          value[n].value = EC_READ_S32(data + 4 * n);
+        }
+        break;
+    }
+  }
+}
+
+void pdo_plan_write(const Pdo_Plan_t *plan, uint8_t *processdata)
+{
+  const Pdo_Copy_Op_t *op = plan->ops;
+  const Pdo_Copy_Op_t *end = plan->ops + plan->op_count;
+
+  for (; op < end; op++) {
+    uint8_t *data = processdata + op->offset;
+    const pdo_t *value = op->values;
+    unsigned int n;
+
+    switch (op->kind) {
+      case PDO_COPY_BITS: {
+        uint8_t mask = (uint8_t) (((1u << op->count) - 1) << op->bit_offset);
+        uint8_t bits = 0;
+        for (n = 0; n < op->count; n++) {
+          if (value[n].value) {
+            bits |= (uint8_t) (1u << (op->bit_offset + n));
+          }
+        }
+        EC_WRITE_U8(data, (EC_READ_U8(data) & ~mask) | bits);
+        break;
+      }
+      case PDO_COPY_U8:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_U8(data + n, value[n].value);
+        }
+        break;
+      case PDO_COPY_U16:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_U16(data + 2 * n, value[n].value);
+        }
+        break;
+      case PDO_COPY_U32:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_U32(data + 4 * n, value[n].value);
+        }
+        break;
+      case PDO_COPY_S8:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_S8(data + n, value[n].value);
+        }
+        break;
+      case PDO_COPY_S16:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_S16(data + 2 * n, value[n].value);
+        }
+        break;
+      case PDO_COPY_S32:
+        for (n = 0; n < op->count; n++) {
+          EC_WRITE_S32(data + 4 * n, value[n].value);
+        }
+        break;
+    }
+  }
+}
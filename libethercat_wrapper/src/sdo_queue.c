@@ -0,0 +1,186 @@
+/*
+ * sdo_queue.c
+ *
+ * Asynchronous SDO operations. The queue only holds the operations, the
+ * transfers run on the SDO request pool of the slaves (see slave.c), so the
+ * number of concurrent transfers per slave is limited by the pool size.
+ *
+ * Synapticon GmbH
+ */
+
+#include "sdo_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Sdo_Queue_t *sdo_queue_create(void)
+{
+  return calloc(1, sizeof(Sdo_Queue_t));
+}
+
+void sdo_queue_free(Sdo_Queue_t *queue)
+{
+  free(queue);
+}
+
+void sdo_queue_clear(Sdo_Queue_t *queue)
+{
+  memset(queue->state, SDO_OP_FREE, sizeof(queue->state));
+  queue->head = 0;
+  queue->count = 0;
+  queue->pending = 0;
+}
+
+static int is_numeric(const Sdo_t *sdo)
+{
+  switch (sdo->entry_type) {
+    case ENTRY_TYPE_BOOLEAN:
+    case ENTRY_TYPE_INTEGER8:
+    case ENTRY_TYPE_INTEGER16:
+    case ENTRY_TYPE_INTEGER32:
+    case ENTRY_TYPE_UNSIGNED8:
+    case ENTRY_TYPE_UNSIGNED16:
+    case ENTRY_TYPE_UNSIGNED32:
+    case ENTRY_TYPE_REAL32:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+int ecw_master_sdo_submit(Ethercat_Master_t *master,
+                          const Ethercat_Sdo_Op_t *op)
+{
+  Sdo_Queue_t *queue = master->sdo_queue;
+
+  if (queue->count == ECW_SDO_QUEUE_SIZE) {
+    return ECW_ERROR_SDO_QUEUE_FULL;
+  }
+
+  if (op->slave < 0 || (size_t) op->slave >= master->slave_count) {
+    return ECW_ERROR_SDO_NOT_FOUND;
+  }
+
+  Sdo_t *sdo = sdo_find(master->slaves + op->slave, op->index, op->subindex);
+  if (sdo == NULL) {
+    return ECW_ERROR_SDO_NOT_FOUND;
+  }
+
+  if (!is_numeric(sdo)) {
+    return ECW_ERROR_SDO_UNSUPORTED_ENTRY_TYPE;
+  }
+
+  size_t n = (queue->head + queue->count) % ECW_SDO_QUEUE_SIZE;
+  queue->op[n] = *op;
+  queue->op[n].result = ECW_ERROR_SDO_REQUEST_BUSY;
+  queue->sdo[n] = sdo;
+  queue->state[n] = SDO_OP_QUEUED;
+  queue->count++;
+  queue->pending++;
+
+  return ECW_SUCCESS;
+}
+
+void ecw_master_sdo_set_callback(Ethercat_Master_t *master,
+                                 ecw_sdo_callback_t callback, void *arg)
+{
+  master->sdo_queue->callback = callback;
+  master->sdo_queue->callback_arg = arg;
+}
+
+static void complete(Sdo_Queue_t *queue, size_t n, int result)
+{
+  Ethercat_Sdo_Op_t *op = queue->op + n;
+
+  op->result = result;
+  if (!op->write && result == ECW_SUCCESS) {
+    op->value = queue->sdo[n]->value;
+  }
+
+  queue->state[n] = SDO_OP_DONE;
+}
+
+size_t ecw_master_sdo_process(Ethercat_Master_t *master,
+                              Ethercat_Sdo_Op_t *completed,
+                              size_t max_completed)
+{
+  Sdo_Queue_t *queue = master->sdo_queue;
+  Link_State_t *link = master->link_state;
+  size_t completed_count = 0;
+
+  if (queue->pending == 0) {
+    return 0;
+  }
+
+  if (!link->valid) {
+    ecrt_master_state(master->master, &(link->state));
+    /* like link_state_get(), the slaves enter and leave the cyclic mode
+     * together and an operation is only queued with at least one slave */
+    link->valid = master->slaves->cyclic_mode;
+  }
+
+  for (size_t i = 0; i < queue->count; i++) {
+    size_t n = (queue->head + i) % ECW_SDO_QUEUE_SIZE;
+    Ethercat_Sdo_Op_t *op = queue->op + n;
+    Ethercat_Slave_t *slave = master->slaves + op->slave;
+    int ret;
+
+    switch (queue->state[n]) {
+      case SDO_OP_QUEUED:
+        if (link->state.link_up != 1) {
+          complete(queue, n, ECW_ERROR_LINK_UP);
+          break;
+        }
+
+        if (op->write) {
+          queue->sdo[n]->value = op->value;
+        }
+
+        ret = sdo_request_submit(slave, queue->sdo[n], op->write);
+        if (ret == ECW_SUCCESS) {
+          queue->state[n] = SDO_OP_ACTIVE;
+        } else if (ret != ECW_ERROR_SDO_REQUEST_BUSY) {
+          complete(queue, n, ret);
+        }
+        break;
+
+      case SDO_OP_ACTIVE:
+        ret = sdo_request_complete(slave, queue->sdo[n]);
+        if (ret != ECW_ERROR_SDO_REQUEST_BUSY) {
+          complete(queue, n, ret);
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    if (queue->state[n] != SDO_OP_DONE) {
+      continue;
+    }
+
+    if (queue->callback != NULL) {
+      queue->callback(op, queue->callback_arg);
+    } else if (completed != NULL && completed_count < max_completed) {
+      completed[completed_count++] = *op;
+    } else {
+      /* returned by the next call */
+      continue;
+    }
+
+    queue->state[n] = SDO_OP_FREE;
+    queue->pending--;
+  }
+
+  while (queue->count > 0 && queue->state[queue->head] == SDO_OP_FREE) {
+    queue->head = (queue->head + 1) % ECW_SDO_QUEUE_SIZE;
+    queue->count--;
+  }
+
+  return completed_count;
+}
+
+size_t ecw_master_sdo_pending(Ethercat_Master_t *master)
+{
+  return master->sdo_queue->pending;
+}
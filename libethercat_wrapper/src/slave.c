@@ -9,9 +9,12 @@
 #include "slave.h"
 #include "ethercat_wrapper_slave.h"
 #include "ethercat_wrapper.h"
+#include "od_cache.h"
 
 #include <string.h>
 #include <errno.h>
+#include <syslog.h>
+#include <time.h>
 
 /* list of supported ETherCAT slaves */
 static const Device_type_map_t type_map[] = { { 0x22d2, 0x201, 0x0a000002,
@@ -22,6 +25,171 @@ static const Device_type_map_t type_map[] = { { 0x22d2, 0x201, 0x0a000002,
  * The direct up-/download of SDOs is only possible in non cyclic mode!
  */
 
+/*
+ * Size of the object in bytes as it is used for the SDO request.
+ */
+static size_t sdo_data_size(const Sdo_t *sdo)
+{
+  return (sdo->bit_length >= 8) ? (size_t) (sdo->bit_length / 8) : 1;
+}
+
+/*
+ * SDO request pool
+ *
+ * Instead of one SDO request per object every slave gets a small pool of
+ * requests at ecw_master_start(). A request is bound to an object when the
+ * object is accessed in cyclic mode and retargeted with
+ * ecrt_sdo_request_index() when an other object needs it. A read result which
+ * is not collected within SDO_REQUEST_COLLECT_TIMEOUT no longer protects the
+ * request, the object then starts a new read on its next access.
+ */
+
+static uint64_t monotonic_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
+
+int sdo_request_pool_create(Ethercat_Slave_t *s)
+{
+  sdo_request_pool_release(s);
+
+  /* the dictionary may not be loaded yet, so ask the slave information */
+  if (s->info->sdo_count == 0) {
+    return 0;
+  }
+
+  for (int i = 0; i < ECW_SDO_REQUEST_POOL_SIZE; i++) {
+    /* the request memory has to hold the largest object, the real target
+     * is set before the first use (0x1000 is present on every CoE slave) */
+    ec_sdo_request_t *request = ecrt_slave_config_create_sdo_request(
+        s->config, 0x1000, 0, ECW_MAX_VISIBLE_STRING_LENGTH);
+
+    if (request == NULL) {
+      return -1;
+    }
+
+    ecrt_sdo_request_timeout(request, SDO_REQUEST_TIMEOUT);
+    s->sdo_request_pool[i] = request;
+  }
+
+  return 0;
+}
+
+void sdo_request_pool_release(Ethercat_Slave_t *s)
+{
+  /* the requests itself are freed with the bus configuration */
+  for (int i = 0; i < ECW_SDO_REQUEST_POOL_SIZE; i++) {
+    s->sdo_request_pool[i] = NULL;
+    s->sdo_request_owner[i] = NULL;
+    s->sdo_request_locked[i] = 0;
+    s->sdo_request_used[i] = 0;
+  }
+  s->sdo_request_next = 0;
+
+  for (size_t i = 0; i < s->sdo_count; i++) {
+    Sdo_t *sdo = s->dictionary + i;
+    sdo->request = NULL;
+    sdo->read_request = 0;
+  }
+}
+
+/*
+ * A request can be taken from its current object if it is not held by a
+ * queued operation, no transfer is running and no read result is pending or
+ * the result was not collected in time.
+ */
+static int sdo_request_is_idle(Ethercat_Slave_t *s, int slot)
+{
+  Sdo_t *owner = s->sdo_request_owner[slot];
+
+  if (owner == NULL) {
+    return 1;
+  }
+
+  if (s->sdo_request_locked[slot]
+      || ecrt_sdo_request_state(s->sdo_request_pool[slot]) == EC_REQUEST_BUSY) {
+    return 0;
+  }
+
+  if (owner->read_request) {
+    return monotonic_ms() - s->sdo_request_used[slot]
+        >= SDO_REQUEST_COLLECT_TIMEOUT;
+  }
+
+  return 1;
+}
+
+/*
+ * Slot of the request bound to the object or -1.
+ */
+static int sdo_request_slot(Ethercat_Slave_t *s, Sdo_t *sdo)
+{
+  for (int i = 0; i < ECW_SDO_REQUEST_POOL_SIZE; i++) {
+    if (s->sdo_request_owner[i] == sdo && s->sdo_request_pool[i] != NULL
+        && s->sdo_request_pool[i] == sdo->request) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * Bind a request of the pool to the object.
+ *
+ * `retargeted` is set if the request was newly bound to the object, its state
+ * then still belongs to the previous object. Returns
+ * ECW_ERROR_SDO_REQUEST_BUSY if all requests are in use.
+ */
+static int sdo_request_acquire(Ethercat_Slave_t *s, Sdo_t *sdo,
+                               int *retargeted)
+{
+  *retargeted = 0;
+
+  int current = sdo_request_slot(s, sdo);
+  if (current >= 0) {
+    s->sdo_request_used[current] = monotonic_ms();
+    return ECW_SUCCESS;
+  }
+
+  if (s->sdo_request_pool[0] == NULL) {
+    sdo->request = NULL;
+    return ECW_ERROR_SDO_REQUEST_ERROR;
+  }
+
+  for (int n = 0; n < ECW_SDO_REQUEST_POOL_SIZE; n++) {
+    int slot = (s->sdo_request_next + n) % ECW_SDO_REQUEST_POOL_SIZE;
+
+    if (!sdo_request_is_idle(s, slot)) {
+      continue;
+    }
+
+    if (s->sdo_request_owner[slot] != NULL) {
+      /* an uncollected result is dropped, the owner reads again */
+      s->sdo_request_owner[slot]->request = NULL;
+      s->sdo_request_owner[slot]->read_request = 0;
+    }
+
+    ecrt_sdo_request_index(s->sdo_request_pool[slot], sdo->index,
+                           sdo->subindex);
+    s->sdo_request_owner[slot] = sdo;
+    s->sdo_request_used[slot] = monotonic_ms();
+    s->sdo_request_next = (slot + 1) % ECW_SDO_REQUEST_POOL_SIZE;
+
+    sdo->request = s->sdo_request_pool[slot];
+    sdo->read_request = 0;
+    *retargeted = 1;
+
+    return ECW_SUCCESS;
+  }
+
+  return ECW_ERROR_SDO_REQUEST_BUSY;
+}
+
 int sdo_read_value(Sdo_t *sdo)
 {
   switch (sdo->entry_type) {
@@ -106,7 +274,7 @@ static int sdo_write_value(Sdo_t *sdo)
       break;
     case ENTRY_TYPE_VISIBLE_STRING:
       memmove(ecrt_sdo_request_data(sdo->request), sdo->value_string,
-              ecrt_sdo_request_data_size(sdo->request));
+              sdo_data_size(sdo));
       break;
     case ENTRY_TYPE_OCTET_STRING:
     case ENTRY_TYPE_UNICODE_STRING:
@@ -124,13 +292,32 @@ static int sdo_write_value(Sdo_t *sdo)
 
 static int slave_sdo_upload_request(Ethercat_Slave_t *s, Sdo_t *sdo)
 {
+  int retargeted;
+  int ret = sdo_request_acquire(s, sdo, &retargeted);
+  if (ret != ECW_SUCCESS) {
+    return ret;
+  }
+
+  /* a queued operation on the same object is running */
+  if (s->sdo_request_locked[sdo_request_slot(s, sdo)]) {
+    return ECW_ERROR_SDO_REQUEST_BUSY;
+  }
+
   // Check if the request is a valid pointer
   if (!sdo->request) {
     sdo->read_request = 0;
     return ECW_ERROR_SDO_REQUEST_ERROR;
   }
 
-  int ret = ECW_ERROR_UNKNOWN;
+  if (retargeted) {
+    /* freshly retargeted, start with a new request */
+    ecrt_sdo_request_read(sdo->request);
+    sdo->request_state = EC_REQUEST_BUSY;
+    sdo->read_request = 1;
+    return ECW_ERROR_SDO_REQUEST_BUSY;
+  }
+
+  ret = ECW_ERROR_UNKNOWN;
 
   sdo->request_state = ecrt_sdo_request_state(sdo->request);
   switch (sdo->request_state) {
@@ -172,14 +359,31 @@ static int slave_sdo_upload_request(Ethercat_Slave_t *s, Sdo_t *sdo)
 
 static int slave_sdo_download_request(Ethercat_Slave_t *s, Sdo_t *sdo)
 {
+  int retargeted;
+  int ret = sdo_request_acquire(s, sdo, &retargeted);
+  if (ret != ECW_SUCCESS) {
+    return ret;
+  }
+
+  /* a queued operation on the same object is running */
+  if (s->sdo_request_locked[sdo_request_slot(s, sdo)]) {
+    return ECW_ERROR_SDO_REQUEST_BUSY;
+  }
+
   // Check if the request is a valid pointer
   if (!sdo->request) {
     return ECW_ERROR_SDO_REQUEST_ERROR;
   }
 
-  int ret = ECW_ERROR_UNKNOWN;
+  if (retargeted) {
+    /* freshly retargeted, the state belongs to the previous object */
+    sdo->request_state = EC_REQUEST_UNUSED;
+  } else {
+    sdo->request_state = ecrt_sdo_request_state(sdo->request);
+  }
+
+  ret = ECW_ERROR_UNKNOWN;
 
-  sdo->request_state = ecrt_sdo_request_state(sdo->request);
   switch (sdo->request_state) {
     case EC_REQUEST_UNUSED:
       // here I can schedule
@@ -187,7 +391,9 @@ static int slave_sdo_download_request(Ethercat_Slave_t *s, Sdo_t *sdo)
       if (ret != 0) {
         return ret;
       }
-      ecrt_sdo_request_write(sdo->request);
+      if (ecrt_sdo_request_write_with_size(sdo->request, sdo_data_size(sdo))) {
+        return ECW_ERROR_SDO_REQUEST_ERROR;
+      }
       ret = ECW_ERROR_SDO_REQUEST_BUSY;
       break;
     case EC_REQUEST_BUSY:
@@ -200,7 +406,9 @@ static int slave_sdo_download_request(Ethercat_Slave_t *s, Sdo_t *sdo)
       if (ret != 0) {
         return ret;
       }
-      ecrt_sdo_request_write(sdo->request);
+      if (ecrt_sdo_request_write_with_size(sdo->request, sdo_data_size(sdo))) {
+        return ECW_ERROR_SDO_REQUEST_ERROR;
+      }
       ret = ECW_SUCCESS;
       break;
     case EC_REQUEST_ERROR:
@@ -212,6 +420,73 @@ static int slave_sdo_download_request(Ethercat_Slave_t *s, Sdo_t *sdo)
   return ret;
 }
 
+int sdo_request_submit(Ethercat_Slave_t *s, Sdo_t *sdo, int write)
+{
+  int retargeted;
+  int ret = sdo_request_acquire(s, sdo, &retargeted);
+  if (ret != ECW_SUCCESS) {
+    return ret;
+  }
+
+  int slot = sdo_request_slot(s, sdo);
+  if (slot < 0) {
+    return ECW_ERROR_SDO_REQUEST_ERROR;
+  }
+
+  /* the object already had the request, it may still be in use */
+  if (!retargeted && !sdo_request_is_idle(s, slot)) {
+    return ECW_ERROR_SDO_REQUEST_BUSY;
+  }
+
+  if (write) {
+    ret = sdo_write_value(sdo);
+    if (ret != 0) {
+      return ret;
+    }
+    if (ecrt_sdo_request_write_with_size(sdo->request, sdo_data_size(sdo))) {
+      return ECW_ERROR_SDO_REQUEST_ERROR;
+    }
+    sdo->read_request = 0;
+  } else {
+    ecrt_sdo_request_read(sdo->request);
+    sdo->read_request = 1;
+  }
+
+  sdo->request_state = EC_REQUEST_BUSY;
+  s->sdo_request_locked[slot] = 1;
+
+  return ECW_SUCCESS;
+}
+
+int sdo_request_complete(Ethercat_Slave_t *s, Sdo_t *sdo)
+{
+  int slot = sdo_request_slot(s, sdo);
+  if (slot < 0 || !s->sdo_request_locked[slot]) {
+    return ECW_ERROR_SDO_REQUEST_ERROR;
+  }
+
+  int ret;
+
+  sdo->request_state = ecrt_sdo_request_state(sdo->request);
+  switch (sdo->request_state) {
+    case EC_REQUEST_UNUSED:
+    case EC_REQUEST_BUSY:
+      return ECW_ERROR_SDO_REQUEST_BUSY;
+    case EC_REQUEST_SUCCESS:
+      ret = sdo->read_request ? sdo_read_value(sdo) : ECW_SUCCESS;
+      break;
+    case EC_REQUEST_ERROR:
+    default:
+      ret = ECW_ERROR_SDO_REQUEST_ERROR;
+      break;
+  }
+
+  s->sdo_request_locked[slot] = 0;
+  sdo->read_request = 0;
+
+  return ret;
+}
+
 static int slave_sdo_upload_direct(Ethercat_Slave_t *s, Sdo_t *sdo)
 {
   size_t result_size = 0;
@@ -332,10 +607,32 @@ static int slave_sdo_download_direct(Ethercat_Slave_t *s, Sdo_t *sdo)
  * module. So in cyclic operation the schedule SDO request must be
  * used to be safe.
  */
+
+/*
+ * In cyclic mode the master state is only read once per cycle and shared by
+ * all slaves, otherwise it is read on every call.
+ */
+static void link_state_get(Ethercat_Slave_t *s, ec_master_state_t *state)
+{
+  Link_State_t *link = s->link_state;
+
+  if (link == NULL) {
+    ecrt_master_state(s->master, state);
+    return;
+  }
+
+  if (!link->valid) {
+    ecrt_master_state(s->master, &(link->state));
+    link->valid = s->cyclic_mode;
+  }
+
+  *state = link->state;
+}
+
 int slave_sdo_upload(Ethercat_Slave_t *s, Sdo_t *sdo)
 {
   ec_master_state_t link_state;
-  ecrt_master_state(s->master, &link_state);
+  link_state_get(s, &link_state);
   if (link_state.link_up != 1) {
     return ECW_ERROR_LINK_UP;
   }
@@ -350,7 +647,7 @@ int slave_sdo_upload(Ethercat_Slave_t *s, Sdo_t *sdo)
 int slave_sdo_download(Ethercat_Slave_t *s, Sdo_t *sdo)
 {
   ec_master_state_t link_state;
-  ecrt_master_state(s->master, &link_state);
+  link_state_get(s, &link_state);
   if (link_state.link_up != 1) {
     return ECW_ERROR_LINK_UP;
   }
@@ -425,6 +722,172 @@ int ecw_slave_get_in_value(Ethercat_Slave_t *s, size_t pdoindex)
   return pdo->value;
 }
 
+/*
+ * Typed PDO access
+ *
+ * Direct access to the domain memory, the type is not checked. The accessors
+ * only check that the process data is available, the pointers of
+ * ecw_slave_get_in_data() and ecw_slave_get_out_data() stay valid during the
+ * cyclic mode and give unchecked access for a fixed mapping.
+ */
+
+enum eValueType ecw_slave_get_in_pdo_type(Ethercat_Slave_t *s, size_t pdoindex,
+                                          enum eEntryType *entry_type)
+{
+  pdo_t *pdo = ecw_slave_get_inpdo(s, pdoindex);
+
+  if (entry_type != NULL) {
+    *entry_type = pdo->entry_type;
+  }
+
+  return pdo->type;
+}
+
+enum eValueType ecw_slave_get_out_pdo_type(Ethercat_Slave_t *s,
+                                           size_t pdoindex,
+                                           enum eEntryType *entry_type)
+{
+  pdo_t *pdo = ecw_slave_get_outpdo(s, pdoindex);
+
+  if (entry_type != NULL) {
+    *entry_type = pdo->entry_type;
+  }
+
+  return pdo->type;
+}
+
+const uint8_t *ecw_slave_get_in_data(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  if (s->processdata == NULL) {
+    return NULL;
+  }
+
+  return s->processdata + (s->input_values + pdoindex)->offset;
+}
+
+uint8_t *ecw_slave_get_out_data(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  if (s->processdata == NULL) {
+    return NULL;
+  }
+
+  return s->processdata + (s->output_values + pdoindex)->offset;
+}
+
+uint64_t ecw_slave_get_in_u64(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  const uint8_t *data = ecw_slave_get_in_data(s, pdoindex);
+
+  return (data != NULL) ? EC_READ_U64(data) : 0;
+}
+
+int64_t ecw_slave_get_in_s64(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  const uint8_t *data = ecw_slave_get_in_data(s, pdoindex);
+
+  return (data != NULL) ? EC_READ_S64(data) : 0;
+}
+
+float ecw_slave_get_in_real32(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  const uint8_t *data = ecw_slave_get_in_data(s, pdoindex);
+  uint32_t raw = (data != NULL) ? EC_READ_U32(data) : 0;
+  float value;
+
+  memcpy(&value, &raw, sizeof(value));
+  return value;
+}
+
+double ecw_slave_get_in_real64(Ethercat_Slave_t *s, size_t pdoindex)
+{
+  const uint8_t *data = ecw_slave_get_in_data(s, pdoindex);
+  uint64_t raw = (data != NULL) ? EC_READ_U64(data) : 0;
+  double value;
+
+  memcpy(&value, &raw, sizeof(value));
+  return value;
+}
+
+void ecw_slave_set_out_u64(Ethercat_Slave_t *s, size_t pdoindex,
+                           uint64_t value)
+{
+  uint8_t *data = ecw_slave_get_out_data(s, pdoindex);
+
+  if (data != NULL) {
+    EC_WRITE_U64(data, value);
+  }
+}
+
+void ecw_slave_set_out_s64(Ethercat_Slave_t *s, size_t pdoindex,
+                           int64_t value)
+{
+  uint8_t *data = ecw_slave_get_out_data(s, pdoindex);
+
+  if (data != NULL) {
+    EC_WRITE_S64(data, value);
+  }
+}
+
+void ecw_slave_set_out_real32(Ethercat_Slave_t *s, size_t pdoindex,
+                              float value)
+{
+  pdo_t *pdo = s->output_values + pdoindex;
+  uint8_t *data = ecw_slave_get_out_data(s, pdoindex);
+  uint32_t raw;
+
+  memcpy(&raw, &value, sizeof(raw));
+
+  /* REAL32 entries are also written from the int value by the copy plan */
+  pdo->value = (int) raw;
+
+  if (data != NULL) {
+    EC_WRITE_U32(data, raw);
+  }
+}
+
+void ecw_slave_set_out_real64(Ethercat_Slave_t *s, size_t pdoindex,
+                              double value)
+{
+  uint8_t *data = ecw_slave_get_out_data(s, pdoindex);
+  uint64_t raw;
+
+  memcpy(&raw, &value, sizeof(raw));
+
+  if (data != NULL) {
+    EC_WRITE_U64(data, raw);
+  }
+}
+
+int ecw_slave_get_in_array(Ethercat_Slave_t *s, size_t pdoindex, uint8_t *data,
+                           size_t size)
+{
+  pdo_t *pdo = s->input_values + pdoindex;
+  size_t length = pdo->bit_length / 8;
+
+  if (s->processdata == NULL) {
+    return -1;
+  }
+
+  memcpy(data, s->processdata + pdo->offset, (size < length) ? size : length);
+
+  return (int) length;
+}
+
+int ecw_slave_set_out_array(Ethercat_Slave_t *s, size_t pdoindex,
+                            const uint8_t *data, size_t size)
+{
+  pdo_t *pdo = s->output_values + pdoindex;
+  size_t length = pdo->bit_length / 8;
+
+  if (s->processdata == NULL) {
+    return -1;
+  }
+
+  memcpy(s->processdata + pdo->offset, data, (size < length) ? size : length);
+
+  return (int) length;
+}
+
 int ecw_slave_set_inpdo(Ethercat_Slave_t *s, size_t pdoindex, pdo_t *pdo)
 {
   if (pdo->value != (s->input_values + pdoindex)->value
@@ -461,18 +924,231 @@ pdo_t *ecw_slave_get_outpdo(Ethercat_Slave_t *s, size_t pdoindex)
  * SDO handling
  */
 
-size_t ecw_slave_get_sdo_count(Ethercat_Slave_t *s)
+/*
+ * Object dictionary
+ */
+
+/*
+ * Upload the object descriptions from the master, each object is expanded to
+ * all of its subindexes.
+ */
+static int dictionary_upload(Ethercat_Slave_t *s, Sdo_t **dictionary,
+                             size_t *count)
 {
-  return (size_t) s->sdo_count;
+  /* count the real number of object entries (including subindexes) */
+  size_t object_count = s->info->sdo_count;
+  for (int i = 0; i < s->info->sdo_count; i++) {
+    ec_sdo_info_t sdoi;
+    if (ecrt_sdo_info_get(s->master, s->info->position, i, &sdoi)) {
+      syslog(
+          LOG_ERR,
+          "Error, unable to retrieve information of object dictionary info %d",
+          i);
+      return -1;
+    }
+
+    object_count += sdoi.maxindex;
+  }
+
+  if (s->info->sdo_count && s->info->sdo_count == object_count) {
+    syslog(LOG_WARNING, "All Slave %d SDOs have no index", s->info->position);
+  }
+
+  Sdo_t *od = calloc(object_count ? object_count : 1, sizeof(Sdo_t));
+  if (od == NULL) {
+    return -1;
+  }
+
+  for (int i = 0, current_sdo = 0; i < s->info->sdo_count; i++) {
+    ec_sdo_info_t sdoi;
+
+    if (ecrt_sdo_info_get(s->master, s->info->position, i, &sdoi)) {
+      syslog(
+          LOG_WARNING,
+          "Warning, unable to retrieve information of object dictionary entry %d",
+          i);
+      continue;
+    }
+
+    for (int j = 0; j < (sdoi.maxindex + 1); j++) {
+      Sdo_t *sdo = od + current_sdo++;
+      ec_sdo_info_entry_t entry;
+
+      if (ecrt_sdo_get_info_entry(s->master, s->info->position, sdoi.index, j,
+                                  &entry)) {
+        syslog(LOG_WARNING,
+               "Warning, cannot read SDO entry index: 0x%04x subindex: %d",
+               sdoi.index, j);
+        continue;
+      }
+
+      sdo->index = sdoi.index;
+      sdo->subindex = j;
+      sdo->entry_type = entry.data_type;
+      sdo->object_type = sdoi.object_code;
+
+      // FIXME: For some reason the bit length of the VISIBLE_STRING gets set to
+      // 144 which is not correct. This causes the SDO requests to have the
+      // wrong size and fail for strings. The root cause why this is happening
+      // must be found and then this workaround should be removed.
+      if (entry.data_type == ENTRY_TYPE_VISIBLE_STRING) {
+        sdo->bit_length = ECW_MAX_VISIBLE_STRING_LENGTH;
+      } else {
+        sdo->bit_length = entry.bit_length;
+      }
+
+      memmove(sdo->name, entry.description, EC_MAX_STRING_LENGTH);
+      memmove(sdo->object_name, sdoi.name, EC_MAX_STRING_LENGTH);
+      memmove(sdo->read_access, entry.read_access, EC_SDO_ENTRY_ACCESS_COUNTER);
+      memmove(sdo->write_access, entry.write_access,
+      EC_SDO_ENTRY_ACCESS_COUNTER);
+
+      /* SDO requests are taken from the request pool created at
+       * master_start(), they are only needed when master and slave are in
+       * real time context. */
+      sdo->request = NULL;
+      sdo->read_request = 0;
+    }
+  }
+
+  *dictionary = od;
+  *count = object_count;
+
+  return 0;
 }
 
-Sdo_t *ecw_slave_get_sdo(Ethercat_Slave_t *s, int index, int subindex)
+int slave_dictionary_load(Ethercat_Slave_t *s)
+{
+  Sdo_t *dictionary = NULL;
+  size_t count = 0;
+
+  if (s->dictionary_loaded) {
+    return 0;
+  }
+
+  int cached = s->dictionary_cache != NULL && s->info->sdo_count > 0;
+
+  if (!cached
+      || od_cache_load(s->dictionary_cache, s->info, &dictionary, &count)) {
+    if (dictionary_upload(s, &dictionary, &count)) {
+      return -1;
+    }
+
+    /* a failing cache only costs the next start-up time */
+    if (cached
+        && od_cache_store(s->dictionary_cache, s->info, dictionary, count)) {
+      syslog(LOG_WARNING, "Warning, cannot store the dictionary of slave %d "
+             "in the cache", s->info->position);
+    }
+  }
+
+  free(s->dictionary);
+  s->dictionary = dictionary;
+  s->sdo_count = count;
+
+  if (sdo_table_build(s)) {
+    return -1;
+  }
+
+  s->dictionary_loaded = 1;
+
+  /* the PDO entries were typed by their bit length only in the lazy mode,
+   * in cyclic mode the copy plans depend on the types and the next
+   * ecw_master_start() takes care of them */
+  if (!s->cyclic_mode) {
+    slave_pdo_types_resolve(s);
+  }
+
+  return 0;
+}
+
+int ecw_slave_load_dictionary(Ethercat_Slave_t *s)
+{
+  return slave_dictionary_load(s);
+}
+
+/*
+ * Object dictionary hash table
+ *
+ * Open addressing with linear probing, the key is (index << 8 | subindex).
+ * The table is at least twice as large as the dictionary, so the probe
+ * sequences stay short.
+ */
+
+static uint32_t sdo_table_key(int index, int subindex)
+{
+  return ((uint32_t) (index & 0xffff) << 8) | (uint32_t) (subindex & 0xff);
+}
+
+static size_t sdo_table_hash(const Ethercat_Slave_t *s, uint32_t key)
+{
+  /* multiplicative hashing, take the upper bits of the product */
+  return (size_t) ((key * 2654435761u) >> (32 - s->sdo_table_bits));
+}
+
+int sdo_table_build(Ethercat_Slave_t *s)
+{
+  unsigned int bits = 1;
+
+  sdo_table_free(s);
+
+  while (((size_t) 1 << bits) < 2 * s->sdo_count) {
+    bits++;
+  }
+
+  size_t size = (size_t) 1 << bits;
+  s->sdo_table = calloc(size, sizeof(uint32_t));
+  if (s->sdo_table == NULL) {
+    return -1;
+  }
+  s->sdo_table_bits = bits;
+
+  for (size_t i = 0; i < s->sdo_count; i++) {
+    Sdo_t *sdo = s->dictionary + i;
+
+    if (sdo->index == 0) { /* entry could not be read */
+      continue;
+    }
+
+    uint32_t key = sdo_table_key(sdo->index, sdo->subindex);
+    size_t slot = sdo_table_hash(s, key);
+
+    while (s->sdo_table[slot] != 0) {
+      Sdo_t *other = s->dictionary + s->sdo_table[slot] - 1;
+      if (sdo_table_key(other->index, other->subindex) == key) {
+        break; /* keep the first occurrence like the linear search did */
+      }
+      slot = (slot + 1) & (size - 1);
+    }
+
+    if (s->sdo_table[slot] == 0) {
+      s->sdo_table[slot] = (uint32_t) (i + 1);
+    }
+  }
+
+  return 0;
+}
+
+void sdo_table_free(Ethercat_Slave_t *s)
+{
+  free(s->sdo_table);
+  s->sdo_table = NULL;
+  s->sdo_table_bits = 0;
+}
+
+Sdo_t *sdo_find_loaded(Ethercat_Slave_t *s, int index, int subindex)
 {
-  for (int i = 0; i < s->sdo_count; i++) {
-    Sdo_t *current = s->dictionary + i;
-    if (current->index == index && current->subindex == subindex) {
-      Sdo_t *sdo = malloc(sizeof(Sdo_t));
-      memmove(sdo, current, sizeof(Sdo_t));
+  if (s->sdo_table == NULL) {
+    return NULL;
+  }
+
+  uint32_t key = sdo_table_key(index, subindex);
+  size_t mask = ((size_t) 1 << s->sdo_table_bits) - 1;
+
+  for (size_t slot = sdo_table_hash(s, key); s->sdo_table[slot] != 0;
+      slot = (slot + 1) & mask) {
+    Sdo_t *sdo = s->dictionary + s->sdo_table[slot] - 1;
+    if (sdo->index == index && sdo->subindex == subindex) {
       return sdo;
     }
   }
@@ -480,9 +1156,47 @@ Sdo_t *ecw_slave_get_sdo(Ethercat_Slave_t *s, int index, int subindex)
   return NULL;
 }
 
+static Sdo_t *sdo_lookup(Ethercat_Slave_t *s, int index, int subindex)
+{
+  if (slave_dictionary_load(s)) {
+    return NULL;
+  }
+
+  return sdo_find_loaded(s, index, subindex);
+}
+
+Sdo_t *sdo_find(Ethercat_Slave_t *s, int index, int subindex)
+{
+  return sdo_lookup(s, index, subindex);
+}
+
+size_t ecw_slave_get_sdo_count(Ethercat_Slave_t *s)
+{
+  if (slave_dictionary_load(s)) {
+    return 0;
+  }
+
+  return (size_t) s->sdo_count;
+}
+
+Sdo_t *ecw_slave_get_sdo(Ethercat_Slave_t *s, int index, int subindex)
+{
+  Sdo_t *current = sdo_lookup(s, index, subindex);
+  if (current == NULL) {
+    return NULL;
+  }
+
+  Sdo_t *sdo = malloc(sizeof(Sdo_t));
+  if (sdo != NULL) {
+    memmove(sdo, current, sizeof(Sdo_t));
+  }
+
+  return sdo;
+}
+
 Sdo_t *ecw_slave_get_sdo_index(Ethercat_Slave_t *s, size_t sdoindex)
 {
-  if (sdoindex >= s->sdo_count) {
+  if (slave_dictionary_load(s) || sdoindex >= s->sdo_count) {
     return NULL;
   }
 
@@ -493,52 +1207,52 @@ Sdo_t *ecw_slave_get_sdo_index(Ethercat_Slave_t *s, size_t sdoindex)
   return sdo;
 }
 
+const Sdo_t *ecw_slave_find_sdo(Ethercat_Slave_t *s, int index, int subindex)
+{
+  return sdo_lookup(s, index, subindex);
+}
+
+int ecw_slave_copy_sdo(Ethercat_Slave_t *s, int index, int subindex,
+                       Sdo_t *sdo)
+{
+  const Sdo_t *current = sdo_lookup(s, index, subindex);
+  if (current == NULL) {
+    return ECW_ERROR_SDO_NOT_FOUND;
+  }
+
+  memmove(sdo, current, sizeof(Sdo_t));
+
+  return ECW_SUCCESS;
+}
+
 int ecw_slave_set_sdo_int_value(Ethercat_Slave_t *s, int index, int subindex,
                                 uint64_t value)
 {
-  Sdo_t *current = NULL;
-
-  for (int i = 0; i < s->sdo_count; i++) {
-    current = s->dictionary + i;
-    if (current->index == index && current->subindex == subindex) {
-      current->value = value;
-      int err = slave_sdo_download(s, current);
-      return err;
-    }
+  Sdo_t *current = sdo_lookup(s, index, subindex);
+  if (current == NULL) {
+    return ECW_ERROR_SDO_NOT_FOUND; /* not found */
   }
 
-  return ECW_ERROR_SDO_NOT_FOUND; /* not found */
+  current->value = value;
+  return slave_sdo_download(s, current);
 }
 
 int ecw_slave_set_sdo_string_value(Ethercat_Slave_t *s, int index, int subindex,
                                    const char *value)
 {
-  Sdo_t *current = NULL;
-
-  for (int i = 0; i < s->sdo_count; i++) {
-    current = s->dictionary + i;
-    if (current->index == index && current->subindex == subindex) {
-      memmove(current->value_string, value, ECW_MAX_VISIBLE_STRING_LENGTH);
-      int err = slave_sdo_download(s, current);
-      return err;
-    }
+  Sdo_t *current = sdo_lookup(s, index, subindex);
+  if (current == NULL) {
+    return ECW_ERROR_SDO_NOT_FOUND; /* not found */
   }
 
-  return ECW_ERROR_SDO_NOT_FOUND; /* not found */
+  memmove(current->value_string, value, ECW_MAX_VISIBLE_STRING_LENGTH);
+  return slave_sdo_download(s, current);
 }
 
 int ecw_slave_get_sdo_int_value(Ethercat_Slave_t *s, int index, int subindex,
                             int *value)
 {
-  Sdo_t *sdo = NULL;  //ecw_slave_get_sdo(s, index, subindex);
-  for (int i = 0; i < s->sdo_count; i++) {
-    Sdo_t *current = s->dictionary + i;
-    if (current->index == index && current->subindex == subindex) {
-      sdo = current;
-      break;
-    }
-  }
-
+  Sdo_t *sdo = sdo_lookup(s, index, subindex);
   if (sdo == NULL) {
     return ECW_ERROR_SDO_NOT_FOUND; /* Not found */
   }
@@ -554,15 +1268,7 @@ int ecw_slave_get_sdo_int_value(Ethercat_Slave_t *s, int index, int subindex,
 int ecw_slave_get_sdo_string_value(Ethercat_Slave_t *s, int index, int subindex,
                                    char *value)
 {
-  Sdo_t *sdo = NULL;
-  for (int i = 0; i < s->sdo_count; i++) {
-    Sdo_t *current = s->dictionary + i;
-    if (current->index == index && current->subindex == subindex) {
-      sdo = current;
-      break;
-    }
-  }
-
+  Sdo_t *sdo = sdo_lookup(s, index, subindex);
   if (sdo == NULL) {
     return ECW_ERROR_SDO_NOT_FOUND; /* Not found */
   }
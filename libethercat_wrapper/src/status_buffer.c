@@ -0,0 +1,79 @@
+/*
+ * status_buffer.c
+ *
+ * Lock free single writer / single reader triple buffer, see
+ * status_buffer.h.
+ *
+ * Synapticon GmbH
+ */
+
+#include "status_buffer.h"
+
+#include <stdlib.h>
+
+#define STATUS_BUFFER_FRESH  0x4
+#define STATUS_BUFFER_INDEX  0x3
+
+Status_Buffer_t *status_buffer_create(size_t slave_count)
+{
+  Status_Buffer_t *status = calloc(1, sizeof(Status_Buffer_t));
+  if (status == NULL) {
+    return NULL;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    Ethercat_Status_t *buffer = status->buffer + i;
+
+    buffer->slave_count = slave_count;
+    buffer->slave_state = calloc(slave_count ? slave_count : 1,
+                                 sizeof(ec_slave_config_state_t));
+    if (buffer->slave_state == NULL) {
+      status_buffer_free(status);
+      return NULL;
+    }
+  }
+
+  status->front = 0;
+  status->state = 1;
+  status->back = 2;
+
+  return status;
+}
+
+void status_buffer_free(Status_Buffer_t *status)
+{
+  if (status == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    free(status->buffer[i].slave_state);
+  }
+
+  free(status);
+}
+
+Ethercat_Status_t *status_buffer_back(Status_Buffer_t *status)
+{
+  return status->buffer + status->back;
+}
+
+void status_buffer_publish(Status_Buffer_t *status)
+{
+  unsigned int old = __atomic_exchange_n(&status->state,
+                                         status->back | STATUS_BUFFER_FRESH,
+                                         __ATOMIC_ACQ_REL);
+  status->back = old & STATUS_BUFFER_INDEX;
+}
+
+const Ethercat_Status_t *status_buffer_latest(Status_Buffer_t *status)
+{
+  if (__atomic_load_n(&status->state, __ATOMIC_ACQUIRE) & STATUS_BUFFER_FRESH) {
+    unsigned int old = __atomic_exchange_n(&status->state, status->front,
+                                           __ATOMIC_ACQ_REL);
+    status->front = old & STATUS_BUFFER_INDEX;
+    status->published = 1;
+  }
+
+  return status->published ? status->buffer + status->front : NULL;
+}
@@ -0,0 +1,300 @@
+/*
+ * topology.c
+ *
+ * On a machine with a fixed bus the sync manager and PDO layout of the
+ * slaves is the same on every start, but reading it from the master takes
+ * one request per sync manager, PDO and PDO entry. The snapshot stores the
+ * layout together with the identity of the slave at every position, so it
+ * can be verified against the slave information and replaces the queries if
+ * nothing changed. The records are written in the byte order of the host.
+ *
+ * Synapticon GmbH
+ */
+
+#include "topology.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TOPOLOGY_MAGIC    0x50544345 /* "ECTP" */
+#define TOPOLOGY_VERSION  1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slave_count;
+} Topology_Header_t;
+
+typedef struct {
+  uint32_t vendor_id;
+  uint32_t product_code;
+  uint32_t revision_number;
+  uint32_t serial_number;
+  uint32_t sync_count;
+} Topology_Slave_t;
+
+typedef struct {
+  uint8_t index;
+  uint8_t dir;
+  uint8_t watchdog_mode;
+  uint8_t reserved;
+  uint32_t n_pdos;
+} Topology_Sync_t;
+
+typedef struct {
+  uint16_t index;
+  uint16_t reserved;
+  uint32_t n_entries;
+} Topology_Pdo_t;
+
+typedef struct {
+  uint16_t index;
+  uint8_t subindex;
+  uint8_t bit_length;
+} Topology_Entry_t;
+
+void topology_free_layout(Ethercat_Slave_t *slave)
+{
+  if (slave->sminfo == NULL) {
+    return;
+  }
+
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    ec_sync_info_t *sm = slave->sminfo + j;
+
+    if (sm->pdos == NULL) {
+      continue;
+    }
+
+    for (unsigned int k = 0; k < sm->n_pdos; k++) {
+      free(sm->pdos[k].entries);
+    }
+    free(sm->pdos);
+  }
+
+  free(slave->sminfo);
+  slave->sminfo = NULL;
+}
+
+static int identity_matches(const Topology_Slave_t *record,
+                            const ec_slave_info_t *info)
+{
+  return record->vendor_id == info->vendor_id
+      && record->product_code == info->product_code
+      && record->revision_number == info->revision_number
+      && record->serial_number == info->serial_number
+      && record->sync_count == info->sync_count;
+}
+
+static int load_layout(FILE *f, Ethercat_Slave_t *slave)
+{
+  slave->sminfo = calloc(slave->info->sync_count + 1, sizeof(ec_sync_info_t));
+  if (slave->sminfo == NULL) {
+    return -1;
+  }
+
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    ec_sync_info_t *sm = slave->sminfo + j;
+    Topology_Sync_t sync;
+
+    if (fread(&sync, sizeof(sync), 1, f) != 1) {
+      return -1;
+    }
+
+    sm->index = sync.index;
+    sm->dir = (ec_direction_t) sync.dir;
+    sm->watchdog_mode = (ec_watchdog_mode_t) sync.watchdog_mode;
+    sm->n_pdos = sync.n_pdos;
+    sm->pdos = NULL;
+
+    if (sm->n_pdos == 0) {
+      continue;
+    }
+
+    sm->pdos = calloc(sm->n_pdos, sizeof(ec_pdo_info_t));
+    if (sm->pdos == NULL) {
+      return -1;
+    }
+
+    for (unsigned int k = 0; k < sm->n_pdos; k++) {
+      ec_pdo_info_t *pdo = sm->pdos + k;
+      Topology_Pdo_t pdo_record;
+
+      if (fread(&pdo_record, sizeof(pdo_record), 1, f) != 1) {
+        return -1;
+      }
+
+      pdo->index = pdo_record.index;
+      pdo->n_entries = pdo_record.n_entries;
+      pdo->entries = calloc(pdo->n_entries ? pdo->n_entries : 1,
+                            sizeof(ec_pdo_entry_info_t));
+      if (pdo->entries == NULL) {
+        return -1;
+      }
+
+      for (unsigned int l = 0; l < pdo->n_entries; l++) {
+        Topology_Entry_t entry;
+
+        if (fread(&entry, sizeof(entry), 1, f) != 1) {
+          return -1;
+        }
+
+        pdo->entries[l].index = entry.index;
+        pdo->entries[l].subindex = entry.subindex;
+        pdo->entries[l].bit_length = entry.bit_length;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int topology_load(const char *path, Ethercat_Slave_t *slaves,
+                  size_t slave_count)
+{
+  Topology_Header_t header;
+
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    return -1;
+  }
+
+  if (fread(&header, sizeof(header), 1, f) != 1
+      || header.magic != TOPOLOGY_MAGIC || header.version != TOPOLOGY_VERSION
+      || header.slave_count != slave_count) {
+    fclose(f);
+    return -1;
+  }
+
+  /* verify the whole bus first, the layout is only read on a match */
+  for (size_t i = 0; i < slave_count; i++) {
+    Topology_Slave_t record;
+
+    if (fread(&record, sizeof(record), 1, f) != 1
+        || !identity_matches(&record, slaves[i].info)) {
+      fclose(f);
+      return -1;
+    }
+  }
+
+  for (size_t i = 0; i < slave_count; i++) {
+    if (load_layout(f, slaves + i)) {
+      for (size_t n = 0; n <= i; n++) {
+        topology_free_layout(slaves + n);
+      }
+      fclose(f);
+      return -1;
+    }
+  }
+
+  fclose(f);
+
+  return 0;
+}
+
+static int store_layout(FILE *f, const Ethercat_Slave_t *slave)
+{
+  for (int j = 0; j < slave->info->sync_count; j++) {
+    const ec_sync_info_t *sm = slave->sminfo + j;
+    Topology_Sync_t sync;
+
+    memset(&sync, 0, sizeof(sync));
+    sync.index = sm->index;
+    sync.dir = (uint8_t) sm->dir;
+    sync.watchdog_mode = (uint8_t) sm->watchdog_mode;
+    sync.n_pdos = (sm->pdos != NULL) ? sm->n_pdos : 0;
+
+    if (fwrite(&sync, sizeof(sync), 1, f) != 1) {
+      return -1;
+    }
+
+    for (unsigned int k = 0; k < sync.n_pdos; k++) {
+      const ec_pdo_info_t *pdo = sm->pdos + k;
+      Topology_Pdo_t pdo_record;
+
+      memset(&pdo_record, 0, sizeof(pdo_record));
+      pdo_record.index = pdo->index;
+      pdo_record.n_entries = pdo->n_entries;
+
+      if (fwrite(&pdo_record, sizeof(pdo_record), 1, f) != 1) {
+        return -1;
+      }
+
+      for (unsigned int l = 0; l < pdo->n_entries; l++) {
+        Topology_Entry_t entry = {
+          .index = pdo->entries[l].index,
+          .subindex = pdo->entries[l].subindex,
+          .bit_length = pdo->entries[l].bit_length
+        };
+
+        if (fwrite(&entry, sizeof(entry), 1, f) != 1) {
+          return -1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
+
+int topology_store(const char *path, const Ethercat_Slave_t *slaves,
+                   size_t slave_count)
+{
+  char tmppath[FILENAME_MAX];
+
+  /* write to a temporary file first, so a crash never leaves a partial
+   * snapshot */
+  int len = snprintf(tmppath, sizeof(tmppath), "%s.%d", path, (int) getpid());
+  if (len < 0 || (size_t) len >= sizeof(tmppath)) {
+    return -1;
+  }
+
+  FILE *f = fopen(tmppath, "wb");
+  if (f == NULL) {
+    return -1;
+  }
+
+  Topology_Header_t header = {
+    .magic = TOPOLOGY_MAGIC,
+    .version = TOPOLOGY_VERSION,
+    .slave_count = (uint32_t) slave_count
+  };
+
+  int ret = (fwrite(&header, sizeof(header), 1, f) == 1) ? 0 : -1;
+
+  for (size_t i = 0; ret == 0 && i < slave_count; i++) {
+    const ec_slave_info_t *info = slaves[i].info;
+    Topology_Slave_t record = {
+      .vendor_id = info->vendor_id,
+      .product_code = info->product_code,
+      .revision_number = info->revision_number,
+      .serial_number = info->serial_number,
+      .sync_count = info->sync_count
+    };
+
+    if (fwrite(&record, sizeof(record), 1, f) != 1) {
+      ret = -1;
+    }
+  }
+
+  for (size_t i = 0; ret == 0 && i < slave_count; i++) {
+    ret = store_layout(f, slaves + i);
+  }
+
+  if (fclose(f) != 0) {
+    ret = -1;
+  }
+
+  if (ret == 0 && rename(tmppath, path) != 0) {
+    ret = -1;
+  }
+
+  if (ret != 0) {
+    unlink(tmppath);
+  }
+
+  return ret;
+}
@@ -0,0 +1,284 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2006-2014  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+/**
+   \file
+   EtherCAT frame capture ring methods.
+*/
+
+/*****************************************************************************/
+
+#include <linux/vmalloc.h>
+#include <linux/log2.h>
+#include <linux/rcupdate.h>
+#include <linux/hrtimer.h>
+
+#include "capture.h"
+
+/*****************************************************************************/
+
+/** Constructor.
+ */
+void ec_capture_init(
+        ec_capture_t *capture /**< Capture ring. */
+        )
+{
+    capture->ring = NULL;
+    capture->size = 0;
+    capture->frame_count = 0;
+    capture->committed = NULL;
+    atomic_set(&capture->reserve, 0);
+    capture->filter = EC_CAPTURE_ALL;
+    capture->sample_interval = 1;
+    atomic_set(&capture->sample_count, 0);
+}
+
+/*****************************************************************************/
+
+/** Destructor.
+ */
+void ec_capture_clear(
+        ec_capture_t *capture /**< Capture ring. */
+        )
+{
+    ec_capture_stop(capture);
+}
+
+/*****************************************************************************/
+
+/** Allocates the ring memory and starts capturing.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ec_capture_start(
+        ec_capture_t *capture, /**< Capture ring. */
+        unsigned int frame_count, /**< Number of ring slots (rounded up to the
+                                    next power of two). */
+        uint8_t filter, /**< Filter mode. */
+        unsigned int sample_interval /**< Capture every n-th frame. */
+        )
+{
+    ec_ioctl_capture_ring_t *ring;
+    size_t size;
+
+    if (capture->ring) {
+        return -EBUSY;
+    }
+
+    if (filter != EC_CAPTURE_ALL && filter != EC_CAPTURE_ERRORS) {
+        return -EINVAL;
+    }
+
+    if (!frame_count) {
+        frame_count = EC_CAPTURE_DEFAULT_FRAMES;
+    }
+    if (frame_count > EC_CAPTURE_MAX_FRAMES) {
+        return -EINVAL;
+    }
+    frame_count = roundup_pow_of_two(frame_count);
+
+    size = PAGE_ALIGN(EC_CAPTURE_FRAMES_OFFSET
+            + frame_count * sizeof(ec_ioctl_capture_frame_t));
+
+    ring = vmalloc_user(size); // zeroed
+    if (!ring) {
+        return -ENOMEM;
+    }
+
+    capture->committed = vzalloc(frame_count * sizeof(uint32_t));
+    if (!capture->committed) {
+        vfree(ring);
+        return -ENOMEM;
+    }
+
+    ring->frame_count = frame_count;
+    ring->frames_offset = EC_CAPTURE_FRAMES_OFFSET;
+
+    capture->size = size;
+    capture->frame_count = frame_count;
+    atomic_set(&capture->reserve, 0);
+    capture->filter = filter;
+    capture->sample_interval = sample_interval ? sample_interval : 1;
+    atomic_set(&capture->sample_count, 0);
+
+    rcu_assign_pointer(capture->ring, ring);
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Stops capturing and frees the ring memory.
+ *
+ * Pages that are still mapped to userspace stay valid until they are
+ * unmapped.
+ */
+void ec_capture_stop(
+        ec_capture_t *capture /**< Capture ring. */
+        )
+{
+    ec_ioctl_capture_ring_t *ring = capture->ring;
+
+    if (!ring) {
+        return;
+    }
+
+    rcu_assign_pointer(capture->ring, NULL);
+    synchronize_rcu(); // wait for frames being written
+    vfree(ring);
+    vfree(capture->committed);
+    capture->committed = NULL;
+    capture->size = 0;
+}
+
+/*****************************************************************************/
+
+/** Advances the published head over all committed slots.
+ *
+ * Any producer may publish the frames of the others, so a frame committed
+ * behind a slower producer is published by that producer at the latest.
+ */
+static void ec_capture_publish(
+        ec_capture_t *capture, /**< Capture ring. */
+        ec_ioctl_capture_ring_t *ring /**< Ring memory. */
+        )
+{
+    uint32_t mask = capture->frame_count - 1, head;
+
+    while (1) {
+        head = READ_ONCE(ring->head);
+        if (READ_ONCE(capture->committed[head & mask]) != head + 1) {
+            break;
+        }
+        cmpxchg(&ring->head, head, head + 1); // full barrier on success
+    }
+}
+
+/*****************************************************************************/
+
+/** Appends a frame to the capture ring.
+ *
+ * May be called concurrently from several contexts without locking, see
+ * ec_capture_t. The consumer only reads up to the published head and is
+ * never blocked.
+ */
+void ec_capture_frame(
+        ec_capture_t *capture, /**< Capture ring. */
+        const uint8_t *data, /**< Frame data including Ethernet header. */
+        size_t size, /**< Frame size. */
+        uint8_t flags /**< Frame flags (EC_CAPTURE_FLAG_*). */
+        )
+{
+    ec_ioctl_capture_ring_t *ring;
+    ec_ioctl_capture_frame_t *frame;
+    uint32_t head, dropped, slot;
+
+    if (capture->filter == EC_CAPTURE_ERRORS
+            && !(flags & EC_CAPTURE_FLAG_ERROR)) {
+        return;
+    }
+
+    if (capture->sample_interval > 1 &&
+            (unsigned int) atomic_inc_return(&capture->sample_count)
+            % capture->sample_interval) {
+        return;
+    }
+
+    rcu_read_lock();
+
+    ring = rcu_dereference(capture->ring);
+    if (!ring) {
+        goto out;
+    }
+    smp_rmb(); // the commit marks are allocated before the ring is published
+
+    // claim a slot, slots behind the tail are published and read already
+    do {
+        head = (uint32_t) atomic_read(&capture->reserve);
+        if (head - READ_ONCE(ring->tail) >= capture->frame_count) {
+            do {
+                dropped = READ_ONCE(ring->dropped);
+            } while (cmpxchg(&ring->dropped, dropped, dropped + 1)
+                    != dropped);
+            goto out;
+        }
+    } while ((uint32_t) atomic_cmpxchg(&capture->reserve, head, head + 1)
+            != head);
+
+    slot = head & (capture->frame_count - 1);
+    frame = (ec_ioctl_capture_frame_t *) ((uint8_t *) ring
+            + EC_CAPTURE_FRAMES_OFFSET) + slot;
+
+    if (size > EC_CAPTURE_FRAME_SIZE) {
+        size = EC_CAPTURE_FRAME_SIZE;
+    }
+
+    frame->timestamp = ktime_to_ns(ktime_get_real());
+    frame->size = size;
+    frame->flags = flags;
+    memcpy(frame->data, data, size);
+
+    smp_wmb(); // frame contents before the commit mark
+    WRITE_ONCE(capture->committed[slot], head + 1);
+    smp_mb(); // commit mark before reading the head, see ec_capture_publish()
+
+    ec_capture_publish(capture, ring);
+
+out:
+    rcu_read_unlock();
+}
+
+/*****************************************************************************/
+
+/** Gets the ring page for a memory-mapping offset.
+ *
+ * \return Page with an additional reference, or \a NULL.
+ */
+struct page *ec_capture_page(
+        ec_capture_t *capture, /**< Capture ring. */
+        unsigned long offset /**< Offset in the ring memory. */
+        )
+{
+    ec_ioctl_capture_ring_t *ring;
+    struct page *page = NULL;
+
+    rcu_read_lock();
+
+    ring = rcu_dereference(capture->ring);
+    if (ring && offset < capture->size) {
+        page = vmalloc_to_page((uint8_t *) ring + offset);
+        if (page) {
+            get_page(page);
+        }
+    }
+
+    rcu_read_unlock();
+    return page;
+}
+
+/*****************************************************************************/
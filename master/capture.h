@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2006-2014  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+/**
+   \file
+   EtherCAT frame capture ring structure.
+*/
+
+/*****************************************************************************/
+
+#ifndef __EC_CAPTURE_H__
+#define __EC_CAPTURE_H__
+
+#include <linux/mm.h>
+#include <linux/atomic.h>
+
+#include "globals.h"
+#include "ioctl.h"
+
+/*****************************************************************************/
+
+/** Default number of frames in a capture ring. */
+#define EC_CAPTURE_DEFAULT_FRAMES 1024
+
+/** Maximum number of frames in a capture ring. */
+#define EC_CAPTURE_MAX_FRAMES 16384
+
+/** Offset of the first frame slot in the ring memory. */
+#define EC_CAPTURE_FRAMES_OFFSET ALIGN(sizeof(ec_ioctl_capture_ring_t), 64)
+
+/*****************************************************************************/
+
+/** EtherCAT frame capture ring.
+ *
+ * The ring is filled by the send and receive paths of a device and read via
+ * mmap() by a userspace process. The ring memory is published via RCU, so
+ * that the capture can be stopped while the device is in use.
+ *
+ * Frames are sent from the application or master thread and from the EoE
+ * processing, which may run in another context, so there can be several
+ * producers. They claim their slots with a compare-and-swap on \a reserve and
+ * mark them in \a committed when written. The head in the ring header is
+ * only advanced over committed slots, so the reader never sees a partly
+ * written frame.
+ */
+typedef struct {
+    ec_ioctl_capture_ring_t *ring; /**< Ring memory, or \a NULL if the
+                                     capture is not running. */
+    size_t size; /**< Size of the ring memory in bytes. */
+    unsigned int frame_count; /**< Number of slots. The header in the ring
+                                memory is writable from userspace, so the
+                                master uses its own copy. */
+    uint32_t *committed; /**< Per slot: sequence number + 1 of the last
+                           frame written to it. Published with \a ring. */
+    atomic_t reserve; /**< Next slot to claim. */
+    uint8_t filter; /**< Filter mode (EC_CAPTURE_ALL, EC_CAPTURE_ERRORS). */
+    unsigned int sample_interval; /**< Capture every n-th frame only. */
+    atomic_t sample_count; /**< Frames offered for sampling. */
+} ec_capture_t;
+
+/*****************************************************************************/
+
+void ec_capture_init(ec_capture_t *);
+void ec_capture_clear(ec_capture_t *);
+
+int ec_capture_start(ec_capture_t *, unsigned int, uint8_t, unsigned int);
+void ec_capture_stop(ec_capture_t *);
+void ec_capture_frame(ec_capture_t *, const uint8_t *, size_t, uint8_t);
+struct page *ec_capture_page(ec_capture_t *, unsigned long);
+
+/*****************************************************************************/
+
+/** Returns true, if frames shall be passed to the capture ring.
+ *
+ * This is only a hint for the fast path; ec_capture_frame() does the
+ * actual checks.
+ */
+static inline int ec_capture_running(
+        const ec_capture_t *capture /**< Capture ring. */
+        )
+{
+    return capture->ring != NULL;
+}
+
+/*****************************************************************************/
+
+#endif
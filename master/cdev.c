@@ -37,6 +37,7 @@
 #include <linux/module.h>
 #include <linux/vmalloc.h>
 #include <linux/mm.h>
+#include <linux/poll.h>
 
 #include "cdev.h"
 #include "master.h"
@@ -54,7 +55,9 @@
 static int eccdev_open(struct inode *, struct file *);
 static int eccdev_release(struct inode *, struct file *);
 static long eccdev_ioctl(struct file *, unsigned int, unsigned long);
+static ssize_t eccdev_read(struct file *, char __user *, size_t, loff_t *);
 static int eccdev_mmap(struct file *, struct vm_area_struct *);
+static unsigned int eccdev_poll(struct file *, poll_table *);
 
 /** This is the kernel version from which the .fault member of the
  * vm_operations_struct is usable.
@@ -83,7 +86,9 @@ static struct file_operations eccdev_fops = {
     .open           = eccdev_open,
     .release        = eccdev_release,
     .unlocked_ioctl = eccdev_ioctl,
-    .mmap           = eccdev_mmap
+    .read           = eccdev_read,
+    .mmap           = eccdev_mmap,
+    .poll           = eccdev_poll
 };
 
 /** Callbacks for a virtual memory area retrieved with ecdevc_mmap().
@@ -165,6 +170,12 @@ int eccdev_open(struct inode *inode, struct file *filp)
     priv->ctx.requested = 0;
     priv->ctx.process_data = NULL;
     priv->ctx.process_data_size = 0;
+    priv->ctx.capture_mask = 0;
+    priv->ctx.foe_request = NULL;
+    priv->ctx.foe_batch = NULL;
+    priv->ctx.emerg_index =
+        ec_coe_emerg_stream_index(&cdev->master->emerg_stream);
+    priv->ctx.emerg_overruns = 0;
 
     filp->private_data = priv;
 
@@ -182,6 +193,19 @@ int eccdev_release(struct inode *inode, struct file *filp)
 {
     ec_cdev_priv_t *priv = (ec_cdev_priv_t *) filp->private_data;
     ec_master_t *master = priv->cdev->master;
+    unsigned int dev_idx;
+
+    ec_ioctl_foe_stream_clear(master, &priv->ctx);
+    ec_ioctl_foe_batch_clear(master, &priv->ctx);
+
+    for (dev_idx = EC_DEVICE_MAIN; dev_idx < ec_master_num_devices(master);
+            dev_idx++) {
+        if (priv->ctx.capture_mask & (1 << dev_idx)) {
+            down(&master->device_sem);
+            ec_capture_stop(&master->devices[dev_idx].capture);
+            up(&master->device_sem);
+        }
+    }
 
     if (priv->ctx.requested) {
         ecrt_release_master(master);
@@ -218,6 +242,110 @@ long eccdev_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 
 /*****************************************************************************/
 
+/** Number of events copied at once by eccdev_read().
+ */
+#define EC_CDEV_EMERG_CHUNK 16
+
+/** Called when a process reads from the character device.
+ *
+ * Delivers the CoE emergency events received since the file was opened, as
+ * an array of ec_coe_emerg_event_t records. Blocks until at least one event
+ * is available, unless the file was opened with O_NONBLOCK.
+ *
+ * \return Number of bytes read, or a negative error code.
+ */
+ssize_t eccdev_read(
+        struct file *filp,
+        char __user *buf,
+        size_t count,
+        loff_t *ppos
+        )
+{
+    ec_cdev_priv_t *priv = (ec_cdev_priv_t *) filp->private_data;
+    ec_master_t *master = priv->cdev->master;
+    ec_coe_emerg_event_t chunk[EC_CDEV_EMERG_CHUNK];
+    size_t max_count = count / sizeof(ec_coe_emerg_event_t), done = 0, n;
+    int ret;
+
+    if (!max_count) {
+        return -EINVAL;
+    }
+
+    for (;;) {
+        n = ec_coe_emerg_stream_read(&master->emerg_stream,
+                &priv->ctx.emerg_index, chunk,
+                min_t(size_t, max_count, EC_CDEV_EMERG_CHUNK),
+                &priv->ctx.emerg_overruns);
+        if (n) {
+            break;
+        }
+
+        if (filp->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+
+        ret = wait_event_interruptible(master->emerg_queue,
+                ec_coe_emerg_stream_index(&master->emerg_stream)
+                != priv->ctx.emerg_index);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    do {
+        if (copy_to_user(buf + done * sizeof(ec_coe_emerg_event_t), chunk,
+                    n * sizeof(ec_coe_emerg_event_t))) {
+            return -EFAULT;
+        }
+        done += n;
+
+        n = ec_coe_emerg_stream_read(&master->emerg_stream,
+                &priv->ctx.emerg_index, chunk,
+                min_t(size_t, max_count - done, EC_CDEV_EMERG_CHUNK),
+                &priv->ctx.emerg_overruns);
+    } while (n);
+
+    return done * sizeof(ec_coe_emerg_event_t);
+}
+
+/*****************************************************************************/
+
+/** Called when a process polls the character device.
+ *
+ * The device becomes readable, if CoE emergency events are pending for the
+ * file handle, or if request completions are pending for the file handle
+ * that requested the master.
+ *
+ * \return Poll event mask.
+ */
+unsigned int eccdev_poll(
+        struct file *filp,
+        poll_table *wait
+        )
+{
+    ec_cdev_priv_t *priv = (ec_cdev_priv_t *) filp->private_data;
+    ec_master_t *master = priv->cdev->master;
+    unsigned int mask = 0;
+
+    poll_wait(filp, &master->emerg_queue, wait);
+    if (priv->ctx.requested) {
+        poll_wait(filp, &master->completion_queue, wait);
+    }
+
+    if (ec_coe_emerg_stream_index(&master->emerg_stream)
+            != priv->ctx.emerg_index) {
+        mask |= POLLIN | POLLRDNORM;
+    }
+
+    if (priv->ctx.requested && ec_master_completions_pending(master)) {
+        mask |= POLLIN | POLLRDNORM;
+    }
+
+    return mask;
+}
+
+/*****************************************************************************/
+
 #ifndef VM_DONTDUMP
 /** VM_RESERVED disappeared in 3.7.
  */
@@ -249,6 +377,32 @@ int eccdev_mmap(
 
 /*****************************************************************************/
 
+/** Gets a page of a capture ring started via this file handle.
+ *
+ * \return Page with an additional reference, or \a NULL.
+ */
+static struct page *eccdev_capture_page(
+        ec_cdev_priv_t *priv, /**< Private data of the file handle. */
+        unsigned long offset /**< Offset in the mapping. */
+        )
+{
+    ec_master_t *master = priv->cdev->master;
+    unsigned int dev_idx;
+
+    offset -= EC_CAPTURE_MMAP_BASE;
+    dev_idx = offset / EC_CAPTURE_MMAP_STRIDE;
+
+    if (dev_idx >= ec_master_num_devices(master)
+            || !(priv->ctx.capture_mask & (1 << dev_idx))) {
+        return NULL;
+    }
+
+    return ec_capture_page(&master->devices[dev_idx].capture,
+            offset % EC_CAPTURE_MMAP_STRIDE);
+}
+
+/*****************************************************************************/
+
 #if LINUX_VERSION_CODE >= PAGE_FAULT_VERSION
 
 /** Page fault callback for a virtual memory area.
@@ -273,6 +427,15 @@ static int eccdev_vma_fault(
     unsigned long offset = vmf->pgoff << PAGE_SHIFT;
     struct page *page;
 
+    if (offset >= EC_CAPTURE_MMAP_BASE) {
+        page = eccdev_capture_page(priv, offset);
+        if (!page) {
+            return VM_FAULT_SIGBUS;
+        }
+        vmf->page = page;
+        return 0;
+    }
+
     if (offset >= priv->ctx.process_data_size) {
         return VM_FAULT_SIGBUS;
     }
@@ -316,6 +479,15 @@ struct page *eccdev_vma_nopage(
 
     offset = (address - vma->vm_start) + (vma->vm_pgoff << PAGE_SHIFT);
 
+    if (offset >= EC_CAPTURE_MMAP_BASE) {
+        page = eccdev_capture_page(priv, offset);
+        if (!page)
+            return NOPAGE_SIGBUS;
+        if (type)
+            *type = VM_FAULT_MINOR;
+        return page;
+    }
+
     if (offset >= priv->ctx.process_data_size)
         return NOPAGE_SIGBUS;
 
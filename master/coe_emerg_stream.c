@@ -0,0 +1,170 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2012  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+
+/** \file
+ * EtherCAT master-wide CoE emergency event stream methods.
+ */
+
+/*****************************************************************************/
+
+#include <linux/slab.h>
+#include <linux/ktime.h>
+
+#include "slave.h"
+#include "coe_emerg_stream.h"
+
+/*****************************************************************************/
+
+/** Emergency stream constructor.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ec_coe_emerg_stream_init(
+        ec_coe_emerg_stream_t *stream /**< Emergency stream. */
+        )
+{
+    BUILD_BUG_ON(EC_COE_EMERG_STREAM_SIZE & (EC_COE_EMERG_STREAM_SIZE - 1));
+
+    stream->write_index = 0;
+    spin_lock_init(&stream->lock);
+
+    stream->events = kmalloc(sizeof(ec_coe_emerg_event_t)
+            * EC_COE_EMERG_STREAM_SIZE, GFP_KERNEL);
+    if (!stream->events) {
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Emergency stream destructor.
+ */
+void ec_coe_emerg_stream_clear(
+        ec_coe_emerg_stream_t *stream /**< Emergency stream. */
+        )
+{
+    if (stream->events) {
+        kfree(stream->events);
+        stream->events = NULL;
+    }
+}
+
+/*****************************************************************************/
+
+/** Appends an emergency message to the stream.
+ *
+ * If the ring is full, the oldest event is overwritten.
+ */
+void ec_coe_emerg_stream_push(
+        ec_coe_emerg_stream_t *stream, /**< Emergency stream. */
+        const ec_slave_t *slave, /**< Slave that sent the message. */
+        const uint8_t *msg /**< Emergency message
+                             (EC_COE_EMERGENCY_MSG_SIZE bytes). */
+        )
+{
+    ec_coe_emerg_event_t *event;
+    unsigned long flags;
+
+    spin_lock_irqsave(&stream->lock, flags);
+    event = &stream->events[
+        stream->write_index & (EC_COE_EMERG_STREAM_SIZE - 1)];
+    event->timestamp = ktime_to_ns(ktime_get_real());
+    event->slave_position = slave->ring_position;
+    event->alias = slave->effective_alias;
+    memcpy(event->data, msg, EC_COE_EMERGENCY_MSG_SIZE);
+    memset(event->reserved, 0x00, sizeof(event->reserved));
+    stream->write_index++;
+    spin_unlock_irqrestore(&stream->lock, flags);
+}
+
+/*****************************************************************************/
+
+/** Returns the current write index.
+ *
+ * A reader has pending events, if its read index differs from this value.
+ *
+ * \return Free-running write index.
+ */
+unsigned int ec_coe_emerg_stream_index(
+        ec_coe_emerg_stream_t *stream /**< Emergency stream. */
+        )
+{
+    unsigned long flags;
+    unsigned int index;
+
+    spin_lock_irqsave(&stream->lock, flags);
+    index = stream->write_index;
+    spin_unlock_irqrestore(&stream->lock, flags);
+    return index;
+}
+
+/*****************************************************************************/
+
+/** Copies pending events of a reader and advances its read index.
+ *
+ * Events that were overwritten before the reader fetched them are skipped
+ * and added to \a lost.
+ *
+ * \return Number of events stored in \a events.
+ */
+size_t ec_coe_emerg_stream_read(
+        ec_coe_emerg_stream_t *stream, /**< Emergency stream. */
+        unsigned int *read_index, /**< Read index of the reader. */
+        ec_coe_emerg_event_t *events, /**< Target memory. */
+        size_t max_count, /**< Maximum number of events to copy. */
+        unsigned int *lost /**< Number of skipped events is added here. */
+        )
+{
+    unsigned long flags;
+    unsigned int index, pending;
+    size_t count = 0;
+
+    spin_lock_irqsave(&stream->lock, flags);
+
+    index = *read_index;
+    pending = stream->write_index - index;
+    if (pending > EC_COE_EMERG_STREAM_SIZE) {
+        *lost += pending - EC_COE_EMERG_STREAM_SIZE;
+        index = stream->write_index - EC_COE_EMERG_STREAM_SIZE;
+    }
+
+    while (count < max_count && index != stream->write_index) {
+        events[count++] =
+            stream->events[index++ & (EC_COE_EMERG_STREAM_SIZE - 1)];
+    }
+
+    *read_index = index;
+    spin_unlock_irqrestore(&stream->lock, flags);
+    return count;
+}
+
+/*****************************************************************************/
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2012  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+
+/**
+   \file
+   EtherCAT master-wide CoE emergency event stream.
+*/
+
+/*****************************************************************************/
+
+#ifndef __EC_COE_EMERG_STREAM_H__
+#define __EC_COE_EMERG_STREAM_H__
+
+#include <linux/spinlock.h>
+
+#include "globals.h"
+
+/*****************************************************************************/
+
+/** Number of events the stream keeps. Must be a power of two.
+ */
+#define EC_COE_EMERG_STREAM_SIZE 0x100
+
+/*****************************************************************************/
+
+/** Master-wide CoE emergency event stream.
+ *
+ * All CoE emergency messages of the bus are appended to this ring,
+ * regardless of whether the slave is configured. The ring is overwritten
+ * when full; each reader keeps its own free-running read index and detects
+ * lost events by the distance to the write index.
+ */
+typedef struct {
+    ec_coe_emerg_event_t *events; /**< Event ring. */
+    unsigned int write_index; /**< Free-running write index (total number
+                                of events). */
+    spinlock_t lock; /**< Lock between the master thread and readers. */
+} ec_coe_emerg_stream_t;
+
+/*****************************************************************************/
+
+int ec_coe_emerg_stream_init(ec_coe_emerg_stream_t *);
+void ec_coe_emerg_stream_clear(ec_coe_emerg_stream_t *);
+
+void ec_coe_emerg_stream_push(ec_coe_emerg_stream_t *, const ec_slave_t *,
+        const uint8_t *);
+unsigned int ec_coe_emerg_stream_index(ec_coe_emerg_stream_t *);
+size_t ec_coe_emerg_stream_read(ec_coe_emerg_stream_t *, unsigned int *,
+        ec_coe_emerg_event_t *, size_t, unsigned int *);
+
+/*****************************************************************************/
+
+#endif
@@ -0,0 +1,188 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2012  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+
+/** \file
+ * EtherCAT request completion ring methods.
+ */
+
+/*****************************************************************************/
+
+#include <linux/slab.h>
+
+#include "completion_ring.h"
+
+/*****************************************************************************/
+
+/** Completion ring constructor.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ec_completion_ring_init(
+        ec_completion_ring_t *ring /**< Completion ring. */
+        )
+{
+    BUILD_BUG_ON(EC_COMPLETION_RING_SIZE & (EC_COMPLETION_RING_SIZE - 1));
+
+    ring->read_index = 0;
+    ring->write_index = 0;
+    ring->overruns = 0;
+    ring->overruns_seen = 0;
+
+    ring->entries = kmalloc(sizeof(ec_request_completion_t)
+            * EC_COMPLETION_RING_SIZE, GFP_KERNEL);
+    if (!ring->entries) {
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Completion ring destructor.
+ */
+void ec_completion_ring_clear(
+        ec_completion_ring_t *ring /**< Completion ring. */
+        )
+{
+    if (ring->entries) {
+        kfree(ring->entries);
+        ring->entries = NULL;
+    }
+}
+
+/*****************************************************************************/
+
+/** Discards all pending completions.
+ *
+ * Must only be called from the consumer side.
+ */
+void ec_completion_ring_reset(
+        ec_completion_ring_t *ring /**< Completion ring. */
+        )
+{
+    WRITE_ONCE(ring->read_index, READ_ONCE(ring->write_index));
+    ring->overruns_seen = READ_ONCE(ring->overruns);
+}
+
+/*****************************************************************************/
+
+/** Posts a completion.
+ *
+ * If the ring is full, the completion is dropped and counted as an overrun.
+ */
+void ec_completion_ring_push(
+        ec_completion_ring_t *ring, /**< Completion ring. */
+        uint64_t tag, /**< Application tag of the request. */
+        ec_request_state_t state /**< Final request state. */
+        )
+{
+    unsigned int write_index = ring->write_index;
+    ec_request_completion_t *entry;
+
+    if (write_index - READ_ONCE(ring->read_index)
+            >= EC_COMPLETION_RING_SIZE) {
+        WRITE_ONCE(ring->overruns, ring->overruns + 1);
+        return;
+    }
+
+    entry = &ring->entries[write_index & (EC_COMPLETION_RING_SIZE - 1)];
+    entry->tag = tag;
+    entry->state = state;
+
+    smp_wmb(); // publish the entry before the index
+    WRITE_ONCE(ring->write_index, write_index + 1);
+}
+
+/*****************************************************************************/
+
+/** Removes completions from the ring.
+ *
+ * \return Number of completions stored in \a completions.
+ */
+size_t ec_completion_ring_pop(
+        ec_completion_ring_t *ring, /**< Completion ring. */
+        ec_request_completion_t *completions, /**< Target memory. */
+        size_t max_count /**< Maximum number of completions to pop. */
+        )
+{
+    unsigned int read_index = ring->read_index;
+    size_t count;
+
+    count = READ_ONCE(ring->write_index) - read_index;
+    smp_rmb(); // read the entries only after the index
+    if (count > max_count) {
+        count = max_count;
+    }
+
+    while (count-- > 0) {
+        *completions++ =
+            ring->entries[read_index++ & (EC_COMPLETION_RING_SIZE - 1)];
+    }
+
+    smp_mb(); // finish reading before releasing the entries
+    count = read_index - ring->read_index;
+    WRITE_ONCE(ring->read_index, read_index);
+    return count;
+}
+
+/*****************************************************************************/
+
+/** Checks, if there are pending completions.
+ *
+ * \return Non-zero, if the ring is empty.
+ */
+int ec_completion_ring_empty(
+        const ec_completion_ring_t *ring /**< Completion ring. */
+        )
+{
+    return READ_ONCE(ring->write_index) == READ_ONCE(ring->read_index);
+}
+
+/*****************************************************************************/
+
+/** Reads the number of overruns since the last call.
+ *
+ * Must only be called from the consumer side.
+ *
+ * \return Number of completions lost since the last call.
+ */
+unsigned int ec_completion_ring_overruns(
+        ec_completion_ring_t *ring /**< Completion ring. */
+        )
+{
+    unsigned int overruns = READ_ONCE(ring->overruns);
+    unsigned int lost = overruns - ring->overruns_seen;
+
+    ring->overruns_seen = overruns;
+    return lost;
+}
+
+/*****************************************************************************/
@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2012  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *****************************************************************************/
+
+
+/**
+   \file
+   EtherCAT request completion ring structure.
+*/
+
+/*****************************************************************************/
+
+#ifndef __EC_COMPLETION_RING_H__
+#define __EC_COMPLETION_RING_H__
+
+#include "globals.h"
+
+/*****************************************************************************/
+
+#ifndef READ_ONCE
+#define READ_ONCE(x) ACCESS_ONCE(x)
+#define WRITE_ONCE(x, val) (ACCESS_ONCE(x) = (val))
+#endif
+
+/*****************************************************************************/
+
+/** Number of completions a ring can hold. Must be a power of two.
+ */
+#define EC_COMPLETION_RING_SIZE 0x400
+
+/*****************************************************************************/
+
+/** EtherCAT request completion ring.
+ *
+ * Single-producer, single-consumer ring without locking. The producer is
+ * either the master thread or the application's cyclic task, the consumer
+ * is the file handle that reserved the master.
+ */
+typedef struct {
+    ec_request_completion_t *entries; /**< Completion entries. */
+    unsigned int read_index; /**< Free-running read index. */
+    unsigned int write_index; /**< Free-running write index. */
+    unsigned int overruns; /**< Number of dropped completions (written by
+                             the producer only). */
+    unsigned int overruns_seen; /**< Overruns already reported to the
+                                  consumer. */
+} ec_completion_ring_t;
+
+/*****************************************************************************/
+
+int ec_completion_ring_init(ec_completion_ring_t *);
+void ec_completion_ring_clear(ec_completion_ring_t *);
+
+void ec_completion_ring_reset(ec_completion_ring_t *);
+void ec_completion_ring_push(ec_completion_ring_t *, uint64_t,
+        ec_request_state_t);
+size_t ec_completion_ring_pop(ec_completion_ring_t *,
+        ec_request_completion_t *, size_t);
+int ec_completion_ring_empty(const ec_completion_ring_t *);
+unsigned int ec_completion_ring_overruns(ec_completion_ring_t *);
+
+/*****************************************************************************/
+
+#endif
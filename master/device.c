@@ -76,6 +76,8 @@ int ec_device_init(
     device->master = master;
     device->dev = NULL;
     device->poll = NULL;
+    device->irq = NULL;
+    device->flush = NULL;
     device->module = NULL;
     device->open = 0;
     device->link_state = 0;
@@ -93,6 +95,7 @@ int ec_device_init(
     device->jiffies_poll = 0;
 
     ec_device_clear_stats(device);
+    ec_capture_init(&device->capture);
 
 #ifdef EC_DEBUG_RING
     for (i = 0; i < EC_DEBUG_RING_SIZE; i++) {
@@ -170,6 +173,7 @@ void ec_device_clear(
     }
     for (i = 0; i < EC_TX_RING_SIZE; i++)
         dev_kfree_skb(device->tx_skb[i]);
+    ec_capture_clear(&device->capture);
 #ifdef EC_DEBUG_IF
     ec_debug_clear(&device->dbg);
 #endif
@@ -222,6 +226,8 @@ void ec_device_detach(
 
     device->dev = NULL;
     device->poll = NULL;
+    device->irq = NULL;
+    device->flush = NULL;
     device->module = NULL;
     device->open = 0;
     device->link_state = 0; // down
@@ -362,6 +368,12 @@ void ec_device_send(
         ec_device_debug_ring_append(
                 device, TX, skb->data + ETH_HLEN, size);
 #endif
+        if (unlikely(ec_capture_running(&device->capture))) {
+            ec_capture_frame(&device->capture, skb->data, ETH_HLEN + size, 0);
+        }
+        if (device->flush) {
+            device->flush_pending++;
+        }
     } else {
         device->tx_errors++;
     }
@@ -369,6 +381,33 @@ void ec_device_send(
 
 /*****************************************************************************/
 
+/** Starts the transmission of frames deferred by the device driver.
+ *
+ * Does nothing, if the device driver does not provide a transmit flush
+ * function.
+ */
+void ec_device_flush(
+        ec_device_t *device /**< EtherCAT device */
+        )
+{
+    unsigned int frames = device->flush_pending;
+
+    if (!device->flush) {
+        return;
+    }
+
+    device->flush(device->dev);
+
+    device->flush_pending = 0;
+    device->flush_count++;
+    device->flush_frames += frames;
+    if (frames > device->flush_max_frames) {
+        device->flush_max_frames = frames;
+    }
+}
+
+/*****************************************************************************/
+
 /** Clears the frame statistics.
  */
 void ec_device_clear_stats(
@@ -387,6 +426,13 @@ void ec_device_clear_stats(
     device->rx_bytes = 0;
     device->last_rx_bytes = 0;
     device->tx_errors = 0;
+    device->poll_count = 0;
+    device->poll_frames = 0;
+    device->poll_max_frames = 0;
+    device->flush_count = 0;
+    device->flush_frames = 0;
+    device->flush_max_frames = 0;
+    device->flush_pending = 0;
 
     for (i = 0; i < EC_RATE_COUNT; i++) {
         device->tx_frame_rates[i] = 0;
@@ -479,6 +525,9 @@ void ec_device_poll(
         ec_device_t *device /**< EtherCAT device */
         )
 {
+    u64 rx_count = device->rx_count;
+    unsigned int frames;
+
 #ifdef EC_HAVE_CYCLES
     device->cycles_poll = get_cycles();
 #endif
@@ -487,6 +536,30 @@ void ec_device_poll(
     do_gettimeofday(&device->timeval_poll);
 #endif
     device->poll(device->dev);
+
+    frames = device->rx_count - rx_count;
+    device->poll_count++;
+    device->poll_frames += frames;
+    if (frames > device->poll_max_frames) {
+        device->poll_max_frames = frames;
+    }
+}
+
+/*****************************************************************************/
+
+/** Enables or disables the receive interrupt of the assigned net_device.
+ *
+ * Does nothing, if the device driver does not provide an interrupt control
+ * function.
+ */
+void ec_device_set_irq(
+        ec_device_t *device, /**< EtherCAT device */
+        int enable /**< Non-zero to enable the interrupt. */
+        )
+{
+    if (device->irq && device->open) {
+        device->irq(device->dev, enable);
+    }
 }
 
 /*****************************************************************************/
@@ -566,6 +639,48 @@ void ecdev_withdraw(ec_device_t *device /**< EtherCAT device */)
 
 /*****************************************************************************/
 
+/** Registers an interrupt control function for the device.
+ *
+ * Optional. Drivers that implement it allow the master to sleep in \a IDLE
+ * phase until a frame is received, instead of polling the device (see the
+ * \a idle_irq module parameter). The driver's interrupt service routine has
+ * to disable the interrupt and call ecdev_irq(). The function is called from
+ * the master thread and may sleep, so the driver can request the interrupt
+ * line on the first call instead of holding it in EtherCAT mode. Must be
+ * called before ecdev_open().
+ *
+ * \ingroup DeviceInterface
+ */
+void ecdev_set_irq_func(
+        ec_device_t *device, /**< EtherCAT device */
+        ec_irqfunc_t irq /**< Interrupt control function. */
+        )
+{
+    device->irq = irq;
+}
+
+/*****************************************************************************/
+
+/** Registers a transmit flush function for the device.
+ *
+ * Optional. Drivers that implement it may defer starting the transmission of
+ * the frames passed to their \a ndo_start_xmit() callback. The master calls
+ * the flush function after it has passed all frames of a cycle to the
+ * device, so that the driver can hand them to the hardware at once. Must be
+ * called before ecdev_open().
+ *
+ * \ingroup DeviceInterface
+ */
+void ecdev_set_flush_func(
+        ec_device_t *device, /**< EtherCAT device */
+        ec_flushfunc_t flush /**< Transmit flush function. */
+        )
+{
+    device->flush = flush;
+}
+
+/*****************************************************************************/
+
 /** Opens the network device and makes the master enter IDLE phase.
  *
  * \return 0 on success, else < 0
@@ -639,6 +754,7 @@ void ecdev_receive(
 {
     const void *ec_data = data + ETH_HLEN;
     size_t ec_size = size - ETH_HLEN;
+    unsigned int errors;
 
     if (unlikely(!data)) {
         EC_MASTER_WARN(device->master, "%s() called with NULL data.\n",
@@ -663,7 +779,13 @@ void ecdev_receive(
     ec_device_debug_ring_append(device, RX, ec_data, ec_size);
 #endif
 
-    ec_master_receive_datagrams(device->master, device, ec_data, ec_size);
+    errors = ec_master_receive_datagrams(device->master, device,
+            ec_data, ec_size);
+
+    if (unlikely(ec_capture_running(&device->capture))) {
+        ec_capture_frame(&device->capture, data, size, EC_CAPTURE_FLAG_RX
+                | (errors ? EC_CAPTURE_FLAG_ERROR : 0));
+    }
 }
 
 /*****************************************************************************/
@@ -715,14 +837,36 @@ uint8_t ecdev_get_link(
 
 /*****************************************************************************/
 
+/** Notifies the master about a receive interrupt.
+ *
+ * Wakes up the master thread, if it is waiting for a frame in \a IDLE phase.
+ * May be called from interrupt context.
+ *
+ * \ingroup DeviceInterface
+ */
+void ecdev_irq(
+        ec_device_t *device /**< EtherCAT device */
+        )
+{
+    ec_master_t *master = device->master;
+
+    master->idle_irq_event = 1;
+    wake_up_interruptible(&master->idle_irq_queue);
+}
+
+/*****************************************************************************/
+
 /** \cond */
 
 EXPORT_SYMBOL(ecdev_withdraw);
+EXPORT_SYMBOL(ecdev_set_irq_func);
+EXPORT_SYMBOL(ecdev_set_flush_func);
 EXPORT_SYMBOL(ecdev_open);
 EXPORT_SYMBOL(ecdev_close);
 EXPORT_SYMBOL(ecdev_receive);
 EXPORT_SYMBOL(ecdev_get_link);
 EXPORT_SYMBOL(ecdev_set_link);
+EXPORT_SYMBOL(ecdev_irq);
 
 /** \endcond */
 
@@ -41,6 +41,7 @@
 
 #include "../devices/ecdev.h"
 #include "globals.h"
+#include "capture.h"
 
 /**
  * Size of the transmit ring.
@@ -83,6 +84,10 @@ struct ec_device
     ec_master_t *master; /**< EtherCAT master */
     struct net_device *dev; /**< pointer to the assigned net_device */
     ec_pollfunc_t poll; /**< pointer to the device's poll function */
+    ec_irqfunc_t irq; /**< pointer to the device's interrupt control
+                        function, or \a NULL */
+    ec_flushfunc_t flush; /**< pointer to the device's transmit flush
+                            function, or \a NULL */
     struct module *module; /**< pointer to the device's owning module */
     uint8_t open; /**< true, if the net_device has been opened */
     uint8_t link_state; /**< device link state */
@@ -108,6 +113,15 @@ struct ec_device
     u64 last_rx_bytes; /**< Number of bytes received of last statistics cycle.
                         */
     u64 tx_errors; /**< Number of transmit errors. */
+    u64 poll_count; /**< Number of device polls. */
+    u64 poll_frames; /**< Number of frames received by all polls. */
+    unsigned int poll_max_frames; /**< Maximum number of frames received by
+                                    a single poll. */
+    u64 flush_count; /**< Number of transmit flushes. */
+    u64 flush_frames; /**< Number of frames started by all flushes. */
+    unsigned int flush_max_frames; /**< Maximum number of frames started by
+                                     a single flush. */
+    unsigned int flush_pending; /**< Frames sent since the last flush. */
     s32 tx_frame_rates[EC_RATE_COUNT]; /**< Transmit rates in frames/s for
                                          different statistics cycle periods.
                                         */
@@ -119,6 +133,7 @@ struct ec_device
     s32 rx_byte_rates[EC_RATE_COUNT]; /**< Receive rates in byte/s for
                                         different statistics cycle periods. */
 
+    ec_capture_t capture; /**< Frame capture ring. */
 #ifdef EC_DEBUG_IF
     ec_debug_t dbg; /**< debug device */
 #endif
@@ -142,8 +157,10 @@ int ec_device_open(ec_device_t *);
 int ec_device_close(ec_device_t *);
 
 void ec_device_poll(ec_device_t *);
+void ec_device_set_irq(ec_device_t *, int);
 uint8_t *ec_device_tx_data(ec_device_t *);
 void ec_device_send(ec_device_t *, size_t);
+void ec_device_flush(ec_device_t *);
 void ec_device_clear_stats(ec_device_t *);
 void ec_device_update_stats(ec_device_t *);
 
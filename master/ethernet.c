@@ -46,6 +46,13 @@
 
 /*****************************************************************************/
 
+#ifndef READ_ONCE
+#define READ_ONCE(x) ACCESS_ONCE(x)
+#define WRITE_ONCE(x, val) (ACCESS_ONCE(x) = (val))
+#endif
+
+/*****************************************************************************/
+
 /** Defines the debug level of EoE processing.
  *
  * 0 = No debug messages.
@@ -56,8 +63,10 @@
 #define EOE_DEBUG_LEVEL 1
 
 /** Size of the EoE tx queue.
+ *
+ * Must be a power of 2.
  */
-#define EC_EOE_TX_QUEUE_SIZE 100
+#define EC_EOE_TX_QUEUE_SIZE 128
 
 /** Number of tries.
  */
@@ -66,6 +75,8 @@
 /*****************************************************************************/
 
 void ec_eoe_flush(ec_eoe_t *);
+static struct sk_buff *ec_eoe_tx_dequeue(ec_eoe_t *);
+static void ec_eoe_tx_done(ec_eoe_t *);
 
 // state functions
 void ec_eoe_state_rx_start(ec_eoe_t *);
@@ -140,19 +151,20 @@ int ec_eoe_init(
 
     eoe->slave = slave;
 
-    ec_datagram_init(&eoe->datagram);
-    eoe->queue_datagram = 0;
-    eoe->state = ec_eoe_state_rx_start;
+    ec_datagram_init(&eoe->rx_datagram);
+    eoe->rx_queue_datagram = 0;
+    eoe->rx_state = ec_eoe_state_rx_start;
+    ec_datagram_init(&eoe->tx_datagram);
+    eoe->tx_queue_datagram = 0;
+    eoe->tx_state = ec_eoe_state_tx_start;
     eoe->opened = 0;
+    eoe->tx_flush_request = 0;
     eoe->rx_skb = NULL;
     eoe->rx_expected_fragment = 0;
-    INIT_LIST_HEAD(&eoe->tx_queue);
-    eoe->tx_frame = NULL;
-    eoe->tx_queue_active = 0;
+    eoe->tx_skb = NULL;
     eoe->tx_queue_size = EC_EOE_TX_QUEUE_SIZE;
-    eoe->tx_queued_frames = 0;
-
-    sema_init(&eoe->tx_queue_sem, 1);
+    eoe->tx_ring_write = 0;
+    eoe->tx_ring_read = 0;
     eoe->tx_frame_number = 0xFF;
     memset(&eoe->stats, 0, sizeof(struct net_device_stats));
 
@@ -174,7 +186,16 @@ int ec_eoe_init(
                 "eoe%us%u", slave->master->index, slave->ring_position);
     }
 
-    snprintf(eoe->datagram.name, EC_DATAGRAM_NAME_SIZE, name);
+    snprintf(eoe->rx_datagram.name, EC_DATAGRAM_NAME_SIZE, name);
+    snprintf(eoe->tx_datagram.name, EC_DATAGRAM_NAME_SIZE, name);
+
+    eoe->tx_ring = kmalloc(eoe->tx_queue_size * sizeof(struct sk_buff *),
+            GFP_KERNEL);
+    if (!eoe->tx_ring) {
+        EC_SLAVE_ERR(slave, "Failed to allocate EoE transmit ring.\n");
+        ret = -ENOMEM;
+        goto out_return;
+    }
 
 #if (LINUX_VERSION_CODE < KERNEL_VERSION(3, 17, 0)) 
     eoe->dev = alloc_netdev(sizeof(ec_eoe_t *), name, ether_setup);
@@ -185,7 +206,7 @@ int ec_eoe_init(
         EC_SLAVE_ERR(slave, "Unable to allocate net_device %s"
                 " for EoE handler!\n", name);
         ret = -ENODEV;
-        goto out_return;
+        goto out_free_ring;
     }
 
     // initialize net_device
@@ -283,6 +304,9 @@ int ec_eoe_init(
  out_free:
     free_netdev(eoe->dev);
     eoe->dev = NULL;
+ out_free_ring:
+    kfree(eoe->tx_ring);
+    eoe->tx_ring = NULL;
  out_return:
     return ret;
 }
@@ -299,38 +323,105 @@ void ec_eoe_clear(ec_eoe_t *eoe /**< EoE handler */)
 
     // empty transmit queue
     ec_eoe_flush(eoe);
-
-    if (eoe->tx_frame) {
-        dev_kfree_skb(eoe->tx_frame->skb);
-        kfree(eoe->tx_frame);
-    }
+    kfree(eoe->tx_ring);
 
     if (eoe->rx_skb)
         dev_kfree_skb(eoe->rx_skb);
 
     free_netdev(eoe->dev);
 
-    ec_datagram_clear(&eoe->datagram);
+    ec_datagram_clear(&eoe->rx_datagram);
+    ec_datagram_clear(&eoe->tx_datagram);
 }
 
 /*****************************************************************************/
 
 /** Empties the transmit queue.
+ *
+ * Acts as the consumer of the transmit ring, so it must only be called from
+ * the EoE processing context, or while it is not running. A frame being sent
+ * is dropped as well, and the transmit state machine starts over.
  */
 void ec_eoe_flush(ec_eoe_t *eoe /**< EoE handler */)
 {
-    ec_eoe_frame_t *frame, *next;
+    struct sk_buff *skb;
+
+    if (eoe->tx_skb) {
+        dev_kfree_skb(eoe->tx_skb);
+        eoe->tx_skb = NULL;
+    }
+
+    eoe->tx_state = ec_eoe_state_tx_start;
+    eoe->tx_queue_datagram = 0;
+    eoe->tx_offset = 0;
+    eoe->tx_fragment_number = 0;
+
+    while ((skb = ec_eoe_tx_dequeue(eoe))) {
+        dev_kfree_skb(skb);
+    }
+}
+
+/*****************************************************************************/
+
+/** Returns the number of frames in the transmit ring.
+ *
+ * Both indices run freely, so the difference is valid across wrap-arounds.
+ *
+ * \return Number of queued frames.
+ */
+unsigned int ec_eoe_tx_queued_frames(
+        const ec_eoe_t *eoe /**< EoE handler */
+        )
+{
+    return READ_ONCE(eoe->tx_ring_write) - READ_ONCE(eoe->tx_ring_read);
+}
 
-    down(&eoe->tx_queue_sem);
+/*****************************************************************************/
 
-    list_for_each_entry_safe(frame, next, &eoe->tx_queue, queue) {
-        list_del(&frame->queue);
-        dev_kfree_skb(frame->skb);
-        kfree(frame);
+/** Takes the next frame out of the transmit ring (consumer side).
+ *
+ * Wakes the net_device queue, if it was stopped and the ring has drained to
+ * half its size.
+ *
+ * \return Socket buffer, or \a NULL if the ring is empty.
+ */
+static struct sk_buff *ec_eoe_tx_dequeue(
+        ec_eoe_t *eoe /**< EoE handler */
+        )
+{
+    unsigned int read = eoe->tx_ring_read;
+    struct sk_buff *skb;
+
+    if (read == READ_ONCE(eoe->tx_ring_write)) {
+        return NULL;
     }
-    eoe->tx_queued_frames = 0;
 
-    up(&eoe->tx_queue_sem);
+    smp_rmb(); // write index before slot contents
+    skb = eoe->tx_ring[read & (eoe->tx_queue_size - 1)];
+
+    smp_mb(); // slot read before it is handed back to the producer
+    WRITE_ONCE(eoe->tx_ring_read, read + 1);
+
+    if (unlikely(netif_queue_stopped(eoe->dev)) && eoe->opened &&
+            ec_eoe_tx_queued_frames(eoe) <= eoe->tx_queue_size / 2) {
+        netif_wake_queue(eoe->dev);
+#if EOE_DEBUG_LEVEL >= 2
+        EC_SLAVE_DBG(eoe->slave, 0, "EoE %s waking up TX queue...\n",
+                eoe->dev->name);
+#endif
+    }
+
+    return skb;
+}
+
+/*****************************************************************************/
+
+/** Releases the current transmit frame.
+ */
+static void ec_eoe_tx_done(ec_eoe_t *eoe /**< EoE handler */)
+{
+    dev_kfree_skb(eoe->tx_skb);
+    eoe->tx_skb = NULL;
 }
 
 /*****************************************************************************/
@@ -348,7 +439,7 @@ int ec_eoe_send(ec_eoe_t *eoe /**< EoE handler */)
     unsigned int i;
 #endif
 
-    remaining_size = eoe->tx_frame->skb->len - eoe->tx_offset;
+    remaining_size = eoe->tx_skb->len - eoe->tx_offset;
 
     if (remaining_size <= eoe->slave->configured_tx_mailbox_size - 10) {
         current_size = remaining_size;
@@ -372,13 +463,13 @@ int ec_eoe_send(ec_eoe_t *eoe /**< EoE handler */)
             " with %u octets (%u). %u frames queued.\n",
             eoe->dev->name, eoe->tx_fragment_number,
             last_fragment ? "" : "+", current_size, complete_offset,
-            eoe->tx_queued_frames);
+            ec_eoe_tx_queued_frames(eoe));
 #endif
 
 #if EOE_DEBUG_LEVEL >= 3
     EC_SLAVE_DBG(master, 0, "");
     for (i = 0; i < current_size; i++) {
-        printk("%02X ", eoe->tx_frame->skb->data[eoe->tx_offset + i]);
+        printk("%02X ", eoe->tx_skb->data[eoe->tx_offset + i]);
         if ((i + 1) % 16 == 0) {
             printk("\n");
             EC_SLAVE_DBG(master, 0, "");
@@ -387,7 +478,7 @@ int ec_eoe_send(ec_eoe_t *eoe /**< EoE handler */)
     printk("\n");
 #endif
 
-    data = ec_slave_mbox_prepare_send(eoe->slave, &eoe->datagram,
+    data = ec_slave_mbox_prepare_send(eoe->slave, &eoe->tx_datagram,
             EC_MBOX_TYPE_EOE, current_size + 4);
     if (IS_ERR(data))
         return PTR_ERR(data);
@@ -398,8 +489,8 @@ int ec_eoe_send(ec_eoe_t *eoe /**< EoE handler */)
                             (complete_offset & 0x3F) << 6 |
                             (eoe->tx_frame_number & 0x0F) << 12));
 
-    memcpy(data + 4, eoe->tx_frame->skb->data + eoe->tx_offset, current_size);
-    eoe->queue_datagram = 1;
+    memcpy(data + 4, eoe->tx_skb->data + eoe->tx_offset, current_size);
+    eoe->tx_queue_datagram = 1;
 
     eoe->tx_offset += current_size;
     eoe->tx_fragment_number++;
@@ -412,15 +503,34 @@ int ec_eoe_send(ec_eoe_t *eoe /**< EoE handler */)
  */
 void ec_eoe_run(ec_eoe_t *eoe /**< EoE handler */)
 {
-    if (!eoe->opened)
-        return;
+    if (unlikely(READ_ONCE(eoe->tx_flush_request))) {
+        // drop frames queued before the device was stopped, even if it has
+        // been opened again in the meantime
+        WRITE_ONCE(eoe->tx_flush_request, 0);
+        smp_mb(); // clear the request before reading the ring
+        ec_eoe_flush(eoe);
+    }
 
-    // if the datagram was not sent, or is not yet received, skip this cycle
-    if (eoe->queue_datagram || eoe->datagram.state == EC_DATAGRAM_SENT)
+    if (!eoe->opened) {
+        // drop frames queued before the device was stopped
+        if (eoe->tx_skb || ec_eoe_tx_queued_frames(eoe))
+            ec_eoe_flush(eoe);
         return;
+    }
+
+    // The receive and transmit state machines use separate datagrams, so
+    // that a mailbox read and a mailbox write can be in flight at the same
+    // time. Each one is skipped, while its datagram was not sent, or is not
+    // yet received.
+    if (!eoe->rx_queue_datagram &&
+            eoe->rx_datagram.state != EC_DATAGRAM_SENT) {
+        eoe->rx_state(eoe);
+    }
 
-    // call state function
-    eoe->state(eoe);
+    if (!eoe->tx_queue_datagram &&
+            eoe->tx_datagram.state != EC_DATAGRAM_SENT) {
+        eoe->tx_state(eoe);
+    }
 
     // update statistics
     if (jiffies - eoe->rate_jiffies > HZ) {
@@ -431,19 +541,74 @@ void ec_eoe_run(ec_eoe_t *eoe /**< EoE handler */)
         eoe->rate_jiffies = jiffies;
     }
 
-    ec_datagram_output_stats(&eoe->datagram);
+    ec_datagram_output_stats(&eoe->rx_datagram);
+    ec_datagram_output_stats(&eoe->tx_datagram);
+}
+
+/*****************************************************************************/
+
+/** Queues a datagram, if necessary and if it fits into the budget.
+ *
+ * \return Non-zero, if the datagram had to be deferred.
+ */
+static int ec_eoe_queue_datagram(
+        ec_eoe_t *eoe, /**< EoE handler */
+        ec_datagram_t *datagram, /**< Datagram to queue. */
+        unsigned int *queue_datagram, /**< Datagram ready for queuing. */
+        size_t *budget /**< Remaining bytes that may be queued. */
+        )
+{
+    if (!*queue_datagram) {
+        return 0;
+    }
+
+    if (datagram->data_size > *budget) {
+        return 1;
+    }
+
+    if (eoe->slave->master->eoe_cycle_running) {
+        // called from the application cycle
+        ec_master_queue_datagram(eoe->slave->master, datagram);
+    } else {
+        ec_master_queue_datagram_ext(eoe->slave->master, datagram);
+    }
+    *queue_datagram = 0;
+    *budget -= datagram->data_size;
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Queues the datagrams, if necessary.
+ *
+ * Datagrams that do not fit into the remaining \a budget stay pending and
+ * are queued by a later call.
+ *
+ * \return Non-zero, if a datagram had to be deferred.
+ */
+int ec_eoe_queue(
+        ec_eoe_t *eoe, /**< EoE handler */
+        size_t *budget /**< Remaining bytes that may be queued. */
+        )
+{
+    int deferred;
+
+    deferred = ec_eoe_queue_datagram(eoe, &eoe->tx_datagram,
+            &eoe->tx_queue_datagram, budget);
+    deferred |= ec_eoe_queue_datagram(eoe, &eoe->rx_datagram,
+            &eoe->rx_queue_datagram, budget);
+    return deferred;
 }
 
 /*****************************************************************************/
 
-/** Queues the datagram, if necessary.
+/** Returns, if the handler has datagrams ready for queuing.
+ *
+ * \return Non-zero, if a datagram is pending.
  */
-void ec_eoe_queue(ec_eoe_t *eoe /**< EoE handler */)
+int ec_eoe_has_datagrams(const ec_eoe_t *eoe /**< EoE handler */)
 {
-   if (eoe->queue_datagram) {
-       ec_master_queue_datagram_ext(eoe->slave->master, &eoe->datagram);
-       eoe->queue_datagram = 0;
-   }
+    return eoe->rx_queue_datagram || eoe->tx_queue_datagram;
 }
 
 /*****************************************************************************/
@@ -489,9 +654,9 @@ void ec_eoe_state_rx_start(ec_eoe_t *eoe /**< EoE handler */)
         return;
     }
 
-    ec_slave_mbox_prepare_check(eoe->slave, &eoe->datagram);
-    eoe->queue_datagram = 1;
-    eoe->state = ec_eoe_state_rx_check;
+    ec_slave_mbox_prepare_check(eoe->slave, &eoe->rx_datagram);
+    eoe->rx_queue_datagram = 1;
+    eoe->rx_state = ec_eoe_state_rx_check;
 }
 
 /*****************************************************************************/
@@ -503,26 +668,26 @@ void ec_eoe_state_rx_start(ec_eoe_t *eoe /**< EoE handler */)
  */
 void ec_eoe_state_rx_check(ec_eoe_t *eoe /**< EoE handler */)
 {
-    if (eoe->datagram.state != EC_DATAGRAM_RECEIVED) {
+    if (eoe->rx_datagram.state != EC_DATAGRAM_RECEIVED) {
         eoe->stats.rx_errors++;
 #if EOE_DEBUG_LEVEL >= 1
         EC_SLAVE_WARN(eoe->slave, "Failed to receive mbox"
                 " check datagram for %s.\n", eoe->dev->name);
 #endif
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
-    if (!ec_slave_mbox_check(&eoe->datagram)) {
+    if (!ec_slave_mbox_check(&eoe->rx_datagram)) {
         eoe->rx_idle = 1;
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
     eoe->rx_idle = 0;
-    ec_slave_mbox_prepare_fetch(eoe->slave, &eoe->datagram);
-    eoe->queue_datagram = 1;
-    eoe->state = ec_eoe_state_rx_fetch;
+    ec_slave_mbox_prepare_fetch(eoe->slave, &eoe->rx_datagram);
+    eoe->rx_queue_datagram = 1;
+    eoe->rx_state = ec_eoe_state_rx_fetch;
 }
 
 /*****************************************************************************/
@@ -545,17 +710,17 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
     unsigned int i;
 #endif
 
-    if (eoe->datagram.state != EC_DATAGRAM_RECEIVED) {
+    if (eoe->rx_datagram.state != EC_DATAGRAM_RECEIVED) {
         eoe->stats.rx_errors++;
 #if EOE_DEBUG_LEVEL >= 1
         EC_SLAVE_WARN(eoe->slave, "Failed to receive mbox"
                 " fetch datagram for %s.\n", eoe->dev->name);
 #endif
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
-    data = ec_slave_mbox_fetch(eoe->slave, &eoe->datagram,
+    data = ec_slave_mbox_fetch(eoe->slave, &eoe->rx_datagram,
             &mbox_prot, &rec_size);
     if (IS_ERR(data)) {
         eoe->stats.rx_errors++;
@@ -563,7 +728,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
         EC_SLAVE_WARN(eoe->slave, "Invalid mailbox response for %s.\n",
                 eoe->dev->name);
 #endif
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
@@ -573,7 +738,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
         EC_SLAVE_WARN(eoe->slave, "Other mailbox protocol response for %s.\n",
                 eoe->dev->name);
 #endif
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
@@ -585,7 +750,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
                 " Dropping.\n", eoe->dev->name);
 #endif
         eoe->stats.rx_dropped++;
-        eoe->state = ec_eoe_state_tx_start;
+        eoe->rx_state = ec_eoe_state_rx_start;
         return;
     }
 
@@ -633,7 +798,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
                 EC_SLAVE_WARN(eoe->slave, "EoE RX low on mem,"
                         " frame dropped.\n");
             eoe->stats.rx_dropped++;
-            eoe->state = ec_eoe_state_tx_start;
+            eoe->rx_state = ec_eoe_state_rx_start;
             return;
         }
 
@@ -644,7 +809,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
     else {
         if (!eoe->rx_skb) {
             eoe->stats.rx_dropped++;
-            eoe->state = ec_eoe_state_tx_start;
+            eoe->rx_state = ec_eoe_state_rx_start;
             return;
         }
 
@@ -659,7 +824,7 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
             EC_SLAVE_WARN(eoe->slave, "Fragmenting error at %s.\n",
                     eoe->dev->name);
 #endif
-            eoe->state = ec_eoe_state_tx_start;
+            eoe->rx_state = ec_eoe_state_rx_start;
             return;
         }
     }
@@ -687,8 +852,6 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
             EC_SLAVE_WARN(eoe->slave, "EoE RX netif_rx failed.\n");
         }
         eoe->rx_skb = NULL;
-
-        eoe->state = ec_eoe_state_tx_start;
     }
     else {
         eoe->rx_expected_fragment++;
@@ -696,25 +859,22 @@ void ec_eoe_state_rx_fetch(ec_eoe_t *eoe /**< EoE handler */)
         EC_SLAVE_DBG(eoe->slave, 0, "EoE %s RX expecting fragment %u\n",
                eoe->dev->name, eoe->rx_expected_fragment);
 #endif
-        eoe->state = ec_eoe_state_rx_start;
     }
+
+    // check for the next fragment right away
+    ec_eoe_state_rx_start(eoe);
 }
 
 /*****************************************************************************/
 
 /** State: TX START.
  *
- * Starts a new transmit sequence. If no data is available, a new receive
- * sequence is started instead.
+ * Starts a new transmit sequence, if data is available.
  *
  * \todo Use both devices.
  */
 void ec_eoe_state_tx_start(ec_eoe_t *eoe /**< EoE handler */)
 {
-#if EOE_DEBUG_LEVEL >= 2
-    unsigned int wakeup = 0;
-#endif
-
     if (eoe->slave->error_flag ||
             !eoe->slave->master->devices[EC_DEVICE_MAIN].link_state) {
         eoe->rx_idle = 1;
@@ -722,32 +882,14 @@ void ec_eoe_state_tx_start(ec_eoe_t *eoe /**< EoE handler */)
         return;
     }
 
-    down(&eoe->tx_queue_sem);
-
-    if (!eoe->tx_queued_frames || list_empty(&eoe->tx_queue)) {
-        up(&eoe->tx_queue_sem);
-        eoe->tx_idle = 1;
+    // take the first frame out of the queue
+    eoe->tx_skb = ec_eoe_tx_dequeue(eoe);
+    if (!eoe->tx_skb) {
         // no data available.
-        // start a new receive immediately.
-        ec_eoe_state_rx_start(eoe);
+        eoe->tx_idle = 1;
         return;
     }
 
-    // take the first frame out of the queue
-    eoe->tx_frame = list_entry(eoe->tx_queue.next, ec_eoe_frame_t, queue);
-    list_del(&eoe->tx_frame->queue);
-    if (!eoe->tx_queue_active &&
-        eoe->tx_queued_frames == eoe->tx_queue_size / 2) {
-        netif_wake_queue(eoe->dev);
-        eoe->tx_queue_active = 1;
-#if EOE_DEBUG_LEVEL >= 2
-        wakeup = 1;
-#endif
-    }
-
-    eoe->tx_queued_frames--;
-    up(&eoe->tx_queue_sem);
-
     eoe->tx_idle = 0;
 
     eoe->tx_frame_number++;
@@ -756,25 +898,17 @@ void ec_eoe_state_tx_start(ec_eoe_t *eoe /**< EoE handler */)
     eoe->tx_offset = 0;
 
     if (ec_eoe_send(eoe)) {
-        dev_kfree_skb(eoe->tx_frame->skb);
-        kfree(eoe->tx_frame);
-        eoe->tx_frame = NULL;
+        ec_eoe_tx_done(eoe);
         eoe->stats.tx_errors++;
-        eoe->state = ec_eoe_state_rx_start;
+        eoe->tx_state = ec_eoe_state_tx_start;
 #if EOE_DEBUG_LEVEL >= 1
         EC_SLAVE_WARN(eoe->slave, "Send error at %s.\n", eoe->dev->name);
 #endif
         return;
     }
 
-#if EOE_DEBUG_LEVEL >= 2
-    if (wakeup)
-        EC_SLAVE_DBG(eoe->slave, 0, "EoE %s waking up TX queue...\n",
-                eoe->dev->name);
-#endif
-
     eoe->tries = EC_EOE_TRIES;
-    eoe->state = ec_eoe_state_tx_sent;
+    eoe->tx_state = ec_eoe_state_tx_sent;
 }
 
 /*****************************************************************************/
@@ -786,10 +920,10 @@ void ec_eoe_state_tx_start(ec_eoe_t *eoe /**< EoE handler */)
  */
 void ec_eoe_state_tx_sent(ec_eoe_t *eoe /**< EoE handler */)
 {
-    if (eoe->datagram.state != EC_DATAGRAM_RECEIVED) {
+    if (eoe->tx_datagram.state != EC_DATAGRAM_RECEIVED) {
         if (eoe->tries) {
             eoe->tries--; // try again
-            eoe->queue_datagram = 1;
+            eoe->tx_queue_datagram = 1;
         } else {
             eoe->stats.tx_errors++;
 #if EOE_DEBUG_LEVEL >= 1
@@ -797,15 +931,15 @@ void ec_eoe_state_tx_sent(ec_eoe_t *eoe /**< EoE handler */)
                     " datagram for %s after %u tries.\n",
                     eoe->dev->name, EC_EOE_TRIES);
 #endif
-            eoe->state = ec_eoe_state_rx_start;
+            eoe->tx_state = ec_eoe_state_tx_start;
         }
         return;
     }
 
-    if (eoe->datagram.working_counter != 1) {
+    if (eoe->tx_datagram.working_counter != 1) {
         if (eoe->tries) {
             eoe->tries--; // try again
-            eoe->queue_datagram = 1;
+            eoe->tx_queue_datagram = 1;
         } else {
             eoe->stats.tx_errors++;
 #if EOE_DEBUG_LEVEL >= 1
@@ -813,31 +947,28 @@ void ec_eoe_state_tx_sent(ec_eoe_t *eoe /**< EoE handler */)
                     " for %s after %u tries.\n",
                     eoe->dev->name, EC_EOE_TRIES);
 #endif
-            eoe->state = ec_eoe_state_rx_start;
+            eoe->tx_state = ec_eoe_state_tx_start;
         }
         return;
     }
 
     // frame completely sent
-    if (eoe->tx_offset >= eoe->tx_frame->skb->len) {
+    if (eoe->tx_offset >= eoe->tx_skb->len) {
         eoe->stats.tx_packets++;
-        eoe->stats.tx_bytes += eoe->tx_frame->skb->len;
-        eoe->tx_counter += eoe->tx_frame->skb->len;
-        dev_kfree_skb(eoe->tx_frame->skb);
-        kfree(eoe->tx_frame);
-        eoe->tx_frame = NULL;
-        eoe->state = ec_eoe_state_rx_start;
+        eoe->stats.tx_bytes += eoe->tx_skb->len;
+        eoe->tx_counter += eoe->tx_skb->len;
+        ec_eoe_tx_done(eoe);
+        // continue with the next frame right away
+        ec_eoe_state_tx_start(eoe);
     }
     else { // send next fragment
         if (ec_eoe_send(eoe)) {
-            dev_kfree_skb(eoe->tx_frame->skb);
-            kfree(eoe->tx_frame);
-            eoe->tx_frame = NULL;
+            ec_eoe_tx_done(eoe);
             eoe->stats.tx_errors++;
 #if EOE_DEBUG_LEVEL >= 1
             EC_SLAVE_WARN(eoe->slave, "Send error at %s.\n", eoe->dev->name);
 #endif
-            eoe->state = ec_eoe_state_rx_start;
+            eoe->tx_state = ec_eoe_state_tx_start;
         }
     }
 }
@@ -853,12 +984,10 @@ void ec_eoe_state_tx_sent(ec_eoe_t *eoe /**< EoE handler */)
 int ec_eoedev_open(struct net_device *dev /**< EoE net_device */)
 {
     ec_eoe_t *eoe = *((ec_eoe_t **) netdev_priv(dev));
-    ec_eoe_flush(eoe);
     eoe->opened = 1;
     eoe->rx_idle = 0;
     eoe->tx_idle = 0;
     netif_start_queue(dev);
-    eoe->tx_queue_active = 1;
 #if EOE_DEBUG_LEVEL >= 2
     EC_SLAVE_DBG(eoe->slave, 0, "%s opened.\n", dev->name);
 #endif
@@ -878,9 +1007,11 @@ int ec_eoedev_stop(struct net_device *dev /**< EoE net_device */)
     netif_stop_queue(dev);
     eoe->rx_idle = 1;
     eoe->tx_idle = 1;
-    eoe->tx_queue_active = 0;
     eoe->opened = 0;
-    ec_eoe_flush(eoe);
+    // the transmit queue is emptied by ec_eoe_run(), the only consumer, on
+    // its next call, which may also be after the device was opened again
+    smp_wmb(); // queue stopped before the request
+    WRITE_ONCE(eoe->tx_flush_request, 1);
 #if EOE_DEBUG_LEVEL >= 2
     EC_SLAVE_DBG(eoe->slave, 0, "%s stopped.\n", dev->name);
 #endif
@@ -899,7 +1030,7 @@ int ec_eoedev_tx(struct sk_buff *skb, /**< transmit socket buffer */
                 )
 {
     ec_eoe_t *eoe = *((ec_eoe_t **) netdev_priv(dev));
-    ec_eoe_frame_t *frame;
+    unsigned int write = eoe->tx_ring_write;
 
 #if 0
     if (skb->len > eoe->slave->configured_tx_mailbox_size - 10) {
@@ -911,33 +1042,35 @@ int ec_eoedev_tx(struct sk_buff *skb, /**< transmit socket buffer */
     }
 #endif
 
-    if (!(frame =
-          (ec_eoe_frame_t *) kmalloc(sizeof(ec_eoe_frame_t), GFP_ATOMIC))) {
-        if (printk_ratelimit())
-            EC_SLAVE_WARN(eoe->slave, "EoE TX: low on mem. frame dropped.\n");
-        return 1;
+    if (unlikely(write - READ_ONCE(eoe->tx_ring_read)
+                >= eoe->tx_queue_size)) {
+        // should not happen, as the queue is stopped when the ring is full
+        netif_stop_queue(dev);
+        return NETDEV_TX_BUSY;
     }
 
-    frame->skb = skb;
+    eoe->tx_ring[write & (eoe->tx_queue_size - 1)] = skb;
+    smp_wmb(); // slot contents before write index
+    WRITE_ONCE(eoe->tx_ring_write, write + 1);
 
-    down(&eoe->tx_queue_sem);
-    list_add_tail(&frame->queue, &eoe->tx_queue);
-    eoe->tx_queued_frames++;
-    if (eoe->tx_queued_frames == eoe->tx_queue_size) {
+    if (ec_eoe_tx_queued_frames(eoe) == eoe->tx_queue_size) {
         netif_stop_queue(dev);
-        eoe->tx_queue_active = 0;
+        smp_mb(); // stopped state before re-reading the read index
+        // the consumer may have drained the ring in the meantime
+        if (ec_eoe_tx_queued_frames(eoe) <= eoe->tx_queue_size / 2) {
+            netif_wake_queue(dev);
+        }
     }
-    up(&eoe->tx_queue_sem);
 
 #if EOE_DEBUG_LEVEL >= 2
     EC_SLAVE_DBG(eoe->slave, 0, "EoE %s TX queued frame"
             " with %u octets (%u frames queued).\n",
-            eoe->dev->name, skb->len, eoe->tx_queued_frames);
-    if (!eoe->tx_queue_active)
+            eoe->dev->name, skb->len, ec_eoe_tx_queued_frames(eoe));
+    if (netif_queue_stopped(dev))
         EC_SLAVE_WARN(eoe->slave, "EoE TX queue is now full.\n");
 #endif
 
-    return 0;
+    return NETDEV_TX_OK;
 }
 
 /*****************************************************************************/
@@ -40,12 +40,6 @@
 #include <linux/list.h>
 #include <linux/netdevice.h>
 
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 27)
-#include <linux/semaphore.h>
-#else
-#include <asm/semaphore.h>
-#endif
-
 #include "globals.h"
 #include "slave.h"
 #include "datagram.h"
@@ -64,19 +58,6 @@ enum {
 
 /*****************************************************************************/
 
-/**
-   Queued frame structure.
-*/
-
-typedef struct
-{
-    struct list_head queue; /**< list item */
-    struct sk_buff *skb; /**< socket buffer */
-}
-ec_eoe_frame_t;
-
-/*****************************************************************************/
-
 typedef struct ec_eoe ec_eoe_t; /**< \see ec_eoe */
 
 /**
@@ -89,12 +70,20 @@ struct ec_eoe
 {
     struct list_head list; /**< list item */
     ec_slave_t *slave; /**< pointer to the corresponding slave */
-    ec_datagram_t datagram; /**< datagram */
-    unsigned int queue_datagram; /**< the datagram is ready for queuing */
-    void (*state)(ec_eoe_t *); /**< state function for the state machine */
+    ec_datagram_t rx_datagram; /**< Datagram for mailbox reads. */
+    unsigned int rx_queue_datagram; /**< The receive datagram is ready for
+                                      queuing. */
+    void (*rx_state)(ec_eoe_t *); /**< Receive state function. */
+    ec_datagram_t tx_datagram; /**< Datagram for mailbox writes. */
+    unsigned int tx_queue_datagram; /**< The transmit datagram is ready for
+                                      queuing. */
+    void (*tx_state)(ec_eoe_t *); /**< Transmit state function. */
     struct net_device *dev; /**< net_device for virtual ethernet device */
     struct net_device_stats stats; /**< device statistics */
     unsigned int opened; /**< net_device is opened */
+    unsigned int tx_flush_request; /**< Set when the net_device is stopped,
+                                     the consumer then drops the frames
+                                     queued so far. */
     unsigned long rate_jiffies; /**< time of last rate output */
 
     struct sk_buff *rx_skb; /**< current rx socket buffer */
@@ -105,12 +94,15 @@ struct ec_eoe
     uint32_t rx_rate; /**< receive rate (bps) */
     unsigned int rx_idle; /**< Idle flag. */
 
-    struct list_head tx_queue; /**< queue for frames to send */
-    unsigned int tx_queue_size; /**< Transmit queue size. */
-    unsigned int tx_queue_active; /**< kernel netif queue started */
-    unsigned int tx_queued_frames; /**< number of frames in the queue */
-    struct semaphore tx_queue_sem; /**< Semaphore for the send queue. */
-    ec_eoe_frame_t *tx_frame; /**< current TX frame */
+    struct sk_buff **tx_ring; /**< Ring of frames to send. Filled by the
+                                net_device (single producer), emptied by
+                                the EoE state machine (single consumer). */
+    unsigned int tx_queue_size; /**< Transmit queue size (power of 2). */
+    unsigned int tx_ring_write; /**< Free-running ring write index. Only
+                                  written by the producer. */
+    unsigned int tx_ring_read; /**< Free-running ring read index. Only
+                                 written by the consumer. */
+    struct sk_buff *tx_skb; /**< current TX frame */
     uint8_t tx_frame_number; /**< number of the transmitted frame */
     uint8_t tx_fragment_number; /**< number of the fragment */
     size_t tx_offset; /**< number of octets sent */
@@ -126,9 +118,11 @@ struct ec_eoe
 int ec_eoe_init(ec_eoe_t *, ec_slave_t *);
 void ec_eoe_clear(ec_eoe_t *);
 void ec_eoe_run(ec_eoe_t *);
-void ec_eoe_queue(ec_eoe_t *);
+int ec_eoe_queue(ec_eoe_t *, size_t *);
+int ec_eoe_has_datagrams(const ec_eoe_t *);
 int ec_eoe_is_open(const ec_eoe_t *);
 int ec_eoe_is_idle(const ec_eoe_t *);
+unsigned int ec_eoe_tx_queued_frames(const ec_eoe_t *);
 
 /*****************************************************************************/
 
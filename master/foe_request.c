@@ -60,9 +60,14 @@ void ec_foe_request_init(
 {
     INIT_LIST_HEAD(&req->list);
     req->buffer = NULL;
+    req->external_buffer = 0;
     req->file_name = file_name;
     req->buffer_size = 0;
     req->data_size = 0;
+    req->ring_head = 0;
+    req->ring_tail = 0;
+    req->stream_end = 0;
+    req->stream_abort = 0;
     req->dir = EC_DIR_INVALID;
     req->issue_timeout = 0; // no timeout
     req->response_timeout = EC_FOE_REQUEST_RESPONSE_TIMEOUT;
@@ -90,21 +95,26 @@ void ec_foe_request_clear_data(
         ec_foe_request_t *req /**< FoE request. */
         )
 {
-    if (req->buffer) {
+    if (req->buffer && !req->external_buffer) {
         kfree(req->buffer);
-        req->buffer = NULL;
     }
+    req->buffer = NULL;
+    req->external_buffer = 0;
 
     req->buffer_size = 0;
     req->data_size = 0;
+    req->ring_head = 0;
+    req->ring_tail = 0;
+    req->stream_end = 0;
 }
 
 /*****************************************************************************/
 
 /** Pre-allocates the data memory.
  *
- * If the internal \a buffer_size is already bigger than \a size, nothing is
- * done.
+ * If the internal \a buffer_size is already bigger than \a size, only the
+ * ring is emptied. For streamed transfers, \a size is the ring size and not
+ * related to the file size.
  *
  * \return Zero on success, otherwise a negative error code.
  */
@@ -113,7 +123,11 @@ int ec_foe_request_alloc(
         size_t size /**< Data size to allocate. */
         )
 {
-    if (size <= req->buffer_size) {
+    if (size <= req->buffer_size && !req->external_buffer) {
+        req->data_size = 0;
+        req->ring_head = 0;
+        req->ring_tail = 0;
+        req->stream_end = 0;
         return 0;
     }
 
@@ -133,7 +147,8 @@ int ec_foe_request_alloc(
 
 /** Copies FoE data from an external source.
  *
- * If the \a buffer_size is to small, new memory is allocated.
+ * If the \a buffer_size is to small, new memory is allocated. The data form
+ * a completely filled ring, so no further data can be put.
  *
  * \return Zero on success, otherwise a negative error code.
  */
@@ -150,13 +165,184 @@ int ec_foe_request_copy_data(
         return ret;
     }
 
-    memcpy(req->buffer, source, size);
-    req->data_size = size;
+    ec_foe_request_ring_put(req, source, size);
+    req->stream_end = 1;
     return 0;
 }
 
 /*****************************************************************************/
 
+/** Uses external FoE data for writing without copying them.
+ *
+ * The data form a completely filled ring, so the same file image can be
+ * written to several slaves at once. The data are only read and have to stay
+ * valid until the request is finished.
+ */
+void ec_foe_request_use_data(
+        ec_foe_request_t *req, /**< FoE request. */
+        const uint8_t *source, /**< Source data. */
+        size_t size /**< Number of bytes in \a source. */
+        )
+{
+    ec_foe_request_clear_data(req);
+
+    req->buffer = (uint8_t *) source;
+    req->buffer_size = size;
+    req->external_buffer = 1;
+    req->ring_head = size;
+    req->stream_end = 1;
+}
+
+/*****************************************************************************/
+
+/** Returns the number of bytes in the ring.
+ *
+ * \return Number of bytes, the consumer can take.
+ */
+size_t ec_foe_request_ring_fill(
+        const ec_foe_request_t *req /**< FoE request. */
+        )
+{
+    size_t head = READ_ONCE(req->ring_head);
+
+    smp_rmb(); // read data only after the head
+    return head - READ_ONCE(req->ring_tail);
+}
+
+/*****************************************************************************/
+
+/** Returns the number of free bytes in the ring.
+ *
+ * \return Number of bytes, the producer can put.
+ */
+size_t ec_foe_request_ring_space(
+        const ec_foe_request_t *req /**< FoE request. */
+        )
+{
+    size_t tail = READ_ONCE(req->ring_tail);
+
+    smp_mb(); // overwrite data only after the consumer released them
+    return req->buffer_size - (READ_ONCE(req->ring_head) - tail);
+}
+
+/*****************************************************************************/
+
+/** Returns the contiguous free memory at the ring head.
+ *
+ * Called by the producer only. The data are made visible to the consumer
+ * with ec_foe_request_ring_commit().
+ *
+ * \return Pointer to the free memory.
+ */
+uint8_t *ec_foe_request_ring_write_ptr(
+        ec_foe_request_t *req, /**< FoE request. */
+        size_t *size /**< Output: Number of contiguous free bytes. */
+        )
+{
+    size_t index = req->ring_head % req->buffer_size;
+
+    *size = min(ec_foe_request_ring_space(req), req->buffer_size - index);
+    return req->buffer + index;
+}
+
+/*****************************************************************************/
+
+/** Hands data written to the ring over to the consumer.
+ */
+void ec_foe_request_ring_commit(
+        ec_foe_request_t *req, /**< FoE request. */
+        size_t size /**< Number of bytes written. */
+        )
+{
+    smp_wmb(); // publish the data before the head
+    WRITE_ONCE(req->ring_head, req->ring_head + size);
+}
+
+/*****************************************************************************/
+
+/** Returns contiguous data in the ring.
+ *
+ * Called by the consumer only. The data are not removed from the ring until
+ * ec_foe_request_ring_release() is called.
+ *
+ * \return Pointer to the data.
+ */
+const uint8_t *ec_foe_request_ring_read_ptr(
+        const ec_foe_request_t *req, /**< FoE request. */
+        size_t offset, /**< Offset relative to the ring tail. */
+        size_t *size /**< Output: Number of contiguous bytes. */
+        )
+{
+    size_t fill = ec_foe_request_ring_fill(req);
+    size_t index = (req->ring_tail + offset) % req->buffer_size;
+
+    *size = offset < fill ?
+        min(fill - offset, req->buffer_size - index) : 0;
+    return req->buffer + index;
+}
+
+/*****************************************************************************/
+
+/** Removes data from the ring.
+ */
+void ec_foe_request_ring_release(
+        ec_foe_request_t *req, /**< FoE request. */
+        size_t size /**< Number of bytes to remove. */
+        )
+{
+    smp_mb(); // finish reading the data before releasing them
+    WRITE_ONCE(req->ring_tail, req->ring_tail + size);
+}
+
+/*****************************************************************************/
+
+/** Puts data into the ring.
+ *
+ * The caller has to make sure, that there is enough space.
+ */
+void ec_foe_request_ring_put(
+        ec_foe_request_t *req, /**< FoE request. */
+        const uint8_t *source, /**< Source data. */
+        size_t size /**< Number of bytes in \a source. */
+        )
+{
+    size_t done = 0, chunk;
+    uint8_t *ptr;
+
+    while (done < size) {
+        ptr = ec_foe_request_ring_write_ptr(req, &chunk);
+        chunk = min(chunk, size - done);
+        memcpy(ptr, source + done, chunk);
+        done += chunk;
+        ec_foe_request_ring_commit(req, chunk);
+    }
+}
+
+/*****************************************************************************/
+
+/** Copies data from the ring tail without removing them.
+ *
+ * The caller has to make sure, that there are enough data.
+ */
+void ec_foe_request_ring_peek(
+        const ec_foe_request_t *req, /**< FoE request. */
+        uint8_t *target, /**< Target memory. */
+        size_t size /**< Number of bytes to copy. */
+        )
+{
+    size_t done = 0, chunk;
+    const uint8_t *ptr;
+
+    while (done < size) {
+        ptr = ec_foe_request_ring_read_ptr(req, done, &chunk);
+        chunk = min(chunk, size - done);
+        memcpy(target + done, ptr, chunk);
+        done += chunk;
+    }
+}
+
+/*****************************************************************************/
+
 /** Checks, if the timeout was exceeded.
  *
  * \return non-zero if the timeout was exceeded, else zero.
@@ -216,6 +402,7 @@ void ec_foe_request_read(
         )
 {
     req->dir = EC_DIR_INPUT;
+    req->stream_abort = 0;
     req->state = EC_INT_REQUEST_QUEUED;
     req->result = FOE_BUSY;
     req->jiffies_start = jiffies;
@@ -230,6 +417,7 @@ void ec_foe_request_write(
         )
 {
     req->dir = EC_DIR_OUTPUT;
+    req->stream_abort = 0;
     req->state = EC_INT_REQUEST_QUEUED;
     req->result = FOE_BUSY;
     req->jiffies_start = jiffies;
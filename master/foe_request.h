@@ -45,13 +45,38 @@
 
 /*****************************************************************************/
 
+#ifndef READ_ONCE
+#define READ_ONCE(x) ACCESS_ONCE(x)
+#define WRITE_ONCE(x, val) (ACCESS_ONCE(x) = (val))
+#endif
+
+/*****************************************************************************/
+
+/** Size of the ring used to stream FoE data between a file handle and the
+ * slave state machine.
+ */
+#define EC_FOE_STREAM_RING_SIZE 0x10000
+
+/*****************************************************************************/
+
 /** FoE request.
+ *
+ * The data memory is used as a ring: The producer (the requester for
+ * writing, the state machine for reading) puts data at \a ring_head, the
+ * consumer takes it from \a ring_tail. Both positions are free-running, so
+ * files of any size can be transferred with a fixed amount of memory.
  */
 typedef struct {
     struct list_head list; /**< List item. */
-    uint8_t *buffer; /**< Pointer to FoE data. */
+    uint8_t *buffer; /**< Pointer to the FoE data ring. */
+    uint8_t external_buffer; /**< The \a buffer is owned by the requester,
+                               see ec_foe_request_use_data(). */
     size_t buffer_size; /**< Size of FoE data memory. */
-    size_t data_size; /**< Size of FoE data. */
+    size_t data_size; /**< Number of bytes transferred. */
+    size_t ring_head; /**< Number of bytes put into the ring. */
+    size_t ring_tail; /**< Number of bytes taken from the ring. */
+    uint8_t stream_end; /**< The producer has put all data into the ring. */
+    uint8_t stream_abort; /**< The requester has aborted the transfer. */
 
     uint32_t issue_timeout; /**< Maximum time in ms, the processing of the
                               request may take. */
@@ -76,8 +101,19 @@ void ec_foe_request_clear(ec_foe_request_t *);
 
 int ec_foe_request_alloc(ec_foe_request_t *, size_t);
 int ec_foe_request_copy_data(ec_foe_request_t *, const uint8_t *, size_t);
+void ec_foe_request_use_data(ec_foe_request_t *, const uint8_t *, size_t);
 int ec_foe_request_timed_out(const ec_foe_request_t *);
 
+size_t ec_foe_request_ring_fill(const ec_foe_request_t *);
+size_t ec_foe_request_ring_space(const ec_foe_request_t *);
+uint8_t *ec_foe_request_ring_write_ptr(ec_foe_request_t *, size_t *);
+void ec_foe_request_ring_commit(ec_foe_request_t *, size_t);
+const uint8_t *ec_foe_request_ring_read_ptr(const ec_foe_request_t *,
+        size_t, size_t *);
+void ec_foe_request_ring_release(ec_foe_request_t *, size_t);
+void ec_foe_request_ring_put(ec_foe_request_t *, const uint8_t *, size_t);
+void ec_foe_request_ring_peek(const ec_foe_request_t *, uint8_t *, size_t);
+
 void ec_foe_request_write(ec_foe_request_t *);
 void ec_foe_request_read(ec_foe_request_t *);
 
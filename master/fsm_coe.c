@@ -307,6 +307,8 @@ int ec_fsm_coe_check_emergency(
         }
     }
 
+    ec_master_post_emergency(fsm->slave->master, fsm->slave, data + 2);
+
     EC_SLAVE_WARN(fsm->slave, "CoE Emergency Request received:\n"
             "Error code 0x%04X, Error register 0x%02X, data:\n",
             EC_READ_U16(data + 2), EC_READ_U8(data + 4));
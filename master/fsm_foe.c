@@ -88,11 +88,13 @@ void ec_fsm_foe_state_rrq_sent(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_state_ack_check(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_state_ack_read(ec_fsm_foe_t *, ec_datagram_t *);
 
+void ec_fsm_foe_state_data_wait(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_state_data_sent(ec_fsm_foe_t *, ec_datagram_t *);
 
 void ec_fsm_foe_state_data_check(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_state_data_read(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_state_sent_ack(ec_fsm_foe_t *, ec_datagram_t *);
+void ec_fsm_foe_state_space_wait(ec_fsm_foe_t *, ec_datagram_t *);
 
 void ec_fsm_foe_write_start(ec_fsm_foe_t *, ec_datagram_t *);
 void ec_fsm_foe_read_start(ec_fsm_foe_t *, ec_datagram_t *);
@@ -138,7 +140,12 @@ int ec_fsm_foe_exec(
         return datagram_used;
     }
 
-    fsm->state(fsm, datagram);
+    if (fsm->request->stream_abort) {
+        EC_SLAVE_WARN(fsm->slave, "FoE transfer aborted.\n");
+        ec_foe_set_tx_error(fsm, FOE_ABORTED_ERROR);
+    } else {
+        fsm->state(fsm, datagram);
+    }
 
     datagram_used =
         fsm->state != ec_fsm_foe_end && fsm->state != ec_fsm_foe_error;
@@ -176,8 +183,6 @@ void ec_fsm_foe_transfer(
     fsm->request = request;
 
     if (request->dir == EC_DIR_OUTPUT) {
-        fsm->tx_buffer = fsm->request->buffer;
-        fsm->tx_buffer_size = fsm->request->data_size;
         fsm->tx_buffer_offset = 0;
 
         fsm->tx_filename = fsm->request->file_name;
@@ -186,9 +191,6 @@ void ec_fsm_foe_transfer(
         fsm->state = ec_fsm_foe_write_start;
     }
     else {
-        fsm->rx_buffer = fsm->request->buffer;
-        fsm->rx_buffer_size = fsm->request->buffer_size;
-
         fsm->rx_filename = fsm->request->file_name;
         fsm->rx_filename_len = strlen(fsm->rx_filename);
 
@@ -228,25 +230,35 @@ void ec_fsm_foe_end(
 
 /** Sends a file or the next fragment.
  *
- * \return Zero on success, otherwise a negative error code.
+ * The fragment data are taken from the request's ring, but they are only
+ * released on acknowledgement, so that the fragment can be repeated.
+ *
+ * \return Zero on success, 1 if the requester has not provided enough data
+ * for the next fragment yet, otherwise a negative error code.
  */
 int ec_foe_prepare_data_send(
         ec_fsm_foe_t *fsm, /**< Finite state machine. */
         ec_datagram_t *datagram /**< Datagram to use. */
         )
 {
-    size_t remaining_size, current_size;
-    uint8_t *data;
+    size_t remaining_size, current_size, max_size;
+    uint8_t *data, end;
 
-    remaining_size = fsm->tx_buffer_size - fsm->tx_buffer_offset;
+    max_size = fsm->slave->configured_rx_mailbox_size
+        - EC_MBOX_HEADER_SIZE - EC_FOE_HEADER_SIZE;
 
-    if (remaining_size < fsm->slave->configured_tx_mailbox_size
-            - EC_MBOX_HEADER_SIZE - EC_FOE_HEADER_SIZE) {
+    end = READ_ONCE(fsm->request->stream_end);
+    smp_rmb(); // the fill level is final, if the end flag is set
+    remaining_size = ec_foe_request_ring_fill(fsm->request);
+
+    if (remaining_size < max_size) {
+        if (!end) {
+            return 1;
+        }
         current_size = remaining_size;
         fsm->tx_last_packet = 1;
     } else {
-        current_size = fsm->slave->configured_tx_mailbox_size
-            - EC_MBOX_HEADER_SIZE - EC_FOE_HEADER_SIZE;
+        current_size = max_size;
     }
 
     data = ec_slave_mbox_prepare_send(fsm->slave,
@@ -262,8 +274,8 @@ int ec_foe_prepare_data_send(
             EC_FOE_OPCODE_DATA, fsm->tx_packet_no);
 #endif
 
-    memcpy(data + EC_FOE_HEADER_SIZE,
-            fsm->tx_buffer + fsm->tx_buffer_offset, current_size);
+    ec_foe_request_ring_peek(fsm->request, data + EC_FOE_HEADER_SIZE,
+            current_size);
     fsm->tx_current_size = current_size;
 
     return 0;
@@ -444,13 +456,9 @@ void ec_fsm_foe_state_ack_read(
 #endif
 
     if (opCode == EC_FOE_OPCODE_BUSY) {
-        // slave not ready
-        if (ec_foe_prepare_data_send(fsm, datagram)) {
-            ec_foe_set_tx_error(fsm, FOE_PROT_ERROR);
-            EC_SLAVE_ERR(slave, "Slave is busy.\n");
-            return;
-        }
-        fsm->state = ec_fsm_foe_state_data_sent;
+        // slave not ready, repeat the fragment (its data are still queued)
+        fsm->state = ec_fsm_foe_state_data_wait;
+        fsm->state(fsm, datagram);
         return;
     }
 
@@ -471,17 +479,18 @@ void ec_fsm_foe_state_ack_read(
     if (opCode == EC_FOE_OPCODE_ACK) {
         fsm->tx_packet_no++;
         fsm->tx_buffer_offset += fsm->tx_current_size;
+        ec_foe_request_ring_release(fsm->request, fsm->tx_current_size);
+        fsm->tx_current_size = 0;
+        wake_up_all(&slave->master->request_queue);
 
         if (fsm->tx_last_packet) {
+            fsm->request->data_size = fsm->tx_buffer_offset;
             fsm->state = ec_fsm_foe_end;
             return;
         }
 
-        if (ec_foe_prepare_data_send(fsm, datagram)) {
-            ec_foe_set_tx_error(fsm, FOE_PROT_ERROR);
-            return;
-        }
-        fsm->state = ec_fsm_foe_state_data_sent;
+        fsm->state = ec_fsm_foe_state_data_wait;
+        fsm->state(fsm, datagram); // send immediately, if data are available
         return;
     }
     ec_foe_set_tx_error(fsm, FOE_ACK_ERROR);
@@ -530,6 +539,38 @@ void ec_fsm_foe_state_wrq_sent(
 
 /*****************************************************************************/
 
+/** State: DATA WAIT.
+ *
+ * Waits for the requester to provide the data for the next fragment. The
+ * mailbox state is polled meanwhile, because the datagram must be used.
+ */
+void ec_fsm_foe_state_data_wait(
+        ec_fsm_foe_t *fsm, /**< FoE statemachine. */
+        ec_datagram_t *datagram /**< Datagram to use. */
+        )
+{
+    int ret;
+
+#ifdef DEBUG_FOE
+    EC_SLAVE_DBG(fsm->slave, 0, "%s()\n", __func__);
+#endif
+
+    ret = ec_foe_prepare_data_send(fsm, datagram);
+    if (ret < 0) {
+        ec_foe_set_tx_error(fsm, FOE_PROT_ERROR);
+        return;
+    }
+
+    if (ret > 0) {
+        ec_slave_mbox_prepare_check(fsm->slave, datagram); // can not fail.
+        return;
+    }
+
+    fsm->state = ec_fsm_foe_state_data_sent;
+}
+
+/*****************************************************************************/
+
 /** State: WRQ SENT.
  *
  * Checks is the previous transmit datagram succeded and sends the next
@@ -852,43 +893,37 @@ void ec_fsm_foe_state_data_read(
 
     rec_size -= EC_FOE_HEADER_SIZE;
 
-    if (fsm->rx_buffer_size >= fsm->rx_buffer_offset + rec_size) {
-        memcpy(fsm->rx_buffer + fsm->rx_buffer_offset,
-                data + EC_FOE_HEADER_SIZE, rec_size);
-        fsm->rx_buffer_offset += rec_size;
+    if (rec_size > ec_foe_request_ring_space(fsm->request)) {
+        // space for a full fragment is awaited before fetching
+        EC_SLAVE_ERR(slave, "Data do not fit in receive ring!\n");
+        ec_foe_set_rx_error(fsm, FOE_RX_DATA_ACK_ERROR);
+        return;
     }
 
+    ec_foe_request_ring_put(fsm->request, data + EC_FOE_HEADER_SIZE,
+            rec_size);
+    fsm->rx_buffer_offset += rec_size;
+
     fsm->rx_last_packet =
         (rec_size + EC_MBOX_HEADER_SIZE + EC_FOE_HEADER_SIZE
-         != slave->configured_rx_mailbox_size);
-
-    if (fsm->rx_last_packet ||
-            (slave->configured_rx_mailbox_size - EC_MBOX_HEADER_SIZE
-             - EC_FOE_HEADER_SIZE + fsm->rx_buffer_offset)
-            <= fsm->rx_buffer_size) {
-        // either it was the last packet or a new packet will fit into the
-        // delivered buffer
+         != slave->configured_tx_mailbox_size);
+
+    if (fsm->rx_last_packet) {
 #ifdef DEBUG_FOE
         EC_SLAVE_DBG(fsm->slave, 0, "last_packet=true\n");
 #endif
-        if (ec_foe_prepare_send_ack(fsm, datagram)) {
-            ec_foe_set_rx_error(fsm, FOE_RX_DATA_ACK_ERROR);
-            return;
-        }
-
-        fsm->state = ec_fsm_foe_state_sent_ack;
+        fsm->request->data_size = fsm->rx_buffer_offset;
+        smp_wmb(); // publish the data before the end flag
+        WRITE_ONCE(fsm->request->stream_end, 1);
     }
-    else {
-        // no more data fits into the delivered buffer
-        // ... wait for new read request
-        EC_SLAVE_ERR(slave, "Data do not fit in receive buffer!\n");
-        printk("  rx_buffer_size = %d\n", fsm->rx_buffer_size);
-        printk("rx_buffer_offset = %d\n", fsm->rx_buffer_offset);
-        printk("        rec_size = %zd\n", rec_size);
-        printk(" rx_mailbox_size = %d\n", slave->configured_rx_mailbox_size);
-        printk("  rx_last_packet = %d\n", fsm->rx_last_packet);
-        fsm->request->result = FOE_READY;
+    wake_up_all(&slave->master->request_queue);
+
+    if (ec_foe_prepare_send_ack(fsm, datagram)) {
+        ec_foe_set_rx_error(fsm, FOE_RX_DATA_ACK_ERROR);
+        return;
     }
+
+    fsm->state = ec_fsm_foe_state_sent_ack;
 }
 
 /*****************************************************************************/
@@ -927,18 +962,48 @@ void ec_fsm_foe_state_sent_ack(
 
     if (fsm->rx_last_packet) {
         fsm->rx_expected_packet_no = 0;
-        fsm->request->data_size = fsm->rx_buffer_offset;
         fsm->state = ec_fsm_foe_end;
     }
     else {
         fsm->rx_expected_packet_no++;
         fsm->retries = EC_FSM_RETRIES;
-        fsm->state = ec_fsm_foe_state_data_check;
+        fsm->state = ec_fsm_foe_state_space_wait;
     }
 }
 
 /*****************************************************************************/
 
+/** State: SPACE WAIT.
+ *
+ * Waits for the requester to take enough data from the ring, so that the
+ * next fragment fits in. The slave keeps the fragment in its mailbox
+ * meanwhile.
+ */
+void ec_fsm_foe_state_space_wait(
+        ec_fsm_foe_t *fsm, /**< FoE statemachine. */
+        ec_datagram_t *datagram /**< Datagram to use. */
+        )
+{
+    ec_slave_t *slave = fsm->slave;
+
+#ifdef DEBUG_FOE
+    EC_SLAVE_DBG(fsm->slave, 0, "%s()\n", __func__);
+#endif
+
+    if (ec_foe_request_ring_space(fsm->request) <
+            slave->configured_tx_mailbox_size - EC_MBOX_HEADER_SIZE
+            - EC_FOE_HEADER_SIZE) {
+        ec_slave_mbox_prepare_check(slave, datagram); // can not fail.
+        fsm->jiffies_start = jiffies;
+        return;
+    }
+
+    fsm->state = ec_fsm_foe_state_data_check;
+    fsm->state(fsm, datagram);
+}
+
+/*****************************************************************************/
+
 /** Set an error code and go to the send error state.
  */
 void ec_foe_set_tx_error(
@@ -61,18 +61,15 @@ struct ec_fsm_foe {
     ec_foe_request_t *request; /**< FoE request. */
     uint8_t toggle; /**< Toggle bit for segment commands. */
 
-    uint8_t *tx_buffer; /**< Buffer with data to transmit. */
-    uint32_t tx_buffer_size; /**< Size of data to transmit. */
-    uint32_t tx_buffer_offset; /**< Offset of data to tranmit next. */
+    size_t tx_buffer_offset; /**< Number of bytes acknowledged by the
+                               slave. */
     uint32_t tx_last_packet; /**< Current packet is last one to send. */
     uint32_t tx_packet_no; /**< FoE packet number. */
     uint32_t tx_current_size; /**< Size of current packet to send. */
     uint8_t *tx_filename; /**< Name of file to transmit. */
     uint32_t tx_filename_len; /**< Lenth of transmit file name. */
 
-    uint8_t *rx_buffer; /**< Buffer for received data. */
-    uint32_t rx_buffer_size; /**< Size of receive buffer. */
-    uint32_t rx_buffer_offset; /**< Offset in receive buffer. */
+    size_t rx_buffer_offset; /**< Number of bytes received. */
     uint32_t rx_expected_packet_no; /**< Expected receive packet number. */
     uint32_t rx_last_packet; /**< Current packet is the last to receive. */
     uint8_t *rx_filename; /**< Name of the file to receive. */
@@ -269,9 +269,11 @@ void ec_fsm_master_state_broadcast(
     unsigned int i, size;
     ec_slave_t *slave;
     ec_master_t *master = fsm->master;
+    int changed = 0;
 
     // bus topology change?
     if (datagram->working_counter != fsm->slaves_responding[fsm->dev_idx]) {
+        changed = 1;
         fsm->rescan_required = 1;
         fsm->slaves_responding[fsm->dev_idx] = datagram->working_counter;
         EC_MASTER_INFO(master, "%u slave(s) responding on %s device.\n",
@@ -300,6 +302,10 @@ void ec_fsm_master_state_broadcast(
                                                     next link up. */
         }
     }
+    if (fsm->link_state[fsm->dev_idx] !=
+            master->devices[fsm->dev_idx].link_state) {
+        changed = 1;
+    }
     fsm->link_state[fsm->dev_idx] = master->devices[fsm->dev_idx].link_state;
 
     if (datagram->state == EC_DATAGRAM_RECEIVED &&
@@ -308,6 +314,7 @@ void ec_fsm_master_state_broadcast(
         if (states != fsm->slave_states[fsm->dev_idx]) {
             // slave states changed
             char state_str[EC_STATE_STRING_SIZE];
+            changed = 1;
             fsm->slave_states[fsm->dev_idx] = states;
             ec_state_string(states, state_str, 1);
             EC_MASTER_INFO(master, "Slave states on %s device: %s.\n",
@@ -317,6 +324,11 @@ void ec_fsm_master_state_broadcast(
         fsm->slave_states[fsm->dev_idx] = 0x00;
     }
 
+    if (changed) {
+        // wake processes waiting in ec_ioctl_master_wait()
+        wake_up_interruptible(&master->scan_queue);
+    }
+
     fsm->dev_idx++;
     if (fsm->dev_idx < ec_master_num_devices(master)) {
         // check number of responding slaves on next device
@@ -503,6 +515,7 @@ int ec_fsm_master_action_process_sdo(
 
                 if (ec_sdo_request_timed_out(req)) {
                     req->state = EC_INT_REQUEST_FAILURE;
+                    ec_master_sdo_request_done(master, req);
                     EC_SLAVE_DBG(slave, 1, "Internal SDO request"
                             " timed out.\n");
                     continue;
@@ -510,6 +523,7 @@ int ec_fsm_master_action_process_sdo(
 
                 if (slave->current_state == EC_SLAVE_STATE_INIT) {
                     req->state = EC_INT_REQUEST_FAILURE;
+                    ec_master_sdo_request_done(master, req);
                     continue;
                 }
 
@@ -1521,6 +1535,7 @@ void ec_fsm_master_state_sdo_request(
         EC_SLAVE_DBG(fsm->slave, 1,
                 "Failed to process internal SDO request.\n");
         request->state = EC_INT_REQUEST_FAILURE;
+        ec_master_sdo_request_done(fsm->master, request);
         wake_up_all(&fsm->master->request_queue);
         ec_fsm_master_restart(fsm);
         return;
@@ -1528,6 +1543,7 @@ void ec_fsm_master_state_sdo_request(
 
     // SDO request finished
     request->state = EC_INT_REQUEST_SUCCESS;
+    ec_master_sdo_request_done(fsm->master, request);
     wake_up_all(&fsm->master->request_queue);
 
     EC_SLAVE_DBG(fsm->slave, 1, "Finished internal SDO request.\n");
@@ -99,6 +99,7 @@ void ec_fsm_slave_clear(
 
     if (fsm->reg_request) {
         fsm->reg_request->state = EC_INT_REQUEST_FAILURE;
+        ec_master_reg_request_done(fsm->slave->master, fsm->reg_request);
         wake_up_all(&fsm->slave->master->request_queue);
     }
 
@@ -383,6 +384,7 @@ int ec_fsm_slave_action_process_reg(
         EC_SLAVE_WARN(slave, "Aborting register request,"
                 " slave has error flag set.\n");
         fsm->reg_request->state = EC_INT_REQUEST_FAILURE;
+        ec_master_reg_request_done(slave->master, fsm->reg_request);
         wake_up_all(&slave->master->request_queue);
         fsm->reg_request = NULL;
         fsm->state = ec_fsm_slave_state_idle;
@@ -434,6 +436,7 @@ void ec_fsm_slave_state_reg_request(
                 " request datagram: ");
         ec_datagram_print_state(fsm->datagram);
         reg->state = EC_INT_REQUEST_FAILURE;
+        ec_master_reg_request_done(slave->master, reg);
         wake_up_all(&slave->master->request_queue);
         fsm->reg_request = NULL;
         fsm->state = ec_fsm_slave_state_ready;
@@ -455,6 +458,7 @@ void ec_fsm_slave_state_reg_request(
                 fsm->datagram->working_counter);
     }
 
+    ec_master_reg_request_done(slave->master, reg);
     wake_up_all(&slave->master->request_queue);
     fsm->reg_request = NULL;
     fsm->state = ec_fsm_slave_state_ready;
@@ -93,6 +93,8 @@ void ec_fsm_slave_config_enter_init(ec_fsm_slave_config_t *);
 void ec_fsm_slave_config_enter_clear_sync(ec_fsm_slave_config_t *);
 void ec_fsm_slave_config_enter_dc_clear_assign(ec_fsm_slave_config_t *);
 void ec_fsm_slave_config_enter_mbox_sync(ec_fsm_slave_config_t *);
+void ec_fsm_slave_config_bulk_mbox(ec_fsm_slave_config_t *, uint16_t,
+        uint16_t *, uint16_t, uint16_t *);
 #ifdef EC_SII_ASSIGN
 void ec_fsm_slave_config_enter_assign_pdi(ec_fsm_slave_config_t *);
 #endif
@@ -420,6 +422,40 @@ void ec_fsm_slave_config_state_dc_clear_assign(
 
 /*****************************************************************************/
 
+/** Enlarges the mailbox sizes for bulk transfers, if enabled.
+ *
+ * Bulk mailboxes are only used in BOOT and PREOP, where FoE and CoE
+ * transfers dominate. Any later configuration passes INIT again and restores
+ * the sizes from the SII.
+ */
+void ec_fsm_slave_config_bulk_mbox(
+        ec_fsm_slave_config_t *fsm, /**< slave state machine */
+        uint16_t rx_offset, /**< Receive mailbox offset. */
+        uint16_t *rx_size, /**< Receive mailbox size. */
+        uint16_t tx_offset, /**< Send mailbox offset. */
+        uint16_t *tx_size /**< Send mailbox size. */
+        )
+{
+    ec_slave_t *slave = fsm->slave;
+    uint16_t old_rx_size = *rx_size, old_tx_size = *tx_size;
+
+    if (!slave->master->bulk_mailbox
+            || (slave->requested_state != EC_SLAVE_STATE_BOOT
+                && slave->requested_state != EC_SLAVE_STATE_PREOP)) {
+        return;
+    }
+
+    ec_slave_mbox_bulk_sizes(slave, rx_offset, rx_size, tx_offset, tx_size);
+
+    if (*rx_size != old_rx_size || *tx_size != old_tx_size) {
+        EC_SLAVE_DBG(slave, 1, "Using bulk mailboxes: rx %u -> %u,"
+                " tx %u -> %u bytes.\n", old_rx_size, *rx_size,
+                old_tx_size, *tx_size);
+    }
+}
+
+/*****************************************************************************/
+
 /** Check for mailbox sync managers to be configured.
  */
 void ec_fsm_slave_config_enter_mbox_sync(
@@ -429,6 +465,7 @@ void ec_fsm_slave_config_enter_mbox_sync(
     ec_slave_t *slave = fsm->slave;
     ec_datagram_t *datagram = fsm->datagram;
     unsigned int i;
+    uint16_t rx_size, tx_size;
 
     // slave is now in INIT
     if (slave->current_state == slave->requested_state) {
@@ -454,6 +491,12 @@ void ec_fsm_slave_config_enter_mbox_sync(
     if (slave->requested_state == EC_SLAVE_STATE_BOOT) {
         ec_sync_t sync;
 
+        rx_size = slave->sii.boot_rx_mailbox_size;
+        tx_size = slave->sii.boot_tx_mailbox_size;
+        ec_fsm_slave_config_bulk_mbox(fsm,
+                slave->sii.boot_rx_mailbox_offset, &rx_size,
+                slave->sii.boot_tx_mailbox_offset, &tx_size);
+
         ec_datagram_fpwr(datagram, slave->station_address, 0x0800,
                 EC_SYNC_PAGE_SIZE * 2);
         ec_datagram_zero(datagram);
@@ -462,36 +505,40 @@ void ec_fsm_slave_config_enter_mbox_sync(
         sync.physical_start_address = slave->sii.boot_rx_mailbox_offset;
         sync.control_register = 0x26;
         sync.enable = 1;
-        ec_sync_page(&sync, 0, slave->sii.boot_rx_mailbox_size,
+        ec_sync_page(&sync, 0, rx_size,
                 EC_DIR_INVALID, // use default direction
                 0, // no PDO xfer
                 datagram->data);
         slave->configured_rx_mailbox_offset =
             slave->sii.boot_rx_mailbox_offset;
-        slave->configured_rx_mailbox_size =
-            slave->sii.boot_rx_mailbox_size;
+        slave->configured_rx_mailbox_size = rx_size;
 
         ec_sync_init(&sync, slave);
         sync.physical_start_address = slave->sii.boot_tx_mailbox_offset;
         sync.control_register = 0x22;
         sync.enable = 1;
-        ec_sync_page(&sync, 1, slave->sii.boot_tx_mailbox_size,
+        ec_sync_page(&sync, 1, tx_size,
                 EC_DIR_INVALID, // use default direction
                 0, // no PDO xfer
                 datagram->data + EC_SYNC_PAGE_SIZE);
         slave->configured_tx_mailbox_offset =
             slave->sii.boot_tx_mailbox_offset;
-        slave->configured_tx_mailbox_size =
-            slave->sii.boot_tx_mailbox_size;
+        slave->configured_tx_mailbox_size = tx_size;
 
     } else if (slave->sii.sync_count >= 2) { // mailbox configuration provided
+        rx_size = slave->sii.syncs[0].default_length;
+        tx_size = slave->sii.syncs[1].default_length;
+        ec_fsm_slave_config_bulk_mbox(fsm,
+                slave->sii.syncs[0].physical_start_address, &rx_size,
+                slave->sii.syncs[1].physical_start_address, &tx_size);
+
         ec_datagram_fpwr(datagram, slave->station_address, 0x0800,
                 EC_SYNC_PAGE_SIZE * slave->sii.sync_count);
         ec_datagram_zero(datagram);
 
         for (i = 0; i < 2; i++) {
             ec_sync_page(&slave->sii.syncs[i], i,
-                    slave->sii.syncs[i].default_length,
+                    i ? tx_size : rx_size,
                     NULL, // use default sync manager configuration
                     0, // no PDO xfer
                     datagram->data + EC_SYNC_PAGE_SIZE * i);
@@ -499,18 +546,22 @@ void ec_fsm_slave_config_enter_mbox_sync(
 
         slave->configured_rx_mailbox_offset =
             slave->sii.syncs[0].physical_start_address;
-        slave->configured_rx_mailbox_size =
-            slave->sii.syncs[0].default_length;
+        slave->configured_rx_mailbox_size = rx_size;
         slave->configured_tx_mailbox_offset =
             slave->sii.syncs[1].physical_start_address;
-        slave->configured_tx_mailbox_size =
-            slave->sii.syncs[1].default_length;
+        slave->configured_tx_mailbox_size = tx_size;
     } else { // no mailbox sync manager configurations provided
         ec_sync_t sync;
 
         EC_SLAVE_DBG(slave, 1, "Slave does not provide"
                 " mailbox sync manager configurations.\n");
 
+        rx_size = slave->sii.std_rx_mailbox_size;
+        tx_size = slave->sii.std_tx_mailbox_size;
+        ec_fsm_slave_config_bulk_mbox(fsm,
+                slave->sii.std_rx_mailbox_offset, &rx_size,
+                slave->sii.std_tx_mailbox_offset, &tx_size);
+
         ec_datagram_fpwr(datagram, slave->station_address, 0x0800,
                 EC_SYNC_PAGE_SIZE * 2);
         ec_datagram_zero(datagram);
@@ -519,27 +570,25 @@ void ec_fsm_slave_config_enter_mbox_sync(
         sync.physical_start_address = slave->sii.std_rx_mailbox_offset;
         sync.control_register = 0x26;
         sync.enable = 1;
-        ec_sync_page(&sync, 0, slave->sii.std_rx_mailbox_size,
+        ec_sync_page(&sync, 0, rx_size,
                 NULL, // use default sync manager configuration
                 0, // no PDO xfer
                 datagram->data);
         slave->configured_rx_mailbox_offset =
             slave->sii.std_rx_mailbox_offset;
-        slave->configured_rx_mailbox_size =
-            slave->sii.std_rx_mailbox_size;
+        slave->configured_rx_mailbox_size = rx_size;
 
         ec_sync_init(&sync, slave);
         sync.physical_start_address = slave->sii.std_tx_mailbox_offset;
         sync.control_register = 0x22;
         sync.enable = 1;
-        ec_sync_page(&sync, 1, slave->sii.std_tx_mailbox_size,
+        ec_sync_page(&sync, 1, tx_size,
                 NULL, // use default sync manager configuration
                 0, // no PDO xfer
                 datagram->data + EC_SYNC_PAGE_SIZE);
         slave->configured_tx_mailbox_offset =
             slave->sii.std_tx_mailbox_offset;
-        slave->configured_tx_mailbox_size =
-            slave->sii.std_tx_mailbox_size;
+        slave->configured_tx_mailbox_size = tx_size;
     }
 
     fsm->take_time = 1;
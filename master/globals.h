@@ -220,6 +220,14 @@ typedef enum {
 
 extern const char *ec_device_names[2]; // only main and backup!
 
+/** Master kernel threads.
+ */
+typedef enum {
+    EC_THREAD_MASTER, /**< IDLE or OPERATION thread. */
+    EC_THREAD_EOE, /**< EoE thread. */
+    EC_THREAD_COUNT /**< Number of threads. */
+} ec_thread_index_t;
+
 /*****************************************************************************/
 
 /** Convenience macro for printing EtherCAT-specific information to syslog.
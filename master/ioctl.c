@@ -41,6 +41,7 @@
 #include "slave_config.h"
 #include "voe_handler.h"
 #include "ethernet.h"
+#include "foe.h"
 #include "ioctl.h"
 
 /** Set to 1 to enable ioctl() latency tracing.
@@ -108,6 +109,7 @@ static ATTRIBUTES int ec_ioctl_master(
 {
     ec_ioctl_master_t io;
     unsigned int dev_idx, j;
+    ec_thread_settings_t settings;
 
     if (down_interruptible(&master->master_sem)) {
         return -EINTR;
@@ -147,6 +149,12 @@ static ATTRIBUTES int ec_ioctl_master(
         io.devices[dev_idx].tx_bytes = device->tx_bytes;
         io.devices[dev_idx].rx_bytes = device->rx_bytes;
         io.devices[dev_idx].tx_errors = device->tx_errors;
+        io.devices[dev_idx].poll_count = device->poll_count;
+        io.devices[dev_idx].poll_frames = device->poll_frames;
+        io.devices[dev_idx].poll_max_frames = device->poll_max_frames;
+        io.devices[dev_idx].flush_count = device->flush_count;
+        io.devices[dev_idx].flush_frames = device->flush_frames;
+        io.devices[dev_idx].flush_max_frames = device->flush_max_frames;
         for (j = 0; j < EC_RATE_COUNT; j++) {
             io.devices[dev_idx].tx_frame_rates[j] =
                 device->tx_frame_rates[j];
@@ -183,6 +191,14 @@ static ATTRIBUTES int ec_ioctl_master(
     io.ref_clock =
         master->dc_ref_clock ? master->dc_ref_clock->ring_position : 0xffff;
 
+    for (j = 0; j < EC_THREAD_COUNT; j++) {
+        io.threads[j].running = ec_master_thread_info(master, j, &settings,
+                &io.threads[j].cpu_time);
+        io.threads[j].cpu_mask = settings.cpu_mask;
+        io.threads[j].policy = settings.policy;
+        io.threads[j].priority = settings.priority;
+    }
+
     if (copy_to_user((void __user *) arg, &io, sizeof(io))) {
         return -EFAULT;
     }
@@ -616,6 +632,31 @@ static ATTRIBUTES int ec_ioctl_master_debug(
 
 /*****************************************************************************/
 
+/** Set the CPU affinity and scheduling settings of a master thread.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_master_thread(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg /**< ioctl() argument. */
+        )
+{
+    ec_ioctl_master_thread_t io;
+    ec_thread_settings_t settings;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    settings.cpu_mask = io.cpu_mask;
+    settings.policy = io.policy;
+    settings.priority = io.priority;
+
+    return ec_master_set_thread_settings(master, io.thread, &settings);
+}
+
+/*****************************************************************************/
+
 /** Issue a bus scan.
  *
  * \return Always zero (success).
@@ -1536,7 +1577,7 @@ static ATTRIBUTES int ec_ioctl_eoe_handler(
     data.rx_rate = eoe->tx_rate;
     data.tx_bytes = eoe->stats.rx_bytes;
     data.tx_rate = eoe->tx_rate;
-    data.tx_queued_frames = eoe->tx_queued_frames;
+    data.tx_queued_frames = ec_eoe_tx_queued_frames(eoe);
     data.tx_queue_size = eoe->tx_queue_size;
 
     up(&master->master_sem);
@@ -1838,9 +1879,11 @@ static ATTRIBUTES int ec_ioctl_activate(
 #ifndef EC_IOCTL_RTDM
     ecrt_master_callbacks(master, ec_master_internal_send_cb,
             ec_master_internal_receive_cb, master);
-#endif
 
+    ret = ec_master_activate(master, 1);
+#else
     ret = ecrt_master_activate(master);
+#endif
     if (ret < 0)
         return ret;
 
@@ -3936,257 +3979,1223 @@ static ATTRIBUTES int ec_ioctl_voe_data(
 
 /*****************************************************************************/
 
-/** Read a file from a slave via FoE.
+/** Enables completion notification for an SDO request.
  *
  * \return Zero on success, otherwise a negative error code.
  */
-static ATTRIBUTES int ec_ioctl_slave_foe_read(
+static ATTRIBUTES int ec_ioctl_sdo_request_notify(
         ec_master_t *master, /**< EtherCAT master. */
-        void *arg /**< ioctl() argument. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
         )
 {
-    ec_ioctl_slave_foe_t io;
-    ec_foe_request_t request;
-    ec_slave_t *slave;
-    int ret;
+    ec_ioctl_request_notify_t data;
+    ec_slave_config_t *sc;
+    ec_sdo_request_t *req;
 
-    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
-        return -EFAULT;
-    }
+    if (unlikely(!ctx->requested))
+        return -EPERM;
 
-    ec_foe_request_init(&request, io.file_name);
-    ret = ec_foe_request_alloc(&request, 10000); // FIXME
-    if (ret) {
-        ec_foe_request_clear(&request);
-        return ret;
-    }
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
+        return -EFAULT;
 
-    ec_foe_request_read(&request);
+    /* no locking of master_sem needed, because neither sc nor req will not be
+     * deleted in the meantime. */
 
-    if (down_interruptible(&master->master_sem)) {
-        ec_foe_request_clear(&request);
-        return -EINTR;
+    if (!(sc = ec_master_get_config(master, data.config_index))) {
+        return -ENOENT;
     }
 
-    if (!(slave = ec_master_find_slave(master, 0, io.slave_position))) {
-        up(&master->master_sem);
-        ec_foe_request_clear(&request);
-        EC_MASTER_ERR(master, "Slave %u does not exist!\n",
-                io.slave_position);
-        return -EINVAL;
+    if (!(req = ec_slave_config_find_sdo_request(sc, data.request_index))) {
+        return -ENOENT;
     }
 
-    EC_SLAVE_DBG(slave, 1, "Scheduling FoE read request.\n");
+    return ecrt_sdo_request_notify(req, data.tag);
+}
 
-    // schedule request.
-    list_add_tail(&request.list, &slave->foe_requests);
+/*****************************************************************************/
 
-    up(&master->master_sem);
+/** Enables completion notification for a register request.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_reg_request_notify(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_request_notify_t data;
+    ec_slave_config_t *sc;
+    ec_reg_request_t *reg;
 
-    // wait for processing through FSM
-    if (wait_event_interruptible(master->request_queue,
-                request.state != EC_INT_REQUEST_QUEUED)) {
-        // interrupted by signal
-        down(&master->master_sem);
-        if (request.state == EC_INT_REQUEST_QUEUED) {
-            list_del(&request.list);
-            up(&master->master_sem);
-            ec_foe_request_clear(&request);
-            return -EINTR;
-        }
-        // request already processing: interrupt not possible.
-        up(&master->master_sem);
-    }
+    if (unlikely(!ctx->requested))
+        return -EPERM;
 
-    // wait until master FSM has finished processing
-    wait_event(master->request_queue, request.state != EC_INT_REQUEST_BUSY);
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
+        return -EFAULT;
 
-    io.result = request.result;
-    io.error_code = request.error_code;
+    /* no locking of master_sem needed, because neither sc nor reg will not be
+     * deleted in the meantime. */
 
-    if (request.state != EC_INT_REQUEST_SUCCESS) {
-        io.data_size = 0;
-        ret = -EIO;
-    } else {
-        if (request.data_size > io.buffer_size) {
-            EC_MASTER_ERR(master, "Buffer too small.\n");
-            ec_foe_request_clear(&request);
-            return -EOVERFLOW;
-        }
-        io.data_size = request.data_size;
-        if (copy_to_user((void __user *) io.buffer,
-                    request.buffer, io.data_size)) {
-            ec_foe_request_clear(&request);
-            return -EFAULT;
-        }
-        ret = 0;
+    if (!(sc = ec_master_get_config(master, data.config_index))) {
+        return -ENOENT;
     }
 
-    if (__copy_to_user((void __user *) arg, &io, sizeof(io))) {
-        ret = -EFAULT;
+    if (!(reg = ec_slave_config_find_reg_request(sc, data.request_index))) {
+        return -ENOENT;
     }
 
-    ec_foe_request_clear(&request);
-    return ret;
+    return ecrt_reg_request_notify(reg, data.tag);
 }
 
 /*****************************************************************************/
 
-/** Write a file to a slave via FoE
+/** Enables completion notification for a VoE handler.
  *
  * \return Zero on success, otherwise a negative error code.
  */
-static ATTRIBUTES int ec_ioctl_slave_foe_write(
+static ATTRIBUTES int ec_ioctl_voe_notify(
         ec_master_t *master, /**< EtherCAT master. */
-        void *arg /**< ioctl() argument. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
         )
 {
-    ec_ioctl_slave_foe_t io;
-    ec_foe_request_t request;
-    ec_slave_t *slave;
-    int ret;
+    ec_ioctl_request_notify_t data;
+    ec_slave_config_t *sc;
+    ec_voe_handler_t *voe;
 
-    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+    if (unlikely(!ctx->requested))
+        return -EPERM;
+
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
         return -EFAULT;
-    }
 
-    ec_foe_request_init(&request, io.file_name);
+    /* no locking of master_sem needed, because neither sc nor voe will not be
+     * deleted in the meantime. */
 
-    ret = ec_foe_request_alloc(&request, io.buffer_size);
-    if (ret) {
-        ec_foe_request_clear(&request);
-        return ret;
+    if (!(sc = ec_master_get_config(master, data.config_index))) {
+        return -ENOENT;
     }
 
-    if (copy_from_user(request.buffer,
-                (void __user *) io.buffer, io.buffer_size)) {
-        ec_foe_request_clear(&request);
-        return -EFAULT;
+    if (!(voe = ec_slave_config_find_voe_handler(sc, data.request_index))) {
+        return -ENOENT;
     }
 
-    request.data_size = io.buffer_size;
-    ec_foe_request_write(&request);
+    return ecrt_voe_handler_notify(voe, data.tag);
+}
 
-    if (down_interruptible(&master->master_sem)) {
-        ec_foe_request_clear(&request);
-        return -EINTR;
-    }
+/*****************************************************************************/
 
-    if (!(slave = ec_master_find_slave(master, 0, io.slave_position))) {
-        up(&master->master_sem);
-        EC_MASTER_ERR(master, "Slave %u does not exist!\n",
-                io.slave_position);
-        ec_foe_request_clear(&request);
-        return -EINVAL;
-    }
+/** Number of completions fetched at once by ec_ioctl_completions().
+ */
+#define EC_IOCTL_COMPLETION_CHUNK 16
 
-    EC_SLAVE_DBG(slave, 1, "Scheduling FoE write request.\n");
+/** Fetches request completions.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_completions(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_completions_t data;
+    ec_request_completion_t chunk[EC_IOCTL_COMPLETION_CHUNK];
+    size_t count;
+    int ret;
 
-    // schedule FoE write request.
-    list_add_tail(&request.list, &slave->foe_requests);
+    if (unlikely(!ctx->requested))
+        return -EPERM;
 
-    up(&master->master_sem);
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
+        return -EFAULT;
 
-    // wait for processing through FSM
-    if (wait_event_interruptible(master->request_queue,
-                request.state != EC_INT_REQUEST_QUEUED)) {
-        // interrupted by signal
-        down(&master->master_sem);
-        if (request.state == EC_INT_REQUEST_QUEUED) {
-            // abort request
-            list_del(&request.list);
-            up(&master->master_sem);
-            ec_foe_request_clear(&request);
-            return -EINTR;
-        }
-        up(&master->master_sem);
+    ret = ec_master_completions_lost(master);
+    if (ret) {
+        return ret;
     }
 
-    // wait until master FSM has finished processing
-    wait_event(master->request_queue, request.state != EC_INT_REQUEST_BUSY);
+    data.count = 0;
 
-    io.result = request.result;
-    io.error_code = request.error_code;
+    while (data.count < data.max_count) {
+        count = ec_master_pop_completions(master, chunk,
+                min_t(uint32_t, data.max_count - data.count,
+                    EC_IOCTL_COMPLETION_CHUNK));
+        if (!count) {
+            break;
+        }
 
-    ret = request.state == EC_INT_REQUEST_SUCCESS ? 0 : -EIO;
+        if (copy_to_user((void __user *) (data.completions + data.count),
+                    chunk, count * sizeof(ec_request_completion_t)))
+            return -EFAULT;
 
-    if (__copy_to_user((void __user *) arg, &io, sizeof(io))) {
-        ret = -EFAULT;
+        data.count += count;
     }
 
-    ec_foe_request_clear(&request);
-    return ret;
+    if (copy_to_user((void __user *) arg, &data, sizeof(data)))
+        return -EFAULT;
+
+    return 0;
 }
 
 /*****************************************************************************/
 
-/** Read an SoE IDN.
+/** Number of events fetched at once by ec_ioctl_emerg_events().
+ */
+#define EC_IOCTL_EMERG_CHUNK 16
+
+/** Fetches CoE emergency events from the master-wide stream.
  *
  * \return Zero on success, otherwise a negative error code.
  */
-static ATTRIBUTES int ec_ioctl_slave_soe_read(
+static ATTRIBUTES int ec_ioctl_emerg_events(
         ec_master_t *master, /**< EtherCAT master. */
-        void *arg /**< ioctl() argument. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
         )
 {
-    ec_ioctl_slave_soe_read_t ioctl;
-    u8 *data;
-    int retval;
+    ec_ioctl_emerg_events_t data;
+    ec_coe_emerg_event_t chunk[EC_IOCTL_EMERG_CHUNK];
+    size_t count;
 
-    if (copy_from_user(&ioctl, (void __user *) arg, sizeof(ioctl))) {
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
         return -EFAULT;
-    }
 
-    data = kmalloc(ioctl.mem_size, GFP_KERNEL);
-    if (!data) {
-        EC_MASTER_ERR(master, "Failed to allocate %zu bytes of IDN data.\n",
-                ioctl.mem_size);
-        return -ENOMEM;
-    }
+    data.count = 0;
 
-    retval = ecrt_master_read_idn(master, ioctl.slave_position,
-            ioctl.drive_no, ioctl.idn, data, ioctl.mem_size, &ioctl.data_size,
-            &ioctl.error_code);
-    if (retval) {
-        kfree(data);
-        return retval;
-    }
+    while (data.count < data.max_count) {
+        count = ec_coe_emerg_stream_read(&master->emerg_stream,
+                &ctx->emerg_index, chunk,
+                min_t(uint32_t, data.max_count - data.count,
+                    EC_IOCTL_EMERG_CHUNK), &ctx->emerg_overruns);
+        if (!count) {
+            break;
+        }
 
-    if (copy_to_user((void __user *) ioctl.data,
-                data, ioctl.data_size)) {
-        kfree(data);
-        return -EFAULT;
-    }
-    kfree(data);
+        if (copy_to_user((void __user *) (data.events + data.count),
+                    chunk, count * sizeof(ec_coe_emerg_event_t)))
+            return -EFAULT;
 
-    if (__copy_to_user((void __user *) arg, &ioctl, sizeof(ioctl))) {
-        retval = -EFAULT;
+        data.count += count;
     }
 
-    EC_MASTER_DBG(master, 1, "Finished SoE read request.\n");
-    return retval;
+    data.overruns = ctx->emerg_overruns;
+    ctx->emerg_overruns = 0;
+
+    if (copy_to_user((void __user *) arg, &data, sizeof(data)))
+        return -EFAULT;
+
+    return 0;
 }
 
 /*****************************************************************************/
 
-/** Write an IDN to a slave via SoE.
+/** Checks the condition of ec_ioctl_master_wait().
  *
- * \return Zero on success, otherwise a negative error code.
+ * \return Non-zero, if the condition is met.
  */
-static ATTRIBUTES int ec_ioctl_slave_soe_write(
+static int ec_ioctl_master_wait_done(
         ec_master_t *master, /**< EtherCAT master. */
-        void *arg /**< ioctl() argument. */
+        const ec_ioctl_master_wait_t *data /**< Wait condition. */
         )
 {
-    ec_ioctl_slave_soe_write_t ioctl;
-    u8 *data;
-    int retval;
+    ec_master_state_t state;
+    ec_device_index_t dev_idx;
 
-    if (copy_from_user(&ioctl, (void __user *) arg, sizeof(ioctl))) {
-        return -EFAULT;
+    ecrt_master_state(master, &state);
+
+    if (!state.link_up) {
+        return 0;
     }
 
-    data = kmalloc(ioctl.data_size, GFP_KERNEL);
+    if (data->condition == EC_MASTER_WAIT_LINK_UP) {
+        return 1;
+    }
+
+    // the master state machine has to have seen the link, otherwise the
+    // number of responding slaves is not up to date
+    for (dev_idx = EC_DEVICE_MAIN; dev_idx < ec_master_num_devices(master);
+            dev_idx++) {
+        if (master->devices[dev_idx].link_state &&
+                !master->fsm.link_state[dev_idx]) {
+            return 0;
+        }
+    }
+
+    // a rescan is only done while scanning is allowed, a requested master
+    // keeps the current bus scan until it is activated
+    if (master->scan_busy ||
+            (master->allow_scan && master->fsm.rescan_required) ||
+            master->slave_count != state.slaves_responding) {
+        return 0;
+    }
+
+    if (data->condition == EC_MASTER_WAIT_SCAN) {
+        return 1;
+    }
+
+    return master->slave_count && state.al_states == data->al_state;
+}
+
+/*****************************************************************************/
+
+/** Waits for the link, the bus scan or the slave states.
+ *
+ * Sleeps on the scan wait queue, which is woken by the master state machine
+ * whenever the link, the number of responding slaves or the slave states
+ * change and when a bus scan finishes.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_master_wait(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_master_wait_t data;
+    long ret;
+
+    if (copy_from_user(&data, (void __user *) arg, sizeof(data)))
+        return -EFAULT;
+
+    if (data.condition > EC_MASTER_WAIT_AL_STATE) {
+        return -EINVAL;
+    }
+
+    ret = wait_event_interruptible_timeout(master->scan_queue,
+            ec_ioctl_master_wait_done(master, &data),
+            msecs_to_jiffies(data.timeout_ms));
+    if (ret < 0) {
+        return ret;
+    }
+
+    ecrt_master_state(master, &data.state);
+
+    if (copy_to_user((void __user *) arg, &data, sizeof(data)))
+        return -EFAULT;
+
+    return ret ? 0 : -ETIMEDOUT;
+}
+
+/*****************************************************************************/
+
+/** Schedules an FoE request for a slave.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static int ec_ioctl_foe_schedule(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_foe_request_t *request, /**< FoE request. */
+        uint16_t slave_position /**< Slave position. */
+        )
+{
+    ec_slave_t *slave;
+
+    if (down_interruptible(&master->master_sem)) {
+        return -EINTR;
+    }
+
+    if (!(slave = ec_master_find_slave(master, 0, slave_position))) {
+        up(&master->master_sem);
+        EC_MASTER_ERR(master, "Slave %u does not exist!\n", slave_position);
+        return -EINVAL;
+    }
+
+    EC_SLAVE_DBG(slave, 1, "Scheduling FoE %s request.\n",
+            request->dir == EC_DIR_OUTPUT ? "write" : "read");
+
+    // schedule request.
+    list_add_tail(&request->list, &slave->foe_requests);
+
+    up(&master->master_sem);
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Checks, if the FSM has finished processing an FoE request.
+ *
+ * \return Non-zero, if the request succeeded or failed.
+ */
+static int ec_ioctl_foe_finished(
+        const ec_foe_request_t *request /**< FoE request. */
+        )
+{
+    return request->state == EC_INT_REQUEST_SUCCESS
+        || request->state == EC_INT_REQUEST_FAILURE;
+}
+
+/*****************************************************************************/
+
+/** Checks, if all data of an FoE read request have been taken.
+ *
+ * \return Non-zero, if the end of the file was reached.
+ */
+static int ec_ioctl_foe_eof(
+        const ec_foe_request_t *request /**< FoE request. */
+        )
+{
+    uint8_t end = READ_ONCE(request->stream_end);
+
+    smp_rmb(); // the fill level is final, if the end flag is set
+    return end && !ec_foe_request_ring_fill(request);
+}
+
+/*****************************************************************************/
+
+/** Copies data from user space into the ring of an FoE write request.
+ *
+ * Blocks, until all data are in the ring, or the transfer has failed.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static int ec_ioctl_foe_put(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_foe_request_t *request, /**< FoE request. */
+        const uint8_t __user *buffer, /**< User space data. */
+        size_t size /**< Number of bytes in \a buffer. */
+        )
+{
+    size_t done = 0, chunk;
+    uint8_t *ptr;
+
+    while (done < size) {
+        if (wait_event_interruptible(master->request_queue,
+                    ec_foe_request_ring_space(request)
+                    || ec_ioctl_foe_finished(request))) {
+            return -EINTR;
+        }
+
+        if (ec_ioctl_foe_finished(request)) {
+            return -EIO;
+        }
+
+        ptr = ec_foe_request_ring_write_ptr(request, &chunk);
+        chunk = min(chunk, size - done);
+        if (copy_from_user(ptr, buffer + done, chunk)) {
+            return -EFAULT;
+        }
+        ec_foe_request_ring_commit(request, chunk);
+        done += chunk;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Marks the data of an FoE write request as complete.
+ */
+static void ec_ioctl_foe_end(
+        ec_foe_request_t *request /**< FoE request. */
+        )
+{
+    smp_wmb(); // publish the head before the end flag
+    WRITE_ONCE(request->stream_end, 1);
+}
+
+/*****************************************************************************/
+
+/** Copies data from the ring of an FoE read request to user space.
+ *
+ * Blocks, until data are available, the end of the file is reached, or the
+ * transfer has failed.
+ *
+ * \return Number of bytes copied, otherwise a negative error code.
+ */
+static ssize_t ec_ioctl_foe_get(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_foe_request_t *request, /**< FoE request. */
+        uint8_t __user *buffer, /**< User space memory. */
+        size_t size /**< Size of \a buffer. */
+        )
+{
+    size_t done = 0, chunk;
+    const uint8_t *ptr;
+
+    if (wait_event_interruptible(master->request_queue,
+                ec_foe_request_ring_fill(request)
+                || READ_ONCE(request->stream_end)
+                || ec_ioctl_foe_finished(request))) {
+        return -EINTR;
+    }
+
+    if (!ec_foe_request_ring_fill(request)
+            && !READ_ONCE(request->stream_end)) {
+        return -EIO; // finished without receiving the whole file
+    }
+
+    while (done < size) {
+        ptr = ec_foe_request_ring_read_ptr(request, 0, &chunk);
+        if (!chunk) {
+            break;
+        }
+        chunk = min(chunk, size - done);
+        if (copy_to_user(buffer + done, ptr, chunk)) {
+            return -EFAULT;
+        }
+        ec_foe_request_ring_release(request, chunk);
+        done += chunk;
+    }
+
+    return done;
+}
+
+/*****************************************************************************/
+
+/** Waits for the FSM to finish an FoE request.
+ *
+ * If the transfer is aborted, or the wait is interrupted by a signal, a
+ * queued request is dequeued, and a busy request is told to stop.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static int ec_ioctl_foe_finish(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_foe_request_t *request, /**< FoE request. */
+        int abort /**< Abort the transfer. */
+        )
+{
+    // wait for processing through FSM
+    if (!abort && wait_event_interruptible(master->request_queue,
+                request->state != EC_INT_REQUEST_QUEUED)) {
+        abort = 1; // interrupted by signal
+    }
+
+    down(&master->master_sem);
+    if (request->state == EC_INT_REQUEST_QUEUED) {
+        list_del(&request->list);
+        up(&master->master_sem);
+        request->state = EC_INT_REQUEST_FAILURE;
+        request->result = FOE_ABORTED_ERROR;
+        return -EINTR;
+    }
+    if (abort) {
+        // request already processing: stop it at the next FSM step.
+        WRITE_ONCE(request->stream_abort, 1);
+    }
+    up(&master->master_sem);
+
+    // wait until master FSM has finished processing
+    wait_event(master->request_queue, request->state != EC_INT_REQUEST_BUSY);
+
+    return request->state == EC_INT_REQUEST_SUCCESS ? 0 : -EIO;
+}
+
+/*****************************************************************************/
+
+/** Read a file from a slave via FoE.
+ *
+ * The data are streamed through the request's ring into the user buffer.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_read(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg /**< ioctl() argument. */
+        )
+{
+    ec_ioctl_slave_foe_t io;
+    ec_foe_request_t request;
+    ssize_t size;
+    int ret;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    ec_foe_request_init(&request, io.file_name);
+    ret = ec_foe_request_alloc(&request, EC_FOE_STREAM_RING_SIZE);
+    if (ret) {
+        ec_foe_request_clear(&request);
+        return ret;
+    }
+
+    ec_foe_request_read(&request);
+
+    ret = ec_ioctl_foe_schedule(master, &request, io.slave_position);
+    if (ret) {
+        ec_foe_request_clear(&request);
+        return ret;
+    }
+
+    io.data_size = 0;
+    while (1) {
+        size = ec_ioctl_foe_get(master, &request,
+                (uint8_t __user *) io.buffer + io.data_size,
+                io.buffer_size - io.data_size);
+        if (size < 0) {
+            ret = size;
+            break;
+        }
+        io.data_size += size;
+
+        if (ec_ioctl_foe_eof(&request)) {
+            break;
+        }
+
+        if (!size) {
+            EC_MASTER_ERR(master, "Buffer too small.\n");
+            ret = -EOVERFLOW;
+            break;
+        }
+    }
+
+    if (ret) {
+        ec_ioctl_foe_finish(master, &request, 1);
+        if (ret != -EIO) {
+            ec_foe_request_clear(&request);
+            return ret;
+        }
+    } else {
+        ret = ec_ioctl_foe_finish(master, &request, 0);
+    }
+
+    io.result = request.result;
+    io.error_code = request.error_code;
+
+    if (ret) {
+        io.data_size = 0;
+    }
+
+    if (__copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        ret = -EFAULT;
+    }
+
+    ec_foe_request_clear(&request);
+    return ret;
+}
+
+/*****************************************************************************/
+
+/** Write a file to a slave via FoE
+ *
+ * The data are streamed from the user buffer through the request's ring.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_write(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg /**< ioctl() argument. */
+        )
+{
+    ec_ioctl_slave_foe_t io;
+    ec_foe_request_t request;
+    int ret;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    ec_foe_request_init(&request, io.file_name);
+
+    ret = ec_foe_request_alloc(&request,
+            min_t(size_t, io.buffer_size, EC_FOE_STREAM_RING_SIZE));
+    if (ret) {
+        ec_foe_request_clear(&request);
+        return ret;
+    }
+
+    ec_foe_request_write(&request);
+
+    ret = ec_ioctl_foe_schedule(master, &request, io.slave_position);
+    if (ret) {
+        ec_foe_request_clear(&request);
+        return ret;
+    }
+
+    ret = ec_ioctl_foe_put(master, &request,
+            (const uint8_t __user *) io.buffer, io.buffer_size);
+    if (ret) {
+        ec_ioctl_foe_finish(master, &request, 1);
+        if (ret != -EIO) {
+            ec_foe_request_clear(&request);
+            return ret;
+        }
+    } else {
+        ec_ioctl_foe_end(&request);
+        ret = ec_ioctl_foe_finish(master, &request, 0);
+    }
+
+    io.result = request.result;
+    io.error_code = request.error_code;
+
+    if (__copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        ret = -EFAULT;
+    }
+
+    ec_foe_request_clear(&request);
+    return ret;
+}
+
+/*****************************************************************************/
+
+#ifndef EC_IOCTL_RTDM
+
+/** Start a streamed FoE transfer.
+ *
+ * The file data are exchanged in chunks with
+ * ec_ioctl_slave_foe_stream_data(), so that files of any size can be
+ * transferred with constant memory.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_stream_start(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_stream_t io;
+    ec_foe_request_t *request;
+    uint8_t *file_name;
+    int ret;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (io.write && !ctx->writable) {
+        return -EPERM;
+    }
+
+    if (ctx->foe_request) {
+        return -EBUSY;
+    }
+
+    // the file name is stored behind the request
+    request = kmalloc(sizeof(*request) + sizeof(io.file_name), GFP_KERNEL);
+    if (!request) {
+        return -ENOMEM;
+    }
+    file_name = (uint8_t *) (request + 1);
+    memcpy(file_name, io.file_name, sizeof(io.file_name));
+    file_name[sizeof(io.file_name) - 1] = 0;
+
+    ec_foe_request_init(request, file_name);
+    ret = ec_foe_request_alloc(request, EC_FOE_STREAM_RING_SIZE);
+    if (ret) {
+        ec_foe_request_clear(request);
+        kfree(request);
+        return ret;
+    }
+
+    if (io.write) {
+        ec_foe_request_write(request);
+    } else {
+        ec_foe_request_read(request);
+    }
+
+    ret = ec_ioctl_foe_schedule(master, request, io.slave_position);
+    if (ret) {
+        ec_foe_request_clear(request);
+        kfree(request);
+        return ret;
+    }
+
+    ctx->foe_request = request;
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Exchange data of a streamed FoE transfer.
+ *
+ * For writing, blocks until all data are queued. For reading, blocks until
+ * at least some data are available, or the end of the file is reached.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_stream_data(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_stream_t io;
+    ec_foe_request_t *request = ctx->foe_request;
+    ssize_t size;
+    int ret;
+
+    if (!request) {
+        return -EINVAL;
+    }
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (request->dir == EC_DIR_OUTPUT) {
+        if (request->stream_end) {
+            return -EINVAL;
+        }
+
+        ret = ec_ioctl_foe_put(master, request,
+                (const uint8_t __user *) io.buffer, io.buffer_size);
+        if (ret) {
+            return ret;
+        }
+
+        if (io.last) {
+            ec_ioctl_foe_end(request);
+        }
+
+        io.data_size = io.buffer_size;
+        io.progress = READ_ONCE(request->ring_tail);
+        io.eof = 0;
+    } else {
+        size = ec_ioctl_foe_get(master, request,
+                (uint8_t __user *) io.buffer, io.buffer_size);
+        if (size < 0) {
+            return size;
+        }
+
+        io.data_size = size;
+        io.progress = READ_ONCE(request->ring_head);
+        io.eof = ec_ioctl_foe_eof(request);
+    }
+
+    if (copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Finish a streamed FoE transfer.
+ *
+ * Waits for the slave to complete the transfer. An incomplete stream is
+ * aborted.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_stream_end(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_stream_t io;
+    ec_foe_request_t *request = ctx->foe_request;
+    int ret;
+
+    if (!request) {
+        return -EINVAL;
+    }
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    ret = ec_ioctl_foe_finish(master, request, !request->stream_end);
+
+    io.data_size = request->data_size;
+    io.progress = request->data_size;
+    io.eof = request->dir == EC_DIR_INPUT && ec_ioctl_foe_eof(request);
+    io.result = request->result;
+    io.error_code = request->error_code;
+
+    ctx->foe_request = NULL;
+    ec_foe_request_clear(request);
+    kfree(request);
+
+    if (copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    return ret;
+}
+
+/*****************************************************************************/
+
+/** Cleans up a streamed FoE transfer, when a file handle is closed.
+ *
+ * A transfer, that is still waiting for data, is aborted.
+ */
+void ec_ioctl_foe_stream_clear(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_foe_request_t *request = ctx->foe_request;
+
+    if (!request) {
+        return;
+    }
+
+    ec_ioctl_foe_finish(master, request, !request->stream_end);
+
+    ctx->foe_request = NULL;
+    ec_foe_request_clear(request);
+    kfree(request);
+}
+
+/*****************************************************************************/
+
+/** FoE batch transfer.
+ *
+ * One file image is written to several slaves concurrently. The image is
+ * held only once, all requests read from it.
+ */
+struct ec_ioctl_foe_batch {
+    uint8_t *image; /**< File image. */
+    uint32_t count; /**< Number of slaves. */
+    uint16_t *positions; /**< Slave positions. */
+    ec_foe_request_t *requests; /**< One FoE request per slave. */
+    uint8_t file_name[255]; /**< Name of the file on the slaves. */
+};
+
+/*****************************************************************************/
+
+/** Frees an FoE batch transfer.
+ *
+ * All requests have to be finished or dequeued.
+ */
+static void ec_ioctl_foe_batch_free(
+        struct ec_ioctl_foe_batch *batch /**< FoE batch transfer. */
+        )
+{
+    uint32_t i;
+
+    for (i = 0; i < batch->count; i++) {
+        ec_foe_request_clear(&batch->requests[i]);
+    }
+
+    kfree(batch->requests);
+    kfree(batch->positions);
+    if (batch->image) {
+        vfree(batch->image);
+    }
+    kfree(batch);
+}
+
+/*****************************************************************************/
+
+/** Copies the states of an FoE batch transfer to user space.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static int ec_ioctl_foe_batch_status(
+        const struct ec_ioctl_foe_batch *batch, /**< FoE batch transfer. */
+        ec_ioctl_slave_foe_batch_t *io /**< ioctl() data. */
+        )
+{
+    ec_ioctl_slave_foe_status_t status;
+    const ec_foe_request_t *request;
+    uint32_t i;
+
+    io->finished_count = 0;
+
+    for (i = 0; i < batch->count; i++) {
+        request = &batch->requests[i];
+
+        if (ec_ioctl_foe_finished(request)) {
+            io->finished_count++;
+        }
+
+        if (i >= io->slave_count) {
+            continue;
+        }
+
+        status.slave_position = batch->positions[i];
+        status.state = request->state;
+        status.progress = READ_ONCE(request->ring_tail);
+        status.result = request->result;
+        status.error_code = request->error_code;
+
+        if (copy_to_user((void __user *) (io->status + i),
+                    &status, sizeof(status))) {
+            return -EFAULT;
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Start writing a file to several slaves via FoE.
+ *
+ * The requests are queued for all slaves at once, so that the slave FSMs
+ * transfer the file concurrently.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_batch_start(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_batch_t io;
+    struct ec_ioctl_foe_batch *batch;
+    ec_slave_t *slave;
+    uint32_t i;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (ctx->foe_batch) {
+        return -EBUSY;
+    }
+
+    if (!io.slave_count || io.slave_count > master->slave_count) {
+        return -EINVAL;
+    }
+
+    if (!(batch = kzalloc(sizeof(*batch), GFP_KERNEL))) {
+        return -ENOMEM;
+    }
+
+    batch->positions = kmalloc(io.slave_count * sizeof(uint16_t),
+            GFP_KERNEL);
+    batch->requests = kmalloc(io.slave_count * sizeof(ec_foe_request_t),
+            GFP_KERNEL);
+    if (io.buffer_size) {
+        batch->image = vmalloc(io.buffer_size);
+    }
+    if (!batch->positions || !batch->requests
+            || (io.buffer_size && !batch->image)) {
+        ec_ioctl_foe_batch_free(batch);
+        return -ENOMEM;
+    }
+
+    if (copy_from_user(batch->positions,
+                (void __user *) io.slave_positions,
+                io.slave_count * sizeof(uint16_t))
+            || copy_from_user(batch->image,
+                (void __user *) io.buffer, io.buffer_size)) {
+        ec_ioctl_foe_batch_free(batch);
+        return -EFAULT;
+    }
+
+    memcpy(batch->file_name, io.file_name, sizeof(batch->file_name));
+    batch->file_name[sizeof(batch->file_name) - 1] = 0;
+
+    for (i = 0; i < io.slave_count; i++) {
+        ec_foe_request_init(&batch->requests[i], batch->file_name);
+        ec_foe_request_use_data(&batch->requests[i], batch->image,
+                io.buffer_size);
+        ec_foe_request_write(&batch->requests[i]);
+    }
+    batch->count = io.slave_count;
+
+    if (down_interruptible(&master->master_sem)) {
+        ec_ioctl_foe_batch_free(batch);
+        return -EINTR;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        if (!ec_master_find_slave(master, 0, batch->positions[i])) {
+            up(&master->master_sem);
+            EC_MASTER_ERR(master, "Slave %u does not exist!\n",
+                    batch->positions[i]);
+            ec_ioctl_foe_batch_free(batch);
+            return -EINVAL;
+        }
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        slave = ec_master_find_slave(master, 0, batch->positions[i]);
+        list_add_tail(&batch->requests[i].list, &slave->foe_requests);
+    }
+
+    up(&master->master_sem);
+
+    EC_MASTER_DBG(master, 1, "Scheduled FoE write of %zu bytes"
+            " to %u slaves.\n", io.buffer_size, batch->count);
+
+    ctx->foe_batch = batch;
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Get the states of an FoE batch transfer.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_batch_get_status(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_batch_t io;
+    int ret;
+
+    if (!ctx->foe_batch) {
+        return -EINVAL;
+    }
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    ret = ec_ioctl_foe_batch_status(ctx->foe_batch, &io);
+    if (ret) {
+        return ret;
+    }
+
+    if (copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Finish an FoE batch transfer.
+ *
+ * Waits for all slaves to complete the transfer. If interrupted by a signal,
+ * the remaining transfers are aborted.
+ *
+ * \return Zero if all transfers succeeded, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_foe_batch_end(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_slave_foe_batch_t io;
+    struct ec_ioctl_foe_batch *batch = ctx->foe_batch;
+    int ret = 0, abort = 0;
+    uint32_t i;
+
+    if (!batch) {
+        return -EINVAL;
+    }
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        if (ec_ioctl_foe_finish(master, &batch->requests[i], abort)) {
+            ret = -EIO;
+        }
+        if (signal_pending(current)) {
+            abort = 1;
+        }
+    }
+
+    if (abort) {
+        ret = -EINTR;
+    }
+
+    if (!ec_ioctl_foe_batch_status(batch, &io)
+            && copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        ret = -EFAULT;
+    }
+
+    ctx->foe_batch = NULL;
+    ec_ioctl_foe_batch_free(batch);
+    return ret;
+}
+
+/*****************************************************************************/
+
+/** Aborts an FoE batch transfer, when a file handle is closed.
+ */
+void ec_ioctl_foe_batch_clear(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    struct ec_ioctl_foe_batch *batch = ctx->foe_batch;
+    uint32_t i;
+
+    if (!batch) {
+        return;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        ec_ioctl_foe_finish(master, &batch->requests[i], 1);
+    }
+
+    ctx->foe_batch = NULL;
+    ec_ioctl_foe_batch_free(batch);
+}
+
+#endif
+
+/*****************************************************************************/
+
+/** Read an SoE IDN.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_soe_read(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg /**< ioctl() argument. */
+        )
+{
+    ec_ioctl_slave_soe_read_t ioctl;
+    u8 *data;
+    int retval;
+
+    if (copy_from_user(&ioctl, (void __user *) arg, sizeof(ioctl))) {
+        return -EFAULT;
+    }
+
+    data = kmalloc(ioctl.mem_size, GFP_KERNEL);
+    if (!data) {
+        EC_MASTER_ERR(master, "Failed to allocate %zu bytes of IDN data.\n",
+                ioctl.mem_size);
+        return -ENOMEM;
+    }
+
+    retval = ecrt_master_read_idn(master, ioctl.slave_position,
+            ioctl.drive_no, ioctl.idn, data, ioctl.mem_size, &ioctl.data_size,
+            &ioctl.error_code);
+    if (retval) {
+        kfree(data);
+        return retval;
+    }
+
+    if (copy_to_user((void __user *) ioctl.data,
+                data, ioctl.data_size)) {
+        kfree(data);
+        return -EFAULT;
+    }
+    kfree(data);
+
+    if (__copy_to_user((void __user *) arg, &ioctl, sizeof(ioctl))) {
+        retval = -EFAULT;
+    }
+
+    EC_MASTER_DBG(master, 1, "Finished SoE read request.\n");
+    return retval;
+}
+
+/*****************************************************************************/
+
+/** Write an IDN to a slave via SoE.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_soe_write(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg /**< ioctl() argument. */
+        )
+{
+    ec_ioctl_slave_soe_write_t ioctl;
+    u8 *data;
+    int retval;
+
+    if (copy_from_user(&ioctl, (void __user *) arg, sizeof(ioctl))) {
+        return -EFAULT;
+    }
+
+    data = kmalloc(ioctl.data_size, GFP_KERNEL);
     if (!data) {
         EC_MASTER_ERR(master, "Failed to allocate %zu bytes of IDN data.\n",
                 ioctl.data_size);
@@ -4215,6 +5224,216 @@ static ATTRIBUTES int ec_ioctl_slave_soe_write(
 
 /*****************************************************************************/
 
+/** Read or write a list of IDNs via SoE.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_slave_soe_list(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        int write /**< Write the IDNs instead of reading them. */
+        )
+{
+    ec_ioctl_slave_soe_list_t io;
+    ec_soe_transfer_t *transfers;
+    uint8_t __user **user_data;
+    size_t i, count = 0;
+    int ret;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (!io.idn_count) {
+        return 0;
+    }
+
+    if (io.idn_count > EC_IOCTL_SOE_LIST_MAX) {
+        return -EINVAL;
+    }
+
+    transfers = vmalloc(io.idn_count * sizeof(ec_soe_transfer_t));
+    user_data = vmalloc(io.idn_count * sizeof(uint8_t __user *));
+    if (!transfers || !user_data) {
+        EC_MASTER_ERR(master, "Failed to allocate list of %u IDNs.\n",
+                io.idn_count);
+        ret = -ENOMEM;
+        goto out_free;
+    }
+
+    if (copy_from_user(transfers, (void __user *) io.transfers,
+                io.idn_count * sizeof(ec_soe_transfer_t))) {
+        ret = -EFAULT;
+        goto out_free;
+    }
+
+    for (count = 0; count < io.idn_count; count++) {
+        ec_soe_transfer_t *transfer = &transfers[count];
+
+        user_data[count] = (uint8_t __user *) transfer->data;
+        transfer->data = kmalloc(transfer->size, GFP_KERNEL);
+        if (!transfer->data) {
+            EC_MASTER_ERR(master, "Failed to allocate %zu bytes"
+                    " of IDN data.\n", transfer->size);
+            ret = -ENOMEM;
+            goto out_free;
+        }
+
+        if (write && copy_from_user(transfer->data, user_data[count],
+                    transfer->size)) {
+            kfree(transfer->data);
+            ret = -EFAULT;
+            goto out_free;
+        }
+    }
+
+    if (write) {
+        ret = ecrt_master_write_idns(master, io.slave_position, io.drive_no,
+                transfers, count);
+    } else {
+        ret = ecrt_master_read_idns(master, io.slave_position, io.drive_no,
+                transfers, count);
+    }
+
+    if (ret && ret != -EIO && ret != -EINTR) {
+        goto out_free;
+    }
+
+    for (i = 0; i < count; i++) {
+        ec_soe_transfer_t *transfer = &transfers[i];
+
+        if (!write && !transfer->result && copy_to_user(user_data[i],
+                    transfer->data, transfer->result_size)) {
+            ret = -EFAULT;
+            goto out_free;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        kfree(transfers[i].data);
+        transfers[i].data = (uint8_t *) user_data[i];
+    }
+    count = 0;
+
+    if (copy_to_user((void __user *) io.transfers, transfers,
+                io.idn_count * sizeof(ec_soe_transfer_t))) {
+        ret = -EFAULT;
+    }
+
+    EC_MASTER_DBG(master, 1, "Finished SoE %s list request.\n",
+            write ? "write" : "read");
+
+out_free:
+    for (i = 0; i < count; i++) {
+        kfree(transfers[i].data);
+    }
+    if (user_data) {
+        vfree(user_data);
+    }
+    if (transfers) {
+        vfree(transfers);
+    }
+    return ret;
+}
+
+/*****************************************************************************/
+
+#ifndef EC_IOCTL_RTDM
+
+/** Start capturing frames of a device.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_capture_start(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_capture_t io;
+    ec_device_t *device;
+    int ret;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (io.dev_idx >= ec_master_num_devices(master)) {
+        return -EINVAL;
+    }
+    device = &master->devices[io.dev_idx];
+
+    if (down_interruptible(&master->device_sem)) {
+        return -EINTR;
+    }
+
+    ret = ec_capture_start(&device->capture, io.frame_count, io.filter,
+            io.sample_interval);
+    if (ret) {
+        up(&master->device_sem);
+        return ret;
+    }
+
+    ctx->capture_mask |= 1 << io.dev_idx;
+    io.frame_count = device->capture.frame_count;
+    io.mmap_size = device->capture.size;
+
+    up(&master->device_sem);
+
+    EC_MASTER_DBG(master, 1, "Started capturing %u frames on device %u.\n",
+            io.frame_count, io.dev_idx);
+
+    if (copy_to_user((void __user *) arg, &io, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Stop capturing frames of a device.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static ATTRIBUTES int ec_ioctl_capture_stop(
+        ec_master_t *master, /**< EtherCAT master. */
+        void *arg, /**< ioctl() argument. */
+        ec_ioctl_context_t *ctx /**< Private data structure of file handle. */
+        )
+{
+    ec_ioctl_capture_t io;
+
+    if (copy_from_user(&io, (void __user *) arg, sizeof(io))) {
+        return -EFAULT;
+    }
+
+    if (io.dev_idx >= ec_master_num_devices(master)) {
+        return -EINVAL;
+    }
+
+    if (!(ctx->capture_mask & (1 << io.dev_idx))) {
+        return -EPERM;
+    }
+
+    if (down_interruptible(&master->device_sem)) {
+        return -EINTR;
+    }
+
+    ec_capture_stop(&master->devices[io.dev_idx].capture);
+    ctx->capture_mask &= ~(1 << io.dev_idx);
+
+    up(&master->device_sem);
+
+    EC_MASTER_DBG(master, 1, "Stopped capturing on device %u.\n",
+            io.dev_idx);
+    return 0;
+}
+
+#endif
+
+/*****************************************************************************/
+
 /** ioctl() function to use.
  */
 #ifdef EC_IOCTL_RTDM
@@ -4275,6 +5494,13 @@ long EC_IOCTL(
             }
             ret = ec_ioctl_master_debug(master, arg);
             break;
+        case EC_IOCTL_MASTER_THREAD:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_master_thread(master, arg);
+            break;
         case EC_IOCTL_MASTER_RESCAN:
             if (!ctx->writable) {
                 ret = -EPERM;
@@ -4335,6 +5561,30 @@ long EC_IOCTL(
             }
             ret = ec_ioctl_slave_foe_write(master, arg);
             break;
+#ifndef EC_IOCTL_RTDM
+        case EC_IOCTL_SLAVE_FOE_STREAM_START:
+            ret = ec_ioctl_slave_foe_stream_start(master, arg, ctx);
+            break;
+        case EC_IOCTL_SLAVE_FOE_STREAM_DATA:
+            ret = ec_ioctl_slave_foe_stream_data(master, arg, ctx);
+            break;
+        case EC_IOCTL_SLAVE_FOE_STREAM_END:
+            ret = ec_ioctl_slave_foe_stream_end(master, arg, ctx);
+            break;
+        case EC_IOCTL_SLAVE_FOE_BATCH_START:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_slave_foe_batch_start(master, arg, ctx);
+            break;
+        case EC_IOCTL_SLAVE_FOE_BATCH_STATUS:
+            ret = ec_ioctl_slave_foe_batch_get_status(master, arg, ctx);
+            break;
+        case EC_IOCTL_SLAVE_FOE_BATCH_END:
+            ret = ec_ioctl_slave_foe_batch_end(master, arg, ctx);
+            break;
+#endif
         case EC_IOCTL_SLAVE_SOE_READ:
             ret = ec_ioctl_slave_soe_read(master, arg);
             break;
@@ -4352,6 +5602,16 @@ long EC_IOCTL(
             }
             ret = ec_ioctl_slave_soe_write(master, arg);
             break;
+        case EC_IOCTL_SLAVE_SOE_READ_LIST:
+            ret = ec_ioctl_slave_soe_list(master, arg, 0);
+            break;
+        case EC_IOCTL_SLAVE_SOE_WRITE_LIST:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_slave_soe_list(master, arg, 1);
+            break;
         case EC_IOCTL_CONFIG:
             ret = ec_ioctl_config(master, arg);
             break;
@@ -4733,6 +5993,33 @@ long EC_IOCTL(
         case EC_IOCTL_VOE_DATA:
             ret = ec_ioctl_voe_data(master, arg, ctx);
             break;
+        case EC_IOCTL_SDO_REQUEST_NOTIFY:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_sdo_request_notify(master, arg, ctx);
+            break;
+        case EC_IOCTL_REG_REQUEST_NOTIFY:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_reg_request_notify(master, arg, ctx);
+            break;
+        case EC_IOCTL_VOE_NOTIFY:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_voe_notify(master, arg, ctx);
+            break;
+        case EC_IOCTL_COMPLETIONS:
+            ret = ec_ioctl_completions(master, arg, ctx);
+            break;
+        case EC_IOCTL_EMERG_EVENTS:
+            ret = ec_ioctl_emerg_events(master, arg, ctx);
+            break;
         case EC_IOCTL_SET_SEND_INTERVAL:
             if (!ctx->writable) {
                 ret = -EPERM;
@@ -4740,6 +6027,25 @@ long EC_IOCTL(
             }
             ret = ec_ioctl_set_send_interval(master, arg, ctx);
             break;
+#ifndef EC_IOCTL_RTDM
+        case EC_IOCTL_CAPTURE_START:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_capture_start(master, arg, ctx);
+            break;
+        case EC_IOCTL_CAPTURE_STOP:
+            if (!ctx->writable) {
+                ret = -EPERM;
+                break;
+            }
+            ret = ec_ioctl_capture_stop(master, arg, ctx);
+            break;
+        case EC_IOCTL_MASTER_WAIT:
+            ret = ec_ioctl_master_wait(master, arg, ctx);
+            break;
+#endif
         default:
             ret = -ENOTTY;
             break;
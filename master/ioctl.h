@@ -56,7 +56,7 @@
  *
  * Increment this when changing the ioctl interface!
  */
-#define EC_IOCTL_VERSION_MAGIC 30
+#define EC_IOCTL_VERSION_MAGIC 39
 
 // Command-line tool
 #define EC_IOCTL_MODULE                EC_IOR(0x00, ec_ioctl_module_t)
@@ -155,6 +155,45 @@
 #define EC_IOCTL_SET_SEND_INTERVAL     EC_IOW(0x59, size_t)
 #define EC_IOCTL_SC_OVERLAPPING_IO     EC_IOW(0x5a, ec_ioctl_config_t)
 
+// Frame capture
+#define EC_IOCTL_CAPTURE_START        EC_IOWR(0x5b, ec_ioctl_capture_t)
+#define EC_IOCTL_CAPTURE_STOP          EC_IOW(0x5c, ec_ioctl_capture_t)
+
+// Kernel threads
+#define EC_IOCTL_MASTER_THREAD         EC_IOW(0x5d, ec_ioctl_master_thread_t)
+
+// Streamed FoE transfers
+#define EC_IOCTL_SLAVE_FOE_STREAM_START \
+    EC_IOW(0x5e, ec_ioctl_slave_foe_stream_t)
+#define EC_IOCTL_SLAVE_FOE_STREAM_DATA \
+    EC_IOWR(0x5f, ec_ioctl_slave_foe_stream_t)
+#define EC_IOCTL_SLAVE_FOE_STREAM_END \
+    EC_IOWR(0x60, ec_ioctl_slave_foe_stream_t)
+#define EC_IOCTL_SLAVE_FOE_BATCH_START \
+    EC_IOW(0x61, ec_ioctl_slave_foe_batch_t)
+#define EC_IOCTL_SLAVE_FOE_BATCH_STATUS \
+    EC_IOWR(0x62, ec_ioctl_slave_foe_batch_t)
+#define EC_IOCTL_SLAVE_FOE_BATCH_END \
+    EC_IOWR(0x63, ec_ioctl_slave_foe_batch_t)
+
+// SoE IDN lists
+#define EC_IOCTL_SLAVE_SOE_READ_LIST \
+    EC_IOW(0x64, ec_ioctl_slave_soe_list_t)
+#define EC_IOCTL_SLAVE_SOE_WRITE_LIST \
+    EC_IOW(0x65, ec_ioctl_slave_soe_list_t)
+
+// Request completions
+#define EC_IOCTL_SDO_REQUEST_NOTIFY    EC_IOW(0x66, ec_ioctl_request_notify_t)
+#define EC_IOCTL_REG_REQUEST_NOTIFY    EC_IOW(0x67, ec_ioctl_request_notify_t)
+#define EC_IOCTL_VOE_NOTIFY            EC_IOW(0x68, ec_ioctl_request_notify_t)
+#define EC_IOCTL_COMPLETIONS         EC_IOWR(0x69, ec_ioctl_completions_t)
+
+// CoE emergency stream
+#define EC_IOCTL_EMERG_EVENTS        EC_IOWR(0x6a, ec_ioctl_emerg_events_t)
+
+// Readiness waits
+#define EC_IOCTL_MASTER_WAIT         EC_IOWR(0x6b, ec_ioctl_master_wait_t)
+
 /*****************************************************************************/
 
 #define EC_IOCTL_STRING_SIZE 64
@@ -187,6 +226,12 @@ typedef struct {
         uint64_t tx_bytes;
         uint64_t rx_bytes;
         uint64_t tx_errors;
+        uint64_t poll_count;
+        uint64_t poll_frames;
+        uint32_t poll_max_frames;
+        uint64_t flush_count;
+        uint64_t flush_frames;
+        uint32_t flush_max_frames;
         int32_t tx_frame_rates[EC_RATE_COUNT];
         int32_t rx_frame_rates[EC_RATE_COUNT];
         int32_t tx_byte_rates[EC_RATE_COUNT];
@@ -204,10 +249,27 @@ typedef struct {
     int32_t loss_rates[EC_RATE_COUNT];
     uint64_t app_time;
     uint16_t ref_clock;
+    struct ec_ioctl_thread {
+        uint8_t running;
+        uint64_t cpu_mask;
+        int32_t policy;
+        int32_t priority;
+        uint64_t cpu_time;
+    } threads[EC_THREAD_COUNT];
 } ec_ioctl_master_t;
 
 /*****************************************************************************/
 
+typedef struct {
+    // inputs
+    uint32_t thread;
+    uint64_t cpu_mask;
+    int32_t policy;
+    int32_t priority;
+} ec_ioctl_master_thread_t;
+
+/*****************************************************************************/
+
 typedef struct {
     // input
     uint16_t position;
@@ -446,6 +508,50 @@ typedef struct {
 
 /*****************************************************************************/
 
+typedef struct {
+    // inputs
+    uint16_t slave_position; // start
+    uint8_t write; // start: store the file on the slave, else read it
+    char file_name[255]; // start
+    size_t buffer_size; // data: bytes to write, or space to read into
+    uint8_t *buffer; // data
+    uint8_t last; // data: no more data follow the written ones
+
+    // outputs
+    size_t data_size; // data: bytes copied, end: total bytes transferred
+    size_t progress; // bytes acknowledged by/received from the slave
+    uint8_t eof; // data: all data of the file have been read
+    uint32_t result; // end
+    uint32_t error_code; // end
+} ec_ioctl_slave_foe_stream_t;
+
+/*****************************************************************************/
+
+typedef struct {
+    uint16_t slave_position;
+    uint8_t state; // ec_internal_request_state_t
+    size_t progress; // bytes acknowledged by the slave
+    uint32_t result;
+    uint32_t error_code;
+} ec_ioctl_slave_foe_status_t;
+
+/*****************************************************************************/
+
+typedef struct {
+    // inputs
+    uint32_t slave_count;
+    uint16_t *slave_positions; // start
+    size_t buffer_size; // start
+    uint8_t *buffer; // start
+    char file_name[255]; // start
+    ec_ioctl_slave_foe_status_t *status; // status, end: slave_count entries
+
+    // outputs
+    uint32_t finished_count; // status, end
+} ec_ioctl_slave_foe_batch_t;
+
+/*****************************************************************************/
+
 typedef struct {
     // inputs
     uint16_t slave_position;
@@ -475,6 +581,20 @@ typedef struct {
 
 /*****************************************************************************/
 
+/** Maximum number of IDNs per list transfer.
+ */
+#define EC_IOCTL_SOE_LIST_MAX 0x10000
+
+typedef struct {
+    // inputs
+    uint16_t slave_position;
+    uint8_t drive_no;
+    uint32_t idn_count;
+    ec_soe_transfer_t *transfers; // outputs are stored in the list
+} ec_ioctl_slave_soe_list_t;
+
+/*****************************************************************************/
+
 typedef struct {
     // inputs
     uint32_t config_index;
@@ -791,8 +911,124 @@ typedef struct {
 
 /*****************************************************************************/
 
+typedef struct {
+    // inputs
+    uint32_t config_index;
+    uint32_t request_index; // SDO request, register request or VoE handler
+    uint64_t tag;
+} ec_ioctl_request_notify_t;
+
+/*****************************************************************************/
+
+typedef struct {
+    // inputs
+    uint32_t max_count;
+    ec_request_completion_t *completions;
+
+    // outputs
+    uint32_t count;
+} ec_ioctl_completions_t;
+
+/*****************************************************************************/
+
+typedef struct {
+    // inputs
+    uint32_t max_count;
+    ec_coe_emerg_event_t *events;
+
+    // outputs
+    uint32_t count;
+    uint32_t overruns;
+} ec_ioctl_emerg_events_t;
+
+/*****************************************************************************/
+
+/** Conditions of EC_IOCTL_MASTER_WAIT.
+ */
+enum {
+    EC_MASTER_WAIT_LINK_UP, /**< At least one device has link. */
+    EC_MASTER_WAIT_SCAN, /**< The bus scan matches the responding slaves. */
+    EC_MASTER_WAIT_AL_STATE /**< All slaves are in the given AL state. */
+};
+
+typedef struct {
+    // inputs
+    uint32_t condition;
+    uint32_t al_state;
+    uint32_t timeout_ms;
+
+    // outputs
+    ec_master_state_t state;
+} ec_ioctl_master_wait_t;
+
+/*****************************************************************************/
+
+/** Maximum size of a captured frame (including the Ethernet header).
+ */
+#define EC_CAPTURE_FRAME_SIZE 1536
+
+/** Capture filter modes.
+ */
+enum {
+    EC_CAPTURE_ALL, /**< Capture all sent and received frames. */
+    EC_CAPTURE_ERRORS /**< Capture only received frames containing corrupted
+                        or unmatched datagrams. */
+};
+
+/** Captured frame flags.
+ */
+enum {
+    EC_CAPTURE_FLAG_RX = 0x01, /**< Frame was received (else sent). */
+    EC_CAPTURE_FLAG_ERROR = 0x02 /**< Frame was corrupted or contained
+                                   unmatched datagrams. */
+};
+
+/** Offset to pass to mmap() to map the capture ring of a device.
+ */
+#define EC_CAPTURE_MMAP_OFFSET(DEV_IDX) \
+    (EC_CAPTURE_MMAP_BASE + (DEV_IDX) * EC_CAPTURE_MMAP_STRIDE)
+#define EC_CAPTURE_MMAP_BASE 0x40000000UL
+#define EC_CAPTURE_MMAP_STRIDE 0x10000000UL
+
+typedef struct {
+    uint64_t timestamp; // ns since epoch
+    uint16_t size;
+    uint8_t flags;
+    uint8_t reserved[5];
+    uint8_t data[EC_CAPTURE_FRAME_SIZE];
+} ec_ioctl_capture_frame_t;
+
+/** Capture ring header.
+ *
+ * Located at the start of the memory-mapped capture ring. The master is the
+ * only writer of \a head, the reader is the only writer of \a tail, so no
+ * locking is necessary.
+ */
+typedef struct {
+    volatile uint32_t head; // next slot to write (master)
+    volatile uint32_t tail; // next slot to read (reader)
+    uint32_t frame_count; // number of slots, power of two
+    uint32_t frames_offset; // offset of the first slot from the header
+    volatile uint32_t dropped; // frames dropped because the ring was full
+} ec_ioctl_capture_ring_t;
+
+typedef struct {
+    // inputs
+    uint32_t dev_idx;
+    uint32_t frame_count;
+    uint8_t filter;
+    uint32_t sample_interval;
+
+    // outputs
+    uint32_t mmap_size;
+} ec_ioctl_capture_t;
+
+/*****************************************************************************/
+
 #ifdef __KERNEL__
 
+#include "foe_request.h"
+
 /** Context data structure for file handles.
  */
 typedef struct {
@@ -800,10 +1036,21 @@ typedef struct {
     unsigned int requested; /**< Master was requested via this file handle. */
     uint8_t *process_data; /**< Total process data area. */
     size_t process_data_size; /**< Size of the \a process_data. */
+    unsigned int capture_mask; /**< Devices capturing via this handle. */
+    ec_foe_request_t *foe_request; /**< FoE transfer streamed via this
+                                     handle, or \a NULL. */
+    struct ec_ioctl_foe_batch *foe_batch; /**< FoE batch transfer started
+                                            via this handle, or \a NULL. */
+    unsigned int emerg_index; /**< Read index in the master's CoE emergency
+                                stream. */
+    unsigned int emerg_overruns; /**< CoE emergency events, that were
+                                   dropped before this handle read them. */
 } ec_ioctl_context_t;
 
 long ec_ioctl(ec_master_t *, ec_ioctl_context_t *, unsigned int,
         void __user *);
+void ec_ioctl_foe_stream_clear(ec_master_t *, ec_ioctl_context_t *);
+void ec_ioctl_foe_batch_clear(ec_master_t *, ec_ioctl_context_t *);
 
 #ifdef EC_RTDM
 
@@ -47,14 +47,15 @@
 #include "globals.h"
 #include "slave.h"
 #include "slave_config.h"
+#include "voe_handler.h"
 #include "device.h"
 #include "datagram.h"
 #ifdef EC_EOE
 #include "ethernet.h"
+#endif
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,11,0))
 #include <linux/sched/types.h>
 #endif
-#endif
 #include "master.h"
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(4,11,0))
 #include <linux/sched/signal.h>
@@ -106,6 +107,7 @@ static int ec_master_idle_thread(void *);
 static int ec_master_operation_thread(void *);
 #ifdef EC_EOE
 static int ec_master_eoe_thread(void *);
+static void ec_master_eoe_cycle(ec_master_t *);
 #endif
 void ec_master_find_dc_ref_clock(ec_master_t *);
 void ec_master_clear_device_stats(ec_master_t *);
@@ -142,7 +144,12 @@ int ec_master_init(ec_master_t *master, /**< EtherCAT master */
         const uint8_t *backup_mac, /**< MAC address of backup device */
         dev_t device_number, /**< Character device number. */
         struct class *class, /**< Device class. */
-        unsigned int debug_level /**< Debug level (module parameter). */
+        unsigned int debug_level, /**< Debug level (module parameter). */
+        unsigned int idle_irq, /**< Interrupt-assisted IDLE phase (module
+                                 parameter). */
+        unsigned int eoe_quota, /**< EoE bytes per application cycle (module
+                                  parameter). */
+        unsigned int bulk_mailbox /**< Bulk mailboxes (module parameter). */
         )
 {
     int ret;
@@ -215,6 +222,7 @@ int ec_master_init(ec_master_t *master, /**< EtherCAT master */
 
     // send interval in IDLE phase
     ec_master_set_send_interval(master, 1000000 / HZ);
+    master->process_data_size = 0;
 
     master->fsm_slave = NULL;
     INIT_LIST_HEAD(&master->fsm_exec_list);
@@ -227,13 +235,36 @@ int ec_master_init(ec_master_t *master, /**< EtherCAT master */
     master->stats.output_jiffies = 0;
 
     master->thread = NULL;
+    sema_init(&master->thread_sem, 1);
+    for (i = 0; i < EC_THREAD_COUNT; i++) {
+        master->thread_settings[i].cpu_mask = 0;
+        master->thread_settings[i].policy = SCHED_NORMAL;
+        master->thread_settings[i].priority = 0;
+    }
 
 #ifdef EC_EOE
     master->eoe_thread = NULL;
     INIT_LIST_HEAD(&master->eoe_handlers);
+    master->eoe_queue_start = 0;
+    master->eoe_quota = eoe_quota;
+    if (eoe_quota && eoe_quota < EC_MAX_DATA_SIZE) {
+        // a smaller quota could never fit a mailbox datagram
+        master->eoe_quota = EC_MAX_DATA_SIZE;
+        EC_MASTER_WARN(master, "EoE quota of %u bytes is less than one"
+                " datagram, using %zu bytes per cycle.\n",
+                eoe_quota, master->eoe_quota);
+    }
+    master->eoe_in_cycle = 0;
+    master->eoe_cycle_running = 0;
+    atomic_set(&master->eoe_cycle_busy, 0);
+    init_waitqueue_head(&master->eoe_cycle_queue);
 #endif
 
     sema_init(&master->io_sem, 1);
+    master->idle_irq = idle_irq;
+    init_waitqueue_head(&master->idle_irq_queue);
+    master->idle_irq_event = 0;
+    master->bulk_mailbox = bulk_mailbox;
     master->send_cb = NULL;
     master->receive_cb = NULL;
     master->cb_data = NULL;
@@ -314,13 +345,35 @@ int ec_master_init(ec_master_t *master, /**< EtherCAT master */
         goto out_clear_sync;
     }
 
+    // init request completion rings
+    ret = ec_completion_ring_init(&master->fsm_completions);
+    if (ret < 0) {
+        EC_MASTER_ERR(master, "Failed to allocate completion ring.\n");
+        goto out_clear_sync_mon;
+    }
+    ret = ec_completion_ring_init(&master->cycle_completions);
+    if (ret < 0) {
+        EC_MASTER_ERR(master, "Failed to allocate completion ring.\n");
+        goto out_clear_fsm_completions;
+    }
+    init_waitqueue_head(&master->completion_queue);
+    atomic_set(&master->voe_notify_pending, 0);
+
+    // init CoE emergency stream
+    ret = ec_coe_emerg_stream_init(&master->emerg_stream);
+    if (ret < 0) {
+        EC_MASTER_ERR(master, "Failed to allocate emergency stream.\n");
+        goto out_clear_completions;
+    }
+    init_waitqueue_head(&master->emerg_queue);
+
     master->dc_ref_config = NULL;
     master->dc_ref_clock = NULL;
 
     // init character device
     ret = ec_cdev_init(&master->cdev, master, device_number);
     if (ret)
-        goto out_clear_sync_mon;
+        goto out_clear_emerg_stream;
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 27)
     master->class_device = device_create(class, NULL,
@@ -365,6 +418,12 @@ out_unregister_class_device:
 #endif
 out_clear_cdev:
     ec_cdev_clear(&master->cdev);
+out_clear_emerg_stream:
+    ec_coe_emerg_stream_clear(&master->emerg_stream);
+out_clear_completions:
+    ec_completion_ring_clear(&master->cycle_completions);
+out_clear_fsm_completions:
+    ec_completion_ring_clear(&master->fsm_completions);
 out_clear_sync_mon:
     ec_datagram_clear(&master->sync_mon_datagram);
 out_clear_sync:
@@ -413,6 +472,10 @@ void ec_master_clear(
     ec_master_clear_slave_configs(master);
     ec_master_clear_slaves(master);
 
+    ec_coe_emerg_stream_clear(&master->emerg_stream);
+    ec_completion_ring_clear(&master->cycle_completions);
+    ec_completion_ring_clear(&master->fsm_completions);
+
     ec_datagram_clear(&master->sync_mon_datagram);
     ec_datagram_clear(&master->sync_datagram);
     ec_datagram_clear(&master->ref_sync_datagram);
@@ -568,6 +631,185 @@ void ec_master_internal_receive_cb(
 
 /*****************************************************************************/
 
+/** Applies CPU affinity and scheduling settings to a kernel thread.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+static int ec_master_thread_apply_settings(
+        ec_master_t *master, /**< EtherCAT master */
+        struct task_struct *thread, /**< Kernel thread. */
+        const ec_thread_settings_t *settings /**< Settings to apply. */
+        )
+{
+    struct sched_param param = { .sched_priority = 0 };
+    cpumask_var_t cpus;
+    unsigned int cpu;
+    int ret;
+
+    if (!zalloc_cpumask_var(&cpus, GFP_KERNEL)) {
+        return -ENOMEM;
+    }
+
+    if (settings->cpu_mask) {
+        for (cpu = 0; cpu < 64 && cpu < nr_cpu_ids; cpu++) {
+            if (settings->cpu_mask & (1ULL << cpu)) {
+                cpumask_set_cpu(cpu, cpus);
+            }
+        }
+    } else {
+        cpumask_copy(cpus, cpu_possible_mask);
+    }
+
+    ret = set_cpus_allowed_ptr(thread, cpus);
+    free_cpumask_var(cpus);
+    if (ret) {
+        EC_MASTER_ERR(master, "Failed to set CPU affinity of %s"
+                " (error %i)!\n", thread->comm, ret);
+        return ret;
+    }
+
+    if (settings->policy != SCHED_NORMAL) {
+        param.sched_priority = settings->priority;
+    }
+
+    ret = sched_setscheduler(thread, settings->policy, &param);
+    if (ret) {
+        EC_MASTER_ERR(master, "Failed to set scheduling policy of %s"
+                " (error %i)!\n", thread->comm, ret);
+        return ret;
+    }
+
+    if (settings->policy == SCHED_NORMAL) {
+        set_user_nice(thread, settings->priority);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+/** Returns the task of a kernel thread.
+ *
+ * The caller must hold the thread semaphore.
+ *
+ * \return Kernel thread, or \a NULL if not running.
+ */
+static struct task_struct *ec_master_thread_task(
+        ec_master_t *master, /**< EtherCAT master */
+        ec_thread_index_t thread /**< Thread index. */
+        )
+{
+    switch (thread) {
+        case EC_THREAD_MASTER:
+            return master->thread;
+#ifdef EC_EOE
+        case EC_THREAD_EOE:
+            return master->eoe_thread;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+/*****************************************************************************/
+
+/** Changes the CPU affinity and scheduling settings of a kernel thread.
+ *
+ * The settings are applied immediately, if the thread is running, and are
+ * used for any later start of the thread.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ec_master_set_thread_settings(
+        ec_master_t *master, /**< EtherCAT master */
+        ec_thread_index_t thread, /**< Thread index. */
+        const ec_thread_settings_t *settings /**< New settings. */
+        )
+{
+    struct task_struct *task;
+    unsigned int cpu, cpu_found = 0;
+    int ret = 0;
+
+    if (thread >= EC_THREAD_COUNT) {
+        return -EINVAL;
+    }
+
+    switch (settings->policy) {
+        case SCHED_NORMAL:
+            if (settings->priority < -20 || settings->priority > 19) {
+                return -EINVAL;
+            }
+            break;
+        case SCHED_FIFO:
+        case SCHED_RR:
+            if (settings->priority < 1
+                    || settings->priority > MAX_RT_PRIO - 1) {
+                return -EINVAL;
+            }
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    if (settings->cpu_mask) {
+        for (cpu = 0; cpu < 64 && cpu < nr_cpu_ids; cpu++) {
+            if ((settings->cpu_mask & (1ULL << cpu)) && cpu_online(cpu)) {
+                cpu_found = 1;
+                break;
+            }
+        }
+        if (!cpu_found) {
+            EC_MASTER_ERR(master, "CPU mask 0x%llx contains no online"
+                    " CPU!\n", settings->cpu_mask);
+            return -EINVAL;
+        }
+    }
+
+    if (down_interruptible(&master->thread_sem)) {
+        return -EINTR;
+    }
+
+    master->thread_settings[thread] = *settings;
+
+    task = ec_master_thread_task(master, thread);
+    if (task) {
+        ret = ec_master_thread_apply_settings(master, task, settings);
+    }
+
+    up(&master->thread_sem);
+    return ret;
+}
+
+/*****************************************************************************/
+
+/** Gets the settings and the consumed CPU time of a kernel thread.
+ *
+ * \return Non-zero, if the thread is running.
+ */
+int ec_master_thread_info(
+        ec_master_t *master, /**< EtherCAT master */
+        ec_thread_index_t thread, /**< Thread index. */
+        ec_thread_settings_t *settings, /**< Current settings. */
+        u64 *cpu_time /**< CPU time in nanoseconds. */
+        )
+{
+    struct task_struct *task;
+
+    *cpu_time = 0;
+
+    down(&master->thread_sem);
+    *settings = master->thread_settings[thread];
+    task = ec_master_thread_task(master, thread);
+    if (task) {
+        *cpu_time = task->se.sum_exec_runtime;
+    }
+    up(&master->thread_sem);
+
+    return task != NULL;
+}
+
+/*****************************************************************************/
+
 /** Starts the master thread.
  *
  * \retval  0 Success.
@@ -579,16 +821,28 @@ int ec_master_thread_start(
         const char *name /**< Thread name. */
         )
 {
+    struct task_struct *thread;
+
     EC_MASTER_INFO(master, "Starting %s thread.\n", name);
-    master->thread = kthread_run(thread_func, master, name);
-    if (IS_ERR(master->thread)) {
-        int err = (int) PTR_ERR(master->thread);
+
+    down(&master->thread_sem);
+
+    thread = kthread_create(thread_func, master, name);
+    if (IS_ERR(thread)) {
+        int err = (int) PTR_ERR(thread);
+        up(&master->thread_sem);
         EC_MASTER_ERR(master, "Failed to start master thread (error %i)!\n",
                 err);
-        master->thread = NULL;
         return err;
     }
 
+    // apply settings before the thread runs for the first time
+    ec_master_thread_apply_settings(master, thread,
+            &master->thread_settings[EC_THREAD_MASTER]);
+    master->thread = thread;
+    wake_up_process(thread);
+
+    up(&master->thread_sem);
     return 0;
 }
 
@@ -601,16 +855,23 @@ void ec_master_thread_stop(
         )
 {
     unsigned long sleep_jiffies;
+    struct task_struct *thread;
+
+    down(&master->thread_sem);
+    thread = master->thread;
+    master->thread = NULL;
+    up(&master->thread_sem);
 
-    if (!master->thread) {
+    if (!thread) {
         EC_MASTER_WARN(master, "%s(): Already finished!\n", __func__);
         return;
     }
 
     EC_MASTER_DBG(master, 1, "Stopping master thread.\n");
 
-    kthread_stop(master->thread);
-    master->thread = NULL;
+    // The semaphore must not be held here: the master state machine running
+    // in the thread starts and stops the EoE thread, which takes it, too.
+    kthread_stop(thread);
     EC_MASTER_INFO(master, "Master thread exited.\n");
 
     if (master->fsm_datagram.state != EC_DATAGRAM_SENT) {
@@ -751,6 +1012,11 @@ int ec_master_enter_operation_phase(
     }
 #endif
 
+    // discard completions left over by a previous application
+    ec_completion_ring_reset(&master->fsm_completions);
+    ec_completion_ring_reset(&master->cycle_completions);
+    atomic_set(&master->voe_notify_pending, 0);
+
     master->phase = EC_OPERATION;
     master->app_send_cb = NULL;
     master->app_receive_cb = NULL;
@@ -799,6 +1065,12 @@ void ec_master_inject_external_datagrams(
     unsigned int datagram_count = 0;
 #endif
 
+#ifdef EC_EOE
+    if (master->eoe_cycle_running) {
+        ec_master_eoe_cycle(master);
+    }
+#endif
+
     if (master->ext_ring_idx_rt == master->ext_ring_idx_fsm) {
         // nothing to inject
         return;
@@ -1109,6 +1381,10 @@ size_t ec_master_send_datagrams(
     }
     while (more_datagrams_waiting && frame_count < EC_TX_RING_SIZE);
 
+    if (frame_count) {
+        ec_device_flush(&master->devices[device_index]);
+    }
+
 #ifdef EC_HAVE_CYCLES
     if (unlikely(master->debug_level > 1)) {
         cycles_end = get_cycles();
@@ -1126,9 +1402,10 @@ size_t ec_master_send_datagrams(
  *
  * This function is called by the network driver for every received frame.
  *
- * \return 0 in case of success, else < 0
+ * \return Number of corrupted frames and unmatched datagrams, so zero in
+ *         case of success.
  */
-void ec_master_receive_datagrams(
+unsigned int ec_master_receive_datagrams(
         ec_master_t *master, /**< EtherCAT master */
         ec_device_t *device, /**< EtherCAT device */
         const uint8_t *frame_data, /**< frame data */
@@ -1137,7 +1414,7 @@ void ec_master_receive_datagrams(
 {
     size_t frame_size, data_size;
     uint8_t datagram_type, datagram_index;
-    unsigned int cmd_follows, matched;
+    unsigned int cmd_follows, matched, errors = 0;
     const uint8_t *cur_data;
     ec_datagram_t *datagram;
 
@@ -1152,7 +1429,7 @@ void ec_master_receive_datagrams(
 #ifdef EC_RT_SYSLOG
         ec_master_output_stats(master);
 #endif
-        return;
+        return 1;
     }
 
     cur_data = frame_data;
@@ -1173,7 +1450,7 @@ void ec_master_receive_datagrams(
 #ifdef EC_RT_SYSLOG
         ec_master_output_stats(master);
 #endif
-        return;
+        return 1;
     }
 
     cmd_follows = 1;
@@ -1197,7 +1474,7 @@ void ec_master_receive_datagrams(
 #ifdef EC_RT_SYSLOG
             ec_master_output_stats(master);
 #endif
-            return;
+            return errors + 1;
         }
 
         // search for matching datagram in the queue
@@ -1215,6 +1492,7 @@ void ec_master_receive_datagrams(
         // no matching datagram was found
         if (!matched) {
             master->stats.unmatched++;
+            errors++;
 #ifdef EC_RT_SYSLOG
             ec_master_output_stats(master);
 #endif
@@ -1257,6 +1535,8 @@ void ec_master_receive_datagrams(
             master->devices[EC_DEVICE_MAIN].jiffies_poll;
         list_del_init(&datagram->queue);
     }
+
+    return errors;
 }
 
 /*****************************************************************************/
@@ -1539,6 +1819,63 @@ void ec_master_exec_slave_fsms(
 
 /*****************************************************************************/
 
+/** Checks, if the master can wait for receive interrupts in IDLE phase.
+ *
+ * \return Non-zero, if enabled and supported by all devices.
+ */
+static int ec_master_idle_irq_capable(
+        const ec_master_t *master /**< EtherCAT master */
+        )
+{
+    unsigned int dev_idx;
+
+    if (!master->idle_irq) {
+        return 0;
+    }
+
+    for (dev_idx = EC_DEVICE_MAIN; dev_idx < ec_master_num_devices(master);
+            dev_idx++) {
+        if (!master->devices[dev_idx].irq) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*****************************************************************************/
+
+/** Waits for a receive interrupt in IDLE phase.
+ *
+ * The receive interrupts of the devices are enabled only while waiting, so
+ * that the devices are polled as usual, otherwise.
+ */
+static void ec_master_idle_irq_wait(
+        ec_master_t *master, /**< EtherCAT master */
+        long timeout /**< Timeout in jiffies. */
+        )
+{
+    unsigned int dev_idx;
+
+    master->idle_irq_event = 0;
+    smp_mb();
+
+    for (dev_idx = EC_DEVICE_MAIN; dev_idx < ec_master_num_devices(master);
+            dev_idx++) {
+        ec_device_set_irq(&master->devices[dev_idx], 1);
+    }
+
+    wait_event_interruptible_timeout(master->idle_irq_queue,
+            master->idle_irq_event || kthread_should_stop(), timeout);
+
+    for (dev_idx = EC_DEVICE_MAIN; dev_idx < ec_master_num_devices(master);
+            dev_idx++) {
+        ec_device_set_irq(&master->devices[dev_idx], 0);
+    }
+}
+
+/*****************************************************************************/
+
 /** Master kernel thread function for IDLE phase.
  */
 static int ec_master_idle_thread(void *priv_data)
@@ -1588,6 +1925,9 @@ static int ec_master_idle_thread(void *priv_data)
             set_current_state(TASK_INTERRUPTIBLE);
             schedule_timeout(1);
 #endif
+        } else if (ec_master_idle_irq_capable(master)) {
+            // sleep until the response arrives or the FSM timer expires
+            ec_master_idle_irq_wait(master, 1);
         } else {
 #ifdef EC_USE_HRTIMER
             ec_master_nanosleep(
@@ -1638,6 +1978,13 @@ static int ec_master_operation_thread(void *priv_data)
             up(&master->master_sem);
         }
 
+        // VoE completions are posted from the application cycle, which may
+        // run in a real-time domain, so the readers are woken here
+        if (!ec_completion_ring_empty(&master->cycle_completions)
+                && waitqueue_active(&master->completion_queue)) {
+            wake_up_interruptible(&master->completion_queue);
+        }
+
 #ifdef EC_USE_HRTIMER
         // the op thread should not work faster than the sending RT thread
         ec_master_nanosleep(master->send_interval * 1000);
@@ -1663,9 +2010,9 @@ static int ec_master_operation_thread(void *priv_data)
  */
 void ec_master_eoe_start(ec_master_t *master /**< EtherCAT master */)
 {
-    struct sched_param param = { .sched_priority = 0 };
+    struct task_struct *thread;
 
-    if (master->eoe_thread) {
+    if (master->eoe_thread || master->eoe_cycle_running) {
         EC_MASTER_WARN(master, "EoE already running!\n");
         return;
     }
@@ -1673,6 +2020,14 @@ void ec_master_eoe_start(ec_master_t *master /**< EtherCAT master */)
     if (list_empty(&master->eoe_handlers))
         return;
 
+    if (master->eoe_in_cycle) {
+        EC_MASTER_INFO(master, "Starting EoE processing in the"
+                " application cycle (%zu bytes per cycle).\n",
+                master->eoe_quota);
+        master->eoe_cycle_running = 1;
+        return;
+    }
+
     if (!master->send_cb || !master->receive_cb) {
         EC_MASTER_WARN(master, "No EoE processing"
                 " because of missing callbacks!\n");
@@ -1680,18 +2035,24 @@ void ec_master_eoe_start(ec_master_t *master /**< EtherCAT master */)
     }
 
     EC_MASTER_INFO(master, "Starting EoE thread.\n");
-    master->eoe_thread = kthread_run(ec_master_eoe_thread, master,
-            "EtherCAT-EoE");
-    if (IS_ERR(master->eoe_thread)) {
-        int err = (int) PTR_ERR(master->eoe_thread);
+
+    down(&master->thread_sem);
+
+    thread = kthread_create(ec_master_eoe_thread, master, "EtherCAT-EoE");
+    if (IS_ERR(thread)) {
+        int err = (int) PTR_ERR(thread);
+        up(&master->thread_sem);
         EC_MASTER_ERR(master, "Failed to start EoE thread (error %i)!\n",
                 err);
-        master->eoe_thread = NULL;
         return;
     }
 
-    sched_setscheduler(master->eoe_thread, SCHED_NORMAL, &param);
-    set_user_nice(master->eoe_thread, 0);
+    ec_master_thread_apply_settings(master, thread,
+            &master->thread_settings[EC_THREAD_EOE]);
+    master->eoe_thread = thread;
+    wake_up_process(thread);
+
+    up(&master->thread_sem);
 }
 
 /*****************************************************************************/
@@ -1700,17 +2061,126 @@ void ec_master_eoe_start(ec_master_t *master /**< EtherCAT master */)
  */
 void ec_master_eoe_stop(ec_master_t *master /**< EtherCAT master */)
 {
-    if (master->eoe_thread) {
+    struct task_struct *thread;
+
+    if (master->eoe_cycle_running) {
+        EC_MASTER_INFO(master, "Stopping EoE processing"
+                " in the application cycle.\n");
+
+        master->eoe_cycle_running = 0;
+        smp_mb();
+        // wait for a concurrent ec_master_eoe_cycle() to finish
+        wait_event(master->eoe_cycle_queue,
+                !atomic_read(&master->eoe_cycle_busy));
+    }
+
+    down(&master->thread_sem);
+    thread = master->eoe_thread;
+    master->eoe_thread = NULL;
+    up(&master->thread_sem);
+
+    if (thread) {
         EC_MASTER_INFO(master, "Stopping EoE thread.\n");
 
-        kthread_stop(master->eoe_thread);
-        master->eoe_thread = NULL;
+        // not under the semaphore, see ec_master_thread_stop()
+        kthread_stop(thread);
         EC_MASTER_INFO(master, "EoE thread exited.\n");
     }
 }
 
 /*****************************************************************************/
 
+/** Queues the pending EoE datagrams within a byte budget.
+ *
+ * Handlers are served round-robin, starting with the first one that had to
+ * be deferred in the previous call, so that no handler starves when the
+ * budget is exhausted.
+ */
+static void ec_master_eoe_queue(
+        ec_master_t *master, /**< EtherCAT master */
+        size_t budget /**< Number of bytes that may be queued. */
+        )
+{
+    ec_eoe_t *eoe;
+    unsigned int index, start = master->eoe_queue_start, pass;
+    int deferred = 0;
+
+    for (pass = 0; pass < 2; pass++) {
+        index = 0;
+        list_for_each_entry(eoe, &master->eoe_handlers, list) {
+            if ((pass == 0 && index >= start) ||
+                    (pass == 1 && index < start)) {
+                if (ec_eoe_queue(eoe, &budget) && !deferred) {
+                    master->eoe_queue_start = index;
+                    deferred = 1;
+                }
+            }
+            index++;
+        }
+    }
+
+    if (!deferred) {
+        master->eoe_queue_start = 0;
+    }
+}
+
+/*****************************************************************************/
+
+/** Returns the EoE thread's budget for one pass.
+ *
+ * This is the part of \a max_queue_size not occupied by process data, but
+ * at least one maximum-sized datagram.
+ *
+ * \return Number of bytes that may be queued.
+ */
+static size_t ec_master_eoe_thread_budget(
+        const ec_master_t *master /**< EtherCAT master */
+        )
+{
+    size_t budget = 0;
+
+    if (master->max_queue_size > master->process_data_size) {
+        budget = master->max_queue_size - master->process_data_size;
+    }
+    return max(budget, (size_t) EC_MAX_DATA_SIZE);
+}
+
+/*****************************************************************************/
+
+/** Processes the EoE handlers as a stage of the application cycle.
+ *
+ * Called from ecrt_master_send() in operation phase, if the \a eoe_quota
+ * module parameter is set and the application cycle runs in Linux context,
+ * see ec_master_activate(). The handlers evaluate the datagrams received by
+ * the preceding ecrt_master_receive() and queue their next datagrams
+ * directly into the datagram queue, up to \a eoe_quota bytes per cycle.
+ * This replaces the EoE thread together with its receive/send callbacks.
+ */
+static void ec_master_eoe_cycle(
+        ec_master_t *master /**< EtherCAT master */
+        )
+{
+    ec_eoe_t *eoe;
+
+    atomic_inc(&master->eoe_cycle_busy);
+    smp_mb();
+
+    if (master->eoe_cycle_running) {
+        list_for_each_entry(eoe, &master->eoe_handlers, list) {
+            ec_eoe_run(eoe);
+        }
+        ec_master_eoe_queue(master, master->eoe_quota);
+    }
+
+    // full barrier, pairs with the one in ec_master_eoe_stop()
+    if (atomic_dec_and_test(&master->eoe_cycle_busy)
+            && !master->eoe_cycle_running) {
+        wake_up(&master->eoe_cycle_queue);
+    }
+}
+
+/*****************************************************************************/
+
 /** Does the Ethernet over EtherCAT processing.
  */
 static int ec_master_eoe_thread(void *priv_data)
@@ -1741,7 +2211,7 @@ static int ec_master_eoe_thread(void *priv_data)
         sth_to_send = 0;
         list_for_each_entry(eoe, &master->eoe_handlers, list) {
             ec_eoe_run(eoe);
-            if (eoe->queue_datagram) {
+            if (ec_eoe_has_datagrams(eoe)) {
                 sth_to_send = 1;
             }
             if (!ec_eoe_is_idle(eoe)) {
@@ -1750,9 +2220,8 @@ static int ec_master_eoe_thread(void *priv_data)
         }
 
         if (sth_to_send) {
-            list_for_each_entry(eoe, &master->eoe_handlers, list) {
-                ec_eoe_queue(eoe);
-            }
+            ec_master_eoe_queue(master,
+                    ec_master_eoe_thread_budget(master));
             // (try to) send datagrams
             down(&master->ext_queue_sem);
             master->send_cb(master->cb_data);
@@ -1805,6 +2274,129 @@ void ec_master_expire_slave_config_requests(
 
 /*****************************************************************************/
 
+/** Posts the completion of a request with enabled notification.
+ *
+ * Wakes up the readers, so this must only be called from Linux context.
+ */
+void ec_master_post_completion(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_completion_ring_t *ring, /**< Ring of the posting context. */
+        uint64_t tag, /**< Tag of the request. */
+        ec_internal_request_state_t state /**< Final request state. */
+        )
+{
+    ec_completion_ring_push(ring, tag,
+            ec_request_state_translation_table[state]);
+
+    if (waitqueue_active(&master->completion_queue)) {
+        wake_up_interruptible(&master->completion_queue);
+    }
+}
+
+/*****************************************************************************/
+
+/** Posts the completion of a slave configuration's SDO request, if the
+ * application asked for it.
+ */
+void ec_master_sdo_request_done(
+        ec_master_t *master, /**< EtherCAT master. */
+        const ec_sdo_request_t *req /**< Finished SDO request. */
+        )
+{
+    if (req->notify) {
+        ec_master_post_completion(master, &master->fsm_completions,
+                req->notify_tag, req->state);
+    }
+}
+
+/*****************************************************************************/
+
+/** Posts the completion of a register request, if the application asked for
+ * it.
+ */
+void ec_master_reg_request_done(
+        ec_master_t *master, /**< EtherCAT master. */
+        const ec_reg_request_t *reg /**< Finished register request. */
+        )
+{
+    if (reg->notify) {
+        ec_master_post_completion(master, &master->fsm_completions,
+                reg->notify_tag, reg->state);
+    }
+}
+
+/*****************************************************************************/
+
+/** Checks, if completions were dropped since the last call.
+ *
+ * \return -EOVERFLOW, if completions were lost, otherwise zero.
+ */
+int ec_master_completions_lost(
+        ec_master_t *master /**< EtherCAT master. */
+        )
+{
+    unsigned int lost;
+
+    lost = ec_completion_ring_overruns(&master->fsm_completions);
+    lost += ec_completion_ring_overruns(&master->cycle_completions);
+    return lost ? -EOVERFLOW : 0;
+}
+
+/*****************************************************************************/
+
+/** Removes pending completions from the completion rings.
+ *
+ * \return Number of completions stored in \a completions.
+ */
+size_t ec_master_pop_completions(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_request_completion_t *completions, /**< Target memory. */
+        size_t max_count /**< Maximum number of completions. */
+        )
+{
+    size_t count;
+
+    count = ec_completion_ring_pop(&master->fsm_completions,
+            completions, max_count);
+    count += ec_completion_ring_pop(&master->cycle_completions,
+            completions + count, max_count - count);
+    return count;
+}
+
+/*****************************************************************************/
+
+/** Checks, if there are completions to be fetched.
+ *
+ * \return Non-zero, if at least one completion is pending.
+ */
+int ec_master_completions_pending(
+        const ec_master_t *master /**< EtherCAT master. */
+        )
+{
+    return !ec_completion_ring_empty(&master->fsm_completions)
+        || !ec_completion_ring_empty(&master->cycle_completions);
+}
+
+/*****************************************************************************/
+
+/** Appends a CoE emergency message to the master-wide stream and wakes up
+ * waiting readers.
+ */
+void ec_master_post_emergency(
+        ec_master_t *master, /**< EtherCAT master. */
+        const ec_slave_t *slave, /**< Slave that sent the message. */
+        const uint8_t *msg /**< Emergency message. */
+        )
+{
+    ec_coe_emerg_stream_push(&master->emerg_stream, slave, msg);
+
+    if (waitqueue_active(&master->emerg_queue)) {
+        wake_up_interruptible(&master->emerg_queue);
+    }
+}
+
+/*****************************************************************************/
+
 /** Common implementation for ec_master_find_slave()
  * and ec_master_find_slave_const().
  */
@@ -2307,7 +2899,20 @@ ec_domain_t *ecrt_master_create_domain(
 
 /*****************************************************************************/
 
-int ecrt_master_activate(ec_master_t *master)
+/** Activates the master.
+ *
+ * The EoE handlers may only be processed in the application cycle (see the
+ * \a eoe_quota module parameter), if the cycle runs in Linux context, because
+ * they feed the network stack. This is only known for applications using the
+ * character device, the application cycle of kernel modules and RTDM
+ * applications may run in a real-time domain.
+ *
+ * \return Zero on success, otherwise a negative error code.
+ */
+int ec_master_activate(
+        ec_master_t *master, /**< EtherCAT master. */
+        int linux_cycle /**< The application cycle runs in Linux context. */
+        )
 {
     uint32_t domain_offset;
     ec_domain_t *domain;
@@ -2336,6 +2941,7 @@ int ecrt_master_activate(ec_master_t *master)
         }
         domain_offset += domain->data_size;
     }
+    master->process_data_size = domain_offset;
 
     up(&master->master_sem);
 
@@ -2345,6 +2951,11 @@ int ecrt_master_activate(ec_master_t *master)
 #ifdef EC_EOE
     eoe_was_running = master->eoe_thread != NULL;
     ec_master_eoe_stop(master);
+    master->eoe_in_cycle = master->eoe_quota && linux_cycle;
+    if (master->eoe_quota && !linux_cycle) {
+        EC_MASTER_WARN(master, "Ignoring eoe_quota, the application cycle"
+                " may run in a real-time domain. Using the EoE thread.\n");
+    }
 #endif
 
     EC_MASTER_DBG(master, 1, "FSM datagram is %p.\n", &master->fsm_datagram);
@@ -2381,6 +2992,13 @@ int ecrt_master_activate(ec_master_t *master)
 
 /*****************************************************************************/
 
+int ecrt_master_activate(ec_master_t *master)
+{
+    return ec_master_activate(master, 0);
+}
+
+/*****************************************************************************/
+
 void ecrt_master_deactivate(ec_master_t *master)
 {
     ec_slave_t *slave;
@@ -2398,8 +3016,10 @@ void ecrt_master_deactivate(ec_master_t *master)
 
     ec_master_thread_stop(master);
 #ifdef EC_EOE
-    eoe_was_running = master->eoe_thread != NULL;
+    eoe_was_running = master->eoe_thread != NULL ||
+        master->eoe_cycle_running;
     ec_master_eoe_stop(master);
+    master->eoe_in_cycle = 0;
 #endif
 
     master->send_cb = ec_master_internal_send_cb;
@@ -2407,6 +3027,8 @@ void ecrt_master_deactivate(ec_master_t *master)
     master->cb_data = master;
 
     ec_master_clear_config(master);
+    master->process_data_size = 0;
+    atomic_set(&master->voe_notify_pending, 0); // handlers are gone
 
     for (slave = master->slaves;
             slave < master->slaves + master->slave_count;
@@ -2452,12 +3074,59 @@ void ecrt_master_deactivate(ec_master_t *master)
 
 /*****************************************************************************/
 
+/** Executes the VoE handlers with a pending notified request.
+ *
+ * The slave configurations are only traversed in operation phase after
+ * activation, because the list is static then, and only while a notified
+ * request is pending. The completions are only pushed to the ring, waking
+ * up the readers is left to the operation thread.
+ */
+static void ec_master_exec_voe_handlers(
+        ec_master_t *master /**< EtherCAT master. */
+        )
+{
+    ec_slave_config_t *sc;
+    ec_voe_handler_t *voe;
+    ec_request_state_t state;
+
+    if (!atomic_read(&master->voe_notify_pending)) {
+        return;
+    }
+
+    list_for_each_entry(sc, &master->configs, list) {
+        list_for_each_entry(voe, &sc->voe_handlers, list) {
+            if (!voe->notify_pending) {
+                continue;
+            }
+
+            if (voe->request_state == EC_INT_REQUEST_BUSY) {
+                ecrt_voe_handler_execute(voe);
+            }
+
+            // the application may have executed the handler itself
+            if (voe->request_state != EC_INT_REQUEST_BUSY) {
+                state = ec_request_state_translation_table[
+                    voe->request_state];
+                ec_completion_ring_push(&master->cycle_completions,
+                        voe->notify_tag, state);
+                voe->notify_pending = 0;
+                atomic_dec(&master->voe_notify_pending);
+            }
+        }
+    }
+}
+
+/*****************************************************************************/
+
 size_t ecrt_master_send(ec_master_t *master)
 {
     ec_datagram_t *datagram, *n;
     ec_device_index_t dev_idx;
     size_t sent_bytes = 0;
 
+    if (master->active) {
+        ec_master_exec_voe_handlers(master);
+    }
 
     if (master->injection_seq_rt != master->injection_seq_fsm) {
         // inject datagram produced by master FSM
@@ -3272,6 +3941,168 @@ int ecrt_master_read_idn(ec_master_t *master, uint16_t slave_position,
 
 /*****************************************************************************/
 
+/** Executes a list of SoE requests.
+ *
+ * All requests are queued in one go, so that the slave FSM can process them
+ * back-to-back without waiting for the caller in between.
+ *
+ * \retval  0 Success.
+ * \retval -EIO At least one request failed.
+ * \retval <0 Error code.
+ */
+static int ec_master_transfer_idns(
+        ec_master_t *master, /**< EtherCAT master. */
+        uint16_t slave_position, /**< Slave position. */
+        uint8_t drive_no, /**< Drive number. */
+        ec_soe_transfer_t *transfers, /**< IDN list. */
+        size_t count, /**< Number of list elements. */
+        int write /**< Write the IDNs instead of reading them. */
+        )
+{
+    ec_soe_request_t *requests;
+    ec_slave_t *slave;
+    size_t i, j;
+    int ret = 0, interrupted = 0;
+
+    if (drive_no > 7) {
+        EC_MASTER_ERR(master, "Invalid drive number!\n");
+        return -EINVAL;
+    }
+
+    if (!count) {
+        return 0;
+    }
+
+    requests = kmalloc(count * sizeof(ec_soe_request_t), GFP_KERNEL);
+    if (!requests) {
+        EC_MASTER_ERR(master, "Failed to allocate %zu SoE requests.\n",
+                count);
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < count; i++) {
+        ec_soe_request_init(&requests[i]);
+        ec_soe_request_set_drive_no(&requests[i], drive_no);
+        ec_soe_request_set_idn(&requests[i], transfers[i].idn);
+        transfers[i].result_size = 0;
+        transfers[i].error_code = 0;
+        transfers[i].result = 0;
+
+        if (write) {
+            ret = ec_soe_request_alloc(&requests[i], transfers[i].size);
+            if (ret) {
+                ec_soe_request_clear(&requests[i]);
+                goto out_clear;
+            }
+            memcpy(requests[i].data, transfers[i].data, transfers[i].size);
+            requests[i].data_size = transfers[i].size;
+            ec_soe_request_write(&requests[i]);
+        } else {
+            ec_soe_request_read(&requests[i]);
+        }
+    }
+
+    if (down_interruptible(&master->master_sem)) {
+        ret = -EINTR;
+        goto out_clear;
+    }
+
+    if (!(slave = ec_master_find_slave(master, 0, slave_position))) {
+        up(&master->master_sem);
+        EC_MASTER_ERR(master, "Slave %u does not exist!\n", slave_position);
+        ret = -EINVAL;
+        goto out_clear;
+    }
+
+    EC_SLAVE_DBG(slave, 1, "Scheduling %zu SoE %s requests.\n", count,
+            write ? "write" : "read");
+
+    for (i = 0; i < count; i++) {
+        list_add_tail(&requests[i].list, &slave->soe_requests);
+    }
+
+    up(&master->master_sem);
+
+    for (i = 0; i < count; i++) {
+        // wait for processing through FSM
+        if (wait_event_interruptible(master->request_queue,
+                    requests[i].state != EC_INT_REQUEST_QUEUED)) {
+            // interrupted by signal: abort all requests still queued
+            down(&master->master_sem);
+            for (j = i; j < count; j++) {
+                if (requests[j].state == EC_INT_REQUEST_QUEUED) {
+                    list_del(&requests[j].list);
+                    requests[j].state = EC_INT_REQUEST_FAILURE;
+                    transfers[j].result = -EINTR;
+                }
+            }
+            up(&master->master_sem);
+            interrupted = 1;
+        }
+
+        // wait until master FSM has finished processing
+        wait_event(master->request_queue,
+                requests[i].state != EC_INT_REQUEST_BUSY);
+    }
+
+    for (i = 0; i < count; i++) {
+        ec_soe_transfer_t *transfer = &transfers[i];
+
+        transfer->error_code = requests[i].error_code;
+
+        if (transfer->result) { // aborted
+            continue;
+        }
+
+        if (requests[i].state != EC_INT_REQUEST_SUCCESS) {
+            transfer->result = -EIO;
+        } else if (!write) {
+            transfer->result_size = requests[i].data_size;
+            if (requests[i].data_size > transfer->size) {
+                transfer->result = -EOVERFLOW;
+            } else {
+                memcpy(transfer->data, requests[i].data,
+                        requests[i].data_size);
+            }
+        }
+
+        if (transfer->result && !ret) {
+            ret = -EIO;
+        }
+    }
+
+    if (interrupted) {
+        ret = -EINTR;
+    }
+
+out_clear:
+    for (j = 0; j < i; j++) {
+        ec_soe_request_clear(&requests[j]);
+    }
+    kfree(requests);
+    return ret;
+}
+
+/*****************************************************************************/
+
+int ecrt_master_read_idns(ec_master_t *master, uint16_t slave_position,
+        uint8_t drive_no, ec_soe_transfer_t *transfers, size_t count)
+{
+    return ec_master_transfer_idns(master, slave_position, drive_no,
+            transfers, count, 0);
+}
+
+/*****************************************************************************/
+
+int ecrt_master_write_idns(ec_master_t *master, uint16_t slave_position,
+        uint8_t drive_no, ec_soe_transfer_t *transfers, size_t count)
+{
+    return ec_master_transfer_idns(master, slave_position, drive_no,
+            transfers, count, 1);
+}
+
+/*****************************************************************************/
+
 void ecrt_master_reset(ec_master_t *master)
 {
     ec_slave_config_t *sc;
@@ -3285,6 +4116,21 @@ void ecrt_master_reset(ec_master_t *master)
 
 /*****************************************************************************/
 
+int ecrt_master_completions(ec_master_t *master,
+        ec_request_completion_t *completions, size_t max_count)
+{
+    int ret;
+
+    ret = ec_master_completions_lost(master);
+    if (ret) {
+        return ret;
+    }
+
+    return ec_master_pop_completions(master, completions, max_count);
+}
+
+/*****************************************************************************/
+
 /** \cond */
 
 EXPORT_SYMBOL(ecrt_master_create_domain);
@@ -3311,7 +4157,10 @@ EXPORT_SYMBOL(ecrt_master_sdo_download_complete);
 EXPORT_SYMBOL(ecrt_master_sdo_upload);
 EXPORT_SYMBOL(ecrt_master_write_idn);
 EXPORT_SYMBOL(ecrt_master_read_idn);
+EXPORT_SYMBOL(ecrt_master_write_idns);
+EXPORT_SYMBOL(ecrt_master_read_idns);
 EXPORT_SYMBOL(ecrt_master_reset);
+EXPORT_SYMBOL(ecrt_master_completions);
 
 /** \endcond */
 
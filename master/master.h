@@ -54,6 +54,8 @@
 #include "ethernet.h"
 #include "fsm_master.h"
 #include "cdev.h"
+#include "completion_ring.h"
+#include "coe_emerg_stream.h"
 
 #ifdef EC_RTDM
 #include "rtdm.h"
@@ -181,6 +183,19 @@ typedef struct {
 
 /*****************************************************************************/
 
+/** Kernel thread settings.
+ */
+typedef struct {
+    u64 cpu_mask; /**< CPUs the thread may run on (one bit per CPU), or zero
+                    for all CPUs. */
+    int policy; /**< Scheduling policy (SCHED_NORMAL, SCHED_FIFO or
+                  SCHED_RR). */
+    int priority; /**< Real-time priority, or nice value for
+                    SCHED_NORMAL. */
+} ec_thread_settings_t;
+
+/*****************************************************************************/
+
 #if EC_MAX_NUM_DEVICES < 1
 #error Invalid number of devices
 #endif
@@ -253,7 +268,8 @@ struct ec_master {
     struct semaphore scan_sem; /**< Semaphore protecting the \a scan_busy
                                  variable and the \a allow_scan flag. */
     wait_queue_head_t scan_queue; /**< Queue for processes that wait for
-                                    slave scanning. */
+                                    slave scanning, also woken on changes of
+                                    the link and the slave states. */
 
     unsigned int config_busy; /**< State of slave configuration. */
     struct semaphore config_sem; /**< Semaphore protecting the \a config_busy
@@ -278,6 +294,8 @@ struct ec_master {
     unsigned int send_interval; /**< Interval between two calls to
                                   ecrt_master_send(). */
     size_t max_queue_size; /**< Maximum size of datagram queue */
+    size_t process_data_size; /**< Size of the process data of all domains,
+                                known after ecrt_master_activate(). */
 
     ec_slave_t *fsm_slave; /**< Slave that is queried next for FSM exec. */
     struct list_head fsm_exec_list; /**< Slave FSM execution list. */
@@ -287,14 +305,40 @@ struct ec_master {
     ec_stats_t stats; /**< Cyclic statistics. */
 
     struct task_struct *thread; /**< Master thread. */
+    struct semaphore thread_sem; /**< Semaphore protecting the thread
+                                   pointers and settings. */
+    ec_thread_settings_t thread_settings[EC_THREAD_COUNT]; /**< Settings of
+                                                             the kernel
+                                                             threads. */
 
 #ifdef EC_EOE
     struct task_struct *eoe_thread; /**< EoE thread. */
     struct list_head eoe_handlers; /**< Ethernet over EtherCAT handlers. */
+    unsigned int eoe_queue_start; /**< Index of the EoE handler, whose
+                                    datagrams are queued first. */
+    size_t eoe_quota; /**< EoE bytes per application cycle in operation
+                        phase, or zero to use the EoE thread. */
+    unsigned int eoe_in_cycle; /**< EoE is processed in the application
+                                 cycle instead of the EoE thread. */
+    volatile unsigned int eoe_cycle_running; /**< In-cycle EoE processing is
+                                               started. */
+    atomic_t eoe_cycle_busy; /**< The application cycle is processing EoE.
+                              */
+    wait_queue_head_t eoe_cycle_queue; /**< Wait queue for the end of the
+                                         in-cycle EoE processing. */
 #endif
 
     struct semaphore io_sem; /**< Semaphore used in \a IDLE phase. */
 
+    unsigned int idle_irq; /**< Sleep until a frame is received in \a IDLE
+                             phase, instead of polling the devices. */
+    wait_queue_head_t idle_irq_queue; /**< Wait queue for receive
+                                        interrupts in \a IDLE phase. */
+    volatile int idle_irq_event; /**< A receive interrupt occurred. */
+
+    unsigned int bulk_mailbox; /**< Enlarge the mailboxes in \a BOOT and
+                                 \a PREOP for bulk transfers. */
+
     void (*send_cb)(void *); /**< Current send datagrams callback. */
     void (*receive_cb)(void *); /**< Current receive datagrams callback. */
     void *cb_data; /**< Current callback data. */
@@ -310,6 +354,23 @@ struct ec_master {
 
     wait_queue_head_t request_queue; /**< Wait queue for external requests
                                        from user space. */
+
+    ec_completion_ring_t fsm_completions; /**< Completions of SDO and
+                                            register requests, posted by the
+                                            master thread. */
+    ec_completion_ring_t cycle_completions; /**< Completions of VoE handlers,
+                                              posted by ecrt_master_send().
+                                              The readers are woken by the
+                                              operation thread. */
+    atomic_t voe_notify_pending; /**< Number of VoE handlers with a pending
+                                   notified request. */
+    wait_queue_head_t completion_queue; /**< Wait queue for processes polling
+                                          for request completions. */
+
+    ec_coe_emerg_stream_t emerg_stream; /**< CoE emergencies of all slaves.
+                                         */
+    wait_queue_head_t emerg_queue; /**< Wait queue for processes waiting for
+                                     CoE emergency events. */
 };
 
 /*****************************************************************************/
@@ -319,7 +380,8 @@ void ec_master_init_static(void);
 
 // master creation/deletion
 int ec_master_init(ec_master_t *, unsigned int, const uint8_t *,
-        const uint8_t *, dev_t, struct class *, unsigned int);
+        const uint8_t *, dev_t, struct class *, unsigned int, unsigned int,
+        unsigned int, unsigned int);
 void ec_master_clear(ec_master_t *);
 
 /** Number of Ethernet devices.
@@ -334,6 +396,7 @@ void ec_master_clear(ec_master_t *);
 int ec_master_enter_idle_phase(ec_master_t *);
 void ec_master_leave_idle_phase(ec_master_t *);
 int ec_master_enter_operation_phase(ec_master_t *);
+int ec_master_activate(ec_master_t *, int);
 void ec_master_leave_operation_phase(ec_master_t *);
 
 #ifdef EC_EOE
@@ -343,15 +406,29 @@ void ec_master_eoe_stop(ec_master_t *);
 #endif
 
 // datagram IO
-void ec_master_receive_datagrams(ec_master_t *, ec_device_t *,
+unsigned int ec_master_receive_datagrams(ec_master_t *, ec_device_t *,
         const uint8_t *, size_t);
 void ec_master_queue_datagram(ec_master_t *, ec_datagram_t *);
 void ec_master_queue_datagram_ext(ec_master_t *, ec_datagram_t *);
 
 // misc.
 void ec_master_set_send_interval(ec_master_t *, unsigned int);
+int ec_master_set_thread_settings(ec_master_t *, ec_thread_index_t,
+        const ec_thread_settings_t *);
+int ec_master_thread_info(ec_master_t *, ec_thread_index_t,
+        ec_thread_settings_t *, u64 *);
 void ec_master_attach_slave_configs(ec_master_t *);
 void ec_master_expire_slave_config_requests(ec_master_t *);
+void ec_master_post_completion(ec_master_t *, ec_completion_ring_t *,
+        uint64_t, ec_internal_request_state_t);
+void ec_master_sdo_request_done(ec_master_t *, const ec_sdo_request_t *);
+void ec_master_reg_request_done(ec_master_t *, const ec_reg_request_t *);
+int ec_master_completions_lost(ec_master_t *);
+size_t ec_master_pop_completions(ec_master_t *, ec_request_completion_t *,
+        size_t);
+int ec_master_completions_pending(const ec_master_t *);
+void ec_master_post_emergency(ec_master_t *, const ec_slave_t *,
+        const uint8_t *);
 ec_slave_t *ec_master_find_slave(ec_master_t *, uint16_t, uint16_t);
 const ec_slave_t *ec_master_find_slave_const(const ec_master_t *, uint16_t,
         uint16_t);
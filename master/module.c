@@ -36,6 +36,7 @@
 #include <linux/module.h>
 #include <linux/device.h>
 #include <linux/err.h>
+#include <linux/sched.h>
 
 #include "globals.h"
 #include "master.h"
@@ -52,6 +53,8 @@ int __init ec_init_module(void);
 void __exit ec_cleanup_module(void);
 
 static int ec_mac_parse(uint8_t *, const char *, int);
+static void ec_thread_params_apply(ec_master_t *, ec_thread_index_t,
+        unsigned long, int);
 
 /*****************************************************************************/
 
@@ -60,6 +63,16 @@ static unsigned int master_count; /**< Number of masters. */
 static char *backup_devices[MAX_MASTERS]; /**< Backup devices parameter. */
 static unsigned int backup_count; /**< Number of backup devices. */
 static unsigned int debug_level;  /**< Debug level parameter. */
+static unsigned int idle_irq; /**< Interrupt-assisted IDLE phase parameter. */
+static unsigned int eoe_quota; /**< EoE per-cycle byte quota parameter. */
+static unsigned int bulk_mailbox; /**< Bulk mailbox parameter. */
+static unsigned long master_cpus[MAX_MASTERS]; /**< Master thread CPU masks
+                                                 parameter. */
+static int master_prio[MAX_MASTERS]; /**< Master thread priorities
+                                       parameter. */
+static unsigned long eoe_cpus[MAX_MASTERS]; /**< EoE thread CPU masks
+                                              parameter. */
+static int eoe_prio[MAX_MASTERS]; /**< EoE thread priorities parameter. */
 
 static ec_master_t *masters; /**< Array of masters. */
 static struct semaphore master_sem; /**< Master semaphore. */
@@ -86,6 +99,27 @@ module_param_array(backup_devices, charp, &backup_count, S_IRUGO);
 MODULE_PARM_DESC(backup_devices, "MAC addresses of backup devices");
 module_param_named(debug_level, debug_level, uint, S_IRUGO+S_IWUSR);
 MODULE_PARM_DESC(debug_level, "Debug level");
+module_param_named(idle_irq, idle_irq, uint, S_IRUGO);
+MODULE_PARM_DESC(idle_irq, "Wait for receive interrupts in IDLE phase"
+        " (only with drivers supporting it, currently 8139too for 3.16,"
+        " otherwise the devices are polled)");
+module_param_named(bulk_mailbox, bulk_mailbox, uint, S_IRUGO);
+MODULE_PARM_DESC(bulk_mailbox, "Enlarge the mailboxes in BOOT and PREOP for"
+        " FoE and CoE transfers");
+module_param_array(master_cpus, ulong, NULL, S_IRUGO);
+MODULE_PARM_DESC(master_cpus, "CPU masks of the master threads");
+module_param_array(master_prio, int, NULL, S_IRUGO);
+MODULE_PARM_DESC(master_prio, "Priorities of the master threads"
+        " (> 0: SCHED_FIFO priority, <= 0: nice value)");
+module_param_array(eoe_cpus, ulong, NULL, S_IRUGO);
+MODULE_PARM_DESC(eoe_cpus, "CPU masks of the EoE threads");
+module_param_array(eoe_prio, int, NULL, S_IRUGO);
+MODULE_PARM_DESC(eoe_prio, "Priorities of the EoE threads"
+        " (> 0: SCHED_FIFO priority, <= 0: nice value)");
+module_param_named(eoe_quota, eoe_quota, uint, S_IRUGO);
+MODULE_PARM_DESC(eoe_quota, "EoE bytes per application cycle in operation"
+        " phase (0 = use the EoE thread, at least one datagram, only for"
+        " userspace applications without RTDM)");
 
 /** \endcond */
 
@@ -152,9 +186,15 @@ int __init ec_init_module(void)
 
     for (i = 0; i < master_count; i++) {
         ret = ec_master_init(&masters[i], i, macs[i][0], macs[i][1],
-                    device_number, class, debug_level);
+                    device_number, class, debug_level, idle_irq,
+                    eoe_quota, bulk_mailbox);
         if (ret)
             goto out_free_masters;
+
+        ec_thread_params_apply(&masters[i], EC_THREAD_MASTER,
+                master_cpus[i], master_prio[i]);
+        ec_thread_params_apply(&masters[i], EC_THREAD_EOE,
+                eoe_cpus[i], eoe_prio[i]);
     }
 
     EC_INFO("%u master%s waiting for devices.\n",
@@ -295,6 +335,29 @@ int ec_mac_is_broadcast(
 
 /*****************************************************************************/
 
+/** Applies the thread parameters of a master.
+ */
+static void ec_thread_params_apply(
+        ec_master_t *master, /**< EtherCAT master. */
+        ec_thread_index_t thread, /**< Thread index. */
+        unsigned long cpu_mask, /**< CPU mask parameter. */
+        int priority /**< Priority parameter. */
+        )
+{
+    ec_thread_settings_t settings;
+
+    settings.cpu_mask = cpu_mask;
+    settings.policy = priority > 0 ? SCHED_FIFO : SCHED_NORMAL;
+    settings.priority = priority;
+
+    if (ec_master_set_thread_settings(master, thread, &settings)) {
+        EC_MASTER_WARN(master, "Ignoring invalid %s thread parameters.\n",
+                thread == EC_THREAD_MASTER ? "master" : "EoE");
+    }
+}
+
+/*****************************************************************************/
+
 /** Parse a MAC address from a string.
  *
  * The MAC address must match the regular expression
@@ -63,6 +63,8 @@ int ec_reg_request_init(
     reg->transfer_size = 0;
     reg->state = EC_INT_REQUEST_INIT;
     reg->ring_position = 0;
+    reg->notify = 0;
+    reg->notify_tag = 0ULL;
     return 0;
 }
 
@@ -119,12 +121,23 @@ void ecrt_reg_request_read(ec_reg_request_t *reg, uint16_t address,
 
 /*****************************************************************************/
 
+int ecrt_reg_request_notify(ec_reg_request_t *reg, uint64_t tag)
+{
+    reg->notify_tag = tag;
+    smp_wmb(); // the tag is valid, as soon as the flag is set
+    reg->notify = 1;
+    return 0;
+}
+
+/*****************************************************************************/
+
 /** \cond */
 
 EXPORT_SYMBOL(ecrt_reg_request_data);
 EXPORT_SYMBOL(ecrt_reg_request_state);
 EXPORT_SYMBOL(ecrt_reg_request_write);
 EXPORT_SYMBOL(ecrt_reg_request_read);
+EXPORT_SYMBOL(ecrt_reg_request_notify);
 
 /** \endcond */
 
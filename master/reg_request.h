@@ -55,6 +55,8 @@ struct ec_reg_request {
     size_t transfer_size; /**< Size of the data to transfer. */
     ec_internal_request_state_t state; /**< Request state. */
     uint16_t ring_position; /**< Ring position for emergency requests. */
+    uint8_t notify; /**< Post a completion when the request finishes. */
+    uint64_t notify_tag; /**< Tag of the completion entries. */
 };
 
 /*****************************************************************************/
@@ -145,15 +145,19 @@ int ec_rtdm_open(
         )
 {
     ec_rtdm_context_t *ctx = (ec_rtdm_context_t *) context->dev_private;
-#if DEBUG
     ec_rtdm_dev_t *rtdm_dev = (ec_rtdm_dev_t *) context->device->device_data;
-#endif
 
     ctx->user_info = user_info;
     ctx->ioctl_ctx.writable = oflags & O_WRONLY || oflags & O_RDWR;
     ctx->ioctl_ctx.requested = 0;
     ctx->ioctl_ctx.process_data = NULL;
     ctx->ioctl_ctx.process_data_size = 0;
+    ctx->ioctl_ctx.capture_mask = 0;
+    ctx->ioctl_ctx.foe_request = NULL;
+    ctx->ioctl_ctx.foe_batch = NULL;
+    ctx->ioctl_ctx.emerg_index =
+        ec_coe_emerg_stream_index(&rtdm_dev->master->emerg_stream);
+    ctx->ioctl_ctx.emerg_overruns = 0;
 
 #if DEBUG
     EC_MASTER_INFO(rtdm_dev->master, "RTDM device %s opened.\n",
@@ -67,6 +67,8 @@ void ec_sdo_request_init(
     req->state = EC_INT_REQUEST_INIT;
     req->errno = 0;
     req->abort_code = 0x00000000;
+    req->notify = 0;
+    req->notify_tag = 0ULL;
 }
 
 /*****************************************************************************/
@@ -243,6 +245,35 @@ void ecrt_sdo_request_write(ec_sdo_request_t *req)
 
 /*****************************************************************************/
 
+int ecrt_sdo_request_write_with_size(ec_sdo_request_t *req, size_t size)
+{
+    if (!size) {
+        return -EINVAL;
+    }
+
+    if (size > req->mem_size) {
+        EC_ERR("Request to write %zu bytes to SDO of size %zu.\n",
+                size, req->mem_size);
+        return -EOVERFLOW;
+    }
+
+    req->data_size = size;
+    ecrt_sdo_request_write(req);
+    return 0;
+}
+
+/*****************************************************************************/
+
+int ecrt_sdo_request_notify(ec_sdo_request_t *req, uint64_t tag)
+{
+    req->notify_tag = tag;
+    smp_wmb(); // the tag is valid, as soon as the flag is set
+    req->notify = 1;
+    return 0;
+}
+
+/*****************************************************************************/
+
 /** \cond */
 
 EXPORT_SYMBOL(ecrt_sdo_request_index);
@@ -252,6 +283,8 @@ EXPORT_SYMBOL(ecrt_sdo_request_data_size);
 EXPORT_SYMBOL(ecrt_sdo_request_state);
 EXPORT_SYMBOL(ecrt_sdo_request_read);
 EXPORT_SYMBOL(ecrt_sdo_request_write);
+EXPORT_SYMBOL(ecrt_sdo_request_write_with_size);
+EXPORT_SYMBOL(ecrt_sdo_request_notify);
 
 /** \endcond */
 
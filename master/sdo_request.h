@@ -66,6 +66,8 @@ struct ec_sdo_request {
                                      request was sent. */
     int errno; /**< Error number. */
     uint32_t abort_code; /**< SDO request abort code. Zero on success. */
+    uint8_t notify; /**< Post a completion when the request finishes. */
+    uint64_t notify_tag; /**< Tag of the completion entries. */
 };
 
 /*****************************************************************************/
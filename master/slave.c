@@ -659,6 +659,78 @@ ec_sync_t *ec_slave_get_sync(
 
 /*****************************************************************************/
 
+/** Limits a mailbox size, so that the mailbox ends before the next sync
+ * manager area or the other mailbox.
+ *
+ * \return Size limit in byte.
+ */
+static uint16_t ec_slave_mbox_size_limit(
+        const ec_slave_t *slave, /**< EtherCAT slave. */
+        uint16_t offset, /**< Mailbox offset. */
+        uint16_t other_offset /**< Offset of the other mailbox. */
+        )
+{
+    uint16_t limit = EC_MAX_DATA_SIZE, start;
+    unsigned int i;
+
+    if (other_offset > offset && other_offset - offset < limit) {
+        limit = other_offset - offset;
+    }
+
+    // process data sync managers
+    for (i = 2; i < slave->sii.sync_count; i++) {
+        start = slave->sii.syncs[i].physical_start_address;
+        if (start > offset && start - offset < limit) {
+            limit = start - offset;
+        }
+    }
+
+    return limit;
+}
+
+/*****************************************************************************/
+
+/** Enlarges the mailbox sizes for bulk transfers.
+ *
+ * The largest mailbox size found in the SII (standard, bootstrap, or sync
+ * manager default length) is used for each direction, as far as the mailbox
+ * neither overlaps the other mailbox nor a process data sync manager and
+ * still fits into a single datagram. Mailboxes are never shrunk.
+ */
+void ec_slave_mbox_bulk_sizes(
+        const ec_slave_t *slave, /**< EtherCAT slave. */
+        uint16_t rx_offset, /**< Receive mailbox offset. */
+        uint16_t *rx_size, /**< Receive mailbox size. */
+        uint16_t tx_offset, /**< Send mailbox offset. */
+        uint16_t *tx_size /**< Send mailbox size. */
+        )
+{
+    uint16_t rx_max, tx_max, limit;
+
+    rx_max = max(slave->sii.std_rx_mailbox_size,
+            slave->sii.boot_rx_mailbox_size);
+    tx_max = max(slave->sii.std_tx_mailbox_size,
+            slave->sii.boot_tx_mailbox_size);
+    if (slave->sii.sync_count >= 2) {
+        rx_max = max(rx_max, slave->sii.syncs[0].default_length);
+        tx_max = max(tx_max, slave->sii.syncs[1].default_length);
+    }
+
+    limit = ec_slave_mbox_size_limit(slave, rx_offset, tx_offset);
+    rx_max = min(rx_max, limit);
+    if (rx_max > *rx_size) {
+        *rx_size = rx_max;
+    }
+
+    limit = ec_slave_mbox_size_limit(slave, tx_offset, rx_offset);
+    tx_max = min(tx_max, limit);
+    if (tx_max > *tx_size) {
+        *tx_size = tx_max;
+    }
+}
+
+/*****************************************************************************/
+
 /**
    Counts the total number of SDOs and entries in the dictionary.
 */
@@ -282,6 +282,8 @@ int ec_slave_fetch_sii_pdos(ec_slave_t *, const uint8_t *, size_t,
 
 // misc.
 ec_sync_t *ec_slave_get_sync(ec_slave_t *, uint8_t);
+void ec_slave_mbox_bulk_sizes(const ec_slave_t *, uint16_t, uint16_t *,
+        uint16_t, uint16_t *);
 
 void ec_slave_sdo_dict_info(const ec_slave_t *,
         unsigned int *, unsigned int *);
@@ -311,6 +311,7 @@ void ec_slave_config_detach(
                 EC_SLAVE_WARN(sc->slave, "Aborting register request,"
                         " slave is detaching.\n");
                 reg->state = EC_INT_REQUEST_FAILURE;
+                ec_master_reg_request_done(sc->master, reg);
                 wake_up_all(&sc->slave->master->request_queue);
                 break;
             }
@@ -571,6 +572,7 @@ void ec_slave_config_expire_disconnected_requests(
                 sdo_req->state == EC_INT_REQUEST_BUSY) {
             EC_CONFIG_DBG(sc, 1, "Aborting SDO request; no slave attached.\n");
             sdo_req->state = EC_INT_REQUEST_FAILURE;
+            ec_master_sdo_request_done(sc->master, sdo_req);
         }
     }
     
@@ -579,6 +581,7 @@ void ec_slave_config_expire_disconnected_requests(
                 reg_req->state == EC_INT_REQUEST_BUSY) {
             EC_CONFIG_DBG(sc, 1, "Aborting register request; no slave attached.\n");
             reg_req->state = EC_INT_REQUEST_FAILURE;
+            ec_master_reg_request_done(sc->master, reg_req);
         }
     }
 }
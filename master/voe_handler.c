@@ -82,6 +82,9 @@ int ec_voe_handler_init(
     voe->dir = EC_DIR_INVALID;
     voe->state = ec_voe_handler_state_error;
     voe->request_state = EC_INT_REQUEST_INIT;
+    voe->notify = 0;
+    voe->notify_tag = 0ULL;
+    voe->notify_pending = 0;
 
     ec_datagram_init(&voe->datagram);
     return ec_datagram_prealloc(&voe->datagram,
@@ -156,11 +159,29 @@ size_t ecrt_voe_handler_data_size(const ec_voe_handler_t *voe)
 
 /*****************************************************************************/
 
+/** Registers a started request for the completion notification.
+ *
+ * ecrt_master_send() only looks at the VoE handlers, while requests with
+ * enabled notification are pending.
+ */
+static void ec_voe_handler_notify_start(
+        ec_voe_handler_t *voe /**< VoE handler. */
+        )
+{
+    if (voe->notify && !voe->notify_pending) {
+        voe->notify_pending = 1;
+        atomic_inc(&voe->config->master->voe_notify_pending);
+    }
+}
+
+/*****************************************************************************/
+
 void ecrt_voe_handler_read(ec_voe_handler_t *voe)
 {
     voe->dir = EC_DIR_INPUT;
     voe->state = ec_voe_handler_state_read_start;
     voe->request_state = EC_INT_REQUEST_BUSY;
+    ec_voe_handler_notify_start(voe);
 }
 
 /*****************************************************************************/
@@ -170,6 +191,7 @@ void ecrt_voe_handler_read_nosync(ec_voe_handler_t *voe)
     voe->dir = EC_DIR_INPUT;
     voe->state = ec_voe_handler_state_read_nosync_start;
     voe->request_state = EC_INT_REQUEST_BUSY;
+    ec_voe_handler_notify_start(voe);
 }
 
 /*****************************************************************************/
@@ -180,6 +202,7 @@ void ecrt_voe_handler_write(ec_voe_handler_t *voe, size_t size)
     voe->data_size = size;
     voe->state = ec_voe_handler_state_write_start;
     voe->request_state = EC_INT_REQUEST_BUSY;
+    ec_voe_handler_notify_start(voe);
 }
 
 /*****************************************************************************/
@@ -199,6 +222,16 @@ ec_request_state_t ecrt_voe_handler_execute(ec_voe_handler_t *voe)
     return ec_request_state_translation_table[voe->request_state];
 }
 
+/*****************************************************************************/
+
+int ecrt_voe_handler_notify(ec_voe_handler_t *voe, uint64_t tag)
+{
+    voe->notify_tag = tag;
+    smp_wmb(); // the tag is valid, as soon as the flag is set
+    voe->notify = 1;
+    return 0;
+}
+
 /******************************************************************************
  * State functions.
  *****************************************************************************/
@@ -550,6 +583,7 @@ EXPORT_SYMBOL(ecrt_voe_handler_data_size);
 EXPORT_SYMBOL(ecrt_voe_handler_read);
 EXPORT_SYMBOL(ecrt_voe_handler_write);
 EXPORT_SYMBOL(ecrt_voe_handler_execute);
+EXPORT_SYMBOL(ecrt_voe_handler_notify);
 
 /** \endcond */
 
@@ -60,6 +60,11 @@ struct ec_voe_handler {
     ec_internal_request_state_t request_state; /**< Handler state. */
     unsigned int retries; /**< retries upon datagram timeout */
     unsigned long jiffies_start; /**< Timestamp for timeout calculation. */
+    uint8_t notify; /**< Post a completion when the request finishes. */
+    uint64_t notify_tag; /**< Tag of the completion entries. */
+    uint8_t notify_pending; /**< A request was started with enabled
+                              notification and its completion is not posted
+                              yet. */
 };
 
 /*****************************************************************************/
@@ -0,0 +1,314 @@
+/*****************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2006-2009  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *  vim: expandtab
+ *
+ ****************************************************************************/
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+#include "CommandCapture.h"
+#include "MasterDevice.h"
+
+/*****************************************************************************/
+
+/** pcapng block types.
+ */
+#define PCAPNG_SECTION_HEADER 0x0A0D0D0A
+#define PCAPNG_INTERFACE_DESCRIPTION 0x00000001
+#define PCAPNG_ENHANCED_PACKET 0x00000006
+
+/** pcapng link type for Ethernet.
+ */
+#define PCAPNG_LINKTYPE_ETHERNET 1
+
+/** Set by the signal handler to terminate capturing.
+ */
+static volatile sig_atomic_t captureInterrupted = 0;
+
+/*****************************************************************************/
+
+static void captureSignalHandler(int)
+{
+    captureInterrupted = 1;
+}
+
+/*****************************************************************************/
+
+template <class T>
+static void append(string &block, T value)
+{
+    block.append((const char *) &value, sizeof(value));
+}
+
+/*****************************************************************************/
+
+static void appendPadded(string &block, const void *data, size_t size)
+{
+    block.append((const char *) data, size);
+    block.append((4 - size % 4) % 4, '\0');
+}
+
+/*****************************************************************************/
+
+static void appendOption(string &block, uint16_t code, const void *data,
+        uint16_t size)
+{
+    append(block, code);
+    append(block, size);
+    appendPadded(block, data, size);
+}
+
+/*****************************************************************************/
+
+CommandCapture::CommandCapture():
+    Command("capture", "Capture EtherCAT frames to a pcapng file.")
+{
+}
+
+/*****************************************************************************/
+
+string CommandCapture::helpString(const string &binaryBaseName) const
+{
+    stringstream str;
+
+    str << binaryBaseName << " " << getName()
+        << " [OPTIONS] [FILTER [INTERVAL]]" << endl
+        << endl
+        << getBriefDescription() << endl
+        << endl
+        << "The frames sent and received by the devices of the master are"
+        << endl
+        << "copied to memory-mapped rings and written to a file in pcapng"
+        << endl
+        << "format, until the command is interrupted (Ctrl-C). Frames, that"
+        << endl
+        << "do not fit into a ring, because the file can not be written fast"
+        << endl
+        << "enough, are dropped and counted." << endl
+        << endl
+        << "Arguments:" << endl
+        << "  FILTER    can be 'all' (default) or 'errors'. 'errors'"
+        << endl
+        << "            captures only received frames, that were corrupted"
+        << endl
+        << "            or contained unmatched datagrams." << endl
+        << "  INTERVAL  Capture only every n-th frame (default: 1)." << endl
+        << endl
+        << "Command-specific options:" << endl
+        << "  --master      -m <index>  Index of the master to use. See the"
+        << endl
+        << "                            global options." << endl
+        << "  --output-file -o <file>   Target pcapng file. Mandatory."
+        << endl << endl
+        << numericInfo();
+
+    return str.str();
+}
+
+/****************************************************************************/
+
+void CommandCapture::execute(const StringVector &args)
+{
+    ec_ioctl_master_t master;
+    uint8_t filter = EC_CAPTURE_ALL;
+    unsigned int interval = 1, dev_idx;
+    vector<ec_ioctl_capture_t> captures;
+    vector<ec_ioctl_capture_ring_t *> rings;
+    uint64_t frameCount = 0, dropped = 0;
+
+    if (args.size() > 2) {
+        stringstream err;
+        err << "'" << getName() << "' takes at most two arguments!";
+        throwInvalidUsageException(err);
+    }
+
+    if (args.size() > 0) {
+        if (args[0] == "errors") {
+            filter = EC_CAPTURE_ERRORS;
+        } else if (args[0] != "all") {
+            stringstream err;
+            err << "Invalid filter '" << args[0] << "'!";
+            throwInvalidUsageException(err);
+        }
+    }
+
+    if (args.size() > 1) {
+        stringstream str;
+        str << args[1];
+        str >> resetiosflags(ios::basefield) // guess base from prefix
+            >> interval;
+        if (str.fail() || !interval) {
+            stringstream err;
+            err << "Invalid interval '" << args[1] << "'!";
+            throwInvalidUsageException(err);
+        }
+    }
+
+    if (getOutputFile().empty()) {
+        stringstream err;
+        err << "Please specify a target file with --output-file!";
+        throwInvalidUsageException(err);
+    }
+
+    MasterDevice m(getSingleMasterIndex());
+    m.open(MasterDevice::ReadWrite);
+    m.getMaster(&master);
+
+    ofstream file(getOutputFile().c_str(), ios::out | ios::binary);
+    if (!file) {
+        stringstream err;
+        err << "Failed to open '" << getOutputFile() << "'!";
+        throwCommandException(err);
+    }
+
+    string shb;
+    append(shb, (uint32_t) 0x1A2B3C4D); // byte-order magic
+    append(shb, (uint16_t) 1); // major version
+    append(shb, (uint16_t) 0); // minor version
+    append(shb, (int64_t) -1); // section length unknown
+    writeBlock(file, PCAPNG_SECTION_HEADER, shb);
+
+    for (dev_idx = 0; dev_idx < master.num_devices; dev_idx++) {
+        string idb;
+        const char *name = !dev_idx ? "main" : "backup";
+        uint8_t tsresol = 9; // nanoseconds
+
+        append(idb, (uint16_t) PCAPNG_LINKTYPE_ETHERNET);
+        append(idb, (uint16_t) 0);
+        append(idb, (uint32_t) EC_CAPTURE_FRAME_SIZE);
+        appendOption(idb, 2, name, strlen(name)); // if_name
+        appendOption(idb, 9, &tsresol, 1); // if_tsresol
+        appendOption(idb, 0, NULL, 0); // opt_endofopt
+        writeBlock(file, PCAPNG_INTERFACE_DESCRIPTION, idb);
+
+        ec_ioctl_capture_t capture;
+        capture.dev_idx = dev_idx;
+        capture.frame_count = 0; // default
+        capture.filter = filter;
+        capture.sample_interval = interval;
+        rings.push_back((ec_ioctl_capture_ring_t *) m.startCapture(&capture));
+        captures.push_back(capture);
+    }
+
+    signal(SIGINT, captureSignalHandler);
+    signal(SIGTERM, captureSignalHandler);
+
+    if (getVerbosity() != Quiet) {
+        cerr << "Capturing to " << getOutputFile()
+            << ". Press Ctrl-C to stop." << endl;
+    }
+
+    while (!captureInterrupted) {
+        unsigned int count = 0;
+
+        for (dev_idx = 0; dev_idx < rings.size(); dev_idx++) {
+            ec_ioctl_capture_ring_t *ring = rings[dev_idx];
+            uint32_t tail = ring->tail, head = ring->head;
+
+            __sync_synchronize(); // read head before frame contents
+
+            while (tail != head) {
+                const ec_ioctl_capture_frame_t *frame =
+                    (const ec_ioctl_capture_frame_t *) ((const uint8_t *) ring
+                            + ring->frames_offset)
+                    + (tail & (captures[dev_idx].frame_count - 1));
+                uint32_t flags = frame->flags & EC_CAPTURE_FLAG_RX ?
+                    0x1 : 0x2; // inbound / outbound
+                string epb;
+
+                append(epb, (uint32_t) dev_idx);
+                append(epb, (uint32_t) (frame->timestamp >> 32));
+                append(epb, (uint32_t) frame->timestamp);
+                append(epb, (uint32_t) frame->size);
+                append(epb, (uint32_t) frame->size);
+                appendPadded(epb, frame->data, frame->size);
+                appendOption(epb, 2, &flags, sizeof(flags)); // epb_flags
+                if (frame->flags & EC_CAPTURE_FLAG_ERROR) {
+                    const char *comment = "Error";
+                    appendOption(epb, 1, comment,
+                            strlen(comment)); // opt_comment
+                }
+                appendOption(epb, 0, NULL, 0); // opt_endofopt
+                writeBlock(file, PCAPNG_ENHANCED_PACKET, epb);
+
+                tail++;
+                count++;
+            }
+
+            __sync_synchronize(); // finish reading before releasing slots
+            ring->tail = tail;
+        }
+
+        frameCount += count;
+        if (!count) {
+            usleep(1000);
+        }
+    }
+
+    for (dev_idx = 0; dev_idx < rings.size(); dev_idx++) {
+        dropped += rings[dev_idx]->dropped;
+        m.stopCapture(&captures[dev_idx], rings[dev_idx]);
+    }
+
+    file.close();
+
+    if (getVerbosity() != Quiet) {
+        cerr << "Captured " << frameCount << " frames";
+        if (dropped) {
+            cerr << ", dropped " << dropped;
+        }
+        cerr << "." << endl;
+    }
+}
+
+/****************************************************************************/
+
+void CommandCapture::writeBlock(
+        ostream &out,
+        uint32_t type,
+        const string &body
+        )
+{
+    uint32_t length = 12 + body.size();
+
+    out.write((const char *) &type, sizeof(type));
+    out.write((const char *) &length, sizeof(length));
+    out.write(body.data(), body.size());
+    out.write((const char *) &length, sizeof(length));
+}
+
+/*****************************************************************************/
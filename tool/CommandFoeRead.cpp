@@ -31,6 +31,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <vector>
 using namespace std;
 
 #include "CommandFoeRead.h"
@@ -79,8 +81,11 @@ void CommandFoeRead::execute(const StringVector &args)
 {
     SlaveList slaves;
     ec_ioctl_slave_t *slave;
-    ec_ioctl_slave_foe_t data;
-    unsigned int i;
+    ec_ioctl_slave_foe_stream_t data;
+    vector<uint8_t> buffer(ChunkSize);
+    ofstream file;
+    ostream *out = &cout;
+    bool writeError = false;
     stringstream err;
 
     if (args.size() != 1) {
@@ -88,6 +93,16 @@ void CommandFoeRead::execute(const StringVector &args)
         throwInvalidUsageException(err);
     }
 
+    if (!getOutputFile().empty() && getOutputFile() != "-") {
+        file.open(getOutputFile().c_str(),
+                ofstream::out | ofstream::binary | ofstream::trunc);
+        if (file.fail()) {
+            err << "Failed to open '" << getOutputFile() << "'!";
+            throwCommandException(err);
+        }
+        out = &file;
+    }
+
     MasterDevice m(getSingleMasterIndex());
     m.open(MasterDevice::Read);
     slaves = selectedSlaves(m);
@@ -96,28 +111,43 @@ void CommandFoeRead::execute(const StringVector &args)
         throwSingleSlaveRequired(slaves.size());
     }
     slave = &slaves.front();
+
+    memset(&data, 0, sizeof(data));
     data.slave_position = slave->position;
+    data.write = 0;
+    strncpy(data.file_name, args[0].c_str(), sizeof(data.file_name));
 
-    /* FIXME: No good idea to have a fixed buffer size.
-     * Read in chunks and fill a buffer instead.
-     */
-    data.offset = 0;
-    data.buffer_size = 0x8800;
-    data.buffer = new uint8_t[data.buffer_size];
+    m.startFoe(&data);
 
-    strncpy(data.file_name, args[0].c_str(), sizeof(data.file_name));
+    // stream the file in chunks; the result is fetched when finishing
+    try {
+        do {
+            data.buffer = &buffer.front();
+            data.buffer_size = buffer.size();
+            m.transferFoe(&data);
+            out->write((const char *) data.buffer, data.data_size);
+            if (out->fail()) {
+                writeError = true;
+                break;
+            }
+            printProgress(data.progress, 0);
+        } while (!data.eof);
+    } catch (MasterDeviceException &e) {
+    }
 
     try {
-        m.readFoe(&data);
+        m.finishFoe(&data);
     } catch (MasterDeviceException &e) {
-        delete [] data.buffer;
-        if (data.result) {
+        if (writeError) {
+            err << "Failed to write FoE data!";
+            throwCommandException(err);
+        } else if (data.result) {
             if (data.result == FOE_OPCODE_ERROR) {
                 err << "FoE read aborted with error code 0x"
                     << setw(8) << setfill('0') << hex << data.error_code
                     << ": " << errorText(data.error_code);
             } else {
-                err << "Failed to write via FoE: "
+                err << "Failed to read via FoE: "
                     << resultText(data.result);
             }
             throwCommandException(err);
@@ -126,13 +156,12 @@ void CommandFoeRead::execute(const StringVector &args)
         }
     }
 
-    // TODO --output-file
-    for (i = 0; i < data.data_size; i++) {
-        uint8_t *w = data.buffer + i;
-        cout << *(uint8_t *) w ;
-    }
+    out->flush();
 
-    delete [] data.buffer;
+    if (getVerbosity() == Verbose) {
+        printProgress(data.data_size, data.data_size);
+        cerr << endl << "FoE reading finished." << endl;
+    }
 }
 
 /*****************************************************************************/
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2006-2009  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ ****************************************************************************/
+
+
+#include <libgen.h> // basename()
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+using namespace std;
+
+#include "CommandFoeUpdate.h"
+#include "foe.h"
+#include "MasterDevice.h"
+
+/*****************************************************************************/
+
+CommandFoeUpdate::CommandFoeUpdate():
+    FoeCommand("foe_update",
+            "Store a file on several slaves concurrently via FoE.")
+{
+}
+
+/*****************************************************************************/
+
+string CommandFoeUpdate::helpString(const string &binaryBaseName) const
+{
+    stringstream str;
+
+    str << binaryBaseName << " " << getName()
+        << " [OPTIONS] <FILENAME>" << endl
+        << endl
+        << getBriefDescription() << endl
+        << endl
+        << "The file is read once and transferred to all selected" << endl
+        << "slaves at the same time. When all transfers are finished," << endl
+        << "the result, the transferred bytes and the throughput are" << endl
+        << "listed for each slave." << endl
+        << endl
+        << "Arguments:" << endl
+        << "  FILENAME can either be a path to a file, or '-'. In" << endl
+        << "           the latter case, data are read from stdin and" << endl
+        << "           the --output-file option has to be specified." << endl
+        << endl
+        << "Command-specific options:" << endl
+        << "  --output-file -o <file>   Target filename on the slaves." << endl
+        << "                            If the FILENAME argument is" << endl
+        << "                            '-', this is mandatory." << endl
+        << "                            Otherwise, the basename() of" << endl
+        << "                            FILENAME is used by default." << endl
+        << "  --alias       -a <alias>" << endl
+        << "  --position    -p <pos>    Slave selection. See the help" << endl
+        << "                            of the 'slaves' command." << endl
+        << "  --verbose     -v          Show the progress while" << endl
+        << "                            transferring." << endl
+        << endl
+        << numericInfo();
+
+    return str.str();
+}
+
+/****************************************************************************/
+
+void CommandFoeUpdate::execute(const StringVector &args)
+{
+    stringstream err;
+    ec_ioctl_slave_foe_batch_t data;
+    ifstream file;
+    istream *in = &cin;
+    SlaveList slaves;
+    SlaveList::const_iterator si;
+    string storeFileName;
+    vector<uint8_t> image;
+    vector<uint16_t> positions;
+    vector<ec_ioctl_slave_foe_status_t> status;
+    vector<double> startTime, endTime;
+    struct timeval start, now;
+    double elapsed;
+    size_t total;
+    unsigned int i, failed = 0;
+
+    if (args.size() != 1) {
+        err << "'" << getName() << "' takes exactly one argument!";
+        throwInvalidUsageException(err);
+    }
+
+    if (args[0] == "-") {
+        if (getOutputFile().empty()) {
+            err << "Please specify a filename for the slave side"
+                << " with --output-file!";
+            throwCommandException(err);
+        } else {
+            storeFileName = getOutputFile();
+        }
+    } else {
+        file.open(args[0].c_str(), ifstream::in | ifstream::binary);
+        if (file.fail()) {
+            err << "Failed to open '" << args[0] << "'!";
+            throwCommandException(err);
+        }
+        in = &file;
+        if (getOutputFile().empty()) {
+            char *cpy = strdup(args[0].c_str()); // basename can modify
+                                                 // the string contents
+            storeFileName = basename(cpy);
+            free(cpy);
+        } else {
+            storeFileName = getOutputFile();
+        }
+    }
+
+    image.assign(istreambuf_iterator<char>(*in), istreambuf_iterator<char>());
+
+    if (getVerbosity() == Verbose) {
+        cerr << "Read " << image.size() << " bytes of FoE data." << endl;
+    }
+
+    MasterDevice m(getSingleMasterIndex());
+    m.open(MasterDevice::ReadWrite);
+
+    slaves = selectedSlaves(m);
+    if (slaves.empty()) {
+        err << "No slaves selected!";
+        throwCommandException(err);
+    }
+
+    for (si = slaves.begin(); si != slaves.end(); si++) {
+        positions.push_back(si->position);
+    }
+    status.resize(positions.size());
+    startTime.resize(positions.size(), -1.0);
+    endTime.resize(positions.size(), -1.0);
+
+    memset(&data, 0, sizeof(data));
+    data.slave_count = positions.size();
+    data.slave_positions = &positions.front();
+    data.buffer_size = image.size();
+    data.buffer = image.empty() ? NULL : &image.front();
+    strncpy(data.file_name, storeFileName.c_str(),
+            sizeof(data.file_name) - 1);
+    data.status = &status.front();
+
+    m.startFoeBatch(&data);
+    gettimeofday(&start, NULL);
+
+    // poll the transfer states to measure the time per slave
+    do {
+        usleep(100000);
+        m.getFoeBatchStatus(&data);
+
+        gettimeofday(&now, NULL);
+        elapsed = (now.tv_sec - start.tv_sec)
+            + (now.tv_usec - start.tv_usec) / 1e6;
+
+        total = 0;
+        for (i = 0; i < positions.size(); i++) {
+            uint8_t state = status[i].state;
+
+            if (startTime[i] < 0.0 && state != EC_INT_REQUEST_QUEUED) {
+                startTime[i] = elapsed;
+            }
+            if (endTime[i] < 0.0 && (state == EC_INT_REQUEST_SUCCESS
+                        || state == EC_INT_REQUEST_FAILURE)) {
+                endTime[i] = elapsed;
+            }
+            total += status[i].progress;
+        }
+
+        if (getVerbosity() == Verbose) {
+            cerr << "\r" << data.finished_count << "/" << positions.size()
+                << " slaves finished, " << total << " bytes" << flush;
+        }
+    } while (data.finished_count < positions.size());
+
+    if (getVerbosity() == Verbose) {
+        cerr << endl;
+    }
+
+    try {
+        m.finishFoeBatch(&data);
+    } catch (MasterDeviceException &e) {
+        // the per-slave results are reported below
+    }
+
+    cout << "Slave  Result              Bytes       Time  Throughput"
+        << endl;
+
+    for (i = 0; i < positions.size(); i++) {
+        const ec_ioctl_slave_foe_status_t &s = status[i];
+        double duration = endTime[i] - max(startTime[i], 0.0);
+        stringstream result;
+
+        if (s.state == EC_INT_REQUEST_SUCCESS) {
+            result << "OK";
+        } else {
+            failed++;
+            if (s.result == FOE_OPCODE_ERROR) {
+                result << "0x" << setw(8) << setfill('0') << hex
+                    << s.error_code;
+            } else {
+                result << resultText(s.result);
+            }
+        }
+
+        cout << setw(5) << dec << s.slave_position << "  "
+            << left << setw(18) << result.str() << right
+            << setw(7) << s.progress << "  "
+            << setw(7) << fixed << setprecision(1) << duration << " s  ";
+        if (duration > 0.0) {
+            cout << setw(6) << s.progress / duration / 1024.0 << " KiB/s";
+        } else {
+            cout << setw(6) << "-";
+        }
+        cout << endl;
+    }
+
+    if (failed) {
+        err << "FoE update failed on " << failed << " of "
+            << positions.size() << " slaves.";
+        throwCommandException(err);
+    }
+}
+
+/*****************************************************************************/
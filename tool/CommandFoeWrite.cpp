@@ -33,6 +33,7 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
 using namespace std;
 
 #include "CommandFoeWrite.h"
@@ -84,10 +85,14 @@ string CommandFoeWrite::helpString(const string &binaryBaseName) const
 void CommandFoeWrite::execute(const StringVector &args)
 {
     stringstream err;
-    ec_ioctl_slave_foe_t data;
+    ec_ioctl_slave_foe_stream_t data;
     ifstream file;
+    istream *in = &cin;
     SlaveList slaves;
     string storeFileName;
+    vector<uint8_t> buffer(ChunkSize);
+    size_t fileSize = 0;
+    bool readError = false;
 
     if (args.size() != 1) {
         err << "'" << getName() << "' takes exactly one argument!";
@@ -95,7 +100,6 @@ void CommandFoeWrite::execute(const StringVector &args)
     }
 
     if (args[0] == "-") {
-        loadFoeData(&data, cin);
         if (getOutputFile().empty()) {
             err << "Please specify a filename for the slave side"
                 << " with --output-file!";
@@ -109,8 +113,10 @@ void CommandFoeWrite::execute(const StringVector &args)
             err << "Failed to open '" << args[0] << "'!";
             throwCommandException(err);
         }
-        loadFoeData(&data, file);
-        file.close();
+        file.seekg(0, ios::end);
+        fileSize = file.tellg();
+        file.seekg(0, ios::beg);
+        in = &file;
         if (getOutputFile().empty()) {
             char *cpy = strdup(args[0].c_str()); // basename can modify
                                                  // the string contents
@@ -122,32 +128,44 @@ void CommandFoeWrite::execute(const StringVector &args)
     }
 
     MasterDevice m(getSingleMasterIndex());
-    try {
-        m.open(MasterDevice::ReadWrite);
-    } catch (MasterDeviceException &e) {
-        if (data.buffer_size)
-            delete [] data.buffer;
-        throw e;
-    }
+    m.open(MasterDevice::ReadWrite);
 
     slaves = selectedSlaves(m);
     if (slaves.size() != 1) {
-        if (data.buffer_size)
-            delete [] data.buffer;
         throwSingleSlaveRequired(slaves.size());
     }
-    data.slave_position = slaves.front().position;
 
-    // write data via foe to the slave
-    data.offset = 0;
+    memset(&data, 0, sizeof(data));
+    data.slave_position = slaves.front().position;
+    data.write = 1;
     strncpy(data.file_name, storeFileName.c_str(), sizeof(data.file_name));
 
+    m.startFoe(&data);
+
+    // stream the file in chunks; the result is fetched when finishing
     try {
-        m.writeFoe(&data);
+        do {
+            in->read((char *) &buffer.front(), buffer.size());
+            if (in->bad()) {
+                readError = true;
+                break;
+            }
+            data.buffer = &buffer.front();
+            data.buffer_size = in->gcount();
+            data.last = in->eof();
+            m.transferFoe(&data);
+            printProgress(data.progress, fileSize);
+        } while (!data.last);
     } catch (MasterDeviceException &e) {
-        if (data.buffer_size)
-            delete [] data.buffer;
-        if (data.result) {
+    }
+
+    try {
+        m.finishFoe(&data);
+    } catch (MasterDeviceException &e) {
+        if (readError) {
+            err << "Failed to read FoE data!";
+            throwCommandException(err);
+        } else if (data.result) {
             if (data.result == FOE_OPCODE_ERROR) {
                 err << "FoE write aborted with error code 0x"
                     << setw(8) << setfill('0') << hex << data.error_code
@@ -163,36 +181,8 @@ void CommandFoeWrite::execute(const StringVector &args)
     }
 
     if (getVerbosity() == Verbose) {
-        cerr << "FoE writing finished." << endl;
-    }
-
-    if (data.buffer_size)
-        delete [] data.buffer;
-}
-
-/*****************************************************************************/
-
-void CommandFoeWrite::loadFoeData(
-        ec_ioctl_slave_foe_t *data,
-        const istream &in
-        )
-{
-    stringstream err;
-    ostringstream tmp;
-
-    tmp << in.rdbuf();
-    string const &contents = tmp.str();
-
-    if (getVerbosity() == Verbose) {
-        cerr << "Read " << contents.size() << " bytes of FoE data." << endl;
-    }
-
-    data->buffer_size = contents.size();
-
-    if (data->buffer_size) {
-        // allocate buffer and read file into buffer
-        data->buffer = new uint8_t[data->buffer_size];
-        contents.copy((char *) data->buffer, contents.size());
+        printProgress(data.data_size, fileSize);
+        cerr << endl << "FoE writing finished." << endl;
     }
 }
 
@@ -42,9 +42,6 @@ class CommandFoeWrite:
 
         string helpString(const string &) const;
         void execute(const StringVector &);
-
-    protected:
-        void loadFoeData(ec_ioctl_slave_foe_t *, const istream &);
 };
 
 /****************************************************************************/
@@ -27,6 +27,8 @@
  *
  ****************************************************************************/
 
+#include <sched.h>
+
 #include <iostream>
 #include <iomanip>
 using namespace std;
@@ -136,7 +138,23 @@ void CommandMaster::execute(const StringVector &args)
                 << data.devices[dev_idx].rx_bytes << endl
                 << "      Tx errors:   "
                 << data.devices[dev_idx].tx_errors << endl
-                << "      Tx frame rate [1/s]: "
+                << "      Rx polls:    "
+                << data.devices[dev_idx].poll_count << " ("
+                << setprecision(1) << fixed
+                << (data.devices[dev_idx].poll_count ?
+                        (double) data.devices[dev_idx].poll_frames /
+                        data.devices[dev_idx].poll_count : 0.0)
+                << " avg., " << data.devices[dev_idx].poll_max_frames
+                << " max. frames per poll)" << endl;
+            if (data.devices[dev_idx].flush_count) {
+                cout << "      Tx flushes:  "
+                    << data.devices[dev_idx].flush_count << " ("
+                    << (double) data.devices[dev_idx].flush_frames /
+                    data.devices[dev_idx].flush_count
+                    << " avg., " << data.devices[dev_idx].flush_max_frames
+                    << " max. frames per flush)" << endl;
+            }
+            cout << "      Tx frame rate [1/s]: "
                 << setfill(' ') << setprecision(0) << fixed;
             for (j = 0; j < EC_RATE_COUNT; j++) {
                 cout << setw(ColWidth)
@@ -272,6 +290,43 @@ void CommandMaster::execute(const StringVector &args)
                 "%Y-%m-%d %H:%M:%S", gmtime(&epoch));
         cout << string(time_str, time_str_size) << "."
             << setfill('0') << setw(9) << data.app_time % 1000000000 << endl;
+
+        cout << "  Threads:" << endl;
+        for (j = 0; j < EC_THREAD_COUNT; j++) {
+            const ec_ioctl_master_t::ec_ioctl_thread &t = data.threads[j];
+
+            cout << "    " << (j == EC_THREAD_MASTER ? "Master" : "EoE")
+                << ": " << (t.running ? "running" : "not running") << endl
+                << "      CPUs: ";
+            if (t.cpu_mask) {
+                bool first = true;
+                for (unsigned int cpu = 0; cpu < 64; cpu++) {
+                    if (t.cpu_mask & (1ULL << cpu)) {
+                        cout << (first ? "" : ",") << cpu;
+                        first = false;
+                    }
+                }
+            } else {
+                cout << "all";
+            }
+            cout << endl << "      Scheduling: ";
+            switch (t.policy) {
+                case SCHED_FIFO:
+                    cout << "FIFO, priority " << t.priority;
+                    break;
+                case SCHED_RR:
+                    cout << "RR, priority " << t.priority;
+                    break;
+                default:
+                    cout << "normal, nice " << t.priority;
+                    break;
+            }
+            cout << endl;
+            if (t.running) {
+                cout << "      CPU time: " << setfill(' ') << setprecision(3)
+                    << fixed << t.cpu_time / 1e9 << " s" << endl;
+            }
+        }
     }
 }
 
@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 using namespace std;
 
 #include "CommandSoeRead.h"
@@ -51,6 +52,8 @@ string CommandSoeRead::helpString(const string &binaryBaseName) const
         << " [OPTIONS] <IDN>" << endl
         << binaryBaseName << " " << getName()
         << " [OPTIONS] <DRIVE> <IDN>" << endl
+        << binaryBaseName << " " << getName()
+        << " [OPTIONS] --output-file <FILE> [<DRIVE>] <IDNS>" << endl
         << endl
         << getBriefDescription() << endl
         << endl
@@ -66,16 +69,29 @@ string CommandSoeRead::helpString(const string &binaryBaseName) const
         << "             Bit 11 - 0: Data block number" << endl
         << "           or a string like 'P-0-150'." << endl
         << endl
+        << "  IDNS     is a comma-separated list of IDNs, or 'backup' for"
+        << endl
+        << "           the IDNs in the backup list S-0-0192." << endl
+        << endl
         << "Data of the given IDN are read and displayed according to" << endl
         << "the given datatype, or as raw hex bytes." << endl
         << endl
+        << "If an output file is given, all IDNs of the list are read" << endl
+        << "at once and stored in the file, one IDN per line:" << endl
+        << endl
+        << "  <DRIVE> <IDN> <HEXDATA>" << endl
+        << endl
+        << "The file can be restored with the 'soe_write' command." << endl
+        << endl
         << typeInfo()
         << endl
         << "Command-specific options:" << endl
-        << "  --alias    -a <alias>" << endl
-        << "  --position -p <pos>    Slave selection. See the help of" << endl
-        << "                         the 'slaves' command." << endl
-        << "  --type     -t <type>   Data type (see above)." << endl
+        << "  --alias       -a <alias>" << endl
+        << "  --position    -p <pos>    Slave selection. See the help of"
+        << endl
+        << "                            the 'slaves' command." << endl
+        << "  --type        -t <type>   Data type (see above)." << endl
+        << "  --output-file -o <file>   Store the IDNS in a file." << endl
         << endl
         << numericInfo();
 
@@ -92,6 +108,11 @@ void CommandSoeRead::execute(const StringVector &args)
     ec_ioctl_slave_soe_read_t ioctl;
     int driveArgIndex = -1, idnArgIndex = -1;
 
+    if (!getOutputFile().empty()) {
+        executeList(args);
+        return;
+    }
+
     if (args.size() == 1) {
         idnArgIndex = 0;
     } else if (args.size() == 2) {
@@ -103,17 +124,7 @@ void CommandSoeRead::execute(const StringVector &args)
     }
 
     if (driveArgIndex >= 0) {
-        stringstream str;
-        unsigned int number;
-        str << args[driveArgIndex];
-        str
-            >> resetiosflags(ios::basefield) // guess base from prefix
-            >> number;
-        if (str.fail() || number > 7) {
-            err << "Invalid drive number '" << args[driveArgIndex] << "'!";
-            throwInvalidUsageException(err);
-        }
-        ioctl.drive_no = number;
+        ioctl.drive_no = parseDrive(args[driveArgIndex]);
     } else {
         ioctl.drive_no = 0;
     }
@@ -174,3 +185,230 @@ void CommandSoeRead::execute(const StringVector &args)
 }
 
 /*****************************************************************************/
+
+void CommandSoeRead::executeList(const StringVector &args)
+{
+    SlaveList slaves;
+    stringstream err;
+    uint8_t drive_no = 0;
+    uint16_t position;
+    vector<uint16_t> idns;
+    vector<ec_soe_transfer_t> transfers;
+    vector<uint8_t *> buffers;
+    ec_ioctl_slave_soe_list_t io;
+    unsigned int i, failed = 0;
+    string idnArg;
+
+    if (args.size() == 1) {
+        idnArg = args[0];
+    } else if (args.size() == 2) {
+        drive_no = parseDrive(args[0]);
+        idnArg = args[1];
+    } else {
+        err << "'" << getName() << "' takes eiter 1 or 2 arguments"
+            << " with an output file!";
+        throwInvalidUsageException(err);
+    }
+
+    MasterDevice m(getSingleMasterIndex());
+    m.open(MasterDevice::Read);
+    slaves = selectedSlaves(m);
+    if (slaves.size() != 1) {
+        throwSingleSlaveRequired(slaves.size());
+    }
+    position = slaves.front().position;
+
+    if (idnArg == "backup") {
+        idns = readBackupList(m, position, drive_no);
+    } else {
+        idns = parseIdnList(idnArg);
+    }
+
+    if (idns.empty()) {
+        err << "No IDNs to read.";
+        throwCommandException(err);
+    }
+
+    transfers.resize(idns.size());
+    for (i = 0; i < idns.size(); i++) {
+        buffers.push_back(new uint8_t[DefaultIdnSize]);
+        transfers[i].idn = idns[i];
+        transfers[i].data = buffers[i];
+        transfers[i].size = DefaultIdnSize;
+    }
+
+    io.slave_position = position;
+    io.drive_no = drive_no;
+    io.idn_count = transfers.size();
+    io.transfers = &transfers.front();
+
+    try {
+        m.readSoeList(&io);
+    } catch (MasterDeviceException &e) {
+        for (i = 0; i < buffers.size(); i++) {
+            delete [] buffers[i];
+        }
+        throw e;
+    }
+
+    // read IDNs exceeding the default size once more
+    for (i = 0; i < transfers.size(); i++) {
+        ec_ioctl_slave_soe_read_t data;
+
+        if (transfers[i].result != -EOVERFLOW) {
+            continue;
+        }
+
+        delete [] buffers[i];
+        buffers[i] = new uint8_t[transfers[i].result_size];
+
+        data.slave_position = position;
+        data.drive_no = drive_no;
+        data.idn = transfers[i].idn;
+        data.mem_size = transfers[i].result_size;
+        data.data = buffers[i];
+        try {
+            m.readSoe(&data);
+        } catch (MasterDeviceSoeException &e) {
+            transfers[i].error_code = e.errorCode;
+            continue;
+        } catch (MasterDeviceException &e) {
+            continue;
+        }
+        transfers[i].data = buffers[i];
+        transfers[i].result_size = data.data_size;
+        transfers[i].result = 0;
+    }
+
+    m.close();
+
+    ofstream file(getOutputFile().c_str(), ios::out);
+    if (!file.good()) {
+        for (i = 0; i < buffers.size(); i++) {
+            delete [] buffers[i];
+        }
+        err << "Failed to open '" << getOutputFile() << "'!";
+        throwCommandException(err);
+    }
+
+    file << "# SoE parameters of slave " << position << endl;
+
+    for (i = 0; i < transfers.size(); i++) {
+        const ec_soe_transfer_t &t = transfers[i];
+        size_t j;
+
+        if (t.result) {
+            cerr << "Failed to read " << outputIdn(t.idn);
+            if (t.error_code) {
+                cerr << ": " << errorMsg(t.error_code);
+            }
+            cerr << endl;
+            failed++;
+            continue;
+        }
+
+        file << (unsigned int) drive_no << " " << outputIdn(t.idn) << " "
+            << hex << setfill('0');
+        for (j = 0; j < t.result_size; j++) {
+            file << setw(2) << (unsigned int) buffers[i][j];
+        }
+        file << dec << endl;
+    }
+
+    for (i = 0; i < buffers.size(); i++) {
+        delete [] buffers[i];
+    }
+
+    if (getVerbosity() != Quiet) {
+        cerr << transfers.size() - failed << " of " << transfers.size()
+            << " IDNs stored in " << getOutputFile() << "." << endl;
+    }
+
+    if (failed) {
+        err << failed << " IDN(s) could not be read.";
+        throwCommandException(err);
+    }
+}
+
+/*****************************************************************************/
+
+uint8_t CommandSoeRead::parseDrive(const string &arg)
+{
+    stringstream str, err;
+    unsigned int number;
+
+    str << arg;
+    str
+        >> resetiosflags(ios::basefield) // guess base from prefix
+        >> number;
+    if (str.fail() || number > 7) {
+        err << "Invalid drive number '" << arg << "'!";
+        throwInvalidUsageException(err);
+    }
+
+    return number;
+}
+
+/*****************************************************************************/
+
+vector<uint16_t> CommandSoeRead::parseIdnList(const string &arg)
+{
+    vector<uint16_t> idns;
+    stringstream str(arg), err;
+    string item;
+
+    while (getline(str, item, ',')) {
+        try {
+            idns.push_back(parseIdn(item));
+        } catch (runtime_error &e) {
+            err << "Invalid IDN '" << item << "': " << e.what();
+            throwInvalidUsageException(err);
+        }
+    }
+
+    return idns;
+}
+
+/*****************************************************************************/
+
+/** Reads the IDNs of the backup list S-0-0192.
+ *
+ * The list data start with the current and the maximum length in bytes,
+ * followed by the IDNs.
+ */
+vector<uint16_t> CommandSoeRead::readBackupList(MasterDevice &m,
+        uint16_t position, uint8_t drive_no)
+{
+    ec_ioctl_slave_soe_read_t data;
+    vector<uint16_t> idns;
+    vector<uint8_t> buffer(0x10000);
+    size_t length, i;
+    stringstream err;
+
+    data.slave_position = position;
+    data.drive_no = drive_no;
+    data.idn = 192;
+    data.mem_size = buffer.size();
+    data.data = &buffer.front();
+
+    try {
+        m.readSoe(&data);
+    } catch (MasterDeviceSoeException &e) {
+        err << "Failed to read the backup list: " << errorMsg(e.errorCode);
+        throwCommandException(err);
+    }
+
+    if (data.data_size < 4) {
+        err << "Invalid backup list size " << data.data_size << "!";
+        throwCommandException(err);
+    }
+
+    length = min((size_t) EC_READ_U16(&buffer[0]), data.data_size - 4);
+    for (i = 0; i + 1 < length; i += 2) {
+        idns.push_back(EC_READ_U16(&buffer[4 + i]));
+    }
+
+    return idns;
+}
+
+/*****************************************************************************/
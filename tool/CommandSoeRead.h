@@ -44,6 +44,14 @@ class CommandSoeRead:
 
         string helpString(const string &) const;
         void execute(const StringVector &);
+
+    protected:
+        enum {DefaultIdnSize = 1024};
+
+        void executeList(const StringVector &);
+        uint8_t parseDrive(const string &);
+        vector<uint16_t> parseIdnList(const string &);
+        vector<uint16_t> readBackupList(MasterDevice &, uint16_t, uint8_t);
 };
 
 /****************************************************************************/
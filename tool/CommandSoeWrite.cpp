@@ -29,6 +29,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <vector>
 using namespace std;
 
 #include "CommandSoeWrite.h"
@@ -51,6 +53,8 @@ string CommandSoeWrite::helpString(const string &binaryBaseName) const
         << " [OPTIONS] <IDN> <VALUE>" << endl
         << binaryBaseName << " " << getName()
         << " [OPTIONS] <DRIVE> <IDN> <VALUE>" << endl
+        << binaryBaseName << " " << getName()
+        << " [OPTIONS] <FILE>" << endl
         << endl
         << getBriefDescription() << endl
         << endl
@@ -66,9 +70,13 @@ string CommandSoeWrite::helpString(const string &binaryBaseName) const
         << "             Bit 11 - 0: Data block number" << endl
         << "           or a string like 'P-0-150'." << endl
         << "  VALUE    is the value to write (see below)." << endl
+        << "  FILE     is a parameter file created with 'soe_read'." << endl
 		<< endl
         << "The VALUE argument is interpreted as the given data type" << endl
 		<< "(--type is mandatory) and written to the selected slave." << endl
+        << endl
+        << "If a FILE is given, all IDNs in the file are written in" << endl
+        << "the order of the file, to restore a drive configuration." << endl
         << endl
 		<< typeInfo()
         << endl
@@ -94,6 +102,11 @@ void CommandSoeWrite::execute(const StringVector &args)
     size_t memSize;
     int driveArgIndex = -1, idnArgIndex = -1, valueArgIndex = -1;
 
+    if (args.size() == 1) {
+        executeRestore(args[0]);
+        return;
+    }
+
     if (args.size() == 2) {
         idnArgIndex = 0;
         valueArgIndex = 1;
@@ -102,7 +115,7 @@ void CommandSoeWrite::execute(const StringVector &args)
         idnArgIndex = 1;
         valueArgIndex = 2;
     } else {
-        err << "'" << getName() << "' takes eiter 2 or 3 arguments!";
+        err << "'" << getName() << "' takes eiter 1, 2 or 3 arguments!";
         throwInvalidUsageException(err);
     }
 
@@ -188,3 +201,128 @@ void CommandSoeWrite::execute(const StringVector &args)
 }
 
 /*****************************************************************************/
+
+void CommandSoeWrite::executeRestore(const string &fileName)
+{
+    stringstream err;
+    ifstream file(fileName.c_str(), ios::in);
+    SlaveList slaves;
+    vector<uint8_t> drives;
+    vector<ec_soe_transfer_t> transfers;
+    vector<vector<uint8_t> > values;
+    ec_ioctl_slave_soe_list_t io;
+    string line;
+    unsigned int lineNumber = 0, i, start, failed = 0;
+
+    if (!file.good()) {
+        err << "Failed to open '" << fileName << "'!";
+        throwCommandException(err);
+    }
+
+    while (getline(file, line)) {
+        stringstream str(line);
+        string idnStr, hexStr;
+        unsigned int drive;
+        ec_soe_transfer_t transfer;
+        vector<uint8_t> value;
+
+        lineNumber++;
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        if (!(str >> drive >> idnStr)) {
+            err << fileName << ":" << lineNumber << ": Invalid line!";
+            throwCommandException(err);
+        }
+        str >> hexStr; // empty for zero-size data
+        if (drive > 7) {
+            err << fileName << ":" << lineNumber << ": Invalid drive number!";
+            throwCommandException(err);
+        }
+
+        try {
+            transfer.idn = parseIdn(idnStr);
+        } catch (runtime_error &e) {
+            err << fileName << ":" << lineNumber << ": Invalid IDN '"
+                << idnStr << "': " << e.what();
+            throwCommandException(err);
+        }
+
+        if (hexStr.size() % 2) {
+            err << fileName << ":" << lineNumber << ": Invalid data!";
+            throwCommandException(err);
+        }
+        for (i = 0; i < hexStr.size(); i += 2) {
+            stringstream byteStr(hexStr.substr(i, 2));
+            unsigned int byte;
+
+            byteStr >> hex >> byte;
+            if (byteStr.fail()) {
+                err << fileName << ":" << lineNumber << ": Invalid data!";
+                throwCommandException(err);
+            }
+            value.push_back(byte);
+        }
+
+        drives.push_back(drive);
+        transfers.push_back(transfer);
+        values.push_back(value);
+    }
+
+    if (transfers.empty()) {
+        err << "No IDNs found in '" << fileName << "'.";
+        throwCommandException(err);
+    }
+
+    for (i = 0; i < transfers.size(); i++) {
+        transfers[i].data = values[i].empty() ? NULL : &values[i].front();
+        transfers[i].size = values[i].size();
+    }
+
+    MasterDevice m(getSingleMasterIndex());
+    m.open(MasterDevice::ReadWrite);
+    slaves = selectedSlaves(m);
+    if (slaves.size() != 1) {
+        throwSingleSlaveRequired(slaves.size());
+    }
+    io.slave_position = slaves.front().position;
+
+    // one list transfer per sequence of IDNs of the same drive
+    for (start = 0; start < transfers.size(); start = i) {
+        for (i = start; i < transfers.size() && drives[i] == drives[start];
+                i++) {}
+
+        io.drive_no = drives[start];
+        io.idn_count = i - start;
+        io.transfers = &transfers[start];
+        m.writeSoeList(&io);
+    }
+
+    for (i = 0; i < transfers.size(); i++) {
+        const ec_soe_transfer_t &t = transfers[i];
+
+        if (t.result) {
+            cerr << "Failed to write " << outputIdn(t.idn)
+                << " of drive " << (unsigned int) drives[i];
+            if (t.error_code) {
+                cerr << ": " << errorMsg(t.error_code);
+            }
+            cerr << endl;
+            failed++;
+        }
+    }
+
+    if (getVerbosity() != Quiet) {
+        cerr << transfers.size() - failed << " of " << transfers.size()
+            << " IDNs restored." << endl;
+    }
+
+    if (failed) {
+        err << failed << " IDN(s) could not be written.";
+        throwCommandException(err);
+    }
+}
+
+/*****************************************************************************/
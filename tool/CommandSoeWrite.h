@@ -44,6 +44,9 @@ class CommandSoeWrite:
 
         string helpString(const string &) const;
         void execute(const StringVector &);
+
+    protected:
+        void executeRestore(const string &);
 };
 
 /****************************************************************************/
@@ -0,0 +1,173 @@
+/*****************************************************************************
+ *
+ *  $Id$
+ *
+ *  Copyright (C) 2006-2009  Florian Pose, Ingenieurgemeinschaft IgH
+ *
+ *  This file is part of the IgH EtherCAT Master.
+ *
+ *  The IgH EtherCAT Master is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU General Public License version 2, as
+ *  published by the Free Software Foundation.
+ *
+ *  The IgH EtherCAT Master is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+ *  Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with the IgH EtherCAT Master; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  ---
+ *
+ *  The license mentioned above concerns the source code only. Using the
+ *  EtherCAT technology and brand is only permitted in compliance with the
+ *  industrial property and similar rights of Beckhoff Automation GmbH.
+ *
+ *  vim: expandtab
+ *
+ ****************************************************************************/
+
+#include <sched.h>
+
+#include <sstream>
+#include <iomanip>
+using namespace std;
+
+#include "CommandThread.h"
+#include "MasterDevice.h"
+#include "NumberListParser.h"
+
+/*****************************************************************************/
+
+class CpuListParser:
+    public NumberListParser
+{
+    protected:
+        int getMax() {
+            return 63; // the CPU mask has 64 bits
+        };
+};
+
+/*****************************************************************************/
+
+CommandThread::CommandThread():
+    Command("thread", "Set CPU affinity and scheduling of master threads.")
+{
+}
+
+/*****************************************************************************/
+
+string CommandThread::helpString(const string &binaryBaseName) const
+{
+    stringstream str;
+
+    str << binaryBaseName << " " << getName()
+        << " [OPTIONS] <THREAD> <CPUS> [<POLICY> [<PRIORITY>]]" << endl
+        << endl
+        << getBriefDescription() << endl
+        << endl
+        << "The settings are applied immediately, if the thread is" << endl
+        << "running, and are kept for later starts of the thread. Use" << endl
+        << "the 'master' command to show the current settings." << endl
+        << endl
+        << "Arguments:" << endl
+        << "  THREAD    can be 'master' (IDLE or OPERATION thread) or"
+        << endl
+        << "            'eoe'." << endl
+        << "  CPUS      List of CPUs the thread may run on. Ranges are"
+        << endl
+        << "            allowed. Examples: '2,3', '4-7'. 'all' removes"
+        << endl
+        << "            any restriction." << endl
+        << "  POLICY    can be 'normal' (default), 'fifo' or 'rr'." << endl
+        << "  PRIORITY  Real-time priority (1 - 99) for 'fifo' and 'rr',"
+        << endl
+        << "            nice value (-20 - 19, default: 0) for 'normal'."
+        << endl
+        << endl
+        << "Command-specific options:" << endl
+        << "  --master -m <indices>  Master indices. A comma-separated" << endl
+        << "                         list with ranges is supported." << endl
+        << "                         Example: 1,4,5,7-9. Default: - (all)."
+        << endl << endl
+        << numericInfo();
+
+    return str.str();
+}
+
+/****************************************************************************/
+
+void CommandThread::execute(const StringVector &args)
+{
+    MasterIndexList masterIndices;
+    ec_ioctl_master_thread_t data;
+
+    if (args.size() < 2 || args.size() > 4) {
+        stringstream err;
+        err << "'" << getName() << "' takes two to four arguments!";
+        throwInvalidUsageException(err);
+    }
+
+    if (args[0] == "master") {
+        data.thread = EC_THREAD_MASTER;
+    } else if (args[0] == "eoe") {
+        data.thread = EC_THREAD_EOE;
+    } else {
+        stringstream err;
+        err << "Invalid thread '" << args[0] << "'!";
+        throwInvalidUsageException(err);
+    }
+
+    data.cpu_mask = 0;
+    if (args[1] != "all") {
+        CpuListParser p;
+        NumberListParser::List cpus = p.parse(args[1].c_str());
+        NumberListParser::List::const_iterator ci;
+
+        for (ci = cpus.begin(); ci != cpus.end(); ci++) {
+            data.cpu_mask |= 1ULL << *ci;
+        }
+    }
+
+    data.policy = SCHED_OTHER;
+    if (args.size() > 2) {
+        if (args[2] == "fifo") {
+            data.policy = SCHED_FIFO;
+        } else if (args[2] == "rr") {
+            data.policy = SCHED_RR;
+        } else if (args[2] != "normal") {
+            stringstream err;
+            err << "Invalid policy '" << args[2] << "'!";
+            throwInvalidUsageException(err);
+        }
+    }
+
+    data.priority = 0;
+    if (args.size() > 3) {
+        stringstream str;
+        str << args[3];
+        str >> data.priority;
+        if (str.fail()) {
+            stringstream err;
+            err << "Invalid priority '" << args[3] << "'!";
+            throwInvalidUsageException(err);
+        }
+    } else if (data.policy != SCHED_OTHER) {
+        stringstream err;
+        err << "Policy '" << args[2] << "' requires a priority!";
+        throwInvalidUsageException(err);
+    }
+
+    masterIndices = getMasterIndices();
+    MasterIndexList::const_iterator mi;
+    for (mi = masterIndices.begin();
+            mi != masterIndices.end(); mi++) {
+        MasterDevice m(*mi);
+        m.open(MasterDevice::ReadWrite);
+        m.setThread(&data);
+    }
+}
+
+/*****************************************************************************/
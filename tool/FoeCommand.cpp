@@ -27,6 +27,9 @@
  *
  ****************************************************************************/
 
+#include <iostream>
+using namespace std;
+
 #include "FoeCommand.h"
 #include "foe.h"
 
@@ -74,6 +77,8 @@ std::string FoeCommand::resultText(int result)
             return "FOE_READ_NODATA_ERROR";
         case FOE_MBOX_PROT_ERROR:
             return "FOE_MBOX_PROT_ERROR";
+        case FOE_ABORTED_ERROR:
+            return "FOE_ABORTED_ERROR";
         default:
             return "???";
     }
@@ -112,3 +117,18 @@ std::string FoeCommand::errorText(int errorCode)
 }
 
 /****************************************************************************/
+
+void FoeCommand::printProgress(size_t done, size_t total) const
+{
+    if (getVerbosity() != Verbose) {
+        return;
+    }
+
+    cerr << "\r" << done << " bytes";
+    if (total) {
+        cerr << " (" << done * 100 / total << "%)";
+    }
+    cerr << flush;
+}
+
+/****************************************************************************/
@@ -41,8 +41,11 @@ class FoeCommand:
         FoeCommand(const string &, const string &);
 
     protected:
+        enum {ChunkSize = 0x8000};
+
         static std::string resultText(int);
         static std::string errorText(int);
+        void printProgress(size_t, size_t) const;
 };
 
 /****************************************************************************/
@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -462,6 +463,84 @@ void MasterDevice::writeFoe(
 
 /****************************************************************************/
 
+void MasterDevice::startFoe(
+        ec_ioctl_slave_foe_stream_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_STREAM_START, data) < 0) {
+        stringstream err;
+        err << "Failed to start FoE transfer: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::transferFoe(
+        ec_ioctl_slave_foe_stream_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_STREAM_DATA, data) < 0) {
+        stringstream err;
+        err << "Failed to transfer FoE data: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::finishFoe(
+        ec_ioctl_slave_foe_stream_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_STREAM_END, data) < 0) {
+        stringstream err;
+        err << "Failed to finish FoE transfer: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::startFoeBatch(
+        ec_ioctl_slave_foe_batch_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_BATCH_START, data) < 0) {
+        stringstream err;
+        err << "Failed to start FoE batch transfer: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::getFoeBatchStatus(
+        ec_ioctl_slave_foe_batch_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_BATCH_STATUS, data) < 0) {
+        stringstream err;
+        err << "Failed to get FoE batch status: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::finishFoeBatch(
+        ec_ioctl_slave_foe_batch_t *data
+        )
+{
+    if (ioctl(fd, EC_IOCTL_SLAVE_FOE_BATCH_END, data) < 0) {
+        stringstream err;
+        err << "Failed to finish FoE batch transfer: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
 void MasterDevice::setDebug(unsigned int debugLevel)
 {
     if (ioctl(fd, EC_IOCTL_MASTER_DEBUG, debugLevel) < 0) {
@@ -473,6 +552,17 @@ void MasterDevice::setDebug(unsigned int debugLevel)
 
 /****************************************************************************/
 
+void MasterDevice::setThread(ec_ioctl_master_thread_t *data)
+{
+    if (ioctl(fd, EC_IOCTL_MASTER_THREAD, data) < 0) {
+        stringstream err;
+        err << "Failed to set thread parameters: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
 void MasterDevice::rescan()
 {
     if (ioctl(fd, EC_IOCTL_MASTER_RESCAN, 0) < 0) {
@@ -587,6 +677,30 @@ void MasterDevice::writeSoe(ec_ioctl_slave_soe_write_t *data)
 
 /****************************************************************************/
 
+void MasterDevice::readSoeList(ec_ioctl_slave_soe_list_t *data)
+{
+    // EIO: results are stored in the list elements
+    if (ioctl(fd, EC_IOCTL_SLAVE_SOE_READ_LIST, data) < 0 && errno != EIO) {
+        stringstream err;
+        err << "Failed to read IDNs: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
+void MasterDevice::writeSoeList(ec_ioctl_slave_soe_list_t *data)
+{
+    // EIO: results are stored in the list elements
+    if (ioctl(fd, EC_IOCTL_SLAVE_SOE_WRITE_LIST, data) < 0 && errno != EIO) {
+        stringstream err;
+        err << "Failed to write IDNs: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
+/****************************************************************************/
+
 void MasterDevice::setIpParam(ec_ioctl_slave_eoe_ip_t *data)
 {
     if (ioctl(fd, EC_IOCTL_SLAVE_EOE_IP_PARAM, data) < 0) {
@@ -600,4 +714,41 @@ void MasterDevice::setIpParam(ec_ioctl_slave_eoe_ip_t *data)
     }
 }
 
+/****************************************************************************/
+
+void *MasterDevice::startCapture(ec_ioctl_capture_t *data)
+{
+    void *ring;
+
+    if (ioctl(fd, EC_IOCTL_CAPTURE_START, data) < 0) {
+        stringstream err;
+        err << "Failed to start capture: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+
+    ring = mmap(0, data->mmap_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+            EC_CAPTURE_MMAP_OFFSET(data->dev_idx));
+    if (ring == MAP_FAILED) {
+        stringstream err;
+        err << "Failed to map capture ring: " << strerror(errno);
+        ioctl(fd, EC_IOCTL_CAPTURE_STOP, data);
+        throw MasterDeviceException(err);
+    }
+
+    return ring;
+}
+
+/****************************************************************************/
+
+void MasterDevice::stopCapture(ec_ioctl_capture_t *data, void *ring)
+{
+    munmap(ring, data->mmap_size);
+
+    if (ioctl(fd, EC_IOCTL_CAPTURE_STOP, data) < 0) {
+        stringstream err;
+        err << "Failed to stop capture: " << strerror(errno);
+        throw MasterDeviceException(err);
+    }
+}
+
 /*****************************************************************************/
@@ -150,18 +150,29 @@ class MasterDevice
         void readReg(ec_ioctl_slave_reg_t *);
         void writeReg(ec_ioctl_slave_reg_t *);
         void setDebug(unsigned int);
+        void setThread(ec_ioctl_master_thread_t *);
         void rescan();
         void sdoDownload(ec_ioctl_slave_sdo_download_t *);
         void sdoUpload(ec_ioctl_slave_sdo_upload_t *);
         void requestState(uint16_t, uint8_t);
         void readFoe(ec_ioctl_slave_foe_t *);
         void writeFoe(ec_ioctl_slave_foe_t *);
+        void startFoe(ec_ioctl_slave_foe_stream_t *);
+        void transferFoe(ec_ioctl_slave_foe_stream_t *);
+        void finishFoe(ec_ioctl_slave_foe_stream_t *);
+        void startFoeBatch(ec_ioctl_slave_foe_batch_t *);
+        void getFoeBatchStatus(ec_ioctl_slave_foe_batch_t *);
+        void finishFoeBatch(ec_ioctl_slave_foe_batch_t *);
 #ifdef EC_EOE
         void getEoeHandler(ec_ioctl_eoe_handler_t *, uint16_t);
 #endif
         void readSoe(ec_ioctl_slave_soe_read_t *);
         void writeSoe(ec_ioctl_slave_soe_write_t *);
+        void readSoeList(ec_ioctl_slave_soe_list_t *);
+        void writeSoeList(ec_ioctl_slave_soe_list_t *);
         void setIpParam(ec_ioctl_slave_eoe_ip_t *);
+        void *startCapture(ec_ioctl_capture_t *);
+        void stopCapture(ec_ioctl_capture_t *, void *);
 
         unsigned int getMasterCount() const {return masterCount;}
 
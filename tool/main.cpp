@@ -36,6 +36,7 @@
 using namespace std;
 
 #include "CommandAlias.h"
+#include "CommandCapture.h"
 #include "CommandConfig.h"
 #include "CommandCStruct.h"
 #include "CommandData.h"
@@ -46,6 +47,7 @@ using namespace std;
 # include "CommandEoe.h"
 #endif
 #include "CommandFoeRead.h"
+#include "CommandFoeUpdate.h"
 #include "CommandFoeWrite.h"
 #include "CommandGraph.h"
 #include "CommandIp.h"
@@ -61,6 +63,7 @@ using namespace std;
 #include "CommandSoeRead.h"
 #include "CommandSoeWrite.h"
 #include "CommandStates.h"
+#include "CommandThread.h"
 #include "CommandUpload.h"
 #include "CommandVersion.h"
 #include "CommandXml.h"
@@ -277,6 +280,7 @@ int main(int argc, char **argv)
     binaryBaseName = basename(argv[0]);
 
     commandList.push_back(new CommandAlias());
+    commandList.push_back(new CommandCapture());
     commandList.push_back(new CommandConfig());
     commandList.push_back(new CommandCStruct());
     commandList.push_back(new CommandData());
@@ -287,6 +291,7 @@ int main(int argc, char **argv)
     commandList.push_back(new CommandEoe());
 #endif
     commandList.push_back(new CommandFoeRead());
+    commandList.push_back(new CommandFoeUpdate());
     commandList.push_back(new CommandFoeWrite());
     commandList.push_back(new CommandGraph());
     commandList.push_back(new CommandIp());
@@ -302,6 +307,7 @@ int main(int argc, char **argv)
     commandList.push_back(new CommandSoeRead());
     commandList.push_back(new CommandSoeWrite());
     commandList.push_back(new CommandStates());
+    commandList.push_back(new CommandThread());
     commandList.push_back(new CommandUpload());
     commandList.push_back(new CommandVersion());
     commandList.push_back(new CommandXml());
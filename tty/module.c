@@ -39,7 +39,7 @@
 #include <linux/tty_driver.h>
 #include <linux/tty_flip.h>
 #include <linux/termios.h>
-#include <linux/timer.h>
+#include <linux/interrupt.h>
 #include <linux/version.h>
 #include <linux/serial.h>
 #include <linux/uaccess.h>
@@ -53,11 +53,16 @@
 #define PFX "ec_tty: "
 
 #define EC_TTY_MAX_DEVICES 32
-#define EC_TTY_TX_BUFFER_SIZE 100
-#define EC_TTY_RX_BUFFER_SIZE 100
+#define EC_TTY_TX_BUFFER_SIZE 0x400 /**< Must be a power of two. */
+#define EC_TTY_RX_BUFFER_SIZE 0x400 /**< Must be a power of two. */
 
 #define EC_TTY_DEBUG 0
 
+#ifndef READ_ONCE
+#define READ_ONCE(x) ACCESS_ONCE(x)
+#define WRITE_ONCE(x, val) (ACCESS_ONCE(x) = (val))
+#endif
+
 /*****************************************************************************/
 
 char *ec_master_version_str = EC_MASTER_VERSION; /**< Version string. */
@@ -95,20 +100,32 @@ static struct ktermios ec_tty_std_termios = {
     .c_cc = INIT_C_CC,
 };
 
+/** Virtual TTY interface.
+ *
+ * Both rings have a single producer and a single consumer and are lock-free:
+ * The TTY core writes into the transmit ring and ectty_tx_data() reads from
+ * it, ectty_rx_data() writes into the receive ring and the wakeup tasklet
+ * reads from it. The indices are free-running and masked on access.
+ */
 struct ec_tty {
     int minor;
     struct device *dev;
 
     uint8_t tx_buffer[EC_TTY_TX_BUFFER_SIZE];
-    unsigned int tx_read_idx;
-    unsigned int tx_write_idx;
+    unsigned int tx_read_idx; /**< Written by ectty_tx_data() only. */
+    unsigned int tx_write_idx; /**< Written by the TTY core only. */
+    unsigned int tx_flush_idx; /**< Transmit data before this index shall be
+                                 discarded. */
+    unsigned int tx_flush_count; /**< Number of flush requests. */
+    unsigned int tx_flush_seen; /**< Number of flush requests handled. */
     unsigned int wakeup;
 
     uint8_t rx_buffer[EC_TTY_RX_BUFFER_SIZE];
-    unsigned int rx_read_idx;
-    unsigned int rx_write_idx;
+    unsigned int rx_read_idx; /**< Written by the wakeup tasklet only. */
+    unsigned int rx_write_idx; /**< Written by ectty_rx_data() only. */
 
-    struct timer_list timer;
+    struct tasklet_struct tasklet; /**< Wakeup tasklet, scheduled from the
+                                     application cycle. */
     struct tty_struct *tty;
     unsigned int open_count;
     struct semaphore sem;
@@ -194,13 +211,19 @@ int ec_tty_init(ec_tty_t *t, int minor,
     struct tty_struct *tty;
     struct ktermios *termios;
 
+    BUILD_BUG_ON(EC_TTY_TX_BUFFER_SIZE & (EC_TTY_TX_BUFFER_SIZE - 1));
+    BUILD_BUG_ON(EC_TTY_RX_BUFFER_SIZE & (EC_TTY_RX_BUFFER_SIZE - 1));
+
     t->minor = minor;
     t->tx_read_idx = 0;
     t->tx_write_idx = 0;
+    t->tx_flush_idx = 0;
+    t->tx_flush_count = 0;
+    t->tx_flush_seen = 0;
     t->wakeup = 0;
     t->rx_read_idx = 0;
     t->rx_write_idx = 0;
-    init_timer(&t->timer);
+    tasklet_init(&t->tasklet, ec_tty_wakeup, (unsigned long) t);
     t->tty = NULL;
     t->open_count = 0;
     sema_init(&t->sem, 1);
@@ -237,10 +260,6 @@ int ec_tty_init(ec_tty_t *t, int minor,
         return ret;
     }
 
-    t->timer.function = ec_tty_wakeup;
-    t->timer.data = (unsigned long) t;
-    t->timer.expires = jiffies + 10;
-    add_timer(&t->timer);
     return 0;
 }
 
@@ -248,52 +267,116 @@ int ec_tty_init(ec_tty_t *t, int minor,
 
 void ec_tty_clear(ec_tty_t *tty)
 {
-    del_timer_sync(&tty->timer);
+    tasklet_kill(&tty->tasklet);
     tty_unregister_device(tty_driver, tty->minor);
 }
 
 /*****************************************************************************/
 
-unsigned int ec_tty_tx_size(ec_tty_t *tty)
+/** Copies data into a ring.
+ *
+ * The data are copied with at most two memcpy() calls, in case they wrap
+ * around the end of the ring.
+ */
+static void ec_tty_ring_write(
+        uint8_t *ring, /**< Ring buffer. */
+        unsigned int ring_size, /**< Ring size (power of two). */
+        unsigned int index, /**< Free-running write index. */
+        const uint8_t *data, /**< Source data. */
+        unsigned int size /**< Number of bytes to copy. */
+        )
 {
-    unsigned int ret;
+    unsigned int offset = index & (ring_size - 1);
+    unsigned int first = min(size, ring_size - offset);
 
-    if (tty->tx_write_idx >= tty->tx_read_idx) {
-        ret = tty->tx_write_idx - tty->tx_read_idx;
-    } else {
-        ret = EC_TTY_TX_BUFFER_SIZE + tty->tx_write_idx - tty->tx_read_idx;
+    memcpy(ring + offset, data, first);
+    memcpy(ring, data + first, size - first);
+}
+
+/*****************************************************************************/
+
+/** Copies data out of a ring.
+ *
+ * \see ec_tty_ring_write()
+ */
+static void ec_tty_ring_read(
+        const uint8_t *ring, /**< Ring buffer. */
+        unsigned int ring_size, /**< Ring size (power of two). */
+        unsigned int index, /**< Free-running read index. */
+        uint8_t *data, /**< Target buffer. */
+        unsigned int size /**< Number of bytes to copy. */
+        )
+{
+    unsigned int offset = index & (ring_size - 1);
+    unsigned int first = min(size, ring_size - offset);
+
+    memcpy(data, ring + offset, first);
+    memcpy(data + first, ring, size - first);
+}
+
+/*****************************************************************************/
+
+/** Returns the effective transmit read index.
+ *
+ * A pending flush request moves the read index forward to the write index,
+ * that was valid at the time of the flush. The write index is read after the
+ * flush index, so it is never behind the returned read index.
+ */
+unsigned int ec_tty_tx_read_idx(
+        ec_tty_t *tty, /**< TTY interface. */
+        unsigned int *flush_count, /**< Flush requests considered. */
+        unsigned int *write_idx /**< Write index. */
+        )
+{
+    unsigned int read_idx = READ_ONCE(tty->tx_read_idx);
+    unsigned int count = READ_ONCE(tty->tx_flush_count);
+
+    smp_rmb(); // flush index is valid for the count read above
+    if (count != READ_ONCE(tty->tx_flush_seen)) {
+        unsigned int flush_idx = READ_ONCE(tty->tx_flush_idx);
+        if ((int) (flush_idx - read_idx) > 0) {
+            read_idx = flush_idx;
+        }
     }
 
-    return ret;
+    smp_rmb(); // write index not older than the flush index
+    *write_idx = READ_ONCE(tty->tx_write_idx);
+
+    if (flush_count) {
+        *flush_count = count;
+    }
+    return read_idx;
 }
 
 /*****************************************************************************/
 
-unsigned int ec_tty_tx_space(ec_tty_t *tty)
+unsigned int ec_tty_tx_size(ec_tty_t *tty)
 {
-    return EC_TTY_TX_BUFFER_SIZE - 1 - ec_tty_tx_size(tty);
+    unsigned int read_idx, write_idx;
+
+    read_idx = ec_tty_tx_read_idx(tty, NULL, &write_idx);
+    return write_idx - read_idx;
 }
 
 /*****************************************************************************/
 
-unsigned int ec_tty_rx_size(ec_tty_t *tty)
+unsigned int ec_tty_tx_space(ec_tty_t *tty)
 {
-    unsigned int ret;
+    return EC_TTY_TX_BUFFER_SIZE - ec_tty_tx_size(tty);
+}
 
-    if (tty->rx_write_idx >= tty->rx_read_idx) {
-        ret = tty->rx_write_idx - tty->rx_read_idx;
-    } else {
-        ret = EC_TTY_RX_BUFFER_SIZE + tty->rx_write_idx - tty->rx_read_idx;
-    }
+/*****************************************************************************/
 
-    return ret;
+unsigned int ec_tty_rx_size(ec_tty_t *tty)
+{
+    return READ_ONCE(tty->rx_write_idx) - READ_ONCE(tty->rx_read_idx);
 }
 
 /*****************************************************************************/
 
 unsigned int ec_tty_rx_space(ec_tty_t *tty)
 {
-    return EC_TTY_RX_BUFFER_SIZE - 1 - ec_tty_rx_size(tty);
+    return EC_TTY_RX_BUFFER_SIZE - ec_tty_rx_size(tty);
 }
 
 /*****************************************************************************/
@@ -315,7 +398,11 @@ int ec_tty_get_serial_info(ec_tty_t *tty, struct serial_struct *data)
 
 /*****************************************************************************/
 
-/** Timer function.
+/** Wakeup tasklet function.
+ *
+ * Scheduled by ectty_tx_data() and ectty_rx_data(), so that writers are woken
+ * up and received data are pushed into the TTY core right after the
+ * application cycle, that exchanged them.
  */
 void ec_tty_wakeup(unsigned long data)
 {
@@ -323,14 +410,14 @@ void ec_tty_wakeup(unsigned long data)
     size_t to_recv;
 
     /* Wake up any process waiting to send data */
-    if (tty->wakeup) {
+    if (READ_ONCE(tty->wakeup)) {
+        WRITE_ONCE(tty->wakeup, 0);
         if (tty->tty) {
 #if EC_TTY_DEBUG >= 1
             printk(KERN_INFO PFX "Waking up.\n");
 #endif
             tty_wakeup(tty->tty);
         }
-        tty->wakeup = 0;
     }
 
     /* Push received data into TTY core. */
@@ -340,8 +427,8 @@ void ec_tty_wakeup(unsigned long data)
         int space = tty_prepare_flip_string(tty->tty, &cbuf, to_recv);
 
         if (space < to_recv) {
-            printk(KERN_WARNING PFX "Insufficient space to_recv=%d space=%d\n",
-                    to_recv, space);
+            printk(KERN_WARNING PFX "Insufficient space to_recv=%zu"
+                    " space=%d\n", to_recv, space);
         }
 
         if (space < 0) {
@@ -351,23 +438,18 @@ void ec_tty_wakeup(unsigned long data)
         }
 
         if (to_recv) {
-            unsigned int i;
-
 #if EC_TTY_DEBUG >= 1
-            printk(KERN_INFO PFX "Pushing %u bytes to TTY core.\n", to_recv);
+            printk(KERN_INFO PFX "Pushing %zu bytes to TTY core.\n", to_recv);
 #endif
 
-            for (i = 0; i < to_recv; i++) {
-                cbuf[i] = tty->rx_buffer[tty->rx_read_idx];
-                tty->rx_read_idx =
-                    (tty->rx_read_idx + 1) % EC_TTY_RX_BUFFER_SIZE;
-            }
+            smp_rmb(); // read the data after the write index
+            ec_tty_ring_read(tty->rx_buffer, EC_TTY_RX_BUFFER_SIZE,
+                    tty->rx_read_idx, cbuf, to_recv);
+            smp_mb(); // finish reading before releasing the space
+            WRITE_ONCE(tty->rx_read_idx, tty->rx_read_idx + to_recv);
             tty_flip_buffer_push(tty->tty);
         }
     }
-
-    tty->timer.expires += 1;
-    add_timer(&tty->timer);
 }
 
 /******************************************************************************
@@ -403,6 +485,8 @@ static int ec_tty_open(struct tty_struct *tty, struct file *file)
     down(&t->sem);
     t->open_count++;
     up(&t->sem);
+
+    tasklet_schedule(&t->tasklet); // push data received while closed
     return 0;
 }
 
@@ -435,7 +519,7 @@ static int ec_tty_write(
         )
 {
     ec_tty_t *t = (ec_tty_t *) tty->driver_data;
-    unsigned int data_size, i;
+    unsigned int data_size;
 
 #if EC_TTY_DEBUG >= 1
     printk(KERN_INFO PFX "%s(count=%i)\n", __func__, count);
@@ -446,9 +530,12 @@ static int ec_tty_write(
     }
 
     data_size = min(ec_tty_tx_space(t), (unsigned int) count);
-    for (i = 0; i < data_size; i++) {
-        t->tx_buffer[t->tx_write_idx] = buffer[i];
-        t->tx_write_idx = (t->tx_write_idx + 1) % EC_TTY_TX_BUFFER_SIZE;
+    if (data_size) {
+        smp_mb(); // the space was released before it is overwritten
+        ec_tty_ring_write(t->tx_buffer, EC_TTY_TX_BUFFER_SIZE,
+                t->tx_write_idx, buffer, data_size);
+        smp_wmb(); // publish the data before the write index
+        WRITE_ONCE(t->tx_write_idx, t->tx_write_idx + data_size);
     }
 
 #if EC_TTY_DEBUG >= 1
@@ -472,8 +559,10 @@ static void ec_tty_put_char(struct tty_struct *tty, unsigned char ch)
 #endif
 
     if (ec_tty_tx_space(t)) {
-        t->tx_buffer[t->tx_write_idx] = ch;
-        t->tx_write_idx = (t->tx_write_idx + 1) % EC_TTY_TX_BUFFER_SIZE;
+        smp_mb(); // the space was released before it is overwritten
+        t->tx_buffer[t->tx_write_idx & (EC_TTY_TX_BUFFER_SIZE - 1)] = ch;
+        smp_wmb(); // publish the data before the write index
+        WRITE_ONCE(t->tx_write_idx, t->tx_write_idx + 1);
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 26)
         return 1;
 #endif
@@ -521,13 +610,30 @@ static int ec_tty_chars_in_buffer(struct tty_struct *tty)
 
 /*****************************************************************************/
 
+/** Discards the data in the transmit ring.
+ *
+ * The read index belongs to ectty_tx_data(), so the flush is only requested
+ * here and carried out by the reader.
+ */
 static void ec_tty_flush_buffer(struct tty_struct *tty)
 {
+    ec_tty_t *t = (ec_tty_t *) tty->driver_data;
+
 #if EC_TTY_DEBUG >= 2
     printk(KERN_INFO PFX "%s().\n", __func__);
 #endif
 
-    // FIXME empty ring buffer
+    if (!t) {
+        return;
+    }
+
+    // take the write index once, a concurrent write either ends before it
+    // and is discarded, or after it and is sent completely
+    WRITE_ONCE(t->tx_flush_idx, READ_ONCE(t->tx_write_idx));
+    smp_wmb(); // publish the flush index before the request
+    WRITE_ONCE(t->tx_flush_count, t->tx_flush_count + 1);
+
+    tty_wakeup(tty);
 }
 
 /*****************************************************************************/
@@ -753,21 +859,28 @@ void ectty_free(ec_tty_t *tty)
 
 unsigned int ectty_tx_data(ec_tty_t *tty, uint8_t *buffer, size_t size)
 {
-    unsigned int data_size = min(ec_tty_tx_size(tty), size), i;
+    unsigned int read_idx, write_idx, flush_count, data_size;
+
+    read_idx = ec_tty_tx_read_idx(tty, &flush_count, &write_idx);
+    data_size = min((size_t) (write_idx - read_idx), size);
 
     if (data_size)  {
 #if EC_TTY_DEBUG >= 1
         printk(KERN_INFO PFX "Fetching %u bytes to send.\n", data_size);
 #endif
-    }
 
-    for (i = 0; i < data_size; i++) {
-        buffer[i] = tty->tx_buffer[tty->tx_read_idx];
-        tty->tx_read_idx = (tty->tx_read_idx + 1) % EC_TTY_TX_BUFFER_SIZE;
+        smp_rmb(); // read the data after the write index
+        ec_tty_ring_read(tty->tx_buffer, EC_TTY_TX_BUFFER_SIZE, read_idx,
+                buffer, data_size);
+        smp_mb(); // finish reading before releasing the space
     }
 
+    WRITE_ONCE(tty->tx_read_idx, read_idx + data_size);
+    WRITE_ONCE(tty->tx_flush_seen, flush_count);
+
     if (data_size) {
-        tty->wakeup = 1;
+        WRITE_ONCE(tty->wakeup, 1);
+        tasklet_schedule(&tty->tasklet);
     }
 
     return data_size;
@@ -780,22 +893,23 @@ void ectty_rx_data(ec_tty_t *tty, const uint8_t *buffer, size_t size)
     size_t to_recv;
 
     if (size)  {
-        unsigned int i;
-
 #if EC_TTY_DEBUG >= 1
-        printk(KERN_INFO PFX "Received %u bytes.\n", size);
+        printk(KERN_INFO PFX "Received %zu bytes.\n", size);
 #endif
 
-        to_recv = min(ec_tty_rx_space(tty), size);
+        to_recv = min((size_t) ec_tty_rx_space(tty), size);
 
         if (to_recv < size) {
-            printk(KERN_WARNING PFX "Dropping %u bytes.\n", size - to_recv);
+            printk(KERN_WARNING PFX "Dropping %zu bytes.\n", size - to_recv);
         }
 
-        for (i = 0; i < size; i++) {
-            tty->rx_buffer[tty->rx_write_idx] = buffer[i];
-            tty->rx_write_idx =
-                (tty->rx_write_idx + 1) % EC_TTY_RX_BUFFER_SIZE;
+        if (to_recv) {
+            smp_mb(); // the space was released before it is overwritten
+            ec_tty_ring_write(tty->rx_buffer, EC_TTY_RX_BUFFER_SIZE,
+                    tty->rx_write_idx, buffer, to_recv);
+            smp_wmb(); // publish the data before the write index
+            WRITE_ONCE(tty->rx_write_idx, tty->rx_write_idx + to_recv);
+            tasklet_schedule(&tty->tasklet);
         }
     }
 }